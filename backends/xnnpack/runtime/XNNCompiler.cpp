@@ -1771,6 +1771,7 @@ ET_NODISCARD Error XNNCompiler::compileModel(
     XNNExecutor* executor,
     XNNWeightsCache* weights_cache,
     xnn_workspace_t workspace,
+    std::mutex* workspace_mutex,
     const NamedDataMap* named_data_map) {
   Result<XNNHeader> header = XNNHeader::Parse(buffer_pointer, num_bytes);
   const uint8_t* flatbuffer_data = nullptr;
@@ -1894,13 +1895,19 @@ ET_NODISCARD Error XNNCompiler::compileModel(
 #ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
   ET_CHECK_OR_RETURN_ERROR(
       workspace != nullptr, Internal, "Failed to initialize XNNPACK workspace");
-  status = xnn_create_runtime_v4(
-      subgraph.get(),
-      weights_cache_ptr,
-      workspace,
-      ::executorch::extension::threadpool::get_pthreadpool(),
-      runtime_flags,
-      &runtime_ptr);
+  {
+    std::unique_lock<std::mutex> workspace_lock;
+    if (workspace_mutex != nullptr) {
+      workspace_lock = std::unique_lock<std::mutex>(*workspace_mutex);
+    }
+    status = xnn_create_runtime_v4(
+        subgraph.get(),
+        weights_cache_ptr,
+        workspace,
+        ::executorch::extension::threadpool::get_pthreadpool(),
+        runtime_flags,
+        &runtime_ptr);
+  }
 #else
   status = xnn_create_runtime_v3(
       subgraph.get(),
@@ -13,6 +13,8 @@
 #include <executorch/runtime/platform/compiler.h>
 #include <xnnpack.h>
 
+#include <mutex>
+
 namespace executorch {
 namespace backends {
 namespace xnnpack {
@@ -23,12 +25,15 @@ class XNNCompiler {
   // Takes Flatbuffer Serialized XNNPACK Model and rebuilds the xnn-subgraph
   // returns an executor object that holds the xnn runtime object which we
   // can then use to set inputs and run inference using the xnn graph.
+  // If workspace_mutex is not null, it is held while the runtime is created
+  // with the shared workspace.
   ET_NODISCARD static executorch::runtime::Error compileModel(
       const void* buffer_pointer,
       size_t num_bytes,
       XNNExecutor* executor,
       XNNWeightsCache* weights_cache,
       xnn_workspace_t workspace,
+      std::mutex* workspace_mutex,
       const NamedDataMap* named_data_map);
 };
 
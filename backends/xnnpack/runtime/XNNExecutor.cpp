@@ -63,7 +63,9 @@ ET_NODISCARD Error XNNExecutor::initialize(
  * Creates an array of xnn_externals_values from the EValues passed in.
  * Reshapes all the external input tensors, in case any input shapes have
  * changed. The reshapes the entire runtime, propagating shape information
- * through the runtime.
+ * through the runtime. When the input shapes are the same as in the previous
+ * call, the runtime is still reshaped for them and both steps are skipped.
+ * The shapes are compared in place, so that such a call doesn't allocate.
  *
  * Note: the external ids given to the external tensors in the XNNPACK
  * runtime correspond to their index in the list of arg passed into
@@ -75,8 +77,21 @@ ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
       Internal,
       "XNNPACK Delegate did not compile correctly");
 
+  // Compare the input shapes against the ones the runtime is reshaped for,
+  // overwriting any that differ.
+  size_t offset = 0;
+  const auto record_shape = [&](size_t value) {
+    if (offset == input_shapes_.size()) {
+      input_shapes_.push_back(value);
+      shapes_valid_ = false;
+    } else if (input_shapes_[offset] != value) {
+      input_shapes_[offset] = value;
+      shapes_valid_ = false;
+    }
+    ++offset;
+  };
+
   // Create xnn_externals_value from evalue args
-  xnn_status status;
   for (uint32_t i = 0; i < externals_.size(); ++i) {
     if (i < input_ids_.size()) {
       externals_[i].id = input_ids_[i];
@@ -97,7 +112,7 @@ ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
 
     executorch::aten::DimOrderType dim_order[kTensorDimensionLimit];
 
-    // Reshape runtime inputs
+    // Collect runtime input shapes
     if (i < input_ids_.size()) {
       size_t num_dims = tensor->dim();
       Error err =
@@ -106,7 +121,6 @@ ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
           err == Error::Ok,
           Internal,
           "Failed to retrieve dim order from tensor!");
-      size_t dims[XNN_MAX_TENSOR_DIMS];
       ET_CHECK_OR_RETURN_ERROR(
           num_dims <= XNN_MAX_TENSOR_DIMS,
           InvalidArgument,
@@ -114,18 +128,47 @@ ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
           XNN_MAX_TENSOR_DIMS,
           num_dims);
 
+      record_shape(num_dims);
       for (int j = 0; j < num_dims; ++j) {
-        dims[j] = tensor->size(static_cast<int>(dim_order[j]));
+        record_shape(tensor->size(static_cast<int>(dim_order[j])));
       }
-      status =
-          xnn_reshape_external_value(runtime_.get(), ext_id, num_dims, dims);
-      ET_CHECK_OR_RETURN_ERROR(
-          status == xnn_status_success,
-          Internal,
-          "Internal Error: Reshape Input Tensor Failed with code: %s",
-          xnn_status_to_string(status));
     }
   }
+
+  if (offset != input_shapes_.size()) {
+    input_shapes_.resize(offset);
+    shapes_valid_ = false;
+  }
+
+  // The runtime is already reshaped for these input shapes.
+  if (shapes_valid_) {
+    return Error::Ok;
+  }
+  return reshape_runtime();
+}
+
+/**
+ * Reshapes the runtime for input_shapes_ and fetches the resulting output
+ * shapes.
+ */
+ET_NODISCARD Error XNNExecutor::reshape_runtime() {
+  // Reshape runtime inputs
+  xnn_status status;
+  size_t offset = 0;
+  for (uint32_t i = 0; i < input_ids_.size(); ++i) {
+    const size_t num_dims = input_shapes_[offset];
+    status = xnn_reshape_external_value(
+        runtime_.get(),
+        externals_[i].id,
+        num_dims,
+        input_shapes_.data() + offset + 1);
+    ET_CHECK_OR_RETURN_ERROR(
+        status == xnn_status_success,
+        Internal,
+        "Internal Error: Reshape Input Tensor Failed with code: %s",
+        xnn_status_to_string(status));
+    offset += num_dims + 1;
+  }
   // // Propagate Input Shape and Memory Plan for increased allocation
   status = xnn_reshape_runtime(runtime_.get());
 
@@ -135,6 +178,24 @@ ET_NODISCARD Error XNNExecutor::prepare_args(EValue** args) {
       "Internal Error: Propagating input shapes failed with code: %s",
       xnn_status_to_string(status));
 
+  output_shapes_.clear();
+  for (uint32_t output_id : output_ids_) {
+    size_t num_dim;
+    size_t dims[XNN_MAX_TENSOR_DIMS];
+
+    // Fetch the updated output shapes from xnnpack runtime
+    status = xnn_get_external_value_shape(
+        runtime_.get(), output_id, &num_dim, dims);
+
+    ET_CHECK_OR_RETURN_ERROR(
+        status == xnn_status_success,
+        Internal,
+        "Internal Error: Failed to retrieve graph output shapes");
+    output_shapes_.push_back(num_dim);
+    output_shapes_.insert(output_shapes_.end(), dims, dims + num_dim);
+  }
+  shapes_valid_ = true;
+  ++num_reshapes_;
   return Error::Ok;
 }
 
@@ -197,22 +258,20 @@ ET_NODISCARD Error XNNExecutor::forward(BackendExecutionContext& context) {
  * back to int64 for ExecuTorch.
  */
 ET_NODISCARD Error XNNExecutor::resize_outputs(EValue** args) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      shapes_valid_,
+      Internal,
+      "Output shapes are not known before prepare_args()");
   size_t output_idx_start = input_ids_.size();
+  size_t offset = 0;
   for (size_t i = output_idx_start; i < externals_.size(); ++i) {
     uint32_t ext_id = externals_[i].id;
     Tensor* out_tensor = &args[ext_id]->toTensor();
 
-    size_t num_dim;
-    size_t dims[XNN_MAX_TENSOR_DIMS];
-
-    // Fetch the updated output shapes from xnnpack runtime
-    xnn_status status =
-        xnn_get_external_value_shape(runtime_.get(), ext_id, &num_dim, dims);
-
-    ET_CHECK_OR_RETURN_ERROR(
-        status == xnn_status_success,
-        Internal,
-        "Internal Error: Failed to retrieve graph output shapes");
+    // The output shapes computed by the xnnpack runtime
+    const size_t num_dim = output_shapes_[offset];
+    const size_t* dims = output_shapes_.data() + offset + 1;
+    offset += num_dim + 1;
 
     // Convert new output shape into SizesType
     SizesType expected_output_size[kTensorDimensionLimit];
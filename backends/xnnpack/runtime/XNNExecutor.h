@@ -15,6 +15,7 @@
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
 
 #include <xnnpack.h>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <vector>
@@ -36,6 +37,21 @@ class XNNExecutor {
   std::vector<xnn_external_value> externals_;
   std::vector<std::string> packed_data_names_;
 
+  // The input shapes that the runtime is currently reshaped for, and the
+  // output shapes it computed for them. Shapes are flattened as the rank of
+  // each tensor followed by its dims, in XNNPACK order. Only the latest shapes
+  // are kept: a runtime per shape would need the subgraph kept alive and the
+  // weights packed again for every runtime.
+  std::vector<size_t> input_shapes_;
+  std::vector<size_t> output_shapes_;
+  // False until the runtime has been reshaped successfully, and after a
+  // reshape fails.
+  bool shapes_valid_ = false;
+  // Number of successful reshapes of the runtime.
+  size_t num_reshapes_ = 0;
+
+  ET_NODISCARD executorch::runtime::Error reshape_runtime();
+
  public:
   XNNExecutor() = default;
 
@@ -51,6 +67,10 @@ class XNNExecutor {
     return packed_data_names_;
   }
 
+  inline size_t get_num_reshapes() const {
+    return num_reshapes_;
+  }
+
   /**
    * Initialize the XNNExecutor with a given runtime and input/output ids.
    * The input/output ids are expected to be sorted in order of their
@@ -66,7 +86,8 @@ class XNNExecutor {
    * Prepares the arguments for runtime graph execution.
    * args is an array of EValues that will be passed into the runtime.
    * input shapes will be propagated through the runtime, and perform
-   * any additional memory planning as needed
+   * any additional memory planning as needed. Shape propagation is skipped
+   * when the input shapes are the same as in the previous call.
    */
   ET_NODISCARD executorch::runtime::Error prepare_args(
       executorch::runtime::EValue** args);
@@ -73,6 +73,19 @@ class XnnpackBackend final
     return xnn_status_success == xnn_initialize(/*allocator=*/nullptr);
   }
 
+  // Each delegate builds its own subgraph and runtime; the shared workspace is
+  // only locked while the runtime is created. The weights cache is used
+  // throughout compilation, so init() holds its mutex for the whole call and
+  // initializing delegates concurrently would only serialize them on extra
+  // threads.
+  bool is_init_thread_safe() const override {
+#ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
+    return false;
+#else
+    return true;
+#endif
+  }
+
   Result<DelegateHandle*> init(
       BackendInitContext& context,
       FreeableBuffer* processed,
@@ -84,10 +97,17 @@ class XnnpackBackend final
     }
 
     const NamedDataMap* named_data_map = context.get_named_data_map();
-    // thread safe. This can heppen when multiple threads call init() on
-    // the same backend instance.
-#ifdef ENABLE_XNNPACK_SHARED_WORKSPACE
+    // Creating a runtime registers it with the shared workspace, which is not
+    // thread safe. This can happen when multiple threads call init() on the
+    // same backend instance.
+    std::mutex* workspace_mutex = nullptr;
+#if defined(ENABLE_XNNPACK_SHARED_WORKSPACE) && \
+    defined(ENABLE_XNNPACK_WEIGHTS_CACHE)
+    // The weights cache mutex is held for the whole compilation and must be
+    // acquired after the workspace mutex, so hold both.
     const std::lock_guard<std::mutex> lock(workspace_mutex_);
+#elif defined(ENABLE_XNNPACK_SHARED_WORKSPACE)
+    workspace_mutex = &workspace_mutex_;
 #endif
 
 #ifdef ENABLE_XNNPACK_WEIGHTS_CACHE
@@ -107,6 +127,7 @@ class XnnpackBackend final
         executor,
         weights_cache_.get(),
         workspace_.get(),
+        workspace_mutex,
         named_data_map);
     // This backend does not need its processed data after compiling the model.
     processed->Free();
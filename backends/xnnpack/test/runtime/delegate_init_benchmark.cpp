@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Times Program::load_method() on a delegated model, initializing its
+ * delegates one at a time and then concurrently.
+ *
+ * The speedup grows with the number of delegates, so use a model with many
+ * partitions, e.g. one exported with the XNNPACK partitioner in per-op mode
+ * (`XnnpackPartitioner(per_op_mode=True)`). XNNPACK only initializes its
+ * delegates concurrently when the weights cache is disabled, as it is in the
+ * default build; with the shared workspace, only runtime creation is
+ * serialized.
+ */
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
+#include <executorch/extension/threadpool/threadpool.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+DEFINE_string(model_path, "", "Delegated program to load.");
+DEFINE_string(method, "forward", "Method of --model_path to load.");
+DEFINE_int32(warmup, 1, "Untimed loads of each mode before measuring.");
+DEFINE_int32(iterations, 10, "Timed loads of each mode.");
+DEFINE_int32(
+    cpu_threads,
+    -1,
+    "Number of CPU threads. Defaults to -1, which uses the number of performant cores.");
+
+using executorch::extension::FileDataLoader;
+using executorch::extension::MallocMemoryAllocator;
+using executorch::runtime::Error;
+using executorch::runtime::HierarchicalAllocator;
+using executorch::runtime::MemoryManager;
+using executorch::runtime::Method;
+using executorch::runtime::MethodMeta;
+using executorch::runtime::ParallelForFn;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+
+namespace {
+
+struct Timing {
+  double mean_ms = 0;
+  double min_ms = 0;
+};
+
+Timing summarize(const std::vector<double>& times_ms) {
+  Timing timing;
+  if (times_ms.empty()) {
+    return timing;
+  }
+  for (double t : times_ms) {
+    timing.mean_ms += t;
+  }
+  timing.mean_ms /= times_ms.size();
+  timing.min_ms = *std::min_element(times_ms.begin(), times_ms.end());
+  return timing;
+}
+
+// Loads the method FLAGS_iterations times after FLAGS_warmup untimed loads.
+// Returns an empty vector on failure.
+std::vector<double> time_loads(
+    const Program& program,
+    Span<Span<uint8_t>> planned_spans,
+    ParallelForFn parallel_for) {
+  std::vector<double> times_ms;
+  for (int i = 0; i < FLAGS_warmup + FLAGS_iterations; ++i) {
+    // Each load starts from an empty method allocator, and the planned memory
+    // is reused since its contents don't matter until execution.
+    MallocMemoryAllocator method_allocator;
+    HierarchicalAllocator planned_memory(planned_spans);
+    MemoryManager memory_manager(&method_allocator, &planned_memory);
+
+    const auto start = std::chrono::steady_clock::now();
+    Result<Method> method = program.load_method(
+        FLAGS_method.c_str(),
+        &memory_manager,
+        /*event_tracer=*/nullptr,
+        /*named_data_map=*/nullptr,
+        /*snapshot=*/{},
+        parallel_for);
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count();
+    if (!method.ok()) {
+      ET_LOG(
+          Error,
+          "Loading %s failed: 0x%" PRIx32,
+          FLAGS_method.c_str(),
+          static_cast<uint32_t>(method.error()));
+      return {};
+    }
+    if (i >= FLAGS_warmup) {
+      times_ms.push_back(elapsed_ms);
+    }
+  }
+  return times_ms;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  executorch::runtime::runtime_init();
+
+  const uint32_t num_threads = FLAGS_cpu_threads == -1
+      ? ::executorch::extension::cpuinfo::get_num_performant_cores()
+      : static_cast<uint32_t>(FLAGS_cpu_threads);
+  if (num_threads > 0) {
+    ::executorch::extension::threadpool::get_threadpool()
+        ->_unsafe_reset_threadpool(num_threads);
+  }
+
+  if (FLAGS_model_path.empty()) {
+    ET_LOG(Error, "--model_path is required");
+    return 1;
+  }
+  // FileDataLoader uses pread(), so delegates can load their data
+  // concurrently.
+  Result<FileDataLoader> loader =
+      FileDataLoader::from(FLAGS_model_path.c_str());
+  if (!loader.ok()) {
+    ET_LOG(Error, "Failed to open %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  Result<Program> program = Program::load(&loader.get());
+  if (!program.ok()) {
+    ET_LOG(Error, "Failed to parse %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  Result<MethodMeta> method_meta = program->method_meta(FLAGS_method.c_str());
+  if (!method_meta.ok()) {
+    ET_LOG(Error, "No method %s", FLAGS_method.c_str());
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<uint8_t[]>> planned_buffers;
+  std::vector<Span<uint8_t>> planned_spans;
+  for (size_t id = 0; id < method_meta->num_memory_planned_buffers(); ++id) {
+    const size_t size =
+        static_cast<size_t>(method_meta->memory_planned_buffer_size(id).get());
+    planned_buffers.push_back(std::make_unique<uint8_t[]>(size));
+    planned_spans.push_back({planned_buffers.back().get(), size});
+  }
+  const Span<Span<uint8_t>> spans(planned_spans.data(), planned_spans.size());
+
+  const std::vector<double> serial_ms =
+      time_loads(program.get(), spans, /*parallel_for=*/nullptr);
+  const std::vector<double> concurrent_ms = time_loads(
+      program.get(),
+      spans,
+      ::executorch::extension::threadpool::parallel_for_on_new_threads);
+  if (serial_ms.empty() || concurrent_ms.empty()) {
+    return 1;
+  }
+
+  printf(
+      "%s: %zu delegates, %zu threads\n",
+      FLAGS_model_path.c_str(),
+      method_meta->num_backends(),
+      ::executorch::extension::threadpool::get_threadpool()
+          ->get_thread_count());
+  printf("%-12s %12s %12s\n", "init", "mean ms", "min ms");
+  const Timing serial = summarize(serial_ms);
+  const Timing concurrent = summarize(concurrent_ms);
+  printf("%-12s %12.3f %12.3f\n", "serial", serial.mean_ms, serial.min_ms);
+  printf(
+      "%-12s %12.3f %12.3f\n",
+      "concurrent",
+      concurrent.mean_ms,
+      concurrent.min_ms);
+  printf("speedup: %.2fx\n", serial.mean_ms / concurrent.mean_ms);
+  return 0;
+}
@@ -17,6 +17,9 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 using namespace ::testing;
 using executorch::extension::FlatTensorDataMap;
 using executorch::runtime::DataLoader;
@@ -112,3 +115,26 @@ TEST_F(DataSeparationTest, TestE2E) {
   Error err = method->execute();
   ASSERT_EQ(err, Error::Ok);
 }
+
+TEST_F(DataSeparationTest, TestConcurrentInit) {
+  // Loads the method on several threads at once, so that the backend's init()
+  // runs concurrently on the same instance. Most useful under TSAN.
+  constexpr size_t kNumThreads = 4;
+  std::vector<Error> errors(kNumThreads, Error::Internal);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([this, &errors, i]() {
+      ManagedMemoryManager mmm(
+          kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+      Result<Method> method = linear_program_->load_method(
+          "forward", &mmm.get(), nullptr, linear_data_map_.get());
+      errors[i] = method.ok() ? method->execute() : method.error();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    EXPECT_EQ(errors[i], Error::Ok) << "thread " << i;
+  }
+}
@@ -93,3 +93,77 @@ TEST(XNNExecutorTest, ArgumentWithTooManyDimensions) {
   // Check for invalid number of dimensions should fail without stack overflow.
   EXPECT_EQ(executor.prepare_args(args.data()), Error::InvalidArgument);
 }
+
+TEST(XNNExecutorTest, ReshapesOnlyWhenInputShapesChange) {
+  XNNExecutor executor;
+  xnn_subgraph_t subgraph = nullptr;
+  xnn_runtime_t rt = nullptr;
+  et_pal_init();
+  ASSERT_EQ(xnn_initialize(nullptr), xnn_status_success);
+  ASSERT_EQ(xnn_create_subgraph(2, 0, &subgraph), xnn_status_success);
+  std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> auto_subgraph(
+      subgraph, xnn_delete_subgraph);
+
+  std::vector<size_t> dims = {1, 1};
+  auto input_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/0,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_INPUT,
+          &input_id));
+  auto output_id = XNN_INVALID_VALUE_ID;
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_tensor_value(
+          subgraph,
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          nullptr,
+          /*external_id=*/1,
+          /*flags=*/XNN_VALUE_FLAG_EXTERNAL_OUTPUT,
+          &output_id));
+  ASSERT_EQ(
+      xnn_status_success,
+      xnn_define_clamp(subgraph, 0.0f, 1.0f, input_id, output_id, 0));
+
+  ASSERT_EQ(xnn_create_runtime(subgraph, &rt), xnn_status_success);
+  ASSERT_EQ(executor.initialize(rt, {0}, {1}, {}), Error::Ok);
+
+  TensorFactory<executorch::aten::ScalarType::Float> tf;
+  auto output_tensor = tf.zeros(
+      {4, 4}, executorch::runtime::TensorShapeDynamism::DYNAMIC_BOUND);
+  EValue output_ev(output_tensor);
+  executorch::ET_RUNTIME_NAMESPACE::BackendExecutionContext context;
+
+  // Repeat a shape (no reshape), then switch to other shapes and back to the
+  // first one (reshape each time).
+  const std::array<int, 6> shapes = {0, 0, 1, 1, 2, 0};
+  const std::array<size_t, 6> expected_num_reshapes = {1, 1, 2, 2, 3, 4};
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const int shape = shapes[i];
+    auto input_tensor = shape == 0 ? tf.make({2, 2}, {-1, 0.5, 2, 0})
+        : shape == 1               ? tf.make({1, 3}, {2, -2, 0.25})
+                                   : tf.make({3, 1}, {0.5, 3, 0.25});
+    EValue input_ev(input_tensor);
+    std::array<EValue*, 2> args = {&input_ev, &output_ev};
+    ASSERT_EQ(executor.prepare_args(args.data()), Error::Ok);
+    EXPECT_EQ(executor.get_num_reshapes(), expected_num_reshapes[i]);
+    ASSERT_EQ(executor.forward(context), Error::Ok);
+    ASSERT_EQ(executor.resize_outputs(args.data()), Error::Ok);
+
+    EXPECT_EQ(output_tensor.sizes(), input_tensor.sizes());
+    if (shape == 0) {
+      EXPECT_EQ(output_tensor.const_data_ptr<float>()[0], 0.0f);
+      EXPECT_EQ(output_tensor.const_data_ptr<float>()[2], 1.0f);
+    } else {
+      EXPECT_EQ(output_tensor.const_data_ptr<float>()[2], 0.25f);
+    }
+  }
+}
@@ -63,3 +63,17 @@ def define_common_targets():
                 "ET_MODULE_LINEAR_XNN_DATA_PATH": "$(location fbcode//executorch/test/models:exported_xnnpack_program_and_data[ModuleLinear.ptd])",
             },
     )
+
+    runtime.cxx_binary(
+        name = "delegate_init_benchmark",
+        srcs = ["runtime/delegate_init_benchmark.cpp"],
+        deps = [
+            "//executorch/backends/xnnpack:xnnpack_backend",
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/memory_allocator:malloc_memory_allocator",
+            "//executorch/extension/threadpool:cpuinfo_utils",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/executor:program",
+        ],
+        external_deps = ["gflags"],
+    )
@@ -489,6 +489,29 @@ void ETDumpGen::end_profiling(EventTracerEntry prof_entry) {
   etdump_RunData_events_push_end(builder_);
 }
 
+void ETDumpGen::log_profiling_event(
+    const char* name,
+    ChainID chain_id,
+    DebugHandle debug_handle,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time) {
+  check_ready_to_add_events();
+  int64_t string_id = name != nullptr ? create_string_entry(name) : -1;
+
+  etdump_ProfileEvent_start(builder_);
+  etdump_ProfileEvent_start_time_add(builder_, start_time);
+  etdump_ProfileEvent_end_time_add(builder_, end_time);
+  etdump_ProfileEvent_chain_index_add(builder_, chain_id);
+  etdump_ProfileEvent_instruction_id_add(builder_, debug_handle);
+  if (string_id != -1) {
+    etdump_ProfileEvent_name_add(builder_, string_id);
+  }
+  etdump_ProfileEvent_ref_t id = etdump_ProfileEvent_end(builder_);
+  etdump_RunData_events_push_start(builder_);
+  etdump_Event_profile_event_add(builder_, id);
+  etdump_RunData_events_push_end(builder_);
+}
+
 AllocatorID ETDumpGen::track_allocator(const char* name) {
   ET_CHECK_MSG(
       (state_ == State::BlockCreated || state_ == State::AddingAllocators),
@@ -97,6 +97,16 @@ class ETDumpGen : public ::executorch::runtime::EventTracer {
       et_timestamp_t end_time,
       const void* metadata,
       size_t metadata_len) override;
+  /**
+   * Log a profiling event that was timed elsewhere, for example by
+   * RingBufferEventTracer.
+   */
+  void log_profiling_event(
+      const char* name,
+      ::executorch::runtime::ChainID chain_id,
+      ::executorch::runtime::DebugHandle debug_handle,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time);
   virtual void track_allocation(
       ::executorch::runtime::AllocatorID id,
       size_t size) override;
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/devtools/etdump/profiling_stats.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <executorch/runtime/platform/platform.h>
+
+using ::executorch::runtime::ChainID;
+using ::executorch::runtime::DebugHandle;
+using ::executorch::runtime::DelegateDebugIntId;
+using ::executorch::runtime::kUnsetChainId;
+
+namespace executorch {
+namespace etdump {
+
+namespace {
+
+// Each power of two above kLinearLimit is split into 2^kSubBucketBits
+// buckets. Values below kLinearLimit are counted exactly.
+constexpr int kSubBucketBits = 5;
+constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+constexpr uint64_t kLinearLimit = kSubBucketCount * 2;
+
+// The index of the most significant set bit of a nonzero value.
+int highest_bit(uint64_t value) {
+  int bit = 0;
+  for (int step = 32; step > 0; step /= 2) {
+    if (value >> step) {
+      value >>= step;
+      bit += step;
+    }
+  }
+  return bit;
+}
+
+// Whether an event times a whole instruction, as opposed to e.g. a
+// Method::step that only shares its chain id and debug handle.
+bool is_instruction_event(const char* name) {
+  return name != nullptr &&
+      (strcmp(name, "OPERATOR_CALL") == 0 ||
+       strcmp(name, "DELEGATE_CALL") == 0);
+}
+
+uint64_t saturating_add(uint64_t a, uint64_t b) {
+  return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+std::string json_escape(const std::string& str) {
+  std::string out;
+  out.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out += escaped;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+std::string csv_quote(const std::string& str) {
+  if (str.find_first_of(",\"\r\n") == std::string::npos) {
+    return str;
+  }
+  std::string out = "\"";
+  for (char c : str) {
+    if (c == '"') {
+      out += '"';
+    }
+    out += c;
+  }
+  out += '"';
+  return out;
+}
+
+// The columns shared by to_json() and to_csv(), after the key.
+struct Row {
+  uint64_t count;
+  uint64_t min;
+  double mean;
+  uint64_t p50;
+  uint64_t p90;
+  uint64_t p99;
+  uint64_t max;
+  uint64_t total;
+};
+
+Row make_row(const LatencyHistogram& histogram) {
+  return {
+      histogram.count(),
+      histogram.min(),
+      histogram.mean(),
+      histogram.percentile(50),
+      histogram.percentile(90),
+      histogram.percentile(99),
+      histogram.max(),
+      histogram.sum()};
+}
+
+} // namespace
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+  if (value < kLinearLimit) {
+    return static_cast<size_t>(value);
+  }
+  const int shift = highest_bit(value) - kSubBucketBits;
+  return static_cast<size_t>(shift) * kSubBucketCount +
+      static_cast<size_t>(value >> shift);
+}
+
+uint64_t LatencyHistogram::bucket_lower_bound(size_t index) {
+  if (index < kLinearLimit) {
+    return index;
+  }
+  const size_t shift = index / kSubBucketCount - 1;
+  return (index % kSubBucketCount + kSubBucketCount) << shift;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+  if (index < kLinearLimit) {
+    return index;
+  }
+  const size_t shift = index / kSubBucketCount - 1;
+  return bucket_lower_bound(index) + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  const size_t index = bucket_index(value);
+  if (index >= counts_.size()) {
+    counts_.resize(index + 1);
+  }
+  counts_[index]++;
+  count_++;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+  sum_ = saturating_add(sum_, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  if (other.counts_.size() > counts_.size()) {
+    counts_.resize(other.counts_.size());
+  }
+  for (size_t i = 0; i < other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  sum_ = saturating_add(sum_, other.sum_);
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  if (percentile <= 0) {
+    return min_;
+  }
+  if (percentile >= 100) {
+    return max_;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile / 100 * count_)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::min(std::max(bucket_upper_bound(i), min_), max_);
+    }
+  }
+  return max_;
+}
+
+void LatencyHistogram::reset() {
+  counts_.clear();
+  count_ = 0;
+  min_ = UINT64_MAX;
+  max_ = 0;
+  sum_ = 0;
+}
+
+ProfilingStats::ProfilingStats(size_t max_entries)
+    : max_entries_(max_entries) {}
+
+void ProfilingStats::set_name_resolver(NameResolver resolver) {
+  resolver_ = std::move(resolver);
+}
+
+void ProfilingStats::record(const Key& key, uint64_t duration_ns) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    if (entries_.size() >= max_entries_) {
+      dropped_events_++;
+      return;
+    }
+    it = entries_.emplace(key, LatencyHistogram()).first;
+  }
+  it->second.record(duration_ns);
+}
+
+size_t ProfilingStats::collect(RingBufferEventTracer& tracer) {
+  const et_tick_ratio_t ratio = runtime::pal_ticks_to_ns_multiplier();
+  // The histogram of each record key seen during this drain, so that the
+  // names are only resolved and copied the first time a key is seen. A null
+  // histogram means the key was dropped.
+  using RecordKey =
+      std::tuple<ChainID, DebugHandle, uint16_t, uint8_t, DelegateDebugIntId>;
+  std::map<RecordKey, LatencyHistogram*> histograms;
+  return tracer.drain([&](const RingBufferEventRecord& r) {
+    const RecordKey record_key = {
+        r.chain_id,
+        r.debug_handle,
+        r.name_id,
+        static_cast<uint8_t>(r.kind),
+        r.delegate_debug_id};
+    auto it = histograms.find(record_key);
+    if (it == histograms.end()) {
+      const char* name = tracer.name(r.name_id);
+      if (resolver_ && r.kind == RingBufferEventKind::kEvent &&
+          r.chain_id != kUnsetChainId && is_instruction_event(name)) {
+        const char* resolved = resolver_(r.chain_id, r.debug_handle);
+        if (resolved != nullptr) {
+          name = resolved;
+        }
+      }
+      Key key = {
+          r.chain_id,
+          r.debug_handle,
+          name != nullptr ? name : "",
+          r.delegate_debug_id};
+      auto entry = entries_.find(key);
+      if (entry == entries_.end() && entries_.size() < max_entries_) {
+        entry = entries_.emplace(std::move(key), LatencyHistogram()).first;
+      }
+      it = histograms
+               .emplace(
+                   record_key,
+                   entry == entries_.end() ? nullptr : &entry->second)
+               .first;
+    }
+    if (it->second == nullptr) {
+      dropped_events_++;
+      return;
+    }
+    const uint64_t ticks =
+        r.end_time > r.start_time ? r.end_time - r.start_time : 0;
+    it->second->record(ticks * ratio.numerator / ratio.denominator);
+  });
+}
+
+const LatencyHistogram* ProfilingStats::find(const Key& key) const {
+  auto it = entries_.find(key);
+  return it == entries_.end() ? nullptr : &it->second;
+}
+
+std::string ProfilingStats::to_json() const {
+  std::string json = "[";
+  char buffer[512];
+  for (const auto& entry : entries_) {
+    const Key& key = entry.first;
+    const Row row = make_row(entry.second);
+    json += json.size() == 1 ? "\n" : ",\n";
+    snprintf(
+        buffer,
+        sizeof(buffer),
+        "  {\"chain\": %" PRId32 ", \"instruction\": %" PRIu32
+        ", \"name\": \"",
+        key.chain_id,
+        key.debug_handle);
+    json += buffer;
+    json += json_escape(key.name);
+    snprintf(
+        buffer,
+        sizeof(buffer),
+        "\", \"delegate_debug_id\": %" PRId32 ", \"count\": %" PRIu64
+        ", \"min_ns\": %" PRIu64 ", \"mean_ns\": %.1f, \"p50_ns\": %" PRIu64
+        ", \"p90_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64
+        ", \"max_ns\": %" PRIu64 ", \"total_ns\": %" PRIu64 "}",
+        key.delegate_debug_id,
+        row.count,
+        row.min,
+        row.mean,
+        row.p50,
+        row.p90,
+        row.p99,
+        row.max,
+        row.total);
+    json += buffer;
+  }
+  json += json.size() == 1 ? "]\n" : "\n]\n";
+  return json;
+}
+
+std::string ProfilingStats::to_csv() const {
+  std::string csv =
+      "chain,instruction,name,delegate_debug_id,count,min_ns,mean_ns,"
+      "p50_ns,p90_ns,p99_ns,max_ns,total_ns\n";
+  char buffer[512];
+  for (const auto& entry : entries_) {
+    const Key& key = entry.first;
+    const Row row = make_row(entry.second);
+    snprintf(
+        buffer,
+        sizeof(buffer),
+        "%" PRId32 ",%" PRIu32 ",",
+        key.chain_id,
+        key.debug_handle);
+    csv += buffer;
+    csv += csv_quote(key.name);
+    snprintf(
+        buffer,
+        sizeof(buffer),
+        ",%" PRId32 ",%" PRIu64 ",%" PRIu64 ",%.1f,%" PRIu64 ",%" PRIu64
+        ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+        key.delegate_debug_id,
+        row.count,
+        row.min,
+        row.mean,
+        row.p50,
+        row.p90,
+        row.p99,
+        row.max,
+        row.total);
+    csv += buffer;
+  }
+  return csv;
+}
+
+void ProfilingStats::reset() {
+  entries_.clear();
+  dropped_events_ = 0;
+}
+
+} // namespace etdump
+} // namespace executorch
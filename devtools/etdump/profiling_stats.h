@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <executorch/devtools/etdump/ring_buffer_event_tracer.h>
+#include <executorch/runtime/core/event_tracer.h>
+
+namespace executorch {
+namespace etdump {
+
+/**
+ * A latency histogram with bounded memory and relative precision, in the style
+ * of HdrHistogram. Values below 64 have their own bucket, and every larger
+ * power of two is split into 32 linear buckets, so a recorded value is off by
+ * at most 1/32 (about 3%) when read back. Buckets are allocated up to the
+ * largest value recorded, which is at most 1920 buckets for any uint64_t.
+ */
+class LatencyHistogram final {
+ public:
+  /// Records one value, e.g. a latency in nanoseconds.
+  void record(uint64_t value);
+
+  /// Adds the values recorded by `other` to this histogram.
+  void merge(const LatencyHistogram& other);
+
+  uint64_t count() const {
+    return count_;
+  }
+  /// The exact smallest and largest values recorded, or 0 when empty.
+  uint64_t min() const {
+    return count_ == 0 ? 0 : min_;
+  }
+  uint64_t max() const {
+    return max_;
+  }
+  /// The exact sum of the values recorded, saturating at UINT64_MAX.
+  uint64_t sum() const {
+    return sum_;
+  }
+  double mean() const {
+    return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_;
+  }
+
+  /**
+   * The value below which `percentile` percent of the recorded values fall,
+   * within the precision of the histogram and clamped to [min(), max()].
+   * percentile(0) is min() and percentile(100) is max().
+   *
+   * @param[in] percentile In the range [0, 100].
+   */
+  uint64_t percentile(double percentile) const;
+
+  /// Forgets every recorded value.
+  void reset();
+
+  /// The bucket a value is counted in.
+  static size_t bucket_index(uint64_t value);
+  /// The smallest and largest values counted in a bucket.
+  static uint64_t bucket_lower_bound(size_t index);
+  static uint64_t bucket_upper_bound(size_t index);
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+  uint64_t sum_ = 0;
+};
+
+/**
+ * Aggregates profiling events into one LatencyHistogram per instruction, so
+ * that an instruction-level latency profile can be kept across millions of
+ * executions with bounded memory, unlike an ETDump whose size grows with every
+ * event.
+ *
+ * Events are keyed by their chain, instruction (debug handle), name and
+ * delegate debug id. The runtime names every operator event "OPERATOR_CALL"
+ * and every delegate event "DELEGATE_CALL", so a name resolver can be set to
+ * name them after what the instruction calls instead, e.g. with
+ * MethodMeta::instruction_name().
+ *
+ * Not thread-safe; drain the tracer from one thread at a time.
+ */
+class ProfilingStats final {
+ public:
+  /**
+   * Returns the name of the instruction with the given chain and debug handle,
+   * or nullptr to keep the name of the event. Only called for the
+   * "OPERATOR_CALL" and "DELEGATE_CALL" events of the runtime.
+   */
+  using NameResolver = std::function<const char*(
+      ::executorch::runtime::ChainID,
+      ::executorch::runtime::DebugHandle)>;
+
+  struct Key {
+    ::executorch::runtime::ChainID chain_id;
+    ::executorch::runtime::DebugHandle debug_handle;
+    std::string name;
+    ::executorch::runtime::DelegateDebugIntId delegate_debug_id;
+
+    bool operator<(const Key& other) const {
+      return std::tie(chain_id, debug_handle, name, delegate_debug_id) <
+          std::tie(
+                 other.chain_id,
+                 other.debug_handle,
+                 other.name,
+                 other.delegate_debug_id);
+    }
+  };
+
+  /**
+   * @param[in] max_entries The maximum number of distinct keys. Events with a
+   * new key are counted in dropped_events() once there are this many.
+   */
+  explicit ProfilingStats(size_t max_entries = 4096);
+
+  /// Sets the resolver used to name the events of instructions.
+  void set_name_resolver(NameResolver resolver);
+
+  /// Records one event that took `duration_ns` nanoseconds.
+  void record(const Key& key, uint64_t duration_ns);
+
+  /**
+   * Drains the records of a RingBufferEventTracer into the statistics.
+   *
+   * @returns The number of records drained.
+   */
+  size_t collect(RingBufferEventTracer& tracer);
+
+  /// The histogram of a key, or nullptr if no event had it.
+  const LatencyHistogram* find(const Key& key) const;
+
+  /// The statistics of every key, ordered by chain and instruction.
+  const std::map<Key, LatencyHistogram>& entries() const {
+    return entries_;
+  }
+
+  /// The number of events not recorded because there were too many keys.
+  size_t dropped_events() const {
+    return dropped_events_;
+  }
+
+  /**
+   * A JSON array with one object per key, holding its count, min, mean,
+   * p50, p90, p99, max and total latency in nanoseconds.
+   */
+  std::string to_json() const;
+
+  /// The same table as to_json() as CSV, with a header row.
+  std::string to_csv() const;
+
+  /// Forgets every recorded event. Keeps the name resolver.
+  void reset();
+
+ private:
+  const size_t max_entries_;
+  NameResolver resolver_;
+  std::map<Key, LatencyHistogram> entries_;
+  size_t dropped_events_ = 0;
+};
+
+} // namespace etdump
+} // namespace executorch
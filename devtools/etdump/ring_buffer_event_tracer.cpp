@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/devtools/etdump/ring_buffer_event_tracer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <executorch/runtime/platform/platform.h>
+
+using ::executorch::runtime::AllocatorID;
+using ::executorch::runtime::ArrayRef;
+using ::executorch::runtime::ChainID;
+using ::executorch::runtime::DebugHandle;
+using ::executorch::runtime::DelegateDebugIdType;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::EValue;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::runtime::kUnsetChainId;
+using ::executorch::runtime::kUnsetDebugHandle;
+using ::executorch::runtime::kUnsetDelegateDebugIntId;
+using ::executorch::runtime::LoggedEValueType;
+
+namespace executorch {
+namespace etdump {
+
+namespace {
+
+// Marks the entries of events in blocks that were not sampled.
+constexpr int64_t kSkippedEventId = INT64_MIN;
+
+constexpr uint32_t kDumpVersion = 1;
+
+size_t round_up_to_power_of_two(size_t n) {
+  size_t capacity = 1;
+  while (capacity < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+uint64_t next_tracer_id() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The ring of the calling thread for the tracer it last recorded to, so that
+// the common case of one tracer per thread needs no lookup.
+struct ThreadRingCache {
+  uint64_t tracer_id = 0;
+  void* ring = nullptr;
+};
+thread_local ThreadRingCache thread_ring_cache;
+
+} // namespace
+
+RingBufferEventTracer::RingBufferEventTracer(size_t records_per_thread)
+    : id_(next_tracer_id()),
+      capacity_(round_up_to_power_of_two(
+          std::max<size_t>(records_per_thread, 1))) {}
+
+RingBufferEventTracer::~RingBufferEventTracer() = default;
+
+void RingBufferEventTracer::set_sample_period(uint32_t period) {
+  sample_period_.store(
+      std::max<uint32_t>(period, 1), std::memory_order_relaxed);
+}
+
+RingBufferEventTracer::ThreadRing* RingBufferEventTracer::thread_ring() {
+  if (thread_ring_cache.tracer_id == id_) {
+    return static_cast<ThreadRing*>(thread_ring_cache.ring);
+  }
+  ThreadRing* ring = register_thread();
+  if (ring != nullptr) {
+    thread_ring_cache.tracer_id = id_;
+    thread_ring_cache.ring = ring;
+  }
+  return ring;
+}
+
+RingBufferEventTracer::ThreadRing* RingBufferEventTracer::register_thread() {
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  const auto self = std::this_thread::get_id();
+  const size_t num_rings = num_rings_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_rings; ++i) {
+    if (rings_[i]->owner == self) {
+      return rings_[i].get();
+    }
+  }
+  if (num_rings == kMaxThreads) {
+    ET_LOG(
+        Error,
+        "RingBufferEventTracer supports at most %zu threads, dropping events",
+        kMaxThreads);
+    return nullptr;
+  }
+  auto ring = std::make_unique<ThreadRing>();
+  ring->records = std::make_unique<RingBufferEventRecord[]>(capacity_);
+  ring->owner = self;
+  ring->thread_id = static_cast<uint8_t>(num_rings);
+  rings_[num_rings] = std::move(ring);
+  num_rings_.store(num_rings + 1, std::memory_order_release);
+  return rings_[num_rings].get();
+}
+
+uint16_t RingBufferEventTracer::intern(const char* name) {
+  if (name == nullptr) {
+    return kNoName;
+  }
+  // Names are almost always string literals, found by their pointer.
+  size_t num_names = num_names_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_names; ++i) {
+    if (name_keys_[i] == name && names_[i] == name) {
+      return static_cast<uint16_t>(i);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(names_mutex_);
+  num_names = num_names_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < num_names; ++i) {
+    if (names_[i] == name) {
+      return static_cast<uint16_t>(i);
+    }
+  }
+  if (num_names == kMaxNames) {
+    return kNoName;
+  }
+  names_[num_names] = name;
+  name_keys_[num_names] = name;
+  num_names_.store(num_names + 1, std::memory_order_release);
+  return static_cast<uint16_t>(num_names);
+}
+
+const char* RingBufferEventTracer::name(uint16_t name_id) const {
+  if (name_id >= num_names_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return names_[name_id].c_str();
+}
+
+void RingBufferEventTracer::record(
+    ThreadRing& ring,
+    const RingBufferEventRecord& record) {
+  const uint64_t head = ring.head.load(std::memory_order_relaxed);
+  ring.records[head & (capacity_ - 1)] = record;
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void RingBufferEventTracer::create_event_block(const char* /*name*/) {
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr) {
+    return;
+  }
+  const uint32_t period = sample_period_.load(std::memory_order_relaxed);
+  ring->sampled = ring->num_blocks++ % period == 0;
+}
+
+EventTracerEntry RingBufferEventTracer::start_profiling(
+    const char* name,
+    ChainID chain_id,
+    DebugHandle debug_handle) {
+  EventTracerEntry entry;
+  entry.delegate_event_id_type = DelegateDebugIdType::kNone;
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr || !ring->sampled) {
+    entry.event_id = kSkippedEventId;
+    return entry;
+  }
+  entry.event_id = intern(name);
+  if (chain_id == kUnsetChainId) {
+    entry.chain_id = chain_id_;
+    entry.debug_handle = debug_handle_;
+  } else {
+    entry.chain_id = chain_id;
+    entry.debug_handle = debug_handle;
+  }
+  entry.start_time = runtime::pal_current_ticks();
+  return entry;
+}
+
+void RingBufferEventTracer::end_profiling(EventTracerEntry prof_entry) {
+  if (prof_entry.event_id == kSkippedEventId) {
+    return;
+  }
+  const et_timestamp_t end_time = runtime::pal_current_ticks();
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr) {
+    return;
+  }
+  record(
+      *ring,
+      {prof_entry.start_time,
+       end_time,
+       prof_entry.chain_id,
+       prof_entry.debug_handle,
+       kUnsetDelegateDebugIntId,
+       static_cast<uint16_t>(prof_entry.event_id),
+       RingBufferEventKind::kEvent,
+       ring->thread_id});
+}
+
+EventTracerEntry RingBufferEventTracer::start_profiling_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index) {
+  EventTracerEntry entry;
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr || !ring->sampled) {
+    entry.event_id = kSkippedEventId;
+    entry.delegate_event_id_type = DelegateDebugIdType::kNone;
+    return entry;
+  }
+  if (delegate_debug_index == kUnsetDelegateDebugIntId) {
+    entry.delegate_event_id_type = DelegateDebugIdType::kStr;
+    entry.event_id = intern(name);
+  } else {
+    entry.delegate_event_id_type = DelegateDebugIdType::kInt;
+    entry.event_id = delegate_debug_index;
+  }
+  entry.chain_id = chain_id_;
+  entry.debug_handle = debug_handle_;
+  entry.start_time = runtime::pal_current_ticks();
+  return entry;
+}
+
+void RingBufferEventTracer::end_profiling_delegate(
+    EventTracerEntry prof_entry,
+    const void* /*metadata*/,
+    size_t /*metadata_len*/) {
+  if (prof_entry.event_id == kSkippedEventId) {
+    return;
+  }
+  const et_timestamp_t end_time = runtime::pal_current_ticks();
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr) {
+    return;
+  }
+  const bool is_int =
+      prof_entry.delegate_event_id_type == DelegateDebugIdType::kInt;
+  record(
+      *ring,
+      {prof_entry.start_time,
+       end_time,
+       prof_entry.chain_id,
+       prof_entry.debug_handle,
+       is_int ? static_cast<DelegateDebugIntId>(prof_entry.event_id)
+              : kUnsetDelegateDebugIntId,
+       is_int ? kNoName : static_cast<uint16_t>(prof_entry.event_id),
+       is_int ? RingBufferEventKind::kDelegateInt
+              : RingBufferEventKind::kDelegateStr,
+       ring->thread_id});
+}
+
+void RingBufferEventTracer::log_profiling_delegate(
+    const char* name,
+    DelegateDebugIntId delegate_debug_index,
+    et_timestamp_t start_time,
+    et_timestamp_t end_time,
+    const void* /*metadata*/,
+    size_t /*metadata_len*/) {
+  ThreadRing* ring = thread_ring();
+  if (ring == nullptr || !ring->sampled) {
+    return;
+  }
+  const bool is_int = delegate_debug_index != kUnsetDelegateDebugIntId;
+  record(
+      *ring,
+      {start_time,
+       end_time,
+       chain_id_,
+       debug_handle_,
+       delegate_debug_index,
+       is_int ? kNoName : intern(name),
+       is_int ? RingBufferEventKind::kDelegateInt
+              : RingBufferEventKind::kDelegateStr,
+       ring->thread_id});
+}
+
+size_t RingBufferEventTracer::drain(
+    const std::function<void(const RingBufferEventRecord&)>& fn) {
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  std::vector<RingBufferEventRecord> records;
+  size_t num_drained = 0;
+  const size_t num_rings = num_rings_.load(std::memory_order_acquire);
+  for (size_t r = 0; r < num_rings; ++r) {
+    ThreadRing& ring = *rings_[r];
+    const uint64_t head = ring.head.load(std::memory_order_acquire);
+    const uint64_t begin =
+        std::max(ring.tail, head > capacity_ ? head - capacity_ : 0);
+    records.clear();
+    for (uint64_t i = begin; i < head; ++i) {
+      records.push_back(ring.records[i & (capacity_ - 1)]);
+    }
+    // The owner may have lapped the copy while it was being taken: the slot
+    // of index i is rewritten once the head passes i + capacity - 1, so only
+    // records after that are known to be intact.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t head_after = ring.head.load(std::memory_order_relaxed);
+    const uint64_t intact_begin = std::max(
+        begin, head_after + 1 > capacity_ ? head_after + 1 - capacity_ : 0);
+    dropped_records_.fetch_add(
+        std::min(intact_begin, head) - ring.tail, std::memory_order_relaxed);
+    for (uint64_t i = intact_begin; i < head; ++i) {
+      fn(records[i - begin]);
+    }
+    num_drained += head - std::min(intact_begin, head);
+    ring.tail = head;
+  }
+  return num_drained;
+}
+
+::executorch::runtime::Result<size_t> RingBufferEventTracer::flush(
+    DataSinkBase& data_sink) {
+  std::vector<RingBufferEventRecord> records;
+  drain([&](const RingBufferEventRecord& r) { records.push_back(r); });
+
+  const size_t num_names = num_names_.load(std::memory_order_acquire);
+  const et_tick_ratio_t ratio = runtime::pal_ticks_to_ns_multiplier();
+  RingBufferDumpHeader header = {
+      {'E', 'T', 'R', 'B'},
+      kDumpVersion,
+      sizeof(RingBufferEventRecord),
+      static_cast<uint32_t>(num_names),
+      records.size(),
+      ratio.numerator,
+      ratio.denominator};
+  // Data sinks may pad between writes, so the dump is written at once.
+  const auto* header_data = reinterpret_cast<const uint8_t*>(&header);
+  std::vector<uint8_t> dump(header_data, header_data + sizeof(header));
+  for (size_t i = 0; i < num_names; ++i) {
+    const char* name = names_[i].c_str();
+    dump.insert(dump.end(), name, name + names_[i].size() + 1);
+  }
+  const auto* data = reinterpret_cast<const uint8_t*>(records.data());
+  dump.insert(
+      dump.end(), data, data + records.size() * sizeof(RingBufferEventRecord));
+  auto result = data_sink.write(dump.data(), dump.size());
+  if (!result.ok()) {
+    return result.error();
+  }
+  return records.size();
+}
+
+size_t RingBufferEventTracer::flush(ETDumpGen& etdump) {
+  std::vector<RingBufferEventRecord> records;
+  drain([&](const RingBufferEventRecord& r) { records.push_back(r); });
+
+  // drain() goes thread by thread; give each thread its own block.
+  int current_thread = -1;
+  for (const auto& r : records) {
+    if (r.thread_id != current_thread) {
+      current_thread = r.thread_id;
+      const std::string block_name = "thread_" + std::to_string(r.thread_id);
+      etdump.create_event_block(block_name.c_str());
+    }
+    switch (r.kind) {
+      case RingBufferEventKind::kEvent:
+        etdump.log_profiling_event(
+            name(r.name_id),
+            r.chain_id,
+            r.debug_handle,
+            r.start_time,
+            r.end_time);
+        break;
+      case RingBufferEventKind::kDelegateStr:
+      case RingBufferEventKind::kDelegateInt:
+        etdump.set_chain_debug_handle(r.chain_id, r.debug_handle);
+        etdump.log_profiling_delegate(
+            r.kind == RingBufferEventKind::kDelegateStr ? name(r.name_id)
+                                                        : nullptr,
+            r.kind == RingBufferEventKind::kDelegateStr
+                ? kUnsetDelegateDebugIntId
+                : r.delegate_debug_id,
+            r.start_time,
+            r.end_time,
+            nullptr,
+            0);
+        etdump.set_chain_debug_handle(kUnsetChainId, kUnsetDebugHandle);
+        break;
+    }
+  }
+  return records.size();
+}
+
+// The tracer only records profiling events; everything else is ignored.
+
+void RingBufferEventTracer::track_allocation(
+    AllocatorID /*id*/,
+    size_t /*size*/) {}
+
+AllocatorID RingBufferEventTracer::track_allocator(const char* /*name*/) {
+  return 0;
+}
+
+Result<bool> RingBufferEventTracer::log_evalue(
+    const EValue& /*evalue*/,
+    LoggedEValueType /*evalue_type*/) {
+  return false;
+}
+
+Result<bool> RingBufferEventTracer::log_intermediate_output_delegate(
+    const char* /*name*/,
+    DelegateDebugIntId /*delegate_debug_index*/,
+    const executorch::aten::Tensor& /*output*/) {
+  return false;
+}
+
+Result<bool> RingBufferEventTracer::log_intermediate_output_delegate(
+    const char* /*name*/,
+    DelegateDebugIntId /*delegate_debug_index*/,
+    const ArrayRef<executorch::aten::Tensor> /*output*/) {
+  return false;
+}
+
+Result<bool> RingBufferEventTracer::log_intermediate_output_delegate(
+    const char* /*name*/,
+    DelegateDebugIntId /*delegate_debug_index*/,
+    const int& /*output*/) {
+  return false;
+}
+
+Result<bool> RingBufferEventTracer::log_intermediate_output_delegate(
+    const char* /*name*/,
+    DelegateDebugIntId /*delegate_debug_index*/,
+    const bool& /*output*/) {
+  return false;
+}
+
+Result<bool> RingBufferEventTracer::log_intermediate_output_delegate(
+    const char* /*name*/,
+    DelegateDebugIntId /*delegate_debug_index*/,
+    const double& /*output*/) {
+  return false;
+}
+
+void RingBufferEventTracer::set_delegation_intermediate_output_filter(
+    EventTracerFilterBase* /*event_tracer_filter*/) {}
+
+} // namespace etdump
+} // namespace executorch
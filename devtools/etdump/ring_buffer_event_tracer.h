@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <executorch/devtools/etdump/data_sinks/data_sink_base.h>
+#include <executorch/devtools/etdump/etdump_flatcc.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/result.h>
+
+namespace executorch {
+namespace etdump {
+
+/**
+ * The kind of event a RingBufferEventRecord describes.
+ */
+enum class RingBufferEventKind : uint8_t {
+  /// A runtime event, such as an operator call or a method execution.
+  kEvent = 0,
+  /// A delegate event identified by its name.
+  kDelegateStr = 1,
+  /// A delegate event identified by an integer debug id.
+  kDelegateInt = 2,
+};
+
+/**
+ * One profiling event recorded by RingBufferEventTracer. Fixed-size and
+ * trivially copyable, so that recording an event is a single store into the
+ * ring buffer of the calling thread.
+ */
+struct RingBufferEventRecord {
+  /// Start and end of the event, in platform ticks.
+  et_timestamp_t start_time;
+  et_timestamp_t end_time;
+  /// The chain and instruction the event belongs to.
+  ::executorch::runtime::ChainID chain_id;
+  ::executorch::runtime::DebugHandle debug_handle;
+  /// The integer debug id of a kDelegateInt event, unset otherwise.
+  ::executorch::runtime::DelegateDebugIntId delegate_debug_id;
+  /// The event name, as an index into RingBufferEventTracer::name(), or
+  /// RingBufferEventTracer::kNoName.
+  uint16_t name_id;
+  RingBufferEventKind kind;
+  /// The index of the thread that recorded the event, dense from 0 in the
+  /// order threads first recorded an event with this tracer.
+  uint8_t thread_id;
+};
+static_assert(
+    sizeof(RingBufferEventRecord) == 32,
+    "RingBufferEventRecord is part of the serialized format");
+
+/**
+ * The header written by RingBufferEventTracer::flush() to a data sink. It is
+ * followed by num_names null-terminated names, in name id order, and then by
+ * num_records RingBufferEventRecords.
+ */
+struct RingBufferDumpHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t num_names;
+  uint64_t num_records;
+  /// Multiply ticks by numerator / denominator to get nanoseconds.
+  uint64_t ticks_to_ns_numerator;
+  uint64_t ticks_to_ns_denominator;
+};
+
+/**
+ * An EventTracer meant to stay enabled in production. Instead of building a
+ * flatbuffer as events arrive like ETDumpGen, it only records profiling events,
+ * as fixed-size binary records in a per-thread ring buffer:
+ *
+ * - Recording an event takes two tick reads and one 32-byte store. There are
+ *   no locks or allocations after a thread's first event, except the first
+ *   time an event name is seen.
+ * - Each thread writes only to its own ring, and another thread can drain all
+ *   rings at any time without stopping the writers. When a ring is full the
+ *   oldest records are overwritten and counted in dropped_records().
+ * - Event blocks (one per Method::execute) can be sampled, so that only one in
+ *   every N executions on each thread records events.
+ *
+ * Records are drained on demand: to a callback, for in-process aggregation
+ * such as per-operator latency histograms, to a DataSinkBase in the format
+ * described by RingBufferDumpHeader, or into an ETDumpGen for the existing
+ * devtools. Intermediate outputs and allocations are not recorded.
+ */
+class RingBufferEventTracer final : public ::executorch::runtime::EventTracer {
+ public:
+  /// The name id of events without a name.
+  static constexpr uint16_t kNoName = UINT16_MAX;
+  /// The maximum number of distinct event names.
+  static constexpr size_t kMaxNames = 256;
+  /// The maximum number of threads that can record events.
+  static constexpr size_t kMaxThreads = 64;
+
+  /**
+   * @param[in] records_per_thread The capacity of the ring buffer of each
+   * recording thread, rounded up to a power of two.
+   */
+  explicit RingBufferEventTracer(size_t records_per_thread = 4096);
+  ~RingBufferEventTracer() override;
+
+  RingBufferEventTracer(const RingBufferEventTracer&) = delete;
+  RingBufferEventTracer& operator=(const RingBufferEventTracer&) = delete;
+  RingBufferEventTracer(RingBufferEventTracer&&) = delete;
+  RingBufferEventTracer& operator=(RingBufferEventTracer&&) = delete;
+
+  /**
+   * Records the events of one in every `period` event blocks on each thread.
+   * 1, the default, records every block, and 100 samples 1% of executions.
+   * Events outside of any block are always recorded.
+   */
+  void set_sample_period(uint32_t period);
+
+  /**
+   * Calls fn with every record written since the previous drain, thread by
+   * thread, in the order each thread recorded them. Safe to call while other
+   * threads record events; only one drain runs at a time.
+   *
+   * @returns The number of records passed to fn.
+   */
+  size_t drain(const std::function<void(const RingBufferEventRecord&)>& fn);
+
+  /**
+   * Drains the records into a data sink, in the format described by
+   * RingBufferDumpHeader.
+   *
+   * @returns The number of records written, or the error from the data sink.
+   */
+  ::executorch::runtime::Result<size_t> flush(DataSinkBase& data_sink);
+
+  /**
+   * Drains the records into an ETDumpGen, as one event block per thread.
+   *
+   * @returns The number of records written.
+   */
+  size_t flush(ETDumpGen& etdump);
+
+  /**
+   * The name with the given id, or nullptr for kNoName and unknown ids.
+   */
+  const char* name(uint16_t name_id) const;
+
+  /**
+   * The number of records overwritten before they were drained.
+   */
+  size_t dropped_records() const {
+    return dropped_records_.load(std::memory_order_relaxed);
+  }
+
+  // EventTracer implementation.
+  void create_event_block(const char* name) override;
+  ::executorch::runtime::EventTracerEntry start_profiling(
+      const char* name,
+      ::executorch::runtime::ChainID chain_id = -1,
+      ::executorch::runtime::DebugHandle debug_handle = 0) override;
+  void end_profiling(
+      ::executorch::runtime::EventTracerEntry prof_entry) override;
+  ::executorch::runtime::EventTracerEntry start_profiling_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index) override;
+  void end_profiling_delegate(
+      ::executorch::runtime::EventTracerEntry prof_entry,
+      const void* metadata,
+      size_t metadata_len) override;
+  void log_profiling_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      et_timestamp_t start_time,
+      et_timestamp_t end_time,
+      const void* metadata,
+      size_t metadata_len) override;
+  void track_allocation(::executorch::runtime::AllocatorID id, size_t size)
+      override;
+  ::executorch::runtime::AllocatorID track_allocator(const char* name) override;
+  Result<bool> log_evalue(
+      const ::executorch::runtime::EValue& evalue,
+      ::executorch::runtime::LoggedEValueType evalue_type) override;
+  Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      const executorch::aten::Tensor& output) override;
+  Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      const ::executorch::runtime::ArrayRef<executorch::aten::Tensor> output)
+      override;
+  Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      const int& output) override;
+  Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      const bool& output) override;
+  Result<bool> log_intermediate_output_delegate(
+      const char* name,
+      DelegateDebugIntId delegate_debug_index,
+      const double& output) override;
+  void set_delegation_intermediate_output_filter(
+      EventTracerFilterBase* event_tracer_filter) override;
+
+ private:
+  // A single-producer ring of records, written by its owning thread only.
+  struct ThreadRing {
+    std::unique_ptr<RingBufferEventRecord[]> records;
+    std::thread::id owner;
+    uint8_t thread_id = 0;
+    // The number of records ever written; published with release order.
+    std::atomic<uint64_t> head{0};
+    // The number of records drained so far, owned by the draining thread.
+    uint64_t tail = 0;
+    // Block sampling state, owned by the recording thread.
+    uint64_t num_blocks = 0;
+    bool sampled = true;
+  };
+
+  ThreadRing* thread_ring();
+  ThreadRing* register_thread();
+  uint16_t intern(const char* name);
+  void record(ThreadRing& ring, const RingBufferEventRecord& record);
+
+  const uint64_t id_;
+  const size_t capacity_;
+  std::atomic<uint32_t> sample_period_{1};
+
+  std::array<std::unique_ptr<ThreadRing>, kMaxThreads> rings_;
+  std::atomic<size_t> num_rings_{0};
+
+  // Interned names, appended under names_mutex_ and published through
+  // num_names_. name_keys_ holds the pointer each name was first seen with,
+  // so that string literals are found without taking the lock.
+  std::array<std::string, kMaxNames> names_;
+  std::array<const char*, kMaxNames> name_keys_{};
+  std::atomic<size_t> num_names_{0};
+
+  std::mutex names_mutex_;
+  std::mutex rings_mutex_;
+  std::mutex drain_mutex_;
+  std::atomic<size_t> dropped_records_{0};
+};
+
+} // namespace etdump
+} // namespace executorch
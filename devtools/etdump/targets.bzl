@@ -122,6 +122,27 @@ def define_common_targets():
             ],
         )
 
+        runtime.cxx_library(
+            name = "profiling_stats" + aten_suffix,
+            srcs = [
+                "profiling_stats.cpp",
+            ],
+            exported_headers = [
+                "profiling_stats.h",
+            ],
+            deps = [
+                "//executorch/runtime/platform:platform",
+            ],
+            exported_deps = [
+                ":ring_buffer_event_tracer" + aten_suffix,
+                "//executorch/runtime/core:event_tracer" + aten_suffix,
+            ],
+            visibility = [
+                "//executorch/...",
+                "@EXECUTORCH_CLIENTS",
+            ],
+        )
+
         runtime.cxx_library(
             name = "etdump_flatcc" + aten_suffix,
             srcs = [
@@ -150,3 +171,25 @@ def define_common_targets():
                 "@EXECUTORCH_CLIENTS",
             ],
         )
+
+        runtime.cxx_library(
+            name = "ring_buffer_event_tracer" + aten_suffix,
+            srcs = [
+                "ring_buffer_event_tracer.cpp",
+            ],
+            exported_headers = [
+                "ring_buffer_event_tracer.h",
+            ],
+            deps = [
+                "//executorch/runtime/platform:platform",
+            ],
+            exported_deps = [
+                ":etdump_flatcc" + aten_suffix,
+                "//executorch/devtools/etdump/data_sinks:data_sink_base" + aten_suffix,
+                "//executorch/runtime/core:event_tracer" + aten_suffix,
+            ],
+            visibility = [
+                "//executorch/...",
+                "@EXECUTORCH_CLIENTS",
+            ],
+        )
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include <executorch/devtools/etdump/profiling_stats.h>
+#include <executorch/devtools/etdump/ring_buffer_event_tracer.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using ::executorch::etdump::LatencyHistogram;
+using ::executorch::etdump::ProfilingStats;
+using ::executorch::etdump::RingBufferEventTracer;
+using ::executorch::runtime::ChainID;
+using ::executorch::runtime::DebugHandle;
+using ::executorch::runtime::kUnsetDelegateDebugIntId;
+
+class ProfilingStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+
+  static ProfilingStats::Key key(
+      ChainID chain_id,
+      DebugHandle debug_handle,
+      const char* name) {
+    return {chain_id, debug_handle, name, kUnsetDelegateDebugIntId};
+  }
+};
+
+TEST_F(ProfilingStatsTest, HistogramBucketsAreContiguous) {
+  for (size_t i = 0; i < 1920; ++i) {
+    const uint64_t lower = LatencyHistogram::bucket_lower_bound(i);
+    const uint64_t upper = LatencyHistogram::bucket_upper_bound(i);
+    ASSERT_LE(lower, upper);
+    EXPECT_EQ(LatencyHistogram::bucket_index(lower), i);
+    EXPECT_EQ(LatencyHistogram::bucket_index(upper), i);
+    if (i > 0) {
+      EXPECT_EQ(lower, LatencyHistogram::bucket_upper_bound(i - 1) + 1);
+    }
+    // Each bucket is at most 1/32 of its lower bound wide.
+    EXPECT_LE(upper - lower, lower / 32);
+  }
+  EXPECT_EQ(LatencyHistogram::bucket_index(UINT64_MAX), 1919);
+  EXPECT_EQ(LatencyHistogram::bucket_upper_bound(1919), UINT64_MAX);
+}
+
+TEST_F(ProfilingStatsTest, HistogramPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0);
+
+  for (uint64_t value = 1; value <= 10000; ++value) {
+    histogram.record(value * 1000);
+  }
+  EXPECT_EQ(histogram.count(), 10000);
+  EXPECT_EQ(histogram.min(), 1000);
+  EXPECT_EQ(histogram.max(), 10000000);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 5000500.0);
+  EXPECT_EQ(histogram.percentile(0), 1000);
+  EXPECT_EQ(histogram.percentile(100), 10000000);
+
+  // Percentiles are within the 1/32 relative precision of the buckets.
+  for (double p : {50.0, 90.0, 99.0}) {
+    const double exact = p * 100 * 1000;
+    const double value = static_cast<double>(histogram.percentile(p));
+    EXPECT_GE(value, exact) << p;
+    EXPECT_LE(value, exact * (1 + 1.0 / 32)) << p;
+  }
+
+  LatencyHistogram other;
+  other.record(5);
+  histogram.merge(other);
+  EXPECT_EQ(histogram.count(), 10001);
+  EXPECT_EQ(histogram.min(), 5);
+  EXPECT_EQ(histogram.percentile(0.001), 5);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+}
+
+TEST_F(ProfilingStatsTest, CollectsFromTracer) {
+  RingBufferEventTracer tracer;
+  ProfilingStats stats;
+  stats.set_name_resolver([](ChainID chain_id, DebugHandle debug_handle) {
+    return chain_id == 0 && debug_handle == 1 ? "aten::add" : nullptr;
+  });
+
+  for (int i = 0; i < 3; ++i) {
+    tracer.create_event_block("Execute");
+    tracer.set_chain_debug_handle(0, 1);
+    tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+    // Shares the chain and debug handle, but is not named after the
+    // instruction.
+    tracer.end_profiling(tracer.start_profiling("Method::step"));
+    tracer.set_chain_debug_handle(0, 2);
+    tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+    tracer.log_profiling_delegate(
+        "fused_conv",
+        kUnsetDelegateDebugIntId,
+        100,
+        100 + 1000 * i,
+        nullptr,
+        0);
+  }
+  EXPECT_EQ(stats.collect(tracer), 12);
+
+  ASSERT_EQ(stats.entries().size(), 4);
+  ASSERT_NE(stats.find(key(0, 1, "aten::add")), nullptr);
+  EXPECT_EQ(stats.find(key(0, 1, "aten::add"))->count(), 3);
+  ASSERT_NE(stats.find(key(0, 1, "Method::step")), nullptr);
+  ASSERT_NE(stats.find(key(0, 2, "OPERATOR_CALL")), nullptr);
+
+  // Delegate events keep their own name. The POSIX PAL counts ticks in
+  // nanoseconds.
+  const LatencyHistogram* conv = stats.find(key(0, 2, "fused_conv"));
+  ASSERT_NE(conv, nullptr);
+  EXPECT_EQ(conv->count(), 3);
+  EXPECT_EQ(conv->min(), 0);
+  EXPECT_EQ(conv->max(), 2000);
+  EXPECT_EQ(conv->sum(), 3000);
+
+  // Collecting again adds to the same entries.
+  tracer.set_chain_debug_handle(0, 1);
+  tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+  EXPECT_EQ(stats.collect(tracer), 1);
+  EXPECT_EQ(stats.find(key(0, 1, "aten::add"))->count(), 4);
+}
+
+TEST_F(ProfilingStatsTest, BoundsEntries) {
+  ProfilingStats stats(/*max_entries=*/2);
+  for (DebugHandle i = 0; i < 5; ++i) {
+    stats.record(key(0, i, "op"), 10);
+    stats.record(key(0, i, "op"), 20);
+  }
+  EXPECT_EQ(stats.entries().size(), 2);
+  EXPECT_EQ(stats.find(key(0, 1, "op"))->count(), 2);
+  EXPECT_EQ(stats.find(key(0, 2, "op")), nullptr);
+  EXPECT_EQ(stats.dropped_events(), 6);
+
+  stats.reset();
+  EXPECT_TRUE(stats.entries().empty());
+  EXPECT_EQ(stats.dropped_events(), 0);
+}
+
+TEST_F(ProfilingStatsTest, ExportsTables) {
+  ProfilingStats stats;
+  EXPECT_EQ(stats.to_json(), "[]\n");
+
+  stats.record(key(0, 3, "aten::add"), 10);
+  stats.record(key(0, 3, "aten::add"), 30);
+  stats.record(key(1, 0, "a \"quoted\", name"), 5);
+
+  EXPECT_EQ(
+      stats.to_json(),
+      "[\n"
+      "  {\"chain\": 0, \"instruction\": 3, \"name\": \"aten::add\", "
+      "\"delegate_debug_id\": -1, \"count\": 2, \"min_ns\": 10, "
+      "\"mean_ns\": 20.0, \"p50_ns\": 10, \"p90_ns\": 30, \"p99_ns\": 30, "
+      "\"max_ns\": 30, \"total_ns\": 40},\n"
+      "  {\"chain\": 1, \"instruction\": 0, "
+      "\"name\": \"a \\\"quoted\\\", name\", "
+      "\"delegate_debug_id\": -1, \"count\": 1, \"min_ns\": 5, "
+      "\"mean_ns\": 5.0, \"p50_ns\": 5, \"p90_ns\": 5, \"p99_ns\": 5, "
+      "\"max_ns\": 5, \"total_ns\": 5}\n"
+      "]\n");
+  EXPECT_EQ(
+      stats.to_csv(),
+      "chain,instruction,name,delegate_debug_id,count,min_ns,mean_ns,"
+      "p50_ns,p90_ns,p99_ns,max_ns,total_ns\n"
+      "0,3,aten::add,-1,2,10,20.0,10,30,30,30,40\n"
+      "1,0,\"a \"\"quoted\"\", name\",-1,1,5,5.0,5,5,5,5,5\n");
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <executorch/devtools/etdump/data_sinks/buffer_data_sink.h>
+#include <executorch/devtools/etdump/etdump_schema_flatcc_reader.h>
+#include <executorch/devtools/etdump/ring_buffer_event_tracer.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using ::executorch::etdump::BufferDataSink;
+using ::executorch::etdump::ETDumpGen;
+using ::executorch::etdump::ETDumpResult;
+using ::executorch::etdump::RingBufferDumpHeader;
+using ::executorch::etdump::RingBufferEventKind;
+using ::executorch::etdump::RingBufferEventRecord;
+using ::executorch::etdump::RingBufferEventTracer;
+using ::executorch::runtime::EventTracerEntry;
+using ::executorch::runtime::kUnsetDelegateDebugIntId;
+
+class RingBufferEventTracerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+
+  static std::vector<RingBufferEventRecord> drain(
+      RingBufferEventTracer& tracer) {
+    std::vector<RingBufferEventRecord> records;
+    tracer.drain(
+        [&](const RingBufferEventRecord& r) { records.push_back(r); });
+    return records;
+  }
+};
+
+TEST_F(RingBufferEventTracerTest, RecordsProfilingEvents) {
+  RingBufferEventTracer tracer;
+  tracer.create_event_block("block");
+
+  tracer.set_chain_debug_handle(1, 7);
+  EventTracerEntry op = tracer.start_profiling("OPERATOR_CALL");
+  tracer.end_profiling(op);
+  EventTracerEntry method = tracer.start_profiling("Method::execute", 0, 3);
+  tracer.end_profiling(method);
+  EventTracerEntry delegate =
+      tracer.start_profiling_delegate(nullptr, /*delegate_debug_index=*/12);
+  tracer.end_profiling_delegate(delegate, nullptr, 0);
+  tracer.log_profiling_delegate(
+      "fused_conv", kUnsetDelegateDebugIntId, 100, 250, nullptr, 0);
+
+  const auto records = drain(tracer);
+  ASSERT_EQ(records.size(), 4);
+
+  EXPECT_EQ(records[0].kind, RingBufferEventKind::kEvent);
+  EXPECT_STREQ(tracer.name(records[0].name_id), "OPERATOR_CALL");
+  EXPECT_EQ(records[0].chain_id, 1);
+  EXPECT_EQ(records[0].debug_handle, 7);
+  EXPECT_LE(records[0].start_time, records[0].end_time);
+
+  EXPECT_STREQ(tracer.name(records[1].name_id), "Method::execute");
+  EXPECT_EQ(records[1].chain_id, 0);
+  EXPECT_EQ(records[1].debug_handle, 3);
+
+  EXPECT_EQ(records[2].kind, RingBufferEventKind::kDelegateInt);
+  EXPECT_EQ(records[2].delegate_debug_id, 12);
+  EXPECT_EQ(records[2].name_id, RingBufferEventTracer::kNoName);
+
+  EXPECT_EQ(records[3].kind, RingBufferEventKind::kDelegateStr);
+  EXPECT_STREQ(tracer.name(records[3].name_id), "fused_conv");
+  EXPECT_EQ(records[3].start_time, 100);
+  EXPECT_EQ(records[3].end_time, 250);
+
+  for (const auto& r : records) {
+    EXPECT_EQ(r.thread_id, 0);
+  }
+
+  // Drained records are not returned again.
+  EXPECT_TRUE(drain(tracer).empty());
+  EXPECT_EQ(tracer.dropped_records(), 0);
+}
+
+TEST_F(RingBufferEventTracerTest, InternsNamesByContent) {
+  RingBufferEventTracer tracer;
+  char name[] = "first";
+  tracer.end_profiling(tracer.start_profiling(name));
+  // The same buffer with a different name, then a copy of the first name.
+  std::strcpy(name, "other");
+  tracer.end_profiling(tracer.start_profiling(name));
+  std::string copy = "first";
+  tracer.end_profiling(tracer.start_profiling(copy.c_str()));
+
+  const auto records = drain(tracer);
+  ASSERT_EQ(records.size(), 3);
+  EXPECT_STREQ(tracer.name(records[0].name_id), "first");
+  EXPECT_STREQ(tracer.name(records[1].name_id), "other");
+  EXPECT_EQ(records[2].name_id, records[0].name_id);
+  EXPECT_EQ(tracer.name(RingBufferEventTracer::kNoName), nullptr);
+}
+
+TEST_F(RingBufferEventTracerTest, SamplesEventBlocks) {
+  RingBufferEventTracer tracer;
+  tracer.set_sample_period(4);
+
+  for (int block = 0; block < 10; ++block) {
+    tracer.create_event_block("Execute");
+    tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL"));
+    tracer.log_profiling_delegate(
+        "delegate", kUnsetDelegateDebugIntId, 0, 1, nullptr, 0);
+  }
+
+  // Blocks 0, 4 and 8 are sampled.
+  EXPECT_EQ(drain(tracer).size(), 6);
+}
+
+TEST_F(RingBufferEventTracerTest, OverwritesOldestRecords) {
+  RingBufferEventTracer tracer(/*records_per_thread=*/3);
+
+  for (uint32_t i = 0; i < 10; ++i) {
+    tracer.end_profiling(tracer.start_profiling("event", 0, i));
+  }
+
+  // The capacity rounds up to 4. The oldest slot of a full ring may be in the
+  // middle of being overwritten, so only the last 3 records are drained.
+  const auto records = drain(tracer);
+  ASSERT_EQ(records.size(), 3);
+  for (uint32_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(records[i].debug_handle, 7 + i);
+  }
+  EXPECT_EQ(tracer.dropped_records(), 7);
+}
+
+TEST_F(RingBufferEventTracerTest, RecordsPerThread) {
+  RingBufferEventTracer tracer;
+  constexpr int kNumThreads = 4;
+  constexpr uint32_t kNumEvents = 100;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&tracer, t]() {
+      for (uint32_t i = 0; i < kNumEvents; ++i) {
+        tracer.end_profiling(tracer.start_profiling("event", t, i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto records = drain(tracer);
+  ASSERT_EQ(records.size(), kNumThreads * kNumEvents);
+  // Each thread's records come out together and in order.
+  for (size_t i = 0; i < records.size(); ++i) {
+    const auto& first = records[i - i % kNumEvents];
+    EXPECT_EQ(records[i].thread_id, first.thread_id);
+    EXPECT_EQ(records[i].chain_id, first.chain_id);
+    EXPECT_EQ(records[i].debug_handle, i % kNumEvents);
+  }
+}
+
+TEST_F(RingBufferEventTracerTest, FlushesToDataSink) {
+  RingBufferEventTracer tracer;
+  tracer.end_profiling(tracer.start_profiling("a", 0, 1));
+  tracer.end_profiling(tracer.start_profiling("bc", 0, 2));
+
+  std::vector<uint8_t> buffer(4096);
+  auto sink =
+      BufferDataSink::create(buffer.data(), buffer.size(), /*alignment=*/1);
+  ASSERT_TRUE(sink.ok());
+  auto flushed = tracer.flush(sink.get());
+  ASSERT_TRUE(flushed.ok());
+  EXPECT_EQ(flushed.get(), 2);
+
+  RingBufferDumpHeader header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  EXPECT_EQ(std::string(header.magic, 4), "ETRB");
+  EXPECT_EQ(header.record_size, sizeof(RingBufferEventRecord));
+  ASSERT_EQ(header.num_names, 2);
+  ASSERT_EQ(header.num_records, 2);
+  EXPECT_GT(header.ticks_to_ns_denominator, 0);
+
+  const char* names =
+      reinterpret_cast<const char*>(buffer.data() + sizeof(header));
+  EXPECT_STREQ(names, "a");
+  EXPECT_STREQ(names + 2, "bc");
+
+  RingBufferEventRecord records[2];
+  std::memcpy(records, names + 5, sizeof(records));
+  EXPECT_EQ(records[0].debug_handle, 1);
+  EXPECT_EQ(records[1].debug_handle, 2);
+  EXPECT_STREQ(tracer.name(records[1].name_id), "bc");
+}
+
+TEST_F(RingBufferEventTracerTest, FlushesToETDump) {
+  RingBufferEventTracer tracer;
+  tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL", 0, 5));
+  tracer.log_profiling_delegate(nullptr, 3, 10, 20, nullptr, 0);
+  std::thread([&tracer]() {
+    tracer.end_profiling(tracer.start_profiling("OPERATOR_CALL", 0, 6));
+  }).join();
+
+  ETDumpGen etdump;
+  EXPECT_EQ(tracer.flush(etdump), 3);
+  EXPECT_EQ(etdump.get_num_blocks(), 2);
+
+  ETDumpResult result = etdump.get_etdump_data();
+  ASSERT_NE(result.buf, nullptr);
+  size_t size = 0;
+  void* buf = flatbuffers_read_size_prefix(result.buf, &size);
+  etdump_ETDump_table_t dump = etdump_ETDump_as_root_with_identifier(
+      buf, etdump_ETDump_file_identifier);
+  ASSERT_NE(dump, nullptr);
+
+  etdump_RunData_vec_t run_data_vec = etdump_ETDump_run_data(dump);
+  ASSERT_EQ(etdump_RunData_vec_len(run_data_vec), 2);
+  etdump_Event_vec_t events =
+      etdump_RunData_events(etdump_RunData_vec_at(run_data_vec, 0));
+  ASSERT_EQ(etdump_Event_vec_len(events), 2);
+
+  etdump_ProfileEvent_table_t op =
+      etdump_Event_profile_event(etdump_Event_vec_at(events, 0));
+  EXPECT_STREQ(etdump_ProfileEvent_name(op), "OPERATOR_CALL");
+  EXPECT_EQ(etdump_ProfileEvent_instruction_id(op), 5);
+
+  etdump_ProfileEvent_table_t delegate =
+      etdump_Event_profile_event(etdump_Event_vec_at(events, 1));
+  EXPECT_EQ(etdump_ProfileEvent_delegate_debug_id_int(delegate), 3);
+  EXPECT_EQ(etdump_ProfileEvent_start_time(delegate), 10);
+  EXPECT_EQ(etdump_ProfileEvent_end_time(delegate), 20);
+
+  free(result.buf);
+}
@@ -33,3 +33,27 @@ def define_common_targets():
             "//executorch/runtime/platform:platform",
         ],
     )
+
+    runtime.cxx_test(
+        name = "ring_buffer_event_tracer_test",
+        srcs = [
+            "ring_buffer_event_tracer_test.cpp",
+        ],
+        deps = [
+            "//executorch/devtools/etdump:ring_buffer_event_tracer",
+            "//executorch/devtools/etdump:etdump_schema_flatcc",
+            "//executorch/devtools/etdump/data_sinks:buffer_data_sink",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "profiling_stats_test",
+        srcs = [
+            "profiling_stats_test.cpp",
+        ],
+        deps = [
+            "//executorch/devtools/etdump:profiling_stats",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
@@ -0,0 +1,541 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Reports how tightly the memory planner packed the planned buffers of a .pte.
+
+For every tensor with allocation_info, the lifetime is derived from the
+instruction stream: a tensor is live from the first instruction that
+references it to the last one, and method inputs and outputs are live for the
+whole method. So are mutable buffers, which keep their contents from one
+execution to the next. Replaying those lifetimes gives the live bytes of each planned
+buffer at every instruction, which is a lower bound on the buffer size any
+planner could achieve for the same execution order.
+"""
+
+import argparse
+import html
+import json
+from dataclasses import asdict, dataclass, field
+from typing import Any, Dict, List, Optional, Set, Tuple
+
+from executorch.exir._serialize._program import deserialize_pte_binary
+from executorch.exir.scalar_type import ScalarType
+from executorch.exir.schema import (
+    DelegateCall,
+    ExecutionPlan,
+    FreeCall,
+    JumpFalseCall,
+    KernelCall,
+    MoveCall,
+    OptionalTensorList,
+    Program,
+    Tensor,
+    TensorList,
+)
+
+_ELEMENT_SIZES: Dict[ScalarType, int] = {
+    ScalarType.BYTE: 1,
+    ScalarType.CHAR: 1,
+    ScalarType.SHORT: 2,
+    ScalarType.INT: 4,
+    ScalarType.LONG: 8,
+    ScalarType.HALF: 2,
+    ScalarType.FLOAT: 4,
+    ScalarType.DOUBLE: 8,
+    ScalarType.COMPLEX32: 4,
+    ScalarType.COMPLEX64: 8,
+    ScalarType.COMPLEX128: 16,
+    ScalarType.BOOL: 1,
+    ScalarType.QINT8: 1,
+    ScalarType.QUINT8: 1,
+    ScalarType.QINT32: 4,
+    ScalarType.BFLOAT16: 2,
+    ScalarType.QUINT4x2: 1,
+    ScalarType.QUINT2x4: 1,
+    ScalarType.BITS16: 2,
+    ScalarType.FLOAT8E5M2: 1,
+    ScalarType.FLOAT8E4M3FN: 1,
+    ScalarType.FLOAT8E5M2FNUZ: 1,
+    ScalarType.FLOAT8E4M3FNUZ: 1,
+    ScalarType.UINT16: 2,
+    ScalarType.UINT32: 4,
+    ScalarType.UINT64: 8,
+}
+
+
+@dataclass
+class PlannedTensor:
+    value_index: int
+    mem_id: int
+    offset: int
+    size_bytes: int
+    # Instruction indices, inclusive. None if no instruction references the
+    # tensor.
+    first_use: Optional[int]
+    last_use: Optional[int]
+    # Read before it is written, so it holds state across executions.
+    mutable_buffer: bool = False
+
+    def is_live(self, step: int) -> bool:
+        return (
+            self.first_use is not None
+            and self.last_use is not None
+            and self.first_use <= step <= self.last_use
+        )
+
+
+@dataclass
+class BufferReport:
+    mem_id: int
+    # The size the planner reserved for this buffer.
+    buffer_size: int
+    # The highest end offset of any tensor placed in this buffer.
+    high_water_bytes: int
+    # The most bytes that are live at any one instruction.
+    peak_live_bytes: int
+    peak_step: int
+    # buffer_size - peak_live_bytes: what a perfect packing for the same
+    # execution order would save.
+    wasted_bytes: int
+    # Unused holes below the highest live tensor at peak_step.
+    fragmented_bytes_at_peak: int
+    num_tensors: int
+    num_unused_tensors: int
+    # Live bytes at every instruction.
+    live_bytes: List[int] = field(default_factory=list)
+
+    @property
+    def efficiency(self) -> float:
+        return self.peak_live_bytes / self.buffer_size if self.buffer_size else 1.0
+
+
+@dataclass
+class MethodReport:
+    name: str
+    num_instructions: int
+    # A short description of each instruction, e.g. the operator name.
+    instructions: List[str]
+    tensors: List[PlannedTensor]
+    buffers: List[BufferReport]
+
+
+def _tensor_nbytes(tensor: Tensor) -> int:
+    if tensor.scalar_type not in _ELEMENT_SIZES:
+        raise RuntimeError(f"Unrecognized scalar_type: {tensor.scalar_type}")
+    numel = 1
+    for size in tensor.sizes:
+        numel *= size
+    return numel * _ELEMENT_SIZES[tensor.scalar_type]
+
+
+def _instruction_values(plan: ExecutionPlan, instr_args: Any) -> List[int]:
+    """Returns the indices of the values an instruction reads or writes."""
+    if isinstance(instr_args, (KernelCall, DelegateCall)):
+        indices = list(instr_args.args)
+    elif isinstance(instr_args, MoveCall):
+        indices = [instr_args.move_from, instr_args.move_to]
+    elif isinstance(instr_args, JumpFalseCall):
+        indices = [instr_args.cond_value_index]
+    elif isinstance(instr_args, FreeCall):
+        indices = [instr_args.value_index]
+    else:
+        raise RuntimeError(f"Unrecognized instruction: {type(instr_args)}")
+
+    # A list argument keeps its elements alive as well.
+    for index in list(indices):
+        val = plan.values[index].val
+        if isinstance(val, (TensorList, OptionalTensorList)):
+            indices.extend(item for item in val.items if item >= 0)
+    return indices
+
+
+def _written_values(plan: ExecutionPlan, instr_args: Any) -> List[int]:
+    """
+    Returns the indices of the values an instruction writes, as far as they
+    can be told apart from the ones it reads. A kernel call's out arguments
+    come last, possibly followed by the returned values, which alias them. A
+    delegate call's arguments are all treated as written.
+    """
+    if isinstance(instr_args, KernelCall):
+        args = list(instr_args.args)
+        num_out = 1
+        for k in range(len(args) // 2, 0, -1):
+            if args[-2 * k : -k] == args[-k:]:
+                num_out = k
+                break
+        indices = args[-num_out:]
+    elif isinstance(instr_args, DelegateCall):
+        indices = list(instr_args.args)
+    elif isinstance(instr_args, MoveCall):
+        indices = [instr_args.move_to]
+    else:
+        indices = []
+
+    for index in list(indices):
+        val = plan.values[index].val
+        if isinstance(val, (TensorList, OptionalTensorList)):
+            indices.extend(item for item in val.items if item >= 0)
+    return indices
+
+
+def _describe_instruction(plan: ExecutionPlan, instr_args: Any) -> str:
+    if isinstance(instr_args, KernelCall):
+        op = plan.operators[instr_args.op_index]
+        return f"{op.name}.{op.overload}" if op.overload else op.name
+    if isinstance(instr_args, DelegateCall):
+        return f"delegate:{plan.delegates[instr_args.delegate_index].id}"
+    return type(instr_args).__name__
+
+
+def _live_bytes(tensors: List[PlannedTensor], step: int) -> Tuple[int, int]:
+    """
+    Returns the live bytes at a step and the end of the highest live tensor.
+    Tensors that alias the same bytes are only counted once.
+    """
+    intervals = sorted(
+        (t.offset, t.offset + t.size_bytes)
+        for t in tensors
+        if t.is_live(step) and t.size_bytes > 0
+    )
+    live = 0
+    covered_end = 0
+    for start, end in intervals:
+        if end <= covered_end:
+            continue
+        live += end - max(start, covered_end)
+        covered_end = end
+    return live, covered_end
+
+
+def analyze_execution_plan(plan: ExecutionPlan) -> MethodReport:
+    """Computes the lifetime and occupancy report of one method."""
+    instructions = [
+        instruction.instr_args
+        for chain in plan.chains
+        for instruction in chain.instructions
+    ]
+    num_steps = max(len(instructions), 1)
+
+    first_use: Dict[int, int] = {}
+    last_use: Dict[int, int] = {}
+    # Values whose first reference reads them.
+    read_first: Set[int] = set()
+    for step, instr_args in enumerate(instructions):
+        written: Optional[Set[int]] = None
+        for index in _instruction_values(plan, instr_args):
+            if index not in first_use:
+                if written is None:
+                    written = set(_written_values(plan, instr_args))
+                if index not in written:
+                    read_first.add(index)
+            first_use.setdefault(index, step)
+            last_use[index] = step
+    # Inputs are written before the first instruction and outputs are read
+    # after the last one.
+    for index in plan.inputs:
+        first_use[index] = 0
+        last_use.setdefault(index, 0)
+    for index in plan.outputs:
+        first_use.setdefault(index, num_steps - 1)
+        last_use[index] = num_steps - 1
+
+    tensors = []
+    for index, evalue in enumerate(plan.values):
+        tensor = evalue.val
+        if not isinstance(tensor, Tensor) or tensor.allocation_info is None:
+            continue
+        # A planned tensor that is read before anything writes it, and that
+        # isn't an input, is a mutable buffer. Its contents must survive until
+        # the next execution, so its slot can't be reused within the method.
+        mutable_buffer = index in read_first and index not in plan.inputs
+        tensors.append(
+            PlannedTensor(
+                value_index=index,
+                mem_id=tensor.allocation_info.memory_id,
+                offset=tensor.allocation_info.memory_offset,
+                size_bytes=_tensor_nbytes(tensor),
+                first_use=0 if mutable_buffer else first_use.get(index),
+                last_use=num_steps - 1 if mutable_buffer else last_use.get(index),
+                mutable_buffer=mutable_buffer,
+            )
+        )
+
+    # Index 0 of non_const_buffer_sizes is the constant buffer.
+    buffers = []
+    for mem_id in range(1, len(plan.non_const_buffer_sizes)):
+        buffer_tensors = [t for t in tensors if t.mem_id == mem_id]
+        live_bytes = []
+        peak_live_bytes, peak_step, peak_end = 0, 0, 0
+        for step in range(num_steps):
+            live, end = _live_bytes(buffer_tensors, step)
+            live_bytes.append(live)
+            if live > peak_live_bytes:
+                peak_live_bytes, peak_step, peak_end = live, step, end
+        buffer_size = plan.non_const_buffer_sizes[mem_id]
+        buffers.append(
+            BufferReport(
+                mem_id=mem_id,
+                buffer_size=buffer_size,
+                high_water_bytes=max(
+                    (t.offset + t.size_bytes for t in buffer_tensors), default=0
+                ),
+                peak_live_bytes=peak_live_bytes,
+                peak_step=peak_step,
+                wasted_bytes=max(buffer_size - peak_live_bytes, 0),
+                fragmented_bytes_at_peak=peak_end - peak_live_bytes,
+                num_tensors=len(buffer_tensors),
+                num_unused_tensors=sum(
+                    1 for t in buffer_tensors if t.first_use is None
+                ),
+                live_bytes=live_bytes,
+            )
+        )
+
+    return MethodReport(
+        name=plan.name,
+        num_instructions=len(instructions),
+        instructions=[_describe_instruction(plan, i) for i in instructions],
+        tensors=tensors,
+        buffers=buffers,
+    )
+
+
+def analyze_program(program: Program) -> List[MethodReport]:
+    return [analyze_execution_plan(plan) for plan in program.execution_plan]
+
+
+def generate_report_json(reports: List[MethodReport]) -> List[Dict[str, Any]]:
+    """Returns a json-serializable summary of the reports."""
+    methods = []
+    for report in reports:
+        buffers = []
+        for buffer in report.buffers:
+            data = asdict(buffer)
+            data["efficiency"] = buffer.efficiency
+            buffers.append(data)
+        methods.append(
+            {
+                "name": report.name,
+                "num_instructions": report.num_instructions,
+                "buffers": buffers,
+                "tensors": [asdict(t) for t in report.tensors],
+            }
+        )
+    return methods
+
+
+def format_report(reports: List[MethodReport]) -> str:
+    """Returns a human readable summary of the reports."""
+    lines = []
+    total_size = 0
+    total_wasted = 0
+    for report in reports:
+        lines.append(
+            f"Method '{report.name}': {report.num_instructions} instructions, "
+            f"{len(report.tensors)} planned tensors"
+        )
+        for buffer in report.buffers:
+            total_size += buffer.buffer_size
+            total_wasted += buffer.wasted_bytes
+            peak_instruction = (
+                report.instructions[buffer.peak_step]
+                if buffer.peak_step < len(report.instructions)
+                else "-"
+            )
+            lines.append(
+                f"  buffer {buffer.mem_id}: size {buffer.buffer_size} B, "
+                f"high water {buffer.high_water_bytes} B, "
+                f"peak live {buffer.peak_live_bytes} B "
+                f"({buffer.efficiency:.1%}) at instruction {buffer.peak_step} "
+                f"({peak_instruction})"
+            )
+            lines.append(
+                f"    wasted {buffer.wasted_bytes} B, "
+                f"fragmented at peak {buffer.fragmented_bytes_at_peak} B, "
+                f"{buffer.num_tensors} tensors "
+                f"({buffer.num_unused_tensors} never referenced)"
+            )
+    lines.append(f"Total: {total_size} B planned, {total_wasted} B above peak live")
+    return "\n".join(lines)
+
+
+def generate_chrome_trace(reports: List[MethodReport]) -> Dict[str, Any]:
+    """
+    Returns the reports as a chrome trace, laid out like the one from
+    executorch.util.activation_memory_profiler: each process is a planned
+    buffer, each thread is an instruction, and each event is a live tensor
+    whose timestamp and duration are its offset and size in bytes.
+    """
+    trace_events: List[Dict[str, Any]] = []
+    for report in reports:
+        for buffer in report.buffers:
+            pid = f"{report.name}/mem_id {buffer.mem_id}"
+            tensors = [t for t in report.tensors if t.mem_id == buffer.mem_id]
+            for step in range(report.num_instructions):
+                for tensor in tensors:
+                    if not tensor.is_live(step):
+                        continue
+                    trace_events.append(
+                        {
+                            "name": f"value {tensor.value_index}",
+                            "cat": "memory_allocation",
+                            "ph": "X",
+                            "ts": tensor.offset,
+                            "dur": tensor.size_bytes,
+                            "pid": pid,
+                            "tid": step,
+                            "args": {
+                                "instruction": report.instructions[step],
+                                "bytes": tensor.size_bytes,
+                                "lifetime": [tensor.first_use, tensor.last_use],
+                            },
+                        }
+                    )
+    return {"traceEvents": trace_events}
+
+
+def _buffer_svg(report: MethodReport, buffer: BufferReport) -> str:
+    """Draws tensors as boxes over (instruction, offset) with live bytes."""
+    width, height = 800, 300
+    steps = max(report.num_instructions, 1)
+    max_bytes = max(buffer.buffer_size, buffer.high_water_bytes, 1)
+
+    def x(step: float) -> float:
+        return step * width / steps
+
+    def y(num_bytes: float) -> float:
+        return height - num_bytes * height / max_bytes
+
+    shapes = []
+    for tensor in report.tensors:
+        if tensor.mem_id != buffer.mem_id or tensor.first_use is None:
+            continue
+        assert tensor.last_use is not None
+        title = html.escape(
+            f"value {tensor.value_index}: {tensor.size_bytes} B at "
+            f"{tensor.offset}, instructions {tensor.first_use}-{tensor.last_use}"
+        )
+        shapes.append(
+            f'<rect x="{x(tensor.first_use):.2f}" '
+            f'y="{y(tensor.offset + tensor.size_bytes):.2f}" '
+            f'width="{x(tensor.last_use + 1) - x(tensor.first_use):.2f}" '
+            f'height="{tensor.size_bytes * height / max_bytes:.2f}" '
+            f'fill="#8ab" stroke="#345" stroke-width="0.5">'
+            f"<title>{title}</title></rect>"
+        )
+    points = " ".join(
+        f"{x(step):.2f},{y(live):.2f} {x(step + 1):.2f},{y(live):.2f}"
+        for step, live in enumerate(buffer.live_bytes)
+    )
+    shapes.append(
+        f'<polyline points="{points}" fill="none" stroke="#c33" '
+        'stroke-width="1.5"><title>live bytes</title></polyline>'
+    )
+    shapes.append(
+        f'<line x1="0" x2="{width}" y1="{y(buffer.buffer_size):.2f}" '
+        f'y2="{y(buffer.buffer_size):.2f}" stroke="#000" '
+        'stroke-dasharray="4"><title>buffer size</title></line>'
+    )
+    return (
+        f'<svg width="{width}" height="{height}" '
+        'style="border: 1px solid #ccc">' + "".join(shapes) + "</svg>"
+    )
+
+
+def generate_html(reports: List[MethodReport]) -> str:
+    """
+    Returns a standalone HTML page with one occupancy chart per planned
+    buffer: tensors are drawn at their offset over their lifetime, the red
+    line is the live bytes and the dashed line is the buffer size.
+    """
+    body = []
+    for report in reports:
+        body.append(f"<h2>{html.escape(report.name)}</h2>")
+        for buffer in report.buffers:
+            body.append(
+                f"<h3>mem_id {buffer.mem_id}</h3><p>size {buffer.buffer_size} B, "
+                f"peak live {buffer.peak_live_bytes} B "
+                f"({buffer.efficiency:.1%}) at instruction {buffer.peak_step}, "
+                f"wasted {buffer.wasted_bytes} B, fragmented at peak "
+                f"{buffer.fragmented_bytes_at_peak} B</p>"
+            )
+            body.append(_buffer_svg(report, buffer))
+    return (
+        "<!DOCTYPE html><html><head><meta charset='utf-8'>"
+        "<title>Memory planning report</title></head>"
+        "<body style='font-family: sans-serif'>" + "\n".join(body) + "</body></html>\n"
+    )
+
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+
+    parser.add_argument(
+        "--pte_path",
+        required=True,
+        help="The path to the .pte file to analyze",
+    )
+
+    parser.add_argument(
+        "--method",
+        default=None,
+        help="Only report this method. Reports every method by default",
+    )
+
+    parser.add_argument(
+        "--json_path",
+        default=None,
+        help="Writes the full report, including per-tensor lifetimes, as json",
+    )
+
+    parser.add_argument(
+        "--trace_path",
+        default=None,
+        help="Writes the buffer occupancy as a chrome trace",
+    )
+
+    parser.add_argument(
+        "--html_path",
+        default=None,
+        help="Writes a standalone HTML page with an occupancy chart per buffer",
+    )
+
+    args = parser.parse_args()
+    return args
+
+
+def main():
+    args = parse_args()
+
+    with open(args.pte_path, "rb") as pte_file:
+        program = deserialize_pte_binary(pte_file.read())
+
+    reports = analyze_program(program)
+    if args.method is not None:
+        reports = [report for report in reports if report.name == args.method]
+        if not reports:
+            raise ValueError(f"Method '{args.method}' not found in {args.pte_path}")
+
+    print(format_report(reports))
+
+    if args.json_path is not None:
+        with open(args.json_path, "w") as json_file:
+            json.dump(generate_report_json(reports), json_file, indent=2)
+
+    if args.trace_path is not None:
+        with open(args.trace_path, "w") as trace_file:
+            json.dump(generate_chrome_trace(reports), trace_file)
+
+    if args.html_path is not None:
+        with open(args.html_path, "w") as html_file:
+            html_file.write(generate_html(reports))
+
+
+if __name__ == "__main__":
+    main()
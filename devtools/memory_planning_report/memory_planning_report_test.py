@@ -0,0 +1,225 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import json
+import unittest
+from typing import List, Optional
+
+from executorch.devtools.memory_planning_report.memory_planning_report import (
+    analyze_execution_plan,
+    format_report,
+    generate_chrome_trace,
+    generate_html,
+    generate_report_json,
+)
+from executorch.exir.scalar_type import ScalarType
+from executorch.exir.schema import (
+    AllocationDetails,
+    Chain,
+    ContainerMetadata,
+    EValue,
+    ExecutionPlan,
+    Instruction,
+    Int,
+    KernelCall,
+    Operator,
+    Tensor,
+    TensorShapeDynamism,
+)
+
+
+def _tensor(numel: int, offset: Optional[int], mem_id: int = 1) -> EValue:
+    return EValue(
+        Tensor(
+            scalar_type=ScalarType.FLOAT,
+            storage_offset=0,
+            sizes=[numel],
+            dim_order=[0],
+            requires_grad=False,
+            layout=0,
+            data_buffer_idx=0,
+            allocation_info=(
+                None
+                if offset is None
+                else AllocationDetails(
+                    memory_id=mem_id,
+                    memory_offset_low=offset,
+                    memory_offset_high=0,
+                )
+            ),
+            shape_dynamism=TensorShapeDynamism.STATIC,
+        )
+    )
+
+
+def _plan(
+    values: List[EValue],
+    calls: List[List[int]],
+    non_const_buffer_sizes: List[int],
+) -> ExecutionPlan:
+    return ExecutionPlan(
+        name="forward",
+        container_meta_type=ContainerMetadata("", ""),
+        values=values,
+        inputs=[0],
+        outputs=[3],
+        chains=[
+            Chain(
+                inputs=[0],
+                outputs=[3],
+                instructions=[
+                    Instruction(KernelCall(op_index=0, args=args)) for args in calls
+                ],
+                stacktrace=None,
+            )
+        ],
+        operators=[Operator(name="aten::add", overload="out")],
+        delegates=[],
+        non_const_buffer_sizes=non_const_buffer_sizes,
+    )
+
+
+class MemoryPlanningReportTest(unittest.TestCase):
+    def test_chain_of_ops(self) -> None:
+        # 0 -> 1 -> 2 -> 3, each 64 bytes. Only two tensors are ever live at
+        # once, but the planner gave every tensor its own slot.
+        values = [
+            _tensor(16, 0),
+            _tensor(16, 64),
+            _tensor(16, 128),
+            _tensor(16, 192),
+            EValue(Int(1)),
+        ]
+        plan = _plan(values, [[0, 0, 4, 1], [1, 1, 4, 2], [2, 2, 4, 3]], [0, 256])
+
+        report = analyze_execution_plan(plan)
+
+        self.assertEqual(report.num_instructions, 3)
+        self.assertEqual(report.instructions, ["aten::add.out"] * 3)
+        lifetimes = [(t.first_use, t.last_use) for t in report.tensors]
+        # The input is live from the start and the output until the end.
+        self.assertEqual(lifetimes, [(0, 0), (0, 1), (1, 2), (2, 2)])
+
+        self.assertEqual(len(report.buffers), 1)
+        buffer = report.buffers[0]
+        self.assertEqual(buffer.mem_id, 1)
+        self.assertEqual(buffer.buffer_size, 256)
+        self.assertEqual(buffer.high_water_bytes, 256)
+        self.assertEqual(buffer.live_bytes, [128, 128, 128])
+        self.assertEqual(buffer.peak_live_bytes, 128)
+        self.assertEqual(buffer.peak_step, 0)
+        self.assertEqual(buffer.wasted_bytes, 128)
+        self.assertEqual(buffer.fragmented_bytes_at_peak, 0)
+        self.assertAlmostEqual(buffer.efficiency, 0.5)
+
+    def test_reused_and_aliased_offsets(self) -> None:
+        # Tensor 2 is written in place over tensor 1, and tensor 3 reuses the
+        # slot of tensor 0, so the buffer is perfectly packed.
+        values = [
+            _tensor(16, 0),
+            _tensor(16, 64),
+            _tensor(16, 64),
+            _tensor(16, 0),
+            EValue(Int(1)),
+            # Unplanned and never-referenced tensors are reported but do not
+            # count towards the live bytes.
+            _tensor(16, None),
+            _tensor(16, 0, mem_id=2),
+        ]
+        plan = _plan(values, [[0, 0, 4, 1], [1, 1, 4, 2], [2, 2, 4, 3]], [0, 128, 64])
+
+        report = analyze_execution_plan(plan)
+
+        self.assertEqual(len(report.tensors), 5)
+        buffer = report.buffers[0]
+        self.assertEqual(buffer.live_bytes, [128, 64, 128])
+        self.assertEqual(buffer.peak_live_bytes, 128)
+        self.assertEqual(buffer.wasted_bytes, 0)
+        self.assertEqual(buffer.num_tensors, 4)
+
+        unused = report.buffers[1]
+        self.assertEqual(unused.mem_id, 2)
+        self.assertEqual(unused.num_unused_tensors, 1)
+        self.assertEqual(unused.peak_live_bytes, 0)
+        self.assertEqual(unused.wasted_bytes, 64)
+
+    def test_fragmentation(self) -> None:
+        values = [
+            _tensor(16, 64),
+            _tensor(16, 0),
+            _tensor(16, 128),
+            _tensor(16, 64),
+            EValue(Int(1)),
+        ]
+        plan = _plan(values, [[0, 0, 4, 1], [1, 1, 4, 2], [2, 2, 4, 3]], [0, 256])
+
+        buffer = analyze_execution_plan(plan).buffers[0]
+
+        self.assertEqual(buffer.live_bytes, [128, 128, 128])
+        self.assertEqual(buffer.peak_step, 0)
+        self.assertEqual(buffer.fragmented_bytes_at_peak, 0)
+
+        # Growing tensor 2 moves the peak to the second instruction, where the
+        # 64 byte slot of tensor 0 is free between tensors 1 and 2.
+        values[2] = _tensor(32, 128)
+        buffer = analyze_execution_plan(plan).buffers[0]
+        self.assertEqual(buffer.peak_step, 1)
+        self.assertEqual(buffer.peak_live_bytes, 192)
+        self.assertEqual(buffer.fragmented_bytes_at_peak, 64)
+
+    def test_mutable_buffer(self) -> None:
+        # Tensor 1 is a buffer that the first instruction reads and the second
+        # one updates. It must keep its slot for the whole method, so that the
+        # next execution reads the update.
+        values = [
+            _tensor(16, 0),
+            _tensor(16, 64),
+            _tensor(16, 128),
+            _tensor(16, 192),
+            EValue(Int(1)),
+        ]
+        plan = _plan(values, [[0, 1, 4, 2], [2, 2, 4, 1], [2, 2, 4, 3]], [0, 256])
+
+        report = analyze_execution_plan(plan)
+
+        lifetimes = [(t.first_use, t.last_use) for t in report.tensors]
+        self.assertEqual(lifetimes, [(0, 0), (0, 2), (0, 2), (2, 2)])
+        self.assertEqual(
+            [t.mutable_buffer for t in report.tensors], [False, True, False, False]
+        )
+        self.assertEqual(report.buffers[0].live_bytes, [192, 128, 192])
+
+    def test_outputs(self) -> None:
+        values = [
+            _tensor(16, 0),
+            _tensor(16, 64),
+            _tensor(16, 0),
+            _tensor(16, 64),
+            EValue(Int(1)),
+        ]
+        plan = _plan(values, [[0, 0, 4, 1], [1, 1, 4, 2], [2, 2, 4, 3]], [0, 128])
+        reports = [analyze_execution_plan(plan)]
+
+        text = format_report(reports)
+        self.assertIn("Method 'forward'", text)
+        self.assertIn("peak live 128 B (100.0%)", text)
+
+        summary = generate_report_json(reports)
+        json.dumps(summary)
+        self.assertEqual(summary[0]["buffers"][0]["efficiency"], 1.0)
+
+        trace = generate_chrome_trace(reports)
+        json.dumps(trace)
+        events = trace["traceEvents"]
+        # Two live tensors at every instruction.
+        self.assertEqual(len(events), 6)
+        self.assertEqual({e["tid"] for e in events}, {0, 1, 2})
+        self.assertEqual(events[0]["pid"], "forward/mem_id 1")
+        self.assertEqual(events[0]["args"]["instruction"], "aten::add.out")
+
+        page = generate_html(reports)
+        self.assertIn("<svg", page)
+        self.assertEqual(page.count("<rect"), 4)
@@ -8,11 +8,15 @@
 # https://arxiv.org/abs/2309.17453 for more details about Attention Sink.
 
 import types
-from typing import Optional
+from typing import Any, Optional, Tuple
 
 import torch
 
-from executorch.examples.models.llama.attention import AttentionMHA, KVCache
+from executorch.examples.models.llama.attention import (
+    AttentionMHA,
+    ForwardOptions,
+    KVCache,
+)
 from executorch.examples.models.llama.model_args import ModelArgs
 from executorch.examples.models.llama.rope import (
     apply_rotary_emb_to_k,
@@ -205,6 +209,86 @@ class KVCacheWithAttentionSink(KVCache):
         return self.position_shift
 
 
+class RingKVCacheWithAttentionSink(torch.nn.Module):
+    """
+    KV cache for attention sink backed by the ring-buffer custom ops. The first
+    sink_size rows keep the first tokens, and token t >= sink_size is written to
+    row sink_size + (t - sink_size) % window_size, overwriting the oldest token
+    of the window. Keys are rotated at their absolute positions, so evicting a
+    token is just overwriting its row: unlike KVCacheWithAttentionSink, nothing
+    is shifted or re-rotated, and generation is not bounded by the cache size.
+
+    The caches are [batch_size, sink_size + window_size, n_heads, head_dim],
+    with the sequence at dim 1 as the custom ops expect.
+    """
+
+    def __init__(
+        self,
+        n_heads: int,
+        head_dim: int,
+        window_size: int,
+        sink_size: int,
+        max_batch_size: int = 1,
+        dtype=torch.float32,
+    ):
+        super().__init__()
+        self.window_size = window_size
+        self.sink_size = sink_size
+        cache_shape = (max_batch_size, sink_size + window_size, n_heads, head_dim)
+        self.register_buffer(
+            "k_cache", torch.zeros(cache_shape, dtype=dtype, device="cpu")
+        )
+        self.register_buffer(
+            "v_cache", torch.zeros(cache_shape, dtype=dtype, device="cpu")
+        )
+
+    def update(
+        self, input_pos: torch.Tensor, k_val: torch.Tensor, v_val: torch.Tensor
+    ) -> Tuple[torch.Tensor, torch.Tensor]:
+        # input_pos: [S], k_val: [B, S, H, D]
+        start_pos = input_pos[0].item()
+        torch._check_is_size(start_pos)
+        torch.ops.llama.update_cache_ring(
+            k_val, self.k_cache, start_pos, self.sink_size
+        )
+        torch.ops.llama.update_cache_ring(
+            v_val, self.v_cache, start_pos, self.sink_size
+        )
+        return self.k_cache, self.v_cache
+
+
+def attention_sink_ring_forward(
+    self,
+    x: torch.Tensor,
+    freqs_cos: torch.Tensor,
+    freqs_sin: torch.Tensor,
+    **kwargs: ForwardOptions,
+) -> Tuple[torch.Tensor, Optional[Any]]:
+    input_pos = kwargs.get("input_pos")
+    assert self.use_kv_cache
+    assert input_pos is not None
+
+    bsz, seqlen, _ = x.shape
+
+    # QKV
+    q, k, v = self.wq(x), self.wk(x), self.wv(x)
+    # We need view_copy elimination
+    q = q.view(bsz, seqlen, self.n_local_heads, self.head_dim)
+    k = k.view(bsz, seqlen, self.n_local_kv_heads, self.head_dim)
+    v = v.view(bsz, seqlen, self.n_local_kv_heads, self.head_dim)
+
+    # RoPE at absolute positions; cached keys keep their rotation.
+    q, k = self.rope.forward(q, k, freqs_cos, freqs_sin)
+
+    start_pos = input_pos[0].item()
+    torch._check_is_size(start_pos)
+    k_cache, v_cache = self.kv_cache.update(input_pos, k, v)
+    output = torch.ops.llama.custom_sdpa_ring(
+        q, k_cache, v_cache, start_pos, self.kv_cache.sink_size, 0.0, None
+    )
+    return self.wo(output.view(bsz, seqlen, -1)), None
+
+
 def attention_sink_forward(
     self,
     x: torch.Tensor,
@@ -282,19 +366,64 @@ def _replace_attention(
             )
 
 
+def _replace_attention_with_ring(
+    module: torch.nn.Module,
+    sink_size: int,
+    window_size: int,
+):
+    for _, child_module in module._modules.items():
+        if len(list(child_module.children())) > 0:  # pyre-ignore [16]
+            _replace_attention_with_ring(
+                module=child_module,  # pyre-ignore [6]
+                sink_size=sink_size,
+                window_size=window_size,
+            )
+
+        if isinstance(child_module, AttentionMHA):
+            kv_cache = child_module.kv_cache
+            child_module.kv_cache = RingKVCacheWithAttentionSink(
+                n_heads=kv_cache.n_heads,
+                head_dim=kv_cache.head_dim,
+                window_size=window_size,
+                sink_size=sink_size,
+                max_batch_size=kv_cache.max_batch_size,
+                dtype=kv_cache.k_cache.dtype,
+            )
+            child_module.forward = types.MethodType(  # pyre-ignore
+                attention_sink_ring_forward, child_module
+            )
+
+
 def enable_attention_sink(
     module: torch.nn.Module,
     params: ModelArgs,
     sink_size: int,
     window_size: int,
     eviction_batch_size: int,
+    use_ring_buffer: bool = False,
 ) -> torch.nn.Module:
     """
     Transform the model to be able to run inference with Attention Sink.
     There mainly three steps:
     - Replace Rope with RopeWithAttentionSink
     - Replace Attention's KVCache with KVCacheWithAttentionSink, forward with attention_sink_forward
+
+    With use_ring_buffer, the Rope is kept and Attention's KVCache is replaced
+    with RingKVCacheWithAttentionSink, forward with attention_sink_ring_forward.
+    Tokens are then evicted by the update_cache_ring custom op overwriting them,
+    instead of by shifting the cache, and eviction_batch_size is unused. Rope
+    frequencies are still looked up by absolute position, so
+    params.max_context_len bounds the generation length, not the cache size.
     """
+    if use_ring_buffer:
+        # This is needed to ensure that custom ops are registered
+        from executorch.extension.llm.custom_ops import custom_ops  # noqa: F401
+
+        _replace_attention_with_ring(
+            module=module, sink_size=sink_size, window_size=window_size
+        )
+        return module
+
     rope_with_attention_sink = RopeWithAttentionSink(
         params=params,
         window_size=window_size,
@@ -34,6 +34,8 @@
 #include <executorch/runtime/platform/runtime.h>
 #ifdef ET_EVENT_TRACER_ENABLED
 #include <executorch/devtools/etdump/etdump_flatcc.h>
+#include <executorch/devtools/etdump/profiling_stats.h>
+#include <executorch/devtools/etdump/ring_buffer_event_tracer.h>
 #endif // ET_EVENT_TRACER_ENABLED
 
 #if defined(ET_USE_THREADPOOL)
@@ -52,6 +54,14 @@ DEFINE_string(
 DEFINE_uint32(num_executions, 1, "Number of times to run the model.");
 #ifdef ET_EVENT_TRACER_ENABLED
 DEFINE_string(etdump_path, "model.etdump", "Write ETDump data to this path.");
+DEFINE_string(
+    stats_json_path,
+    "",
+    "Write per-instruction latency percentiles as JSON to this path instead of writing an ETDump.");
+DEFINE_string(
+    stats_csv_path,
+    "",
+    "Write per-instruction latency percentiles as CSV to this path instead of writing an ETDump.");
 #endif // ET_EVENT_TRACER_ENABLED
 DEFINE_int32(
     cpu_threads,
@@ -71,12 +81,33 @@ using executorch::runtime::Program;
 using executorch::runtime::Result;
 using executorch::runtime::Span;
 
-/// Helper to manage resources for ETDump generation
+/// Helper to manage resources for ETDump generation, or for latency
+/// statistics when --stats_json_path or --stats_csv_path is set.
 class EventTraceManager {
  public:
-  EventTraceManager() : event_tracer_ptr_(nullptr) {
+  explicit EventTraceManager(const MethodMeta& method_meta)
+      : event_tracer_ptr_(nullptr) {
 #ifdef ET_EVENT_TRACER_ENABLED
-    event_tracer_ptr_ = std::make_shared<executorch::etdump::ETDumpGen>();
+    if (FLAGS_stats_json_path.empty() && FLAGS_stats_csv_path.empty()) {
+      event_tracer_ptr_ = std::make_shared<executorch::etdump::ETDumpGen>();
+      return;
+    }
+    // The records are drained after every execution, so the ring only needs
+    // to hold the events of one, including the events logged by delegates.
+    ring_buffer_ptr_ =
+        std::make_shared<executorch::etdump::RingBufferEventTracer>(
+            /*records_per_thread=*/16384);
+    event_tracer_ptr_ = ring_buffer_ptr_;
+    stats_.set_name_resolver(
+        [method_meta](
+            executorch::runtime::ChainID chain_id,
+            executorch::runtime::DebugHandle debug_handle) -> const char* {
+          Result<const char*> name =
+              method_meta.instruction_name(chain_id, debug_handle);
+          return name.ok() ? name.get() : nullptr;
+        });
+#else
+    (void)method_meta;
 #endif // ET_EVENT_TRACER_ENABLED
   }
 
@@ -84,6 +115,59 @@ class EventTraceManager {
     return event_tracer_ptr_.get();
   };
 
+  bool has_stats() const {
+#ifdef ET_EVENT_TRACER_ENABLED
+    return ring_buffer_ptr_ != nullptr;
+#else
+    return false;
+#endif // ET_EVENT_TRACER_ENABLED
+  }
+
+  /// Adds the events of the executions since the last call to the statistics.
+  void collect_stats() {
+#ifdef ET_EVENT_TRACER_ENABLED
+    if (ring_buffer_ptr_) {
+      stats_.collect(*ring_buffer_ptr_);
+    }
+#endif // ET_EVENT_TRACER_ENABLED
+  }
+
+  Error write_stats_to_files() const {
+    if (!has_stats()) {
+      return Error::NotSupported;
+    }
+
+#ifdef ET_EVENT_TRACER_ENABLED
+    if (ring_buffer_ptr_->dropped_records() > 0 ||
+        stats_.dropped_events() > 0) {
+      ET_LOG(
+          Error,
+          "Statistics are missing %zu overwritten and %zu untracked events.",
+          ring_buffer_ptr_->dropped_records(),
+          stats_.dropped_events());
+    }
+    const std::pair<const std::string&, std::string> files[] = {
+        {FLAGS_stats_json_path, stats_.to_json()},
+        {FLAGS_stats_csv_path, stats_.to_csv()}};
+    for (const auto& file : files) {
+      if (file.first.empty()) {
+        continue;
+      }
+      const char* filename = file.first.c_str();
+      std::unique_ptr<FILE, decltype(&fclose)> stats_file(
+          fopen(filename, "w"), fclose);
+      if (!stats_file) {
+        ET_LOG(Error, "Failed to open statistics file at %s.", filename);
+        return Error::AccessFailed;
+      }
+      fwrite(file.second.data(), 1, file.second.size(), stats_file.get());
+      ET_LOG(Info, "Statistics written to file '%s'.", filename);
+    }
+#endif // ET_EVENT_TRACER_ENABLED
+
+    return Error::Ok;
+  }
+
   Error write_etdump_to_file() const {
     EventTracer* const event_tracer_ptr = get_event_tracer();
     if (!event_tracer_ptr) {
@@ -91,6 +175,9 @@ class EventTraceManager {
     }
 
 #ifdef ET_EVENT_TRACER_ENABLED
+    if (has_stats()) {
+      return Error::NotSupported;
+    }
     executorch::etdump::ETDumpGen* const etdump_ptr =
         static_cast<executorch::etdump::ETDumpGen*>(event_tracer_ptr);
 
@@ -119,6 +206,10 @@ class EventTraceManager {
 
  private:
   std::shared_ptr<EventTracer> event_tracer_ptr_;
+#ifdef ET_EVENT_TRACER_ENABLED
+  std::shared_ptr<executorch::etdump::RingBufferEventTracer> ring_buffer_ptr_;
+  executorch::etdump::ProfilingStats stats_;
+#endif // ET_EVENT_TRACER_ENABLED
 };
 
 int main(int argc, char** argv) {
@@ -240,7 +331,7 @@ int main(int argc, char** argv) {
   // the method can mutate the memory-planned buffers, so the method should only
   // be used by a single thread at at time, but it can be reused.
   //
-  EventTraceManager tracer;
+  EventTraceManager tracer(method_meta.get());
   Result<Method> method = program->load_method(
       method_name, &memory_manager, tracer.get_event_tracer());
   ET_CHECK_MSG(
@@ -280,6 +371,7 @@ int main(int argc, char** argv) {
         "Execution of method %s failed with status 0x%" PRIx32,
         method_name,
         (uint32_t)status);
+    tracer.collect_stats();
   }
   const auto tick_ratio = et_pal_ticks_to_ns_multiplier();
   constexpr auto NANOSECONDS_PER_MILLISECOND = 1000000;
@@ -301,7 +393,10 @@ int main(int argc, char** argv) {
     std::cout << "Output " << i << ": " << outputs[i] << std::endl;
   }
 
-  if (tracer.get_event_tracer()) {
+  if (tracer.has_stats()) {
+    status = tracer.write_stats_to_files();
+    ET_CHECK_MSG(status == Error::Ok, "Failed to save statistics files.");
+  } else if (tracer.get_event_tracer()) {
     // Dump ETDump data containing profiling/debugging data to file specified in
     // command line flag.
     status = tracer.write_etdump_to_file();
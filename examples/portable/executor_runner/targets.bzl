@@ -17,6 +17,7 @@ def define_common_targets():
         deps = [
             "//executorch/runtime/executor:program",
             "//executorch/devtools/etdump:etdump_flatcc",
+            "//executorch/devtools/etdump:profiling_stats",
             "//executorch/extension/data_loader:file_data_loader",
             "//executorch/extension/evalue_util:print_evalue",
             "//executorch/extension/runner_util:inputs",
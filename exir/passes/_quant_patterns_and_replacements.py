@@ -573,6 +573,323 @@ def embedding_4bit_dtype_out_meta(
     )
 
 
+def _unpack_linear_xbit_weight(
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+    weight_nbit: int,
+) -> torch.Tensor:
+    """
+    Unpacks and dequantizes a weight packed the same way as for
+    embedding_{2,4}bit into a [out_features, in_features] tensor.
+    """
+    embedding_weight_checks(weight, weight_scales, weight_zero_points)
+    values_per_byte = 8 // weight_nbit
+    group_size = (values_per_byte * weight.size(1)) // (
+        weight_scales.size(1) if weight_scales.dim() == 2 else 1
+    )
+    if weight_nbit == 4:
+        weight_even = weight.div(16, rounding_mode="trunc")
+        weight_odd = weight.remainder(16)
+        weight_unpacked = torch.stack((weight_even, weight_odd), dim=-1)
+    else:
+        weight_0 = weight & 3
+        weight_1 = (weight & 12) >> 2
+        weight_2 = (weight & 48) >> 4
+        weight_3 = (weight & 192) >> 6
+        weight_unpacked = torch.stack(
+            (weight_0, weight_1, weight_2, weight_3), dim=-1
+        )
+    weight = weight_unpacked.view(weight.shape[0], -1)
+    weight = weight.view(torch.int8).add(-(1 << (weight_nbit - 1)))
+
+    return torch.ops.quantized_decomposed.dequantize_per_channel_group.default(
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+        weight.dtype,
+        group_size,
+        weight_scales.dtype,
+    )
+
+
+def _fake_quantize_input_per_token(input: torch.Tensor) -> torch.Tensor:
+    """
+    Rounds input the way the dynamic linear_{2,4}bit kernels do: to int8 with a
+    symmetric scale per row.
+    """
+    scale = input.abs().amax(dim=-1, keepdim=True).float() / 127
+    safe_scale = torch.where(scale > 0, scale, torch.ones_like(scale))
+    quantized = torch.clamp(torch.round(input.float() / safe_scale), -127, 127)
+    return (quantized * scale).to(input.dtype)
+
+
+quantized_decomposed_lib.define(
+    "linear_2bit(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max) -> Tensor",
+)
+
+quantized_decomposed_lib.define(
+    "linear_2bit.out(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max, *, Tensor(a!) out) -> Tensor(a!)",
+)
+
+quantized_decomposed_lib.define(
+    "linear_2bit.dynamic(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max) -> Tensor",
+)
+
+quantized_decomposed_lib.define(
+    "linear_2bit.dynamic_out(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max, *, Tensor(a!) out) -> Tensor(a!)",
+)
+
+
+@impl(quantized_decomposed_lib, "linear_2bit", "CompositeExplicitAutograd")
+def linear_2bit(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    assert (
+        weight_quant_min == -2
+    ), "linear_2bit in ExecuTorch expects weight_quant_min == -2"
+    assert (
+        weight_quant_max == 1
+    ), "linear_2bit in ExecuTorch expects weight_quant_max == 1"
+
+    weight = _unpack_linear_xbit_weight(
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+        2,
+    )
+    return torch.nn.functional.linear(input, weight.to(input.dtype))
+
+
+@register_fake("quantized_decomposed::linear_2bit")
+def _(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return input.new_empty((*input.shape[:-1], weight.size(0)))
+
+
+@register_fake("quantized_decomposed::linear_2bit.out")
+def linear_2bit_out_meta(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return linear_2bit(
+        input,
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
+@impl(quantized_decomposed_lib, "linear_2bit.dynamic", "CompositeExplicitAutograd")
+def linear_2bit_dynamic(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return linear_2bit(
+        _fake_quantize_input_per_token(input),
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
+@register_fake("quantized_decomposed::linear_2bit.dynamic")
+def _(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return input.new_empty((*input.shape[:-1], weight.size(0)))
+
+
+@register_fake("quantized_decomposed::linear_2bit.dynamic_out")
+def linear_2bit_dynamic_out_meta(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return linear_2bit_dynamic(
+        input,
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
+quantized_decomposed_lib.define(
+    "linear_4bit(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max) -> Tensor",
+)
+
+quantized_decomposed_lib.define(
+    "linear_4bit.out(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max, *, Tensor(a!) out) -> Tensor(a!)",
+)
+
+quantized_decomposed_lib.define(
+    "linear_4bit.dynamic(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max) -> Tensor",
+)
+
+quantized_decomposed_lib.define(
+    "linear_4bit.dynamic_out(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points, "
+    "int weight_quant_min, int weight_quant_max, *, Tensor(a!) out) -> Tensor(a!)",
+)
+
+
+@impl(quantized_decomposed_lib, "linear_4bit", "CompositeExplicitAutograd")
+def linear_4bit(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    assert (
+        weight_quant_min == -8
+    ), "linear_4bit in ExecuTorch expects weight_quant_min == -8"
+    assert (
+        weight_quant_max == 7
+    ), "linear_4bit in ExecuTorch expects weight_quant_max == 7"
+
+    weight = _unpack_linear_xbit_weight(
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+        4,
+    )
+    return torch.nn.functional.linear(input, weight.to(input.dtype))
+
+
+@register_fake("quantized_decomposed::linear_4bit")
+def _(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return input.new_empty((*input.shape[:-1], weight.size(0)))
+
+
+@register_fake("quantized_decomposed::linear_4bit.out")
+def linear_4bit_out_meta(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return linear_4bit(
+        input,
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
+@impl(quantized_decomposed_lib, "linear_4bit.dynamic", "CompositeExplicitAutograd")
+def linear_4bit_dynamic(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return linear_4bit(
+        _fake_quantize_input_per_token(input),
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
+@register_fake("quantized_decomposed::linear_4bit.dynamic")
+def _(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+) -> torch.Tensor:
+    return input.new_empty((*input.shape[:-1], weight.size(0)))
+
+
+@register_fake("quantized_decomposed::linear_4bit.dynamic_out")
+def linear_4bit_dynamic_out_meta(
+    input: torch.Tensor,
+    weight: torch.Tensor,
+    weight_scales: torch.Tensor,
+    weight_zero_points: Optional[torch.Tensor],
+    weight_quant_min: int,
+    weight_quant_max: int,
+    out: torch.Tensor,
+) -> torch.Tensor:
+    return linear_4bit_dynamic(
+        input,
+        weight,
+        weight_scales,
+        weight_zero_points,
+        weight_quant_min,
+        weight_quant_max,
+    )
+
+
 quantized_decomposed_lib.define(
     "mixed_mm(Tensor input, Tensor weight, Tensor weight_scales, Tensor? weight_zero_points) -> Tensor",
 )
@@ -0,0 +1,514 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Benchmarks a method of a .pte model on Linux and writes the results as
+ * JSON, for tracking performance per model and commit on CI hosts.
+ *
+ * The program is loaded once, and then one instance of the method, with its
+ * own memory, is loaded for every concurrent instance to run. Each instance
+ * runs --warmup untimed executions and then --iterations timed ones, or runs
+ * for --duration_s seconds instead. The timed phase is repeated for every
+ * combination of --threads and --instances, e.g.
+ *
+ *   executorch_bench --model_path=model.pte --threads=1,2,4 --instances=1,2
+ *
+ * Input tensors are filled with ones. Concurrent instances share the CPU
+ * threadpool, so their operators contend for it like they would in a server.
+ *
+ * The peak_rss_bytes fields are high-water marks for the whole process so
+ * far. The max_rss_bytes of a run is the largest resident set size sampled
+ * after each timed execution of its first instance.
+ */
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/runner_util/inputs.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#if defined(ET_USE_THREADPOOL)
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
+#include <executorch/extension/threadpool/threadpool.h>
+#endif
+
+DEFINE_string(
+    model_path,
+    "model.pte",
+    "Model serialized in flatbuffer format.");
+DEFINE_string(
+    method,
+    "",
+    "Method to benchmark. Defaults to the first method of the program.");
+DEFINE_int32(warmup, 3, "Untimed executions of each instance per run.");
+DEFINE_int32(iterations, 50, "Timed executions of each instance per run.");
+DEFINE_double(
+    duration_s,
+    0,
+    "If positive, each instance executes for this many seconds per run instead of --iterations times.");
+DEFINE_string(
+    threads,
+    "",
+    "Comma-separated CPU thread counts to sweep, e.g. 1,2,4. Defaults to the number of performant cores. Ignored without threadpool support.");
+DEFINE_string(
+    instances,
+    "1",
+    "Comma-separated numbers of method instances to execute concurrently, e.g. 1,2,4.");
+DEFINE_string(
+    output_path,
+    "",
+    "Write the JSON results to this path. Defaults to stdout.");
+
+using executorch::extension::BufferCleanup;
+using executorch::extension::FileDataLoader;
+using executorch::extension::MallocMemoryAllocator;
+using executorch::runtime::Error;
+using executorch::runtime::HierarchicalAllocator;
+using executorch::runtime::MemoryManager;
+using executorch::runtime::Method;
+using executorch::runtime::MethodMeta;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+/// Parses a comma-separated list of positive integers. Returns an empty list
+/// on malformed input.
+std::vector<uint32_t> parse_list(const std::string& list) {
+  std::vector<uint32_t> values;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    char* end = nullptr;
+    const unsigned long value = strtoul(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || value == 0 || value > UINT32_MAX) {
+      return {};
+    }
+    values.push_back(static_cast<uint32_t>(value));
+  }
+  return values;
+}
+
+/// The peak resident set size of the process so far, in bytes.
+uint64_t peak_rss_bytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Linux reports kilobytes.
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+/// The current resident set size of the process, in bytes, or 0 if it can't
+/// be read.
+uint64_t current_rss_bytes() {
+  std::unique_ptr<FILE, decltype(&fclose)> statm(
+      fopen("/proc/self/statm", "r"), fclose);
+  unsigned long long size_pages = 0;
+  unsigned long long resident_pages = 0;
+  if (!statm ||
+      fscanf(statm.get(), "%llu %llu", &size_pages, &resident_pages) != 2) {
+    return 0;
+  }
+  const long page_size = sysconf(_SC_PAGESIZE);
+  return page_size > 0 ? resident_pages * static_cast<uint64_t>(page_size)
+                       : 0;
+}
+
+/// A loaded method with its own memory, so that instances can execute
+/// concurrently.
+struct Instance {
+  MallocMemoryAllocator method_allocator;
+  MallocMemoryAllocator temp_allocator;
+  std::vector<std::unique_ptr<uint8_t[]>> planned_buffers;
+  std::vector<Span<uint8_t>> planned_spans;
+  std::unique_ptr<HierarchicalAllocator> planned_memory;
+  std::unique_ptr<MemoryManager> memory_manager;
+  std::unique_ptr<Method> method;
+  std::unique_ptr<BufferCleanup> inputs;
+  double load_ms = 0;
+  double first_inference_ms = 0;
+};
+
+Result<std::unique_ptr<Instance>> load_instance(
+    const Program& program,
+    const char* method_name,
+    const MethodMeta& method_meta) {
+  auto instance = std::make_unique<Instance>();
+  const auto start = Clock::now();
+  for (size_t id = 0; id < method_meta.num_memory_planned_buffers(); ++id) {
+    // .get() will always succeed because id < num_memory_planned_buffers.
+    const size_t size =
+        static_cast<size_t>(method_meta.memory_planned_buffer_size(id).get());
+    instance->planned_buffers.push_back(std::make_unique<uint8_t[]>(size));
+    instance->planned_spans.push_back(
+        {instance->planned_buffers.back().get(), size});
+  }
+  instance->planned_memory = std::make_unique<HierarchicalAllocator>(
+      Span<Span<uint8_t>>(
+          instance->planned_spans.data(), instance->planned_spans.size()));
+  instance->memory_manager = std::make_unique<MemoryManager>(
+      &instance->method_allocator,
+      instance->planned_memory.get(),
+      &instance->temp_allocator);
+  Result<Method> method =
+      program.load_method(method_name, instance->memory_manager.get());
+  if (!method.ok()) {
+    ET_LOG(
+        Error,
+        "Loading method %s failed: 0x%" PRIx32,
+        method_name,
+        static_cast<uint32_t>(method.error()));
+    return method.error();
+  }
+  instance->method = std::make_unique<Method>(std::move(method.get()));
+  instance->load_ms = ms_since(start);
+
+  // The inputs are prepared once. Memory-planned inputs may be overwritten by
+  // an execution, which changes their values but not the work to do.
+  auto inputs = executorch::extension::prepare_input_tensors(*instance->method);
+  if (!inputs.ok()) {
+    ET_LOG(
+        Error,
+        "Could not prepare inputs: 0x%" PRIx32,
+        static_cast<uint32_t>(inputs.error()));
+    return inputs.error();
+  }
+  instance->inputs = std::make_unique<BufferCleanup>(std::move(inputs.get()));
+
+  const auto first_start = Clock::now();
+  Error status = instance->method->execute();
+  instance->first_inference_ms = ms_since(first_start);
+  if (status != Error::Ok) {
+    ET_LOG(
+        Error,
+        "Executing method %s failed: 0x%" PRIx32,
+        method_name,
+        static_cast<uint32_t>(status));
+    return status;
+  }
+  return instance;
+}
+
+struct RunResult {
+  uint32_t threads = 0;
+  uint32_t instances = 0;
+  // The latency of every timed execution, in milliseconds.
+  std::vector<double> latencies_ms;
+  // From the start of the first to the end of the last timed execution.
+  double wall_ms = 0;
+  // The largest resident set size sampled during the run. Unlike the peak
+  // RSS of the process, this isn't inflated by earlier runs.
+  uint64_t max_rss_bytes = 0;
+};
+
+/// Executes the first `num_instances` instances concurrently, after releasing
+/// them at the same time.
+Result<RunResult> run(
+    std::vector<std::unique_ptr<Instance>>& instances,
+    uint32_t num_threads,
+    uint32_t num_instances) {
+  std::vector<std::vector<double>> latencies(num_instances);
+  std::vector<Error> errors(num_instances, Error::Ok);
+  std::mutex mutex;
+  std::condition_variable ready_cv;
+  uint32_t num_ready = 0;
+  bool started = false;
+  Clock::time_point start;
+  uint64_t max_rss_bytes = 0;
+  const std::chrono::duration<double> duration(FLAGS_duration_s);
+
+  auto body = [&](uint32_t index) {
+    Method& method = *instances[index]->method;
+    for (int i = 0; i < FLAGS_warmup && errors[index] == Error::Ok; ++i) {
+      errors[index] = method.execute();
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (++num_ready == num_instances) {
+        start = Clock::now();
+        started = true;
+        ready_cv.notify_all();
+      } else {
+        ready_cv.wait(lock, [&] { return started; });
+      }
+    }
+    const auto deadline =
+        start + std::chrono::duration_cast<Clock::duration>(duration);
+    latencies[index].reserve(FLAGS_iterations);
+    for (int i = 0; errors[index] == Error::Ok; ++i) {
+      if (FLAGS_duration_s > 0 ? Clock::now() >= deadline
+                               : i >= FLAGS_iterations) {
+        break;
+      }
+      const auto execute_start = Clock::now();
+      errors[index] = method.execute();
+      latencies[index].push_back(ms_since(execute_start));
+      // Only one instance samples, outside of the timed section, to keep the
+      // /proc reads from perturbing the others.
+      if (index == 0) {
+        max_rss_bytes = std::max(max_rss_bytes, current_rss_bytes());
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < num_instances; ++i) {
+    workers.emplace_back(body, i);
+  }
+  body(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  RunResult result;
+  result.threads = num_threads;
+  result.instances = num_instances;
+  result.wall_ms = ms_since(start);
+  result.max_rss_bytes = std::max(max_rss_bytes, current_rss_bytes());
+  for (uint32_t i = 0; i < num_instances; ++i) {
+    if (errors[i] != Error::Ok) {
+      ET_LOG(
+          Error,
+          "Execution of instance %" PRIu32 " failed: 0x%" PRIx32,
+          i,
+          static_cast<uint32_t>(errors[i]));
+      return errors[i];
+    }
+    result.latencies_ms.insert(
+        result.latencies_ms.end(), latencies[i].begin(), latencies[i].end());
+  }
+  return result;
+}
+
+/// The nearest-rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+std::string json_escape(const std::string& str) {
+  std::string out;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::string run_to_json(RunResult& run) {
+  std::vector<double>& sorted = run.latencies_ms;
+  std::sort(sorted.begin(), sorted.end());
+  double total_ms = 0;
+  for (double latency : sorted) {
+    total_ms += latency;
+  }
+  char buffer[1024];
+  snprintf(
+      buffer,
+      sizeof(buffer),
+      "    {\"threads\": %" PRIu32 ", \"instances\": %" PRIu32
+      ", \"iterations\": %zu, \"wall_ms\": %.3f, \"latency_ms\": "
+      "{\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+      "\"p99\": %.3f, \"max\": %.3f}, \"throughput_per_s\": %.3f, "
+      "\"max_rss_bytes\": %" PRIu64 "}",
+      run.threads,
+      run.instances,
+      sorted.size(),
+      run.wall_ms,
+      sorted.empty() ? 0 : sorted.front(),
+      sorted.empty() ? 0 : total_ms / sorted.size(),
+      percentile(sorted, 50),
+      percentile(sorted, 90),
+      percentile(sorted, 99),
+      sorted.empty() ? 0 : sorted.back(),
+      run.wall_ms > 0 ? sorted.size() * 1000 / run.wall_ms : 0,
+      run.max_rss_bytes);
+  return buffer;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  const std::vector<uint32_t> instance_counts = parse_list(FLAGS_instances);
+  if (instance_counts.empty()) {
+    ET_LOG(Error, "Invalid --instances '%s'", FLAGS_instances.c_str());
+    return 1;
+  }
+  std::vector<uint32_t> thread_counts;
+#if defined(ET_USE_THREADPOOL)
+  if (FLAGS_threads.empty()) {
+    thread_counts.push_back(
+        ::executorch::extension::cpuinfo::get_num_performant_cores());
+  } else {
+    thread_counts = parse_list(FLAGS_threads);
+    if (thread_counts.empty()) {
+      ET_LOG(Error, "Invalid --threads '%s'", FLAGS_threads.c_str());
+      return 1;
+    }
+  }
+#else
+  if (!FLAGS_threads.empty()) {
+    ET_LOG(Info, "Built without threadpool support, ignoring --threads.");
+  }
+  // 0 stands for running without a threadpool.
+  thread_counts.push_back(0);
+#endif // ET_USE_THREADPOOL
+
+  const char* model_path = FLAGS_model_path.c_str();
+  const auto program_start = Clock::now();
+  Result<FileDataLoader> loader = FileDataLoader::from(model_path);
+  if (!loader.ok()) {
+    ET_LOG(Error, "Failed to open %s", model_path);
+    return 1;
+  }
+  Result<Program> program = Program::load(&loader.get());
+  if (!program.ok()) {
+    ET_LOG(Error, "Failed to parse model file %s", model_path);
+    return 1;
+  }
+  const double program_load_ms = ms_since(program_start);
+
+  std::string method_name = FLAGS_method;
+  if (method_name.empty()) {
+    Result<const char*> first_method = program->get_method_name(0);
+    if (!first_method.ok()) {
+      ET_LOG(Error, "Program has no methods");
+      return 1;
+    }
+    method_name = first_method.get();
+  }
+  Result<MethodMeta> method_meta = program->method_meta(method_name.c_str());
+  if (!method_meta.ok()) {
+    ET_LOG(Error, "No method %s in %s", method_name.c_str(), model_path);
+    return 1;
+  }
+  uint64_t planned_memory_bytes = 0;
+  for (size_t id = 0; id < method_meta->num_memory_planned_buffers(); ++id) {
+    planned_memory_bytes += method_meta->memory_planned_buffer_size(id).get();
+  }
+
+  // Instances are loaded and executed for the first time one at a time, so
+  // the load and first inference times reported for the first one are not
+  // slowed down by the others.
+  std::vector<std::unique_ptr<Instance>> instances;
+  const uint32_t max_instances =
+      *std::max_element(instance_counts.begin(), instance_counts.end());
+  for (uint32_t i = 0; i < max_instances; ++i) {
+    auto instance =
+        load_instance(program.get(), method_name.c_str(), method_meta.get());
+    if (!instance.ok()) {
+      return 1;
+    }
+    instances.push_back(std::move(instance.get()));
+  }
+  const uint64_t load_peak_rss_bytes = peak_rss_bytes();
+
+  std::vector<RunResult> runs;
+  for (uint32_t num_threads : thread_counts) {
+#if defined(ET_USE_THREADPOOL)
+    ::executorch::extension::threadpool::get_threadpool()
+        ->_unsafe_reset_threadpool(num_threads);
+#endif // ET_USE_THREADPOOL
+    for (uint32_t num_instances : instance_counts) {
+      ET_LOG(
+          Info,
+          "Running %" PRIu32 " instance(s) with %" PRIu32 " thread(s).",
+          num_instances,
+          num_threads);
+      Result<RunResult> result = run(instances, num_threads, num_instances);
+      if (!result.ok()) {
+        return 1;
+      }
+      runs.push_back(std::move(result.get()));
+    }
+  }
+
+  char buffer[1024];
+  snprintf(
+      buffer,
+      sizeof(buffer),
+      "  \"program_load_ms\": %.3f,\n  \"method_load_ms\": %.3f,\n"
+      "  \"first_inference_ms\": %.3f,\n"
+      "  \"planned_memory_bytes\": %" PRIu64 ",\n"
+      "  \"load_peak_rss_bytes\": %" PRIu64 ",\n"
+      "  \"peak_rss_bytes\": %" PRIu64 ",\n",
+      program_load_ms,
+      instances[0]->load_ms,
+      instances[0]->first_inference_ms,
+      planned_memory_bytes,
+      load_peak_rss_bytes,
+      peak_rss_bytes());
+  std::string json = "{\n  \"model\": \"" + json_escape(FLAGS_model_path) +
+      "\",\n  \"method\": \"" + json_escape(method_name) + "\",\n" + buffer +
+      "  \"runs\": [\n";
+  for (size_t i = 0; i < runs.size(); ++i) {
+    json += run_to_json(runs[i]);
+    json += i + 1 < runs.size() ? ",\n" : "\n";
+  }
+  json += "  ]\n}\n";
+
+  if (FLAGS_output_path.empty()) {
+    fwrite(json.data(), 1, json.size(), stdout);
+    return 0;
+  }
+  std::unique_ptr<FILE, decltype(&fclose)> output(
+      fopen(FLAGS_output_path.c_str(), "w"), fclose);
+  if (!output) {
+    ET_LOG(Error, "Failed to open %s", FLAGS_output_path.c_str());
+    return 1;
+  }
+  fwrite(json.data(), 1, json.size(), output.get());
+  ET_LOG(Info, "Results written to %s", FLAGS_output_path.c_str());
+  return 0;
+}
@@ -0,0 +1,657 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Load-tests TextLLMRunner the way it is served: a trace of requests arrives
+ * over time and is served first come, first served by --sessions concurrent
+ * sessions, each with its own runner. Writes time to first token, inter-token
+ * latency and end-to-end latency percentiles, token throughput, and memory
+ * high-water marks as JSON.
+ *
+ * Requests are read from --trace_path, one "arrival_ms,prompt_tokens,
+ * output_tokens" line per request, or are generated with lengths drawn
+ * uniformly from --prompt_tokens_min/max and --output_tokens_min/max, and
+ * Poisson arrivals at --arrival_rate requests per second, e.g.
+ *
+ *   llm_serving_bench --model_path=llama.pte --tokenizer_path=tokenizer.model \
+ *       --sessions=4 --num_requests=64 --arrival_rate=2
+ *
+ * With --synthetic, no model or tokenizer is loaded. Every session runs an
+ * in-process decoder instead, which spends --synthetic_prefill_us per prompt
+ * token and --synthetic_decode_us per generated token of CPU time and writes
+ * --synthetic_kv_bytes_per_token of KV cache per position, so that the
+ * scheduling, the runner and the reporting can be benchmarked anywhere.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <gflags/gflags.h>
+
+#include <executorch/extension/llm/runner/text_llm_runner.h>
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/runtime.h>
+
+DEFINE_string(model_path, "", "Model serialized in flatbuffer format.");
+DEFINE_string(tokenizer_path, "", "Tokenizer of the model.");
+DEFINE_string(data_path, "", "Optional external data file of the model.");
+DEFINE_bool(
+    synthetic,
+    false,
+    "Run a synthetic decoder and tokenizer instead of loading a model.");
+DEFINE_int32(synthetic_vocab_size, 32000, "Vocabulary size in synthetic mode.");
+DEFINE_int32(
+    synthetic_max_context_len,
+    2048,
+    "Maximum number of KV cache positions in synthetic mode.");
+DEFINE_int32(
+    synthetic_max_seq_len,
+    128,
+    "Maximum number of tokens per prefill step in synthetic mode.");
+DEFINE_double(
+    synthetic_prefill_us,
+    50,
+    "CPU time spent per prompt token in synthetic mode, in microseconds.");
+DEFINE_double(
+    synthetic_decode_us,
+    5000,
+    "CPU time spent per generated token in synthetic mode, in microseconds.");
+DEFINE_int64(
+    synthetic_kv_bytes_per_token,
+    128 * 1024,
+    "KV cache bytes written per position in synthetic mode.");
+DEFINE_string(
+    trace_path,
+    "",
+    "CSV file of requests, one 'arrival_ms,prompt_tokens,output_tokens' line each. Lines starting with '#' are ignored. Overrides the generated requests.");
+DEFINE_int32(num_requests, 32, "Number of requests to generate.");
+DEFINE_int32(prompt_tokens_min, 64, "Smallest generated prompt length.");
+DEFINE_int32(prompt_tokens_max, 256, "Largest generated prompt length.");
+DEFINE_int32(output_tokens_min, 32, "Smallest generated output length.");
+DEFINE_int32(output_tokens_max, 128, "Largest generated output length.");
+DEFINE_double(
+    arrival_rate,
+    0,
+    "Mean rate of the generated Poisson arrivals, in requests per second. 0 makes every request arrive at once.");
+DEFINE_int32(sessions, 1, "Number of requests served concurrently.");
+DEFINE_int32(warmup, 1, "Untimed requests run by each session first.");
+DEFINE_uint32(seed, 0, "Seed of the generated requests.");
+DEFINE_double(temperature, 0, "Sampling temperature. 0 samples greedily.");
+DEFINE_string(
+    output_path,
+    "llm_serving_bench.json",
+    "Write the JSON results to this path.");
+
+using executorch::extension::Module;
+using executorch::extension::TensorPtr;
+using executorch::extension::llm::GenerationConfig;
+using executorch::extension::llm::Stats;
+using executorch::extension::llm::TextDecoderRunner;
+using executorch::extension::llm::TextLLMRunner;
+using executorch::extension::llm::TextPrefiller;
+using executorch::extension::llm::TextTokenGenerator;
+using executorch::runtime::Error;
+using executorch::runtime::Result;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/// The peak resident set size of the process so far, in bytes.
+uint64_t peak_rss_bytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Linux reports kilobytes.
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+/// Keeps the CPU busy for `us` microseconds, like a kernel would.
+void spin_for_us(double us) {
+  const auto deadline = Clock::now() +
+      std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double, std::micro>(us));
+  while (Clock::now() < deadline) {
+  }
+}
+
+constexpr uint64_t kSyntheticBosId = 1;
+constexpr uint64_t kSyntheticEosId = 2;
+// The first token id that is not a special token.
+constexpr uint64_t kSyntheticFirstId = 3;
+
+/// A tokenizer with one token per byte of text, so that a prompt of N bytes is
+/// N tokens long.
+class SyntheticTokenizer : public ::tokenizers::Tokenizer {
+ public:
+  explicit SyntheticTokenizer(int32_t vocab_size) {
+    vocab_size_ = vocab_size;
+    bos_tok_ = kSyntheticBosId;
+    eos_tok_ = kSyntheticEosId;
+    initialized_ = true;
+  }
+
+  ::tokenizers::Error load(const std::string&) override {
+    return ::tokenizers::Error::Ok;
+  }
+
+  ::tokenizers::Result<std::vector<uint64_t>>
+  encode(const std::string& input, int8_t bos, int8_t eos) const override {
+    std::vector<uint64_t> tokens(bos, bos_tok_);
+    for (char c : input) {
+      tokens.push_back(
+          kSyntheticFirstId +
+          static_cast<unsigned char>(c) % (vocab_size_ - kSyntheticFirstId));
+    }
+    tokens.insert(tokens.end(), eos, eos_tok_);
+    return tokens;
+  }
+
+  ::tokenizers::Result<std::string> decode(uint64_t, uint64_t token)
+      const override {
+    return std::string(1, static_cast<char>('a' + token % 26));
+  }
+};
+
+/**
+ * Stands in for the forward method of an LLM with a KV cache. Each step
+ * spends CPU time in proportion to its tokens, writes their KV cache entries,
+ * and returns logits that never select a special token.
+ */
+class SyntheticDecoderRunner : public TextDecoderRunner {
+ public:
+  SyntheticDecoderRunner(
+      int32_t vocab_size,
+      int64_t max_context_len,
+      size_t kv_bytes_per_token)
+      : TextDecoderRunner(nullptr),
+        vocab_size_(vocab_size),
+        max_context_len_(max_context_len),
+        kv_bytes_per_token_(kv_bytes_per_token),
+        // Left uninitialized so that only the positions used become resident.
+        kv_cache_(new uint8_t[max_context_len * kv_bytes_per_token]),
+        logits_(executorch::extension::make_tensor_ptr(
+            {1, vocab_size},
+            std::vector<float>(vocab_size, 0.0f))) {}
+
+  Result<executorch::aten::Tensor> step(TensorPtr& input, int64_t start_pos)
+      override {
+    const int64_t num_tokens = input->numel();
+    ET_CHECK_OR_RETURN_ERROR(
+        start_pos >= 0 && start_pos + num_tokens <= max_context_len_,
+        InvalidArgument,
+        "Positions [%" PRId64 ", %" PRId64 ") exceed the context of %" PRId64,
+        start_pos,
+        start_pos + num_tokens,
+        max_context_len_);
+    memset(
+        kv_cache_.get() + start_pos * kv_bytes_per_token_,
+        static_cast<int>(start_pos),
+        num_tokens * kv_bytes_per_token_);
+    spin_for_us(
+        num_tokens > 1 ? FLAGS_synthetic_prefill_us * num_tokens
+                       : FLAGS_synthetic_decode_us);
+
+    float* logits = logits_->mutable_data_ptr<float>();
+    std::fill(logits, logits + vocab_size_, 0.0f);
+    const int64_t next = start_pos + num_tokens;
+    logits[kSyntheticFirstId + next % (vocab_size_ - kSyntheticFirstId)] = 1.0f;
+    return *logits_;
+  }
+
+  Error load() override {
+    return Error::Ok;
+  }
+
+  bool is_method_loaded() override {
+    return true;
+  }
+
+ private:
+  const int32_t vocab_size_;
+  const int64_t max_context_len_;
+  const size_t kv_bytes_per_token_;
+  std::unique_ptr<uint8_t[]> kv_cache_;
+  TensorPtr logits_;
+};
+
+/// Assembles a TextLLMRunner around a SyntheticDecoderRunner.
+std::unique_ptr<TextLLMRunner> create_synthetic_runner() {
+  const std::unordered_map<std::string, int64_t> metadata = {
+      {"enable_dynamic_shape", 1},
+      {"get_bos_id", kSyntheticBosId},
+      {"get_max_context_len", FLAGS_synthetic_max_context_len},
+      {"get_max_seq_len", FLAGS_synthetic_max_seq_len},
+      {"get_vocab_size", FLAGS_synthetic_vocab_size},
+      {"use_kv_cache", 1},
+      {"use_sdpa_with_kv_cache", 0},
+  };
+  auto tokenizer =
+      std::make_unique<SyntheticTokenizer>(FLAGS_synthetic_vocab_size);
+  auto decoder = std::make_unique<SyntheticDecoderRunner>(
+      FLAGS_synthetic_vocab_size,
+      FLAGS_synthetic_max_context_len,
+      static_cast<size_t>(FLAGS_synthetic_kv_bytes_per_token));
+  auto prefiller = std::make_unique<TextPrefiller>(
+      decoder.get(),
+      /*use_kv_cache=*/true,
+      /*enable_parallel_prefill=*/true,
+      FLAGS_synthetic_max_seq_len);
+  auto stats = std::make_unique<Stats>();
+  auto generator = std::make_unique<TextTokenGenerator>(
+      tokenizer.get(),
+      decoder.get(),
+      /*use_kv_cache=*/true,
+      std::make_unique<std::unordered_set<uint64_t>>(
+          std::unordered_set<uint64_t>{kSyntheticEosId}),
+      stats.get());
+  // The module is never loaded; the decoder runs instead.
+  return std::make_unique<TextLLMRunner>(
+      metadata,
+      std::move(tokenizer),
+      std::make_unique<Module>(""),
+      std::move(decoder),
+      std::move(prefiller),
+      std::move(generator),
+      std::move(stats));
+}
+
+std::unique_ptr<TextLLMRunner> create_runner() {
+  if (FLAGS_synthetic) {
+    return create_synthetic_runner();
+  }
+  auto tokenizer =
+      executorch::extension::llm::load_tokenizer(FLAGS_tokenizer_path);
+  if (!tokenizer) {
+    ET_LOG(Error, "Failed to load tokenizer %s", FLAGS_tokenizer_path.c_str());
+    return nullptr;
+  }
+  return executorch::extension::llm::create_text_llm_runner(
+      FLAGS_model_path,
+      std::move(tokenizer),
+      FLAGS_data_path.empty()
+          ? std::nullopt
+          : std::optional<const std::string>(FLAGS_data_path));
+}
+
+/// The memory-planned bytes of one instance of the forward method.
+uint64_t planned_memory_bytes() {
+  if (FLAGS_synthetic) {
+    return static_cast<uint64_t>(FLAGS_synthetic_max_context_len) *
+        FLAGS_synthetic_kv_bytes_per_token;
+  }
+  Module module(FLAGS_model_path);
+  auto method_meta = module.method_meta("forward");
+  if (!method_meta.ok()) {
+    return 0;
+  }
+  uint64_t bytes = 0;
+  for (size_t id = 0; id < method_meta->num_memory_planned_buffers(); ++id) {
+    bytes += method_meta->memory_planned_buffer_size(id).get();
+  }
+  return bytes;
+}
+
+struct Request {
+  double arrival_ms;
+  int32_t prompt_tokens;
+  int32_t output_tokens;
+};
+
+/// Reads a trace file. Returns an empty list on malformed input.
+std::vector<Request> read_trace(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    ET_LOG(Error, "Failed to open %s", path.c_str());
+    return {};
+  }
+  std::vector<Request> requests;
+  std::string line;
+  for (size_t line_number = 1; std::getline(file, line); ++line_number) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    Request request;
+    char trailing;
+    if (sscanf(
+            line.c_str(),
+            "%lf,%" SCNd32 ",%" SCNd32 " %c",
+            &request.arrival_ms,
+            &request.prompt_tokens,
+            &request.output_tokens,
+            &trailing) != 3 ||
+        request.arrival_ms < 0 || request.prompt_tokens <= 0 ||
+        request.output_tokens <= 0) {
+      ET_LOG(Error, "Malformed line %zu of %s", line_number, path.c_str());
+      return {};
+    }
+    requests.push_back(request);
+  }
+  return requests;
+}
+
+std::vector<Request> generate_requests() {
+  std::mt19937 rng(FLAGS_seed);
+  std::uniform_int_distribution<int32_t> prompt_tokens(
+      FLAGS_prompt_tokens_min, FLAGS_prompt_tokens_max);
+  std::uniform_int_distribution<int32_t> output_tokens(
+      FLAGS_output_tokens_min, FLAGS_output_tokens_max);
+  std::exponential_distribution<double> interarrival_s(
+      FLAGS_arrival_rate > 0 ? FLAGS_arrival_rate : 1);
+  std::vector<Request> requests;
+  double arrival_ms = 0;
+  for (int32_t i = 0; i < FLAGS_num_requests; ++i) {
+    requests.push_back({arrival_ms, prompt_tokens(rng), output_tokens(rng)});
+    if (FLAGS_arrival_rate > 0) {
+      arrival_ms += interarrival_s(rng) * 1000;
+    }
+  }
+  return requests;
+}
+
+/// A prompt of about `num_tokens` tokens. Exact with the synthetic tokenizer.
+std::string make_prompt(int32_t num_tokens) {
+  if (FLAGS_synthetic) {
+    std::string prompt(num_tokens, ' ');
+    for (int32_t i = 0; i < num_tokens; ++i) {
+      prompt[i] = static_cast<char>('a' + i % 26);
+    }
+    return prompt;
+  }
+  std::string prompt;
+  for (int32_t i = 0; i < num_tokens; ++i) {
+    prompt += " hello";
+  }
+  return prompt;
+}
+
+struct RequestResult {
+  bool ok = false;
+  // From the arrival of the request until a session starts serving it.
+  double queue_ms = 0;
+  // From the arrival of the request until its first generated token.
+  double ttft_ms = 0;
+  // From the arrival of the request until its last generated token.
+  double e2e_ms = 0;
+  // Between consecutive generated tokens.
+  std::vector<double> itl_ms;
+  int64_t prompt_tokens = 0;
+  int64_t generated_tokens = 0;
+  Clock::time_point end;
+};
+
+/// Serves the requests, each session taking the next one in order of arrival
+/// when it is free.
+std::vector<RequestResult> serve(
+    const std::vector<Request>& requests,
+    std::vector<std::unique_ptr<TextLLMRunner>>& runners,
+    Clock::time_point start) {
+  std::vector<RequestResult> results(requests.size());
+  std::atomic<size_t> next{0};
+
+  auto session = [&](size_t session_index) {
+    TextLLMRunner& runner = *runners[session_index];
+    for (size_t i = next++; i < requests.size(); i = next++) {
+      const Request& request = requests[i];
+      RequestResult& result = results[i];
+      const auto arrival = start +
+          std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double, std::milli>(
+                                   request.arrival_ms));
+      std::this_thread::sleep_until(arrival);
+      result.queue_ms = ms_between(arrival, Clock::now());
+
+      std::vector<Clock::time_point> token_times;
+      token_times.reserve(request.output_tokens);
+      GenerationConfig config;
+      config.echo = false;
+      // Printing and flushing every token would add terminal I/O to the
+      // measured latencies.
+      config.print_output = false;
+      config.max_new_tokens = request.output_tokens;
+      config.temperature = static_cast<float>(FLAGS_temperature);
+      const Error status = runner.generate(
+          make_prompt(request.prompt_tokens),
+          config,
+          [&](const std::string&) { token_times.push_back(Clock::now()); },
+          [&](const Stats& stats) {
+            result.prompt_tokens = stats.num_prompt_tokens;
+          });
+      result.end = Clock::now();
+      if (status != Error::Ok || token_times.empty()) {
+        ET_LOG(
+            Error,
+            "Request %zu failed: 0x%" PRIx32,
+            i,
+            static_cast<uint32_t>(status));
+        continue;
+      }
+      result.ok = true;
+      result.ttft_ms = ms_between(arrival, token_times.front());
+      result.e2e_ms = ms_between(arrival, token_times.back());
+      result.generated_tokens = token_times.size();
+      for (size_t t = 1; t < token_times.size(); ++t) {
+        result.itl_ms.push_back(ms_between(token_times[t - 1], token_times[t]));
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < runners.size(); ++i) {
+    workers.emplace_back(session, i);
+  }
+  session(0);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return results;
+}
+
+/// The nearest-rank percentile of sorted values.
+double percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+/// The min, mean, percentiles and max of the values as a JSON object.
+std::string summary_json(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  double total = 0;
+  for (double value : values) {
+    total += value;
+  }
+  char buffer[256];
+  snprintf(
+      buffer,
+      sizeof(buffer),
+      "{\"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+      "\"p99\": %.3f, \"max\": %.3f}",
+      values.empty() ? 0 : values.front(),
+      values.empty() ? 0 : total / values.size(),
+      percentile(values, 50),
+      percentile(values, 90),
+      percentile(values, 99),
+      values.empty() ? 0 : values.back());
+  return buffer;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_sessions <= 0) {
+    ET_LOG(Error, "--sessions must be positive");
+    return 1;
+  }
+  if (!FLAGS_synthetic &&
+      (FLAGS_model_path.empty() || FLAGS_tokenizer_path.empty())) {
+    ET_LOG(Error, "Pass --model_path and --tokenizer_path, or --synthetic");
+    return 1;
+  }
+  if (FLAGS_synthetic &&
+      (FLAGS_synthetic_vocab_size <= static_cast<int32_t>(kSyntheticFirstId) ||
+       FLAGS_synthetic_max_context_len <= 0 ||
+       FLAGS_synthetic_max_seq_len <= 0 ||
+       FLAGS_synthetic_kv_bytes_per_token < 0)) {
+    ET_LOG(Error, "Invalid --synthetic_* flags");
+    return 1;
+  }
+  std::vector<Request> requests;
+  if (!FLAGS_trace_path.empty()) {
+    requests = read_trace(FLAGS_trace_path);
+  } else if (
+      FLAGS_prompt_tokens_min > 0 &&
+      FLAGS_prompt_tokens_min <= FLAGS_prompt_tokens_max &&
+      FLAGS_output_tokens_min > 0 &&
+      FLAGS_output_tokens_min <= FLAGS_output_tokens_max) {
+    requests = generate_requests();
+  } else {
+    ET_LOG(Error, "Invalid --prompt_tokens_* or --output_tokens_* flags");
+    return 1;
+  }
+  if (requests.empty()) {
+    ET_LOG(Error, "No requests to serve");
+    return 1;
+  }
+  std::stable_sort(
+      requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.arrival_ms < b.arrival_ms;
+      });
+
+  // Every session loads and warms up its own runner before the first request
+  // arrives.
+  std::vector<std::unique_ptr<TextLLMRunner>> runners;
+  const auto load_start = Clock::now();
+  for (int32_t i = 0; i < FLAGS_sessions; ++i) {
+    auto runner = create_runner();
+    if (!runner || runner->load() != Error::Ok) {
+      ET_LOG(Error, "Failed to load session %" PRId32, i);
+      return 1;
+    }
+    for (int32_t w = 0; w < FLAGS_warmup; ++w) {
+      if (runner->warmup(make_prompt(requests[0].prompt_tokens), 4) !=
+          Error::Ok) {
+        ET_LOG(Error, "Warmup of session %" PRId32 " failed", i);
+        return 1;
+      }
+    }
+    runners.push_back(std::move(runner));
+  }
+  const double load_ms = ms_between(load_start, Clock::now());
+  const uint64_t load_peak_rss_bytes = peak_rss_bytes();
+
+  const auto start = Clock::now();
+  std::vector<RequestResult> results = serve(requests, runners, start);
+
+  std::vector<double> queue_ms, ttft_ms, itl_ms, e2e_ms;
+  size_t completed = 0;
+  int64_t prompt_tokens = 0, generated_tokens = 0, max_kv_positions = 0;
+  Clock::time_point last_end = start;
+  for (const RequestResult& result : results) {
+    if (!result.ok) {
+      continue;
+    }
+    completed++;
+    queue_ms.push_back(result.queue_ms);
+    ttft_ms.push_back(result.ttft_ms);
+    e2e_ms.push_back(result.e2e_ms);
+    itl_ms.insert(itl_ms.end(), result.itl_ms.begin(), result.itl_ms.end());
+    prompt_tokens += result.prompt_tokens;
+    generated_tokens += result.generated_tokens;
+    // The last generated token is sampled but never fed back to the model.
+    max_kv_positions = std::max(
+        max_kv_positions, result.prompt_tokens + result.generated_tokens - 1);
+    last_end = std::max(last_end, result.end);
+  }
+  const double wall_s = ms_between(start, last_end) / 1000;
+  const uint64_t planned_bytes = planned_memory_bytes();
+
+  char buffer[2048];
+  snprintf(
+      buffer,
+      sizeof(buffer),
+      "{\n  \"mode\": \"%s\",\n  \"sessions\": %" PRId32
+      ",\n  \"requests\": %zu,\n  \"completed_requests\": %zu,\n"
+      "  \"load_ms\": %.3f,\n  \"wall_s\": %.3f,\n"
+      "  \"prompt_tokens\": %" PRId64 ",\n  \"generated_tokens\": %" PRId64
+      ",\n  \"requests_per_s\": %.3f,\n  \"output_tokens_per_s\": %.3f,\n"
+      "  \"total_tokens_per_s\": %.3f,\n",
+      FLAGS_synthetic ? "synthetic" : "model",
+      FLAGS_sessions,
+      requests.size(),
+      completed,
+      load_ms,
+      wall_s,
+      prompt_tokens,
+      generated_tokens,
+      wall_s > 0 ? completed / wall_s : 0,
+      wall_s > 0 ? generated_tokens / wall_s : 0,
+      wall_s > 0 ? (prompt_tokens + generated_tokens) / wall_s : 0);
+  std::string json = buffer;
+  json += "  \"queue_ms\": " + summary_json(queue_ms) + ",\n";
+  json += "  \"ttft_ms\": " + summary_json(ttft_ms) + ",\n";
+  json += "  \"itl_ms\": " + summary_json(itl_ms) + ",\n";
+  json += "  \"e2e_ms\": " + summary_json(e2e_ms) + ",\n";
+  // The KV cache high-water mark is known in bytes only in synthetic mode;
+  // with a model it is part of the planned memory.
+  snprintf(
+      buffer,
+      sizeof(buffer),
+      "  \"max_kv_positions\": %" PRId64 ",\n"
+      "  \"kv_high_water_bytes_per_session\": %" PRId64 ",\n"
+      "  \"planned_memory_bytes_per_session\": %" PRIu64 ",\n"
+      "  \"load_peak_rss_bytes\": %" PRIu64 ",\n"
+      "  \"peak_rss_bytes\": %" PRIu64 "\n}\n",
+      max_kv_positions,
+      FLAGS_synthetic ? max_kv_positions * FLAGS_synthetic_kv_bytes_per_token
+                      : 0,
+      planned_bytes,
+      load_peak_rss_bytes,
+      peak_rss_bytes());
+  json += buffer;
+
+  std::unique_ptr<FILE, decltype(&fclose)> output(
+      fopen(FLAGS_output_path.c_str(), "w"), fclose);
+  if (!output) {
+    ET_LOG(Error, "Failed to open %s", FLAGS_output_path.c_str());
+    return 1;
+  }
+  fwrite(json.data(), 1, json.size(), output.get());
+  ET_LOG(Info, "Results written to %s", FLAGS_output_path.c_str());
+  return completed == requests.size() ? 0 : 1;
+}
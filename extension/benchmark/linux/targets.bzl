@@ -0,0 +1,49 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    # Benchmarks a .pte model and writes the results as JSON. Links the
+    # portable kernels; define a new binary with the same sources to benchmark
+    # other kernels or backends.
+    runtime.cxx_binary(
+        name = "executorch_bench",
+        srcs = ["executorch_bench.cpp"],
+        compiler_flags = ["-Wno-global-constructors"],
+        deps = [
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/memory_allocator:malloc_memory_allocator",
+            "//executorch/extension/runner_util:inputs",
+            "//executorch/extension/threadpool:cpuinfo_utils",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/runtime/executor:program",
+        ],
+        external_deps = [
+            "gflags",
+        ],
+    )
+
+    # Load-tests TextLLMRunner with concurrent sessions and writes the results
+    # as JSON. Runs without a model with --synthetic.
+    runtime.cxx_binary(
+        name = "llm_serving_bench",
+        srcs = ["llm_serving_bench.cpp"],
+        compiler_flags = [
+            "-Wno-global-constructors",
+            "-Wno-deprecated-declarations",
+        ],
+        deps = [
+            "//executorch/extension/llm/runner:runner_lib",
+            "//executorch/extension/module:module",
+            "//executorch/extension/tensor:tensor",
+            "//executorch/kernels/portable:generated_lib",
+        ],
+        external_deps = [
+            "gflags",
+        ],
+    )
@@ -265,6 +265,190 @@ def update_cache_with_indices_meta(
     return torch.empty((1,), dtype=value.dtype, device="meta")
 
 
+def _validate_block_table(block_table, batch_size):
+    assert (
+        block_table.dim() == 2
+    ), f"Expected block_table to be 2 dimensional but got {block_table.dim()} dimensions."
+    assert (
+        block_table.dtype == torch.int64
+    ), f"Expected block_table to be int64 but got {block_table.dtype}"
+    assert (
+        block_table.size(0) == batch_size
+    ), f"Expected block_table batch dimension to match batch size but got {block_table.size(0)} and {batch_size}"
+
+
+@impl(custom_ops_lib, "update_cache_paged", "Meta")
+def update_cache_paged_meta(
+    value,
+    cache,
+    start_pos,
+    block_table,
+):
+    assert (
+        value.dim() == 4
+    ), f"Expected value to be 4 dimensional but got {value.dim()} dimensions."
+    assert (
+        cache.dim() == 4
+    ), f"Expected cache to be 4 dimensional but got {cache.dim()} dimensions."
+    assert (
+        value.dtype == cache.dtype
+    ), f"Expected value and cache to be of the same type but got value type {value.dtype} and cache type {cache.dtype}"
+    for i in [2, 3]:
+        assert value.size(i) == cache.size(
+            i
+        ), f"Expected value and cache to have same size in dimension {i} but got {value.size(i)} and {cache.size(i)}"
+    _validate_block_table(block_table, value.size(0))
+    torch._check_is_size(start_pos)
+
+    return torch.empty((1,), dtype=value.dtype, device="meta")
+
+
+def _validate_ring_window(seq_len, cache, sink_size):
+    assert (
+        0 <= sink_size < cache.size(1)
+    ), f"Expected sink_size to be in [0, {cache.size(1)}) but got {sink_size}"
+    assert (
+        seq_len <= cache.size(1) - sink_size
+    ), f"Expected sequence length {seq_len} to be at most the ring window {cache.size(1) - sink_size}"
+
+
+@impl(custom_ops_lib, "update_cache_ring", "Meta")
+def update_cache_ring_meta(
+    value,
+    cache,
+    start_pos,
+    sink_size,
+):
+    assert (
+        value.dim() == 4
+    ), f"Expected value to be 4 dimensional but got {value.dim()} dimensions."
+    assert (
+        cache.dim() == 4
+    ), f"Expected cache to be 4 dimensional but got {cache.dim()} dimensions."
+    assert (
+        value.dtype == cache.dtype
+    ), f"Expected value and cache to be of the same type but got value type {value.dtype} and cache type {cache.dtype}"
+    for i in [0, 2, 3]:
+        assert value.size(i) == cache.size(
+            i
+        ), f"Expected value and cache to have same size in dimension {i} but got {value.size(i)} and {cache.size(i)}"
+    _validate_ring_window(value.size(1), cache, sink_size)
+    torch._check_is_size(start_pos)
+
+    return torch.empty((1,), dtype=value.dtype, device="meta")
+
+
+@impl(custom_ops_lib, "rope_update_cache", "Meta")
+def rope_update_cache_meta(
+    q,
+    k,
+    v,
+    freqs_cos,
+    freqs_sin,
+    k_cache,
+    v_cache,
+    start_pos,
+):
+    assert (
+        q.dim() == 4 and k.dim() == 4
+    ), f"Expected q and k to be 4 dimensional but got {q.dim()} and {k.dim()} dimensions."
+    assert (
+        k.shape == v.shape
+    ), f"Expected k and v to have the same shape but got {k.shape} and {v.shape}"
+    assert (
+        q.size(0) == k.size(0) and q.size(1) == k.size(1)
+    ), f"Expected q and k to have the same batch size and sequence length but got {q.shape} and {k.shape}"
+    for t in [k, v, freqs_cos, freqs_sin, k_cache, v_cache]:
+        assert (
+            t.dtype == q.dtype
+        ), f"Expected all inputs to be of type {q.dtype} but got {t.dtype}"
+
+    head_dim = q.size(3)
+    assert (
+        head_dim % 2 == 0 and k.size(3) == head_dim
+    ), f"Expected q and k to have the same, even, head dim but got {head_dim} and {k.size(3)}"
+    for freqs in [freqs_cos, freqs_sin]:
+        assert freqs.shape == (
+            q.size(1),
+            head_dim // 2,
+        ), f"Expected freqs to have shape {(q.size(1), head_dim // 2)} but got {freqs.shape}"
+
+    for cache in [k_cache, v_cache]:
+        assert (
+            cache.dim() == 4
+        ), f"Expected cache to be 4 dimensional but got {cache.dim()} dimensions."
+        for i in [0, 2, 3]:
+            assert k.size(i) == cache.size(
+                i
+            ), f"Expected k and cache to have same size in dimension {i} but got {k.size(i)} and {cache.size(i)}"
+
+    torch._check_is_size(start_pos)
+    torch._check(start_pos + k.size(1) <= k_cache.size(1))
+
+    return torch.empty_like(q)
+
+
+@impl(custom_ops_lib, "custom_sdpa_paged", "Meta")
+def custom_sdpa_paged_meta(
+    query,
+    key_cache,
+    value_cache,
+    start_pos,
+    block_table,
+    attn_mask=None,
+    drpout_p=0.0,
+    is_causal=False,
+    scale=None,
+):
+    seq_len = query.size(1)
+    _validate_params(
+        query,
+        key_cache,
+        value_cache,
+        key_cache,
+        value_cache,
+        start_pos,
+        seq_len,
+        attn_mask,
+        drpout_p,
+        is_causal,
+        scale,
+    )
+    _validate_block_table(block_table, query.size(0))
+
+    return torch.empty_like(query)
+
+
+@impl(custom_ops_lib, "custom_sdpa_ring", "Meta")
+def custom_sdpa_ring_meta(
+    query,
+    key_cache,
+    value_cache,
+    start_pos,
+    sink_size,
+    drpout_p=0.0,
+    scale=None,
+):
+    seq_len = query.size(1)
+    _validate_params(
+        query,
+        key_cache,
+        value_cache,
+        key_cache,
+        value_cache,
+        start_pos,
+        seq_len,
+        None,
+        drpout_p,
+        False,
+        scale,
+    )
+    _validate_ring_window(seq_len, key_cache, sink_size)
+    torch._check_is_size(start_pos)
+
+    return torch.empty_like(query)
+
+
 def _validate_quantized_sdpa_params(
     query,
     key,
@@ -304,8 +488,15 @@ def _validate_quantized_sdpa_params(
     ), "v_scale and v_zero_point must be provided"
 
     assert query.dtype == torch.int8, f"Expected query to be int8 but got {query.dtype}"
-    assert key.dtype == torch.int8, f"Expected key to be int8 but got {key.dtype}"
-    assert value.dtype == torch.int8, f"Expected value to be int8 but got {value.dtype}"
+    # uint8 key and value hold int4 values, packed two per byte.
+    assert key.dtype in (
+        torch.int8,
+        torch.uint8,
+    ), f"Expected key to be int8 or uint8 but got {key.dtype}"
+    assert value.dtype in (
+        torch.int8,
+        torch.uint8,
+    ), f"Expected value to be int8 or uint8 but got {value.dtype}"
 
     assert (
         q_scale.dtype == torch.float32
@@ -347,6 +538,32 @@ def _validate_quantized_sdpa_params(
         value.size()[:-1] == v_zero_point.size()[:-1]
     ), f"Expected value and v_zero_point to have same size except last dimensions but got {value.size()} and {v_zero_point.size()}"
 
+    # The last dim of the scales and zero points is the number of
+    # quantization groups: one per token for query, one per token or per
+    # group of head_dim / num_groups channels for key and value.
+    head_dim = query.size(-1)
+    assert (
+        q_scale.size(-1) == 1 and q_zero_point.size(-1) == 1
+    ), f"Expected query to be quantized per token but got {q_scale.size(-1)} groups"
+    for name, t, t_scale, t_zero_point in (
+        ("key", key, k_scale, k_zero_point),
+        ("value", value, v_scale, v_zero_point),
+    ):
+        t_head_dim = t.size(-1) * (2 if t.dtype == torch.uint8 else 1)
+        assert (
+            t_head_dim == head_dim
+        ), f"Expected {name} head dim {t_head_dim} to match query head dim {head_dim}"
+        num_groups = t_scale.size(-1)
+        assert (
+            t_zero_point.size(-1) == num_groups
+        ), f"Expected {name} scales and zero points to have the same number of groups"
+        assert (
+            head_dim % num_groups == 0
+        ), f"Expected {name} quantization groups {num_groups} to divide head dim {head_dim}"
+        assert (
+            t.dtype != torch.uint8 or (head_dim // num_groups) % 2 == 0
+        ), f"Expected int4 {name} quantization groups to have an even size"
+
 
 @impl(custom_ops_lib, "custom_quantized_sdpa", "Meta")
 def custom_quantized_sdpa_meta(
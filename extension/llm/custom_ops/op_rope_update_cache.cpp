@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/custom_ops/op_rope_update_cache.h>
+
+#include <ATen/cpu/vec/vec.h>
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+// @lint-ignore CLANGTIDY facebook-unused-include-check
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace torch {
+namespace executor {
+
+namespace native {
+
+namespace {
+
+bool is_contiguous(const Tensor& t) {
+  return is_contiguous_dim_order(t.dim_order().data(), t.dim());
+}
+
+bool validate_rope_update_cache_args(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    int64_t start_pos) {
+  ET_CHECK_OR_RETURN_FALSE(q.dim() == 4, "q must be a 4D tensor");
+  ET_CHECK_OR_RETURN_FALSE(k.dim() == 4, "k must be a 4D tensor");
+  ET_CHECK_OR_RETURN_FALSE(k_cache.dim() == 4, "k_cache must be a 4D tensor");
+  ET_CHECK_OR_RETURN_FALSE(
+      freqs_cos.dim() == 2 && freqs_sin.dim() == 2,
+      "freqs_cos and freqs_sin must be 2D tensors [seq_len, head_dim / 2]");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      q.scalar_type() == k.scalar_type() &&
+          q.scalar_type() == v.scalar_type() &&
+          q.scalar_type() == freqs_cos.scalar_type() &&
+          q.scalar_type() == freqs_sin.scalar_type() &&
+          q.scalar_type() == k_cache.scalar_type() &&
+          q.scalar_type() == v_cache.scalar_type(),
+      "q, k, v, freqs and caches must have the same dtype");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      k.sizes() == v.sizes(), "k and v must have the same shape");
+  ET_CHECK_OR_RETURN_FALSE(
+      k_cache.sizes() == v_cache.sizes(),
+      "k_cache and v_cache must have the same shape");
+  ET_CHECK_OR_RETURN_FALSE(
+      q.size(0) == k.size(0) && q.size(1) == k.size(1),
+      "q and k must have the same batch size and sequence length");
+  ET_CHECK_OR_RETURN_FALSE(
+      k.size(0) == k_cache.size(0) && k.size(2) == k_cache.size(2) &&
+          k.size(3) == k_cache.size(3),
+      "k batch size, heads and head dim must match those of the cache");
+
+  const int64_t head_dim = q.size(3);
+  ET_CHECK_OR_RETURN_FALSE(
+      head_dim % 2 == 0 && k.size(3) == head_dim,
+      "q and k must have the same, even, head dim");
+  ET_CHECK_OR_RETURN_FALSE(
+      freqs_cos.sizes() == freqs_sin.sizes() &&
+          freqs_cos.size(0) == q.size(1) && freqs_cos.size(1) == head_dim / 2,
+      "freqs_cos and freqs_sin must be [seq_len, head_dim / 2]");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0 && start_pos + k.size(1) <= k_cache.size(1),
+      "start_pos + seq_length must be at most the cache size at dim 1."
+      "start pos: %" PRId64 ", seq_length: %zd, cache size: %zd",
+      start_pos,
+      k.size(1),
+      k_cache.size(1));
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous(q) && is_contiguous(k) && is_contiguous(v) &&
+          is_contiguous(freqs_cos) && is_contiguous(freqs_sin) &&
+          is_contiguous(k_cache) && is_contiguous(v_cache),
+      "all inputs must be in contiguous dim order");
+
+  return true;
+}
+
+// Rotates each of the n_rows rows of head_dim = 2 * half interleaved
+// (real, imaginary) pairs by the same angles. The vector loop deinterleaves
+// the pairs so that the complex multiply is plain lane-wise arithmetic.
+template <typename T>
+void rotate_rows(
+    const T* in,
+    const T* cos,
+    const T* sin,
+    T* out,
+    int64_t n_rows,
+    int64_t half) {
+  using Vec = ::at::vec::Vectorized<T>;
+  for (int64_t row = 0; row < n_rows; ++row) {
+    const T* x = in + row * 2 * half;
+    T* y = out + row * 2 * half;
+    int64_t i = 0;
+    for (; i + Vec::size() <= half; i += Vec::size()) {
+      const auto pairs = ::at::vec::deinterleave2(
+          Vec::loadu(x + 2 * i), Vec::loadu(x + 2 * i + Vec::size()));
+      const Vec c = Vec::loadu(cos + i);
+      const Vec s = Vec::loadu(sin + i);
+      const auto rotated = ::at::vec::interleave2(
+          pairs.first * c - pairs.second * s,
+          pairs.first * s + pairs.second * c);
+      rotated.first.store(y + 2 * i);
+      rotated.second.store(y + 2 * i + Vec::size());
+    }
+    for (; i < half; ++i) {
+      const T re = x[2 * i];
+      const T im = x[2 * i + 1];
+      y[2 * i] = re * cos[i] - im * sin[i];
+      y[2 * i + 1] = re * sin[i] + im * cos[i];
+    }
+  }
+}
+
+// One task per (batch, token): the token's cos/sin rows stay in L1 while
+// all of its q and k heads are rotated, and k goes straight into the cache.
+template <typename T>
+void rope_update_cache_impl(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    Tensor& k_cache,
+    Tensor& v_cache,
+    int64_t start_pos,
+    Tensor& out) {
+  const T* q_data = q.const_data_ptr<T>();
+  const T* k_data = k.const_data_ptr<T>();
+  const T* v_data = v.const_data_ptr<T>();
+  const T* cos_data = freqs_cos.const_data_ptr<T>();
+  const T* sin_data = freqs_sin.const_data_ptr<T>();
+  T* k_cache_data = k_cache.mutable_data_ptr<T>();
+  T* v_cache_data = v_cache.mutable_data_ptr<T>();
+  T* out_data = out.mutable_data_ptr<T>();
+
+  const int64_t seq_len = q.size(1);
+  const int64_t head_dim = q.size(3);
+  const int64_t half = head_dim / 2;
+  const int64_t q_row = q.size(2) * head_dim;
+  const int64_t kv_row = k.size(2) * head_dim;
+  const int64_t max_seq_len = k_cache.size(1);
+
+  const int64_t num_tokens = q.size(0) * seq_len;
+  const int64_t grain_size = std::max<int64_t>(
+      1,
+      ::executorch::extension::internal::GRAIN_SIZE /
+          std::max<int64_t>(q_row + 2 * kv_row, 1));
+  ::executorch::extension::parallel_for(
+      0, num_tokens, grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t token = begin; token < end; ++token) {
+          const int64_t b = token / seq_len;
+          const int64_t s = token % seq_len;
+          const T* cos = cos_data + s * half;
+          const T* sin = sin_data + s * half;
+          const int64_t cache_offset =
+              (b * max_seq_len + start_pos + s) * kv_row;
+          rotate_rows(
+              q_data + token * q_row,
+              cos,
+              sin,
+              out_data + token * q_row,
+              q.size(2),
+              half);
+          rotate_rows(
+              k_data + token * kv_row,
+              cos,
+              sin,
+              k_cache_data + cache_offset,
+              k.size(2),
+              half);
+          std::memcpy(
+              v_cache_data + cache_offset,
+              v_data + token * kv_row,
+              kv_row * sizeof(T));
+        }
+      });
+}
+
+} // anonymous namespace
+
+Tensor& rope_update_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    Tensor& k_cache,
+    Tensor& v_cache,
+    const int64_t start_pos,
+    Tensor& out) {
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_rope_update_cache_args(
+          q, k, v, freqs_cos, freqs_sin, k_cache, v_cache, start_pos),
+      InvalidArgument,
+      out);
+
+  ET_KERNEL_CHECK(
+      ctx, resize_tensor(out, q.sizes()) == Error::Ok, InvalidArgument, out);
+
+  ET_SWITCH_FLOAT_TYPES(q.scalar_type(), ctx, "rope_update_cache", CTYPE, [&] {
+    rope_update_cache_impl<CTYPE>(
+        q, k, v, freqs_cos, freqs_sin, k_cache, v_cache, start_pos, out);
+  });
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
+
+EXECUTORCH_LIBRARY(
+    llama,
+    "rope_update_cache.out",
+    torch::executor::native::rope_update_cache_out);
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+
+namespace native {
+
+/**
+ * Fuses the rotary embedding of q and k with the KV cache update.
+ *
+ * q is [batch, seq_len, n_heads, head_dim] and k, v are
+ * [batch, seq_len, n_kv_heads, head_dim]; the caches are
+ * [batch, max_seq_len, n_kv_heads, head_dim]. freqs_cos and freqs_sin are
+ * the [seq_len, head_dim / 2] tables of the positions being written, and are
+ * applied to interleaved (real, imaginary) pairs as in the Llama
+ * apply_rotary_emb. The rotated q is written to out, the rotated k to rows
+ * [start_pos, start_pos + seq_len) of k_cache and v to the same rows of
+ * v_cache, so neither rotated k nor v is materialized separately.
+ */
+Tensor& rope_update_cache_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    Tensor& k_cache,
+    Tensor& v_cache,
+    const int64_t start_pos,
+    Tensor& out);
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_rope_update_cache.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::Error;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+constexpr int32_t kBatch = 2;
+constexpr int32_t kHeads = 4;
+constexpr int32_t kKVHeads = 2;
+constexpr int32_t kMaxSeqLen = 16;
+
+std::vector<float> random_data(size_t n, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(n);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+  return data;
+}
+
+// Llama frequencies for positions [start_pos, start_pos + seq_len).
+void make_freqs(
+    int32_t start_pos,
+    int32_t seq_len,
+    int32_t head_dim,
+    std::vector<float>& cos,
+    std::vector<float>& sin) {
+  cos.clear();
+  sin.clear();
+  for (int32_t s = 0; s < seq_len; ++s) {
+    for (int32_t i = 0; i < head_dim / 2; ++i) {
+      const double freq = std::pow(10000.0, -2.0 * i / head_dim);
+      cos.push_back(static_cast<float>(std::cos((start_pos + s) * freq)));
+      sin.push_back(static_cast<float>(std::sin((start_pos + s) * freq)));
+    }
+  }
+}
+
+// apply_rotary_emb of examples/models/llama/rope.py, on [batch, seq_len,
+// heads, head_dim] data.
+std::vector<float> reference_rope(
+    const std::vector<float>& x,
+    const std::vector<float>& cos,
+    const std::vector<float>& sin,
+    int32_t seq_len,
+    int32_t heads,
+    int32_t head_dim) {
+  std::vector<float> out(x.size());
+  const int32_t half = head_dim / 2;
+  for (size_t row = 0; row < x.size() / head_dim; ++row) {
+    const int32_t s = (row / heads) % seq_len;
+    for (int32_t i = 0; i < half; ++i) {
+      const float re = x[row * head_dim + 2 * i];
+      const float im = x[row * head_dim + 2 * i + 1];
+      const float c = cos[s * half + i];
+      const float sn = sin[s * half + i];
+      out[row * head_dim + 2 * i] = re * c - im * sn;
+      out[row * head_dim + 2 * i + 1] = re * sn + im * c;
+    }
+  }
+  return out;
+}
+
+// Runs rope_update_cache on random inputs and checks every output against
+// rotating and copying separately.
+void expect_matches_reference(
+    int32_t start_pos,
+    int32_t seq_len,
+    int32_t head_dim) {
+  TensorFactory<ScalarType::Float> tf;
+  const std::vector<float> q_data =
+      random_data(kBatch * seq_len * kHeads * head_dim, 1);
+  const std::vector<float> k_data =
+      random_data(kBatch * seq_len * kKVHeads * head_dim, 2);
+  const std::vector<float> v_data =
+      random_data(kBatch * seq_len * kKVHeads * head_dim, 3);
+  const std::vector<float> cache_data =
+      random_data(kBatch * kMaxSeqLen * kKVHeads * head_dim, 4);
+  std::vector<float> cos, sin;
+  make_freqs(start_pos, seq_len, head_dim, cos, sin);
+
+  const std::vector<int32_t> kv_sizes = {kBatch, seq_len, kKVHeads, head_dim};
+  const std::vector<int32_t> cache_sizes = {
+      kBatch, kMaxSeqLen, kKVHeads, head_dim};
+  Tensor q = tf.make({kBatch, seq_len, kHeads, head_dim}, q_data);
+  Tensor k = tf.make(kv_sizes, k_data);
+  Tensor v = tf.make(kv_sizes, v_data);
+  Tensor freqs_cos = tf.make({seq_len, head_dim / 2}, cos);
+  Tensor freqs_sin = tf.make({seq_len, head_dim / 2}, sin);
+  Tensor k_cache = tf.make(cache_sizes, cache_data);
+  Tensor v_cache = tf.make(cache_sizes, cache_data);
+  Tensor out = tf.zeros({kBatch, seq_len, kHeads, head_dim});
+
+  KernelRuntimeContext context{};
+  torch::executor::native::rope_update_cache_out(
+      context, q, k, v, freqs_cos, freqs_sin, k_cache, v_cache, start_pos, out);
+  ASSERT_EQ(context.failure_state(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      out,
+      tf.make(
+          {kBatch, seq_len, kHeads, head_dim},
+          reference_rope(q_data, cos, sin, seq_len, kHeads, head_dim)));
+
+  const std::vector<float> k_rotated =
+      reference_rope(k_data, cos, sin, seq_len, kKVHeads, head_dim);
+  std::vector<float> expected_k_cache = cache_data;
+  std::vector<float> expected_v_cache = cache_data;
+  const int32_t row = kKVHeads * head_dim;
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t s = 0; s < seq_len; ++s) {
+      for (int32_t d = 0; d < row; ++d) {
+        const int32_t src = (b * seq_len + s) * row + d;
+        const int32_t dst = (b * kMaxSeqLen + start_pos + s) * row + d;
+        expected_k_cache[dst] = k_rotated[src];
+        expected_v_cache[dst] = v_data[src];
+      }
+    }
+  }
+  EXPECT_TENSOR_CLOSE(k_cache, tf.make(cache_sizes, expected_k_cache));
+  EXPECT_TENSOR_EQ(v_cache, tf.make(cache_sizes, expected_v_cache));
+}
+
+} // namespace
+
+TEST(OpRopeUpdateCacheTest, PrefillMatchesReference) {
+  expect_matches_reference(/*start_pos=*/0, /*seq_len=*/5, /*head_dim=*/64);
+}
+
+TEST(OpRopeUpdateCacheTest, DecodeMatchesReference) {
+  expect_matches_reference(/*start_pos=*/11, /*seq_len=*/1, /*head_dim=*/64);
+}
+
+TEST(OpRopeUpdateCacheTest, HeadDimWithScalarTail) {
+  // 20 pairs do not fill a whole number of vectors.
+  expect_matches_reference(/*start_pos=*/3, /*seq_len=*/4, /*head_dim=*/40);
+}
+
+TEST(OpRopeUpdateCacheTest, WriteBeyondCacheFails) {
+  TensorFactory<ScalarType::Float> tf;
+  Tensor q = tf.zeros({kBatch, 2, kHeads, 8});
+  Tensor k = tf.zeros({kBatch, 2, kKVHeads, 8});
+  Tensor v = tf.zeros({kBatch, 2, kKVHeads, 8});
+  Tensor freqs = tf.zeros({2, 4});
+  Tensor k_cache = tf.zeros({kBatch, kMaxSeqLen, kKVHeads, 8});
+  Tensor v_cache = tf.zeros({kBatch, kMaxSeqLen, kKVHeads, 8});
+  Tensor out = tf.zeros({kBatch, 2, kHeads, 8});
+
+  KernelRuntimeContext context{};
+  torch::executor::native::rope_update_cache_out(
+      context,
+      q,
+      k,
+      v,
+      freqs,
+      freqs,
+      k_cache,
+      v_cache,
+      kMaxSeqLen - 1,
+      out);
+  EXPECT_EQ(context.failure_state(), Error::InvalidArgument);
+}
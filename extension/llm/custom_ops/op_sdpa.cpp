@@ -8,6 +8,7 @@
 
 #include <executorch/extension/llm/custom_ops/op_sdpa.h>
 #include <executorch/extension/llm/custom_ops/op_sdpa_impl.h>
+#include <executorch/extension/llm/custom_ops/op_sdpa_tuning.h>
 
 #include <ATen/cpu/vec/functional.h>
 #include <ATen/cpu/vec/vec.h>
@@ -29,6 +30,11 @@ namespace native {
 
 namespace {
 
+// Packed int4 tensors hold two values of the last dim per byte.
+int64_t head_dim_of(const Tensor& t) {
+  return t.scalar_type() == ScalarType::Byte ? 2 * t.size(3) : t.size(3);
+}
+
 bool validate_flash_attention_args(
     const Tensor& query,
     const Tensor& key,
@@ -40,7 +46,8 @@ bool validate_flash_attention_args(
 
   // Sizes
   ET_CHECK_OR_RETURN_FALSE(
-      (query.size(3) == value.size(3)) && (key.size(3) == value.size(3)),
+      (query.size(3) == head_dim_of(value)) &&
+          (head_dim_of(key) == head_dim_of(value)),
       "scaled_dot_product_attention_flash_attention: Q/K/V should have the same head size");
 
   ET_CHECK_OR_RETURN_FALSE(
@@ -48,10 +55,19 @@ bool validate_flash_attention_args(
           (query.scalar_type() == ScalarType::Char),
       "Query must be Float type");
 
-  ET_CHECK_OR_RETURN_FALSE(
-      (query.scalar_type() == key.scalar_type()) &&
-          (query.scalar_type() == value.scalar_type()),
-      "Key and Value must have the same data type as Query");
+  if (query.scalar_type() == ScalarType::Char) {
+    ET_CHECK_OR_RETURN_FALSE(
+        (key.scalar_type() == ScalarType::Char ||
+         key.scalar_type() == ScalarType::Byte) &&
+            (value.scalar_type() == ScalarType::Char ||
+             value.scalar_type() == ScalarType::Byte),
+        "Key and Value must be int8, or int4 packed in uint8, if Query is int8");
+  } else {
+    ET_CHECK_OR_RETURN_FALSE(
+        (query.scalar_type() == key.scalar_type()) &&
+            (query.scalar_type() == value.scalar_type()),
+        "Key and Value must have the same data type as Query");
+  }
 
   ET_CHECK_OR_RETURN_FALSE(
       !attn_mask.has_value() || attn_mask.value().dim() == 2,
@@ -96,7 +112,9 @@ bool validate_cache_quant_params_args(
       "Quantized tensor and scales must have the same number of dimensions");
 
   ET_CHECK_OR_RETURN_FALSE(
-      (t.scalar_type() == ScalarType::Char), "Tensor must be of int8_t type");
+      (t.scalar_type() == ScalarType::Char) ||
+          (t.scalar_type() == ScalarType::Byte),
+      "Tensor must be of int8_t type, or int4 packed in uint8_t");
 
   ET_CHECK_OR_RETURN_FALSE(
       (t_scales.scalar_type() == ScalarType::Float),
@@ -126,6 +144,22 @@ bool validate_cache_quant_params_args(
     ;
   }
 
+  // The last dim of the qparams is the number of quantization groups.
+  const int64_t num_groups = t_scales.size(t.dim() - 1);
+  ET_CHECK_OR_RETURN_FALSE(
+      t_zero_points.size(t.dim() - 1) == num_groups,
+      "Scales and zero points must have the same number of groups");
+  ET_CHECK_OR_RETURN_FALSE(
+      num_groups > 0 && head_dim_of(t) % num_groups == 0,
+      "Number of quantization groups %" PRId64
+      " must divide the head dim %" PRId64,
+      num_groups,
+      head_dim_of(t));
+  ET_CHECK_OR_RETURN_FALSE(
+      t.scalar_type() != ScalarType::Byte ||
+          (head_dim_of(t) / num_groups) % 2 == 0,
+      "int4 quantization groups must have an even size");
+
   return true;
 }
 
@@ -178,6 +212,109 @@ bool validate_cache_params(
   return true;
 }
 
+bool validate_paged_kv_params(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const Tensor& block_table,
+    int64_t start_pos,
+    int64_t seq_length,
+    bool has_attn_mask) {
+  ET_CHECK_OR_RETURN_FALSE(
+      q.scalar_type() == ScalarType::Float,
+      "Paged SDPA only supports Float query and KV cache");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      k_cache.dim() == 4, "key cache pool must be a 4D tensor");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      k_cache.sizes() == v_cache.sizes(),
+      "key and value cache pools must have the same shape");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.dim() == 2,
+      "block_table must be a 2D tensor [batch_size, max_blocks_per_seq]");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.scalar_type() == ScalarType::Long,
+      "block_table must be of Long (int64_t) type");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.size(0) == q.size(0),
+      "block_table batch dimension (%zd) must match query batch size (%zd)",
+      block_table.size(0),
+      q.size(0));
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(
+          block_table.dim_order().data(), block_table.dim()),
+      "block_table must be in contiguous dim order");
+
+  const int64_t block_size = k_cache.size(1);
+  const int64_t capacity = block_table.size(1) * block_size;
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0 && start_pos + seq_length <= capacity,
+      "start_pos + seq_length must be at most the block table capacity."
+      "start pos: %" PRId64 ", seq_length: %" PRId64 ", capacity: %" PRId64,
+      start_pos,
+      seq_length,
+      capacity);
+
+  // With a mask every key up to the table capacity is read; otherwise only
+  // those before start_pos + seq_length.
+  const int64_t num_keys = has_attn_mask ? capacity : start_pos + seq_length;
+  const int64_t num_blocks_used = (num_keys + block_size - 1) / block_size;
+  const int64_t* table = block_table.const_data_ptr<int64_t>();
+  for (int64_t b = 0; b < block_table.size(0); ++b) {
+    for (int64_t blk = 0; blk < num_blocks_used; ++blk) {
+      const int64_t block = table[b * block_table.size(1) + blk];
+      ET_CHECK_OR_RETURN_FALSE(
+          block >= 0 && block < k_cache.size(0),
+          "block_table[%" PRId64 "][%" PRId64 "] = %" PRId64
+          " not in [0, %zd)",
+          b,
+          blk,
+          block,
+          k_cache.size(0));
+    }
+  }
+
+  return true;
+}
+
+bool validate_ring_kv_params(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    int64_t start_pos,
+    int64_t sink_size) {
+  ET_CHECK_OR_RETURN_FALSE(
+      q.scalar_type() == ScalarType::Float,
+      "Ring SDPA only supports Float query and KV cache");
+
+  ET_CHECK_OR_RETURN_FALSE(k_cache.dim() == 4, "key cache must be a 4D tensor");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      k_cache.sizes() == v_cache.sizes(),
+      "key and value caches must have the same shape");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      sink_size >= 0 && sink_size < k_cache.size(1),
+      "sink_size: %" PRId64 " must be in [0, %zd)",
+      sink_size,
+      k_cache.size(1));
+
+  // A longer chunk would overwrite its own keys before attending to them.
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0 && q.size(1) <= k_cache.size(1) - sink_size,
+      "seq_length: %zd must be at most the ring window: %zd, start_pos: %" PRId64,
+      q.size(1),
+      k_cache.size(1) - sink_size,
+      start_pos);
+
+  return true;
+}
+
 // TODO: seq_length is not yet used for copy
 void update_cache(
     const Tensor& projected_value,
@@ -264,62 +401,37 @@ Tensor& flash_attention_kernel_out(
       InvalidArgument,
       output);
 
-  auto seq_len = query.size(2);
-
   ET_SWITCH_FLOAT_TYPES(
       query.scalar_type(), ctx, "flash_attention", CTYPE, [&] {
-        // TODO we need to re-evaluate this for ARM CPUs
-        // And there can be many so instead of templatizing
-        // we might consider another appraoch
-        if (seq_len >= 768) {
-          sdpa::impl::cpu_flash_attention<CTYPE, 256, 512>(
-              output,
-              query,
-              key,
-              value,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt);
-        } else if (seq_len >= 192) {
-          sdpa::impl::cpu_flash_attention<CTYPE, 64, 512>(
-              output,
-              query,
-              key,
-              value,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt);
-        } else {
-          sdpa::impl::cpu_flash_attention<CTYPE, 32, 512>(
-              output,
-              query,
-              key,
-              value,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt,
-              nullopt);
-        }
+        const sdpa::tuning::ProblemShape shape{
+            query.size(0) * query.size(1),
+            query.size(2),
+            key.size(2),
+            query.size(3),
+            sizeof(CTYPE)};
+        auto run = [&](size_t tile_config) {
+          sdpa::tuning::dispatch_tile_config(tile_config, [&](auto tile) {
+            sdpa::impl::cpu_flash_attention<
+                CTYPE,
+                decltype(tile)::q_split_size,
+                decltype(tile)::kv_split_size>(
+                output,
+                query,
+                key,
+                value,
+                dropout_p,
+                is_causal,
+                attn_mask,
+                scale,
+                nullopt,
+                nullopt,
+                nullopt,
+                nullopt,
+                nullopt,
+                nullopt);
+          });
+        };
+        run(sdpa::tuning::select_tile_config(shape, run));
       });
   return output;
 }
@@ -342,7 +454,9 @@ Tensor& custom_sdpa_out_impl(
     const optional<Tensor>& k_scales = nullopt,
     const optional<Tensor>& v_zero_points = nullopt,
     const optional<Tensor>& v_scales = nullopt,
-    bool is_seq_at_dim_2 = false) {
+    bool is_seq_at_dim_2 = false,
+    const sdpa::impl::PagedKVBlockTable* paged_kv = nullptr,
+    const sdpa::impl::RingKVWindow* ring_kv = nullptr) {
   ET_KERNEL_CHECK_MSG(
       ctx,
       !attn_mask.has_value() || !is_causal,
@@ -371,7 +485,7 @@ Tensor& custom_sdpa_out_impl(
         ctx,
         q_scales.has_value() && q_zero_points.has_value() &&
             k_scales.has_value() && k_zero_points.has_value() &&
-            q_scales.has_value() && q_zero_points.has_value(),
+            v_scales.has_value() && v_zero_points.has_value(),
         InvalidArgument,
         output,
         "If q is quantized, k and v must be quantized as well");
@@ -382,6 +496,12 @@ Tensor& custom_sdpa_out_impl(
         InvalidArgument,
         output,
         "Invalid arguments for quantized query");
+    ET_KERNEL_CHECK_MSG(
+        ctx,
+        q_scales.value().size(q.dim() - 1) == 1,
+        InvalidArgument,
+        output,
+        "Quantized query must have one scale per token");
     ET_KERNEL_CHECK_MSG(
         ctx,
         validate_cache_quant_params_args(
@@ -401,7 +521,7 @@ Tensor& custom_sdpa_out_impl(
   ET_CHECK_MSG(q.dim() == 4, "query must be a 4D tensor");
 
   const int64_t num_keys_for_causal_attention =
-      attn_mask.has_value() ? -1 : start_pos + seq_len;
+      attn_mask.has_value() || ring_kv != nullptr ? -1 : start_pos + seq_len;
 
   ET_KERNEL_CHECK(
       ctx,
@@ -409,71 +529,49 @@ Tensor& custom_sdpa_out_impl(
       InvalidArgument,
       output);
 
-  // TODO(task): replace the template param selection logic
-  // with whatever apprpriately makes more sense for
+  const int64_t num_heads = seq_dim == SeqDim::ONE ? q.size(2) : q.size(1);
+  const int64_t q_len = seq_dim == SeqDim::ONE ? q.size(1) : q.size(2);
+  int64_t kv_len = seq_dim == SeqDim::ONE ? k.size(1) : k.size(2);
+  if (num_keys_for_causal_attention > 0) {
+    kv_len = num_keys_for_causal_attention;
+  } else if (paged_kv != nullptr) {
+    kv_len = paged_kv->max_blocks_per_seq * paged_kv->block_size;
+  } else if (ring_kv != nullptr) {
+    kv_len = std::min(kv_len, ring_kv->num_tokens);
+  }
+
   ET_SWITCH_FLOAT_TYPES(
       output.scalar_type(), ctx, "flash_attention", CTYPE, [&] {
-        // TODO we need to re-evaluate this for ARM CPUs
-        // And there can be many so instead of templatizing
-        // we might consider another appraoch
-        if (seq_len >= 768) {
-          sdpa::impl::cpu_flash_attention<CTYPE, 256, 512>(
-              output,
-              q,
-              k,
-              v,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              q_zero_points, // q_zero_points
-              q_scales, // q_scales
-              k_zero_points, // k_zero_points
-              k_scales, // k_scales
-              v_zero_points, // v_zero_points
-              v_scales, // v_scales
-              seq_dim, /* seq_dim */
-              start_pos,
-              num_keys_for_causal_attention);
-        } else if (seq_len >= 192) {
-          sdpa::impl::cpu_flash_attention<CTYPE, 64, 512>(
-              output,
-              q,
-              k,
-              v,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              q_zero_points, // q_zero_points
-              q_scales, // q_scales
-              k_zero_points, // k_zero_points
-              k_scales, // k_scales
-              v_zero_points, // v_zero_points
-              v_scales, // v_scales
-              seq_dim, /* seq_dim */
-              start_pos,
-              num_keys_for_causal_attention);
-        } else {
-          sdpa::impl::cpu_flash_attention<CTYPE, 32, 512>(
-              output,
-              q,
-              k,
-              v,
-              dropout_p,
-              is_causal,
-              attn_mask,
-              scale,
-              q_zero_points, // q_zero_points
-              q_scales, // q_scales
-              k_zero_points, // k_zero_points
-              k_scales, // k_scales
-              v_zero_points, // v_zero_points
-              v_scales, // v_scales
-              seq_dim, /* seq_dim */
-              start_pos,
-              num_keys_for_causal_attention);
-        }
+        const sdpa::tuning::ProblemShape shape{
+            q.size(0) * num_heads, q_len, kv_len, q.size(3), sizeof(CTYPE)};
+        auto run = [&](size_t tile_config) {
+          sdpa::tuning::dispatch_tile_config(tile_config, [&](auto tile) {
+            sdpa::impl::cpu_flash_attention<
+                CTYPE,
+                decltype(tile)::q_split_size,
+                decltype(tile)::kv_split_size>(
+                output,
+                q,
+                k,
+                v,
+                dropout_p,
+                is_causal,
+                attn_mask,
+                scale,
+                q_zero_points, // q_zero_points
+                q_scales, // q_scales
+                k_zero_points, // k_zero_points
+                k_scales, // k_scales
+                v_zero_points, // v_zero_points
+                v_scales, // v_scales
+                seq_dim, /* seq_dim */
+                start_pos,
+                num_keys_for_causal_attention,
+                paged_kv,
+                ring_kv);
+          });
+        };
+        run(sdpa::tuning::select_tile_config(shape, run));
       });
   return output;
 }
@@ -547,6 +645,130 @@ Tensor& custom_sdpa_out(
   return custom_sdpa_out_impl(
       ctx, q, k, v, start_pos, attn_mask, dropout_p, is_causal, scale, output);
 }
+/*
+  Input params
+  @param[in] q Query. Format [batch size, seq_len, num heads, head dim]
+  @param[in] k_cache Pool of key cache blocks.
+  Format [num blocks, block size, num kv heads, head dim]
+  @param[in] v_cache Pool of value cache blocks, same format as k_cache.
+  @param[in] start_pos: sequence position
+  @param[in] block_table Pool blocks of each sequence, in order.
+  Format [batch size, max blocks per seq], int64
+  ....
+  Same as custom_sdpa, except that keys and values are gathered through
+  block_table instead of being read from one contiguous cache per sequence.
+*/
+Tensor& custom_sdpa_paged_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    const optional<Tensor>& attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  ET_KERNEL_CHECK_MSG(
+      ctx, q.dim() == 4, InvalidArgument, output, "query must be a 4D tensor");
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_paged_kv_params(
+          q,
+          k_cache,
+          v_cache,
+          block_table,
+          start_pos,
+          q.size(1),
+          attn_mask.has_value()),
+      InvalidArgument,
+      output);
+
+  const sdpa::impl::PagedKVBlockTable paged_kv{
+      block_table.const_data_ptr<int64_t>(),
+      block_table.size(1),
+      k_cache.size(1),
+      block_table.size(1)};
+  return custom_sdpa_out_impl(
+      ctx,
+      q,
+      k_cache,
+      v_cache,
+      start_pos,
+      attn_mask,
+      dropout_p,
+      is_causal,
+      scale,
+      output,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      false,
+      &paged_kv);
+}
+
+/*
+  Input params
+  @param[in] q Query. Format [batch size, seq_len, num heads, head dim]
+  @param[in] k_cache Ring-buffer key cache written by update_cache_ring.
+  Format [batch size, sink_size + window_size, num kv heads, head dim]
+  @param[in] v_cache Ring-buffer value cache, same format as k_cache.
+  @param[in] start_pos: sequence position of the first query token
+  @param[in] sink_size Number of leading tokens pinned in the cache.
+  ....
+  Causal attention by absolute position over whatever the ring holds: query
+  token p attends to the sink tokens and to the cached tokens at positions up
+  to p. Keys are expected to have been rotated at their absolute positions,
+  so nothing is shifted or re-rotated when the ring wraps around.
+*/
+Tensor& custom_sdpa_ring_out(
+    RuntimeContext& ctx,
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    const double dropout_p,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  ET_KERNEL_CHECK_MSG(
+      ctx, q.dim() == 4, InvalidArgument, output, "query must be a 4D tensor");
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_ring_kv_params(q, k_cache, v_cache, start_pos, sink_size),
+      InvalidArgument,
+      output);
+
+  const sdpa::impl::RingKVWindow ring_kv{
+      sink_size, k_cache.size(1) - sink_size, start_pos + q.size(1)};
+  return custom_sdpa_out_impl(
+      ctx,
+      q,
+      k_cache,
+      v_cache,
+      start_pos,
+      nullopt,
+      dropout_p,
+      false,
+      scale,
+      output,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      nullopt,
+      false,
+      nullptr,
+      &ring_kv);
+}
+
 /*
   Input params
   @param[in] q_projected Projected query with query weights.
@@ -622,3 +844,13 @@ EXECUTORCH_LIBRARY(
     llama,
     "custom_quantized_sdpa.out",
     torch::executor::native::custom_quantized_sdpa_out);
+
+EXECUTORCH_LIBRARY(
+    llama,
+    "custom_sdpa_paged.out",
+    torch::executor::native::custom_sdpa_paged_out);
+
+EXECUTORCH_LIBRARY(
+    llama,
+    "custom_sdpa_ring.out",
+    torch::executor::native::custom_sdpa_ring_out);
@@ -8,6 +8,7 @@
 
 #include <executorch/extension/aten_util/make_aten_functor_from_et_functor.h>
 #include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
+#include <executorch/extension/llm/custom_ops/op_rope_update_cache.h>
 #include <executorch/extension/llm/custom_ops/op_sdpa.h>
 #include <executorch/extension/llm/custom_ops/op_update_cache.h>
 
@@ -118,6 +119,56 @@ at::Tensor custom_quantized_sdpa_aten(
     const std::optional<at::Tensor>& v_scales,
     const bool is_seq_at_dim_2);
 
+Tensor& custom_sdpa_paged_out_no_context(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+at::Tensor custom_sdpa_paged_aten(
+    const at::Tensor& q,
+    const at::Tensor& k_cache,
+    const at::Tensor& v_cache,
+    const int64_t start_pos,
+    const at::Tensor& block_table,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<at::Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale);
+
+Tensor& custom_sdpa_ring_out_no_context(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    const double dropout_p,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output);
+
+at::Tensor custom_sdpa_ring_aten(
+    const at::Tensor& q,
+    const at::Tensor& k_cache,
+    const at::Tensor& v_cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    const double dropout_p,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale);
+
 Tensor& update_cache_out_no_context(
     const Tensor& value,
     Tensor& cache,
@@ -143,6 +194,53 @@ at::Tensor update_cache_with_indices_aten(
     const int64_t start_pos,
     const at::Tensor& indices);
 
+Tensor& update_cache_paged_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    Tensor& output);
+
+at::Tensor update_cache_paged_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const at::Tensor& block_table);
+
+Tensor& update_cache_ring_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output);
+
+at::Tensor update_cache_ring_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size);
+
+Tensor& rope_update_cache_out_no_context(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    Tensor& k_cache,
+    Tensor& v_cache,
+    const int64_t start_pos,
+    Tensor& output);
+
+at::Tensor rope_update_cache_aten(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& v,
+    const at::Tensor& freqs_cos,
+    const at::Tensor& freqs_sin,
+    at::Tensor& k_cache,
+    at::Tensor& v_cache,
+    const int64_t start_pos);
+
 Tensor& sdpa_with_kv_cache_out_no_context(
     const Tensor& q_projected,
     const Tensor& k_projected,
@@ -334,6 +432,101 @@ at::Tensor custom_quantized_sdpa_aten(
   return output;
 }
 
+Tensor& custom_sdpa_paged_out_no_context(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::custom_sdpa_paged_out(
+      context,
+      q,
+      k_cache,
+      v_cache,
+      start_pos,
+      block_table,
+      attn_mask,
+      dropout_p,
+      is_causal,
+      scale,
+      output);
+}
+
+at::Tensor custom_sdpa_paged_aten(
+    const at::Tensor& q,
+    const at::Tensor& k_cache,
+    const at::Tensor& v_cache,
+    const int64_t start_pos,
+    const at::Tensor& block_table,
+    // @lint-ignore CLANGTIDY facebook-hte-ConstantArgumentPassByValue
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<at::Tensor> attn_mask,
+    const double dropout_p,
+    const bool is_causal,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale) {
+  auto output = at::empty(q.sizes());
+  WRAP_TO_ATEN(custom_sdpa_paged_out_no_context, 9)
+  (q,
+   k_cache,
+   v_cache,
+   start_pos,
+   block_table,
+   attn_mask,
+   dropout_p,
+   is_causal,
+   scale,
+   output);
+  return output;
+}
+
+Tensor& custom_sdpa_ring_out_no_context(
+    const Tensor& q,
+    const Tensor& k_cache,
+    const Tensor& v_cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    const double dropout_p,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const optional<double> scale,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::custom_sdpa_ring_out(
+      context,
+      q,
+      k_cache,
+      v_cache,
+      start_pos,
+      sink_size,
+      dropout_p,
+      scale,
+      output);
+}
+
+at::Tensor custom_sdpa_ring_aten(
+    const at::Tensor& q,
+    const at::Tensor& k_cache,
+    const at::Tensor& v_cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    const double dropout_p,
+    // @lint-ignore CLANGTIDY facebook-hte-ParameterMightThrowOnCopy
+    const std::optional<double> scale) {
+  auto output = at::empty(q.sizes());
+  WRAP_TO_ATEN(custom_sdpa_ring_out_no_context, 7)
+  (q, k_cache, v_cache, start_pos, sink_size, dropout_p, scale, output);
+  return output;
+}
+
 Tensor& update_cache_out_no_context(
     const Tensor& value,
     Tensor& cache,
@@ -377,6 +570,89 @@ at::Tensor update_cache_with_indices_aten(
   return output;
 }
 
+Tensor& update_cache_paged_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::update_cache_paged_out(
+      context, value, cache, start_pos, block_table, output);
+}
+
+at::Tensor update_cache_paged_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const at::Tensor& block_table) {
+  auto output = at::empty({1});
+  WRAP_TO_ATEN(update_cache_paged_out_no_context, 4)
+  (value, cache, start_pos, block_table, output);
+  return output;
+}
+
+Tensor& update_cache_ring_out_no_context(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::update_cache_ring_out(
+      context, value, cache, start_pos, sink_size, output);
+}
+
+at::Tensor update_cache_ring_aten(
+    const at::Tensor& value,
+    at::Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size) {
+  auto output = at::empty({1});
+  WRAP_TO_ATEN(update_cache_ring_out_no_context, 4)
+  (value, cache, start_pos, sink_size, output);
+  return output;
+}
+
+Tensor& rope_update_cache_out_no_context(
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v,
+    const Tensor& freqs_cos,
+    const Tensor& freqs_sin,
+    Tensor& k_cache,
+    Tensor& v_cache,
+    const int64_t start_pos,
+    Tensor& output) {
+  executorch::aten::RuntimeContext context{};
+  return torch::executor::native::rope_update_cache_out(
+      context,
+      q,
+      k,
+      v,
+      freqs_cos,
+      freqs_sin,
+      k_cache,
+      v_cache,
+      start_pos,
+      output);
+}
+
+at::Tensor rope_update_cache_aten(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& v,
+    const at::Tensor& freqs_cos,
+    const at::Tensor& freqs_sin,
+    at::Tensor& k_cache,
+    at::Tensor& v_cache,
+    const int64_t start_pos) {
+  auto output = at::empty(q.sizes(), q.options());
+  WRAP_TO_ATEN(rope_update_cache_out_no_context, 8)
+  (q, k, v, freqs_cos, freqs_sin, k_cache, v_cache, start_pos, output);
+  return output;
+}
+
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -410,6 +686,43 @@ TORCH_LIBRARY_FRAGMENT(llama, m) {
   m.def(
       "update_cache_with_indices.out(Tensor value, Tensor(a!) cache, "
       "SymInt start_pos, Tensor indices, *, Tensor(b!) out) -> Tensor(b!)");
+  m.def(
+      "update_cache_paged(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, Tensor block_table) -> Tensor");
+  m.def(
+      "update_cache_paged.out(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, Tensor block_table, *, Tensor(b!) out) -> Tensor(b!)");
+  m.def(
+      "update_cache_ring(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, int sink_size) -> Tensor");
+  m.def(
+      "update_cache_ring.out(Tensor value, Tensor(a!) cache, "
+      "SymInt start_pos, int sink_size, *, Tensor(b!) out) -> Tensor(b!)");
+  m.def(
+      "rope_update_cache(Tensor q, Tensor k, Tensor v, Tensor freqs_cos, "
+      "Tensor freqs_sin, Tensor(a!) k_cache, Tensor(b!) v_cache, "
+      "SymInt start_pos) -> Tensor");
+  m.def(
+      "rope_update_cache.out(Tensor q, Tensor k, Tensor v, Tensor freqs_cos, "
+      "Tensor freqs_sin, Tensor(a!) k_cache, Tensor(b!) v_cache, "
+      "SymInt start_pos, *, Tensor(c!) out) -> Tensor(c!)");
+  m.def(
+      "custom_sdpa_paged(Tensor query, Tensor key_cache, Tensor value_cache, "
+      "SymInt start_pos, Tensor block_table, Tensor? attn_mask=None, "
+      "float drpout_p=0.0, bool is_causal=False, float? scale=None) -> Tensor");
+  m.def(
+      "custom_sdpa_paged.out(Tensor query, Tensor key_cache, Tensor value_cache, "
+      "SymInt start_pos, Tensor block_table, Tensor? attn_mask=None, "
+      "float drpout_p=0.0, bool is_causal=False, float? scale=None, *, "
+      "Tensor(a!) out) -> Tensor(a!)");
+  m.def(
+      "custom_sdpa_ring(Tensor query, Tensor key_cache, Tensor value_cache, "
+      "SymInt start_pos, int sink_size, float drpout_p=0.0, "
+      "float? scale=None) -> Tensor");
+  m.def(
+      "custom_sdpa_ring.out(Tensor query, Tensor key_cache, Tensor value_cache, "
+      "SymInt start_pos, int sink_size, float drpout_p=0.0, "
+      "float? scale=None, *, Tensor(a!) out) -> Tensor(a!)");
   m.def(
       "custom_quantized_sdpa(Tensor query, Tensor key, Tensor value, SymInt start_pos, "
       "Tensor? attn_mask=None, float drpout_p=0.0, bool is_causal=False, "
@@ -448,6 +761,33 @@ TORCH_LIBRARY_IMPL(llama, CompositeExplicitAutograd, m) {
       WRAP_TO_ATEN(
           torch::executor::native::update_cache_with_indices_out_no_context,
           4));
+  m.impl(
+      "update_cache_paged", torch::executor::native::update_cache_paged_aten);
+  m.impl(
+      "update_cache_paged.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::update_cache_paged_out_no_context, 4));
+  m.impl(
+      "update_cache_ring", torch::executor::native::update_cache_ring_aten);
+  m.impl(
+      "update_cache_ring.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::update_cache_ring_out_no_context, 4));
+  m.impl("rope_update_cache", torch::executor::native::rope_update_cache_aten);
+  m.impl(
+      "rope_update_cache.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::rope_update_cache_out_no_context, 8));
+  m.impl("custom_sdpa_paged", torch::executor::native::custom_sdpa_paged_aten);
+  m.impl(
+      "custom_sdpa_paged.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::custom_sdpa_paged_out_no_context, 9));
+  m.impl("custom_sdpa_ring", torch::executor::native::custom_sdpa_ring_aten);
+  m.impl(
+      "custom_sdpa_ring.out",
+      WRAP_TO_ATEN(
+          torch::executor::native::custom_sdpa_ring_out_no_context, 7));
   m.impl(
       "custom_quantized_sdpa",
       torch::executor::native::custom_quantized_sdpa_aten);
@@ -16,8 +16,13 @@
 // @lint-ignore CLANGTIDY facebook-unused-include-check
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
 
+#include <algorithm>
 #include <vector>
 
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+#include <immintrin.h>
+#endif
+
 #ifdef ET_USE_THREADPOOL
 #include <executorch/extension/threadpool/threadpool.h>
 #include <executorch/runtime/kernel/thread_parallel_interface.h>
@@ -35,6 +40,13 @@ enum class SeqDim { ONE = 1, TWO };
 
 namespace sdpa::impl {
 
+/**
+ * A float matrix, or a quantized one with a scale and zero point per row, or
+ * per group of group_size consecutive columns of a row. Quantized data is
+ * int8 (ScalarType::Char) or int4 packed two per byte (ScalarType::Byte),
+ * with the even column in the low nibble. int4 values are unsigned, so a
+ * symmetric int4 group has zero point 8.
+ */
 struct MaybeQuantizedMatrixData {
   const void* data{nullptr};
   const int8_t* zero_points{nullptr};
@@ -43,6 +55,7 @@ struct MaybeQuantizedMatrixData {
   const int64_t zero_points_stride{1};
   const int64_t scales_stride{1};
   ScalarType dtype{ScalarType::Float};
+  int64_t group_size = 0;
   MaybeQuantizedMatrixData() = default;
   MaybeQuantizedMatrixData(
       const void* data_,
@@ -51,7 +64,8 @@ struct MaybeQuantizedMatrixData {
       int64_t m_,
       int64_t n_,
       int64_t qparams_stride,
-      ScalarType dtype_)
+      ScalarType dtype_,
+      int64_t group_size_ = 0)
       : data(data_),
         zero_points(zero_points_),
         scales(scales_),
@@ -59,9 +73,156 @@ struct MaybeQuantizedMatrixData {
         n(n_),
         zero_points_stride(qparams_stride),
         scales_stride(qparams_stride),
-        dtype(dtype_) {}
+        dtype(dtype_),
+        group_size(group_size_ > 0 ? group_size_ : n_) {}
+
+  bool is_per_row_int8() const {
+    return dtype == ScalarType::Char && group_size == n;
+  }
 };
 
+// Unpacks n (even) int4 values, stored two per byte with the even index in
+// the low nibble, into one int8 each.
+inline void unpack_int4(const uint8_t* in, int8_t* out, int64_t n) {
+  int64_t i = 0;
+#if defined(__aarch64__) || defined(__ARM_NEON)
+  const uint8x16_t low_mask = vdupq_n_u8(0x0F);
+  for (; i + 32 <= n; i += 32) {
+    const uint8x16_t packed = vld1q_u8(in + i / 2);
+    const uint8x16x2_t unpacked =
+        vzipq_u8(vandq_u8(packed, low_mask), vshrq_n_u8(packed, 4));
+    vst1q_s8(out + i, vreinterpretq_s8_u8(unpacked.val[0]));
+    vst1q_s8(out + i + 16, vreinterpretq_s8_u8(unpacked.val[1]));
+  }
+#endif
+  for (; i < n; i += 2) {
+    out[i] = static_cast<int8_t>(in[i / 2] & 0x0F);
+    out[i + 1] = static_cast<int8_t>(in[i / 2] >> 4);
+  }
+}
+
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+inline int32_t _reduce_add_epi32(__m256i v) {
+  __m128i sum = _mm_add_epi32(
+      _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+// Returns sum(a[i] * b[i]) over n int8 values, using the int8 dot product
+// instructions (SDOT, VNNI) where the target has them.
+inline int32_t int8_dot(const int8_t* a, const int8_t* b, int64_t n) {
+  int64_t i = 0;
+  int32_t dot = 0;
+#if defined(__ARM_FEATURE_DOTPROD)
+  int32x4_t dot_vec = vdupq_n_s32(0);
+  for (; i + 16 <= n; i += 16) {
+    dot_vec = vdotq_s32(dot_vec, vld1q_s8(a + i), vld1q_s8(b + i));
+  }
+  dot = vaddvq_s32(dot_vec);
+#elif defined(__AVX512VNNI__) && defined(__AVX512VL__)
+  // vpdpbusd multiplies unsigned by signed bytes. Flipping the sign bit of a
+  // adds 128 to it, so sum(a * b) = sum((a ^ 0x80) * b) - sum(128 * b).
+  const __m256i sign = _mm256_set1_epi8(static_cast<char>(0x80));
+  __m256i dot_vec = _mm256_setzero_si256();
+  __m256i offset_vec = _mm256_setzero_si256();
+  for (; i + 32 <= n; i += 32) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    dot_vec = _mm256_dpbusd_epi32(dot_vec, _mm256_xor_si256(va, sign), vb);
+    offset_vec = _mm256_dpbusd_epi32(offset_vec, sign, vb);
+  }
+  dot = _reduce_add_epi32(dot_vec) - _reduce_add_epi32(offset_vec);
+#endif
+  for (; i < n; ++i) {
+    dot += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+  }
+  return dot;
+}
+
+inline int32_t int8_sum(const int8_t* a, int64_t n) {
+  int32_t sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    sum += a[i];
+  }
+  return sum;
+}
+
+// Row j of a quantized matrix as int8, unpacking int4 rows into buf.
+inline const int8_t* quantized_row(
+    const MaybeQuantizedMatrixData& data,
+    int64_t stride,
+    int64_t j,
+    int8_t* buf) {
+  if (data.dtype == ScalarType::Byte) {
+    unpack_int4(
+        static_cast<const uint8_t*>(data.data) + j * stride, buf, data.n);
+    return buf;
+  }
+  return static_cast<const int8_t*>(data.data) + j * stride;
+}
+
+/**
+ * qk = q @ k.T for q quantized per row and k quantized per row or per group,
+ * int8 or int4, without dequantizing either. With x = q - q_zp and
+ * y = k - k_zp, the sum of x * y over a group is
+ *   sum(q * k) - k_zp * sum(q) - q_zp * sum(k) + group_size * q_zp * k_zp,
+ * so only sum(q * k) is computed per (q row, k row) pair, in int32, and each
+ * group is rescaled once.
+ */
+inline void quantized_q_at_k_gemm(
+    const int64_t q_m,
+    const int64_t k_n,
+    const int64_t qk_k,
+    const MaybeQuantizedMatrixData& q_data,
+    const int64_t q_stride_m,
+    const MaybeQuantizedMatrixData& k_data,
+    const int64_t k_stride_n,
+    float* qk_data) {
+  const int64_t group_size = k_data.group_size;
+  const int64_t num_groups = qk_k / group_size;
+  const int8_t* q = static_cast<const int8_t*>(q_data.data);
+  std::vector<int32_t> q_group_sums(q_m * num_groups);
+  for (int64_t i = 0; i < q_m; ++i) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      q_group_sums[i * num_groups + g] =
+          int8_sum(q + i * q_stride_m + g * group_size, group_size);
+    }
+  }
+  std::vector<int32_t> k_group_sums(num_groups);
+  std::vector<int8_t> k_buf(k_data.dtype == ScalarType::Byte ? qk_k : 0);
+  for (int64_t j = 0; j < k_n; ++j) {
+    const int8_t* k_row = quantized_row(k_data, k_stride_n, j, k_buf.data());
+    const float* k_scales = k_data.scales + j * k_data.scales_stride;
+    const int8_t* k_zero_points =
+        k_data.zero_points + j * k_data.zero_points_stride;
+    for (int64_t g = 0; g < num_groups; ++g) {
+      k_group_sums[g] = int8_sum(k_row + g * group_size, group_size);
+    }
+    for (int64_t i = 0; i < q_m; ++i) {
+      const int8_t* q_row = q + i * q_stride_m;
+      const int32_t q_zero_point =
+          q_data.zero_points[i * q_data.zero_points_stride];
+      float acc = 0;
+      for (int64_t g = 0; g < num_groups; ++g) {
+        const int8_t* q_group = q_row + g * group_size;
+        const int8_t* k_group = k_row + g * group_size;
+        const int32_t k_zero_point = k_zero_points[g];
+        const int32_t dot = int8_dot(q_group, k_group, group_size) -
+            k_zero_point * q_group_sums[i * num_groups + g] -
+            q_zero_point * k_group_sums[g] +
+            static_cast<int32_t>(group_size) * q_zero_point * k_zero_point;
+        acc += k_scales[g] * static_cast<float>(dot);
+      }
+      qk_data[i * k_n + j] = acc * q_data.scales[i * q_data.scales_stride];
+    }
+  }
+}
+
 template <typename accum_t>
 void _q_at_k_gemm(
     const int64_t q_m,
@@ -72,12 +233,20 @@ void _q_at_k_gemm(
     const MaybeQuantizedMatrixData& k_data,
     const int64_t k_stride_n,
     accum_t* qk_data) {
-  ET_CHECK_MSG(q_data.dtype == k_data.dtype, "q and k must have same dtype");
   ET_CHECK_MSG(
-      q_data.dtype == ScalarType::Char || q_data.dtype == ScalarType::Float,
-      "q and k must be either int8 or float");
+      (q_data.dtype == ScalarType::Float &&
+       k_data.dtype == ScalarType::Float) ||
+          (q_data.dtype == ScalarType::Char &&
+           (k_data.dtype == ScalarType::Char ||
+            k_data.dtype == ScalarType::Byte)),
+      "q and k must be either float, or int8 and int8 or int4");
   if (q_data.dtype == ScalarType::Char) {
     if constexpr (std::is_same<accum_t, float>::value) {
+      if (!k_data.is_per_row_int8()) {
+        quantized_q_at_k_gemm(
+            q_m, k_n, qk_k, q_data, q_stride_m, k_data, k_stride_n, qk_data);
+        return;
+      }
       int a_stride_m_tmp, b_stride_n_tmp;
       auto kernel = torchao::kernels::cpu::quantized_matmul::
           get_int8_a_int8_b_channelwise_qmatmul(
@@ -215,21 +384,39 @@ void dequant_and_gemm(
     const int64_t o_stride_m,
     const float beta) {
   std::vector<float> dequantized_v_data(v_data.m * v_data.n);
-  dequantize_per_channel_optimized(
-      static_cast<const int8_t*>(v_data.data),
-      static_cast<const float*>(v_data.scales),
-      static_cast<const int8_t*>(v_data.zero_points),
-      dequantized_v_data.data(),
-      -128,
-      127,
-      1,
-      0,
-      0,
-      v_data.m,
-      v_stride_n,
-      v_data.n,
-      v_data.n,
-      v_data.zero_points_stride);
+  if (v_data.is_per_row_int8()) {
+    dequantize_per_channel_optimized(
+        static_cast<const int8_t*>(v_data.data),
+        static_cast<const float*>(v_data.scales),
+        static_cast<const int8_t*>(v_data.zero_points),
+        dequantized_v_data.data(),
+        -128,
+        127,
+        1,
+        0,
+        0,
+        v_data.m,
+        v_stride_n,
+        v_data.n,
+        v_data.n,
+        v_data.zero_points_stride);
+  } else {
+    const int64_t num_groups = v_data.n / v_data.group_size;
+    std::vector<int8_t> v_buf(v_data.dtype == ScalarType::Byte ? v_data.n : 0);
+    for (int64_t j = 0; j < v_data.m; ++j) {
+      const int8_t* v_row = quantized_row(v_data, v_stride_n, j, v_buf.data());
+      for (int64_t g = 0; g < num_groups; ++g) {
+        dequantize_optimized(
+            v_row + g * v_data.group_size,
+            v_data.scales[j * v_data.scales_stride + g],
+            v_data.zero_points[j * v_data.zero_points_stride + g],
+            dequantized_v_data.data() + j * v_data.n + g * v_data.group_size,
+            -128,
+            127,
+            v_data.group_size);
+      }
+    }
+  }
   ::executorch::cpublas::gemm(
       ::executorch::cpublas::TransposeType::NoTranspose,
       ::executorch::cpublas::TransposeType::NoTranspose,
@@ -246,6 +433,70 @@ void dequant_and_gemm(
       o_stride_m);
 }
 
+/**
+ * o = beta * o + p @ v for v quantized per row or per group, int8 or int4,
+ * without materializing the dequantized v block. Each row of v is converted
+ * once, a chunk of a group at a time, to (v - zero_point) in a small buffer;
+ * the group scale is folded into the weight p[i][j], so the update of every
+ * output row is an axpy. Rows with zero weight, e.g. masked out keys, are
+ * skipped.
+ */
+inline void quantized_qk_at_v_gemm(
+    const int64_t m,
+    const int64_t n,
+    const int64_t k,
+    const float* qk_data,
+    const int64_t qk_stride_m,
+    const MaybeQuantizedMatrixData& v_data,
+    const int64_t v_stride_n,
+    float* o_data,
+    const int64_t o_stride_m,
+    const float beta) {
+  using Vec = ::at::vec::Vectorized<float>;
+  for (int64_t i = 0; i < m; ++i) {
+    float* o_row = o_data + i * o_stride_m;
+    if (beta == 0) {
+      std::fill(o_row, o_row + n, 0.0f);
+    } else if (beta != 1) {
+      ::at::vec::map<float>(
+          [beta](Vec x) { return x * Vec(beta); }, o_row, o_row, n);
+    }
+  }
+  constexpr int64_t kChunkSize = 64;
+  float v_chunk[kChunkSize];
+  const int64_t group_size = v_data.group_size;
+  const int64_t num_groups = n / group_size;
+  std::vector<int8_t> v_buf(v_data.dtype == ScalarType::Byte ? n : 0);
+  for (int64_t j = 0; j < k; ++j) {
+    const int8_t* v_row = quantized_row(v_data, v_stride_n, j, v_buf.data());
+    for (int64_t g = 0; g < num_groups; ++g) {
+      const float scale = v_data.scales[j * v_data.scales_stride + g];
+      const int8_t zero_point =
+          v_data.zero_points[j * v_data.zero_points_stride + g];
+      for (int64_t c = g * group_size; c < (g + 1) * group_size;
+           c += kChunkSize) {
+        const int64_t chunk_size =
+            std::min(kChunkSize, (g + 1) * group_size - c);
+        dequantize_optimized(
+            v_row + c, 1.0f, zero_point, v_chunk, -128, 127, chunk_size);
+        for (int64_t i = 0; i < m; ++i) {
+          const float weight = qk_data[i * qk_stride_m + j] * scale;
+          if (weight == 0) {
+            continue;
+          }
+          float* o_chunk = o_data + i * o_stride_m + c;
+          ::at::vec::map2<float>(
+              [weight](Vec o, Vec v) { return o + v * Vec(weight); },
+              o_chunk,
+              o_chunk,
+              v_chunk,
+              chunk_size);
+        }
+      }
+    }
+  }
+}
+
 template <typename accum_t>
 void _qk_at_v_gemm(
     const int64_t m,
@@ -258,7 +509,7 @@ void _qk_at_v_gemm(
     accum_t* o_data,
     const int64_t o_stride_m,
     const accum_t beta) {
-  if (v_data.dtype == ScalarType::Char) {
+  if (v_data.dtype == ScalarType::Char || v_data.dtype == ScalarType::Byte) {
     if constexpr (std::is_same<accum_t, float>::value) {
       if (m > 4) {
         // For larger batch sizes, dequantize and use BLAS for better
@@ -274,6 +525,18 @@ void _qk_at_v_gemm(
             o_data,
             o_stride_m,
             beta);
+      } else if (!v_data.is_per_row_int8()) {
+        quantized_qk_at_v_gemm(
+            m,
+            n,
+            k,
+            qk_data,
+            qk_stride_m,
+            v_data,
+            v_stride_n,
+            o_data,
+            o_stride_m,
+            beta);
       } else {
         // For smaller batch sizes, use quantized gemm
         int a_stride_m_tmp, b_stride_n_tmp;
@@ -469,6 +732,46 @@ inline void fill_stub(scalar_t* data, scalar_t val, int64_t size) {
   }
 }
 
+/**
+ * Block table of a paged KV cache. Keys and values live in a pool of
+ * fixed-size blocks, each of shape [block_size, num_heads_kv, head_dim], and
+ * row b of the table lists, in order, the pool blocks that hold the tokens of
+ * sequence b. Token t of sequence b is therefore at row t % block_size of pool
+ * block data[b * batch_stride + t / block_size].
+ */
+struct PagedKVBlockTable {
+  const int64_t* data{nullptr};
+  int64_t batch_stride{0};
+  int64_t block_size{0};
+  int64_t max_blocks_per_seq{0};
+};
+
+/**
+ * Layout of a ring-buffer KV cache. The first sink_size rows hold tokens
+ * [0, sink_size) for good, and token t >= sink_size is written to row
+ * sink_size + (t - sink_size) % window_size, overwriting the token window_size
+ * positions before it. num_tokens is the number of tokens written so far.
+ */
+struct RingKVWindow {
+  int64_t sink_size{0};
+  int64_t window_size{0};
+  int64_t num_tokens{0};
+
+  // Absolute position of the token in cache row `row`, or -1 if the row has
+  // not been written yet.
+  int64_t token_at(int64_t row) const {
+    if (row < sink_size) {
+      return row < num_tokens ? row : -1;
+    }
+    const int64_t offset = row - sink_size;
+    const int64_t last = num_tokens - 1 - sink_size;
+    if (last < offset) {
+      return -1;
+    }
+    return sink_size + last - (last - offset) % window_size;
+  }
+};
+
 /*
 Note on start_pos as a parameter:
 What is start_pos?
@@ -538,6 +841,13 @@ TODO: Just handle conversion of bool mask to float
  * @param start_pos Starting position for causal masking in generation
  * @param num_keys_for_causal_attention Number of keys to consider for causal
  attention (-1 for all)
+ * @param paged_kv Optional block table. When set, key and value are block
+ pools of shape [Num_blocks x Block_size x Num_heads_kv x Dim_per_head],
+ seq_dim must be SeqDim::ONE, and KV_seq_len is the capacity of the table.
+ * @param ring_kv Optional ring-buffer layout of key and value. When set, query
+ row m is the token at position start_pos + m, and it attends to the cached
+ tokens at positions up to its own, wherever they sit in the ring; is_causal
+ and attn_mask must not be set.
  */
 template <typename scalar_t, int64_t q_split_size, int64_t kv_split_size>
 void cpu_flash_attention(
@@ -557,7 +867,9 @@ void cpu_flash_attention(
     const optional<Tensor>& v_scales,
     const SeqDim seq_dim = SeqDim::TWO,
     const int64_t start_pos = 0,
-    const int64_t num_keys_for_causal_attention = -1) {
+    const int64_t num_keys_for_causal_attention = -1,
+    const PagedKVBlockTable* paged_kv = nullptr,
+    const RingKVWindow* ring_kv = nullptr) {
   (void)dropout_p;
 
   // Without this we have out-of-bounds writes for
@@ -591,6 +903,25 @@ void cpu_flash_attention(
     kvSize = value.size(1);
   }
 
+  if (paged_kv != nullptr) {
+    ET_CHECK_MSG(
+        seq_dim == SeqDim::ONE,
+        "Paged KV cache requires the sequence at dim 1");
+    ET_CHECK_MSG(
+        paged_kv->block_size == key.size(1) &&
+            paged_kv->block_size == value.size(1),
+        "Paged KV cache block size must match dim 1 of the key and value pools");
+    kvSize = paged_kv->max_blocks_per_seq * paged_kv->block_size;
+  }
+
+  if (ring_kv != nullptr) {
+    ET_CHECK_MSG(
+        paged_kv == nullptr && !is_causal && !attn_mask.has_value(),
+        "Ring KV cache cannot be combined with paging, is_causal or attn_mask");
+    // Before the ring wraps around, the rows past num_tokens are empty.
+    kvSize = std::min(kvSize, ring_kv->num_tokens);
+  }
+
   if (num_keys_for_causal_attention > 0) {
     ET_CHECK_MSG(
         num_keys_for_causal_attention <= kvSize,
@@ -638,6 +969,9 @@ void cpu_flash_attention(
 
   bool is_quantized_sdpa = false;
   is_quantized_sdpa = query.scalar_type() == ScalarType::Char;
+  ET_CHECK_MSG(
+      !(is_quantized_sdpa && paged_kv != nullptr),
+      "Paged KV cache does not support quantized SDPA");
 
   auto strides = query.strides();
   int64_t qStrideB = strides[0];
@@ -678,6 +1012,8 @@ void cpu_flash_attention(
   int64_t v_quant_params_StrideB = 0;
   int64_t v_quant_params_StrideH = 0;
   int64_t v_quant_params_StrideN = 0;
+  int64_t k_group_size = headSize;
+  int64_t v_group_size = headSize;
 
   if (is_quantized_sdpa) {
     auto q_strides = q_zero_points.value().strides();
@@ -695,10 +1031,18 @@ void cpu_flash_attention(
     v_quant_params_StrideH = v_strides[1];
     v_quant_params_StrideN = v_strides[2];
 
+    // q has one scale per token; k and v one per token or per group of
+    // head_dim / num_groups channels.
+    const int64_t k_num_groups = k_zero_points.value().size(3);
+    const int64_t v_num_groups = v_zero_points.value().size(3);
+    ET_CHECK_MSG(
+        q_zero_points.value().size(3) == 1,
+        "Query must be quantized per token");
     ET_CHECK_MSG(
-        (v_quant_params_StrideN == k_quant_params_StrideN) &&
-            (v_quant_params_StrideN == q_quant_params_StrideM),
-        "Quant params strides must be same for seq dim");
+        headSize % k_num_groups == 0 && headSize % v_num_groups == 0,
+        "Number of key and value quantization groups must divide head dim");
+    k_group_size = headSize / k_num_groups;
+    v_group_size = headSize / v_num_groups;
 
     if (seq_dim == SeqDim::ONE) {
       q_quant_params_StrideH = q_strides[2];
@@ -740,6 +1084,15 @@ void cpu_flash_attention(
 
   int64_t qSplitSize = q_split_size > qSize ? qSize : q_split_size;
   int64_t kvSplitSize = kv_split_size > kvSize ? kvSize : kv_split_size;
+  if (paged_kv != nullptr) {
+    // A kv split must not straddle two pool blocks, since consecutive
+    // blocks of a sequence are not adjacent in memory. Use the largest
+    // split that evenly divides the block size.
+    kvSplitSize = std::min(kvSplitSize, paged_kv->block_size);
+    while (paged_kv->block_size % kvSplitSize != 0) {
+      --kvSplitSize;
+    }
+  }
   int64_t qSlice = (qSize - 1) / qSplitSize + 1;
 #ifdef ET_USE_THREADPOOL
   int64_t num_thread =
@@ -748,6 +1101,24 @@ void cpu_flash_attention(
   int64_t num_thread = 1;
 #endif
 
+  // Split-KV ("flash decoding"): when there are fewer (batch, head, q block)
+  // tasks than threads, as in single-token decode, also split the keys into
+  // chunks of whole kv splits. Each task then produces unnormalized partial
+  // results with their own softmax max and sum, which are combined by a
+  // log-sum-exp reduction afterwards.
+  const int64_t num_q_tasks = batchSize * num_head * qSlice;
+  int64_t num_kv_chunks = 1;
+  int64_t kv_chunk_size = kvSize;
+  if (num_q_tasks < num_thread) {
+    const int64_t num_kv_splits = (kvSize - 1) / kvSplitSize + 1;
+    num_kv_chunks = std::min(
+        (num_thread + num_q_tasks - 1) / num_q_tasks, num_kv_splits);
+    kv_chunk_size =
+        ((num_kv_splits + num_kv_chunks - 1) / num_kv_chunks) * kvSplitSize;
+    num_kv_chunks = (kvSize - 1) / kv_chunk_size + 1;
+  }
+  const bool split_kv = num_kv_chunks > 1;
+
   // const auto dtype = query.scalar_type();
   // Following will be revisited in the future
   // const auto accumulate_dtype = dtype; // toOpMathType(dtype);
@@ -773,6 +1144,10 @@ void cpu_flash_attention(
   // at::Tensor buf_reduced = at::empty(
   //    {num_thread, qSplitSize, is_reduced_type ? kvSplitSize : 0},
   //    query.options());
+  // Partial max, sum and unnormalized output of every (task, kv chunk).
+  int64_t size_per_partial = qSplitSize * (2 + headSize);
+  std::vector<accum_t> partial_vec(
+      split_kv ? num_q_tasks * num_kv_chunks * size_per_partial : 0);
 
   // Data ptrs
   const scalar_t* q_data = query.const_data_ptr<scalar_t>();
@@ -785,9 +1160,26 @@ void cpu_flash_attention(
   scalar_t* buf_reduced_data =
       is_reduced_type ? reinterpret_cast<scalar_t*>(buf_reduced) : nullptr;
 
+  // Offset of key/value row n of batch i, excluding the head offset. Without
+  // a block table row n is at n * stride_n of batch i; with one, it is looked
+  // up through the table.
+  auto kv_row_offset = [paged_kv](
+                           int64_t i,
+                           int64_t n,
+                           int64_t stride_b,
+                           int64_t stride_n) -> int64_t {
+    if (paged_kv == nullptr) {
+      return i * stride_b + n * stride_n;
+    }
+    const int64_t block = paged_kv->data
+        [i * paged_kv->batch_stride + n / paged_kv->block_size];
+    return block * stride_b + (n % paged_kv->block_size) * stride_n;
+  };
+
   auto compute_lambda = [&](int64_t begin, int64_t end) {
-    int64_t i = 0, j = 0, k = 0;
-    data_index_init(begin, i, batchSize, j, num_head, k, qSlice);
+    int64_t i = 0, j = 0, k = 0, c = 0;
+    data_index_init(
+        begin, i, batchSize, j, num_head, k, qSlice, c, num_kv_chunks);
     int ompIdx = torch::executor::get_thread_num();
     accum_t* buf_ptr = buf_data + ompIdx * size_per_thread;
     accum_t* qk_data = buf_ptr;
@@ -801,9 +1193,18 @@ void cpu_flash_attention(
     for (int64_t z = begin; z < end; z++) {
       int64_t m = k * qSplitSize;
       int64_t qBlockSize = std::min(qSplitSize, qSize - m);
+      int64_t kv_begin = c * kv_chunk_size;
+      int64_t kv_end = std::min(kv_begin + kv_chunk_size, kvSize);
+      if (split_kv) {
+        // Work items are ordered (i, j, k, c), so z indexes the partials.
+        qk_max_data = partial_vec.data() + z * size_per_partial;
+        qk_sum_data = qk_max_data + qSplitSize;
+        dst_data = qk_sum_data + qSplitSize;
+      }
       // Initialize max and sum
       fill_stub(
           qk_max_data, -std::numeric_limits<accum_t>::infinity(), qBlockSize);
+      fill_stub(qk_sum_data, static_cast<accum_t>(0), qBlockSize);
       // Original flash sdpa wasnt really meant to be used
       // for decode the way we are using via start_pos here.
       // Thus when num_keys is 1 during decode phase, we
@@ -835,8 +1236,9 @@ void cpu_flash_attention(
           is_causal ? std::min(m + start_pos + qBlockSize, kvSize) : kvSize;
       int64_t m_start_pos = m + start_pos;
       auto j_kv = j / num_reps;
-      for (int64_t n = 0; n < num_keys; n += kvSplitSize) {
-        int64_t kvBlockSize = std::min(kvSplitSize, kvSize - n);
+      num_keys = std::min(num_keys, kv_end);
+      for (int64_t n = kv_begin; n < num_keys; n += kvSplitSize) {
+        int64_t kvBlockSize = std::min(kvSplitSize, kv_end - n);
         // Calculate scale * q @ k.T
         fill_stub(qk_data, static_cast<accum_t>(0), qSplitSize * kvSplitSize);
 
@@ -847,7 +1249,8 @@ void cpu_flash_attention(
         const int8_t* q_zero_points_ptr = nullptr;
         const int8_t* k_zero_points_ptr = nullptr;
         int64_t q_offset = i * qStrideB + j * qStrideH + m * qStrideM;
-        int64_t k_offset = i * kStrideB + j_kv * kStrideH + n * kStrideN;
+        int64_t k_offset =
+            kv_row_offset(i, n, kStrideB, kStrideN) + j_kv * kStrideH;
         if (is_quantized_sdpa) {
           int64_t q_quant_params_offset = i * q_quant_params_StrideB +
               j * q_quant_params_StrideH + m * q_quant_params_StrideM;
@@ -882,7 +1285,8 @@ void cpu_flash_attention(
             kvBlockSize,
             headSize,
             k_quant_params_StrideN,
-            key.scalar_type());
+            key.scalar_type(),
+            k_group_size);
         _q_at_k_gemm<accum_t>(
             qBlockSize,
             kvBlockSize,
@@ -951,6 +1355,22 @@ void cpu_flash_attention(
                 kvBlockSize - last_col);
           }
         }
+        // In a ring cache, key rows are not in position order, so mask each
+        // key against the positions of the query rows. Only chunked prefill
+        // needs this: a single query is the newest token and sees every key.
+        if (ring_kv != nullptr && m_start_pos < ring_kv->num_tokens - 1) {
+          for (int64_t col = 0; col < kvBlockSize; ++col) {
+            const int64_t token = ring_kv->token_at(n + col);
+            // The first token - m_start_pos rows are older than the key.
+            const int64_t masked_rows = token < 0
+                ? qBlockSize
+                : std::clamp<int64_t>(token - m_start_pos, 0, qBlockSize);
+            for (int64_t row = 0; row < masked_rows; ++row) {
+              qk_data[row * kvBlockSize + col] =
+                  -std::numeric_limits<accum_t>::infinity();
+            }
+          }
+        }
         // Update attention weights with attention mask
         // And apply scaling factor
         // qk <- qk * scaling + attn_mask
@@ -1009,7 +1429,7 @@ void cpu_flash_attention(
             // max[row] <- max
             qk_max_data[row] = tmp_max;
             // dst <- dst * exp_tmp
-            if (n > 0) {
+            if (n > kv_begin) {
               vec::map<accum_t>(
                   [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
                   dst_data + row * headSize,
@@ -1022,7 +1442,8 @@ void cpu_flash_attention(
         const void* v_sub_matrix_data_ptr;
         const float* v_scales_ptr = nullptr;
         const int8_t* v_zero_points_ptr = nullptr;
-        int64_t v_offset = i * vStrideB + j_kv * vStrideH + n * vStrideN;
+        int64_t v_offset =
+            kv_row_offset(i, n, vStrideB, vStrideN) + j_kv * vStrideH;
         if (is_quantized_sdpa) {
           int64_t v_quant_params_offset = i * v_quant_params_StrideB +
               j_kv * v_quant_params_StrideH + n * v_quant_params_StrideN;
@@ -1041,7 +1462,8 @@ void cpu_flash_attention(
             kvBlockSize,
             headSize,
             v_quant_params_StrideN,
-            value.scalar_type());
+            value.scalar_type(),
+            v_group_size);
         // Calculate Softmax(q @ k.T) @ v
         _qk_at_v_gemm<accum_t>(
             qBlockSize,
@@ -1053,11 +1475,12 @@ void cpu_flash_attention(
             vStrideN,
             dst_data,
             headSize,
-            n == 0 ? static_cast<accum_t>(0) : static_cast<accum_t>(1));
+            n == kv_begin ? static_cast<accum_t>(0)
+                          : static_cast<accum_t>(1));
       }
       // dst <- dst / sum[row]
       // reorder MHA output with strides
-      for (int64_t row = 0; row < qBlockSize; ++row) {
+      for (int64_t row = 0; row < qBlockSize && !split_kv; ++row) {
         accum_t sum_reciprocal = 1 / qk_sum_data[row];
         vec::map<scalar_t>(
             [sum_reciprocal](Vec x) { return x * Vec(sum_reciprocal); },
@@ -1067,11 +1490,64 @@ void cpu_flash_attention(
             headSize);
       }
       // Move to the next query
-      data_index_step(i, batchSize, j, num_head, k, qSlice);
+      data_index_step(i, batchSize, j, num_head, k, qSlice, c, num_kv_chunks);
     }
   };
   torch::executor::parallel_for(
-      0, batchSize * num_head * qSlice, 1, compute_lambda);
+      0, num_q_tasks * num_kv_chunks, 1, compute_lambda);
+  if (!split_kv) {
+    return;
+  }
+
+  // out[row] = sum_c(exp(max_c - max) * dst_c) / sum_c(exp(max_c - max) *
+  // sum_c), where max is the largest max_c. Chunks with max_c = -inf had no
+  // attendable key for the row and contribute nothing.
+  auto reduce_lambda = [&](int64_t begin, int64_t end) {
+    int64_t i = 0, j = 0, k = 0;
+    data_index_init(begin, i, batchSize, j, num_head, k, qSlice);
+    for (int64_t z = begin; z < end; z++) {
+      int64_t m = k * qSplitSize;
+      int64_t qBlockSize = std::min(qSplitSize, qSize - m);
+      const accum_t* task_partials =
+          partial_vec.data() + z * num_kv_chunks * size_per_partial;
+      for (int64_t row = 0; row < qBlockSize; ++row) {
+        accum_t max = -std::numeric_limits<accum_t>::infinity();
+        for (int64_t chunk = 0; chunk < num_kv_chunks; ++chunk) {
+          max = std::max(max, task_partials[chunk * size_per_partial + row]);
+        }
+        scalar_t* out_row =
+            out_data + i * oStrideB + j * oStrideH + (m + row) * oStrideM;
+        fill_stub(out_row, static_cast<scalar_t>(0), headSize);
+        accum_t sum = 0;
+        for (int64_t chunk = 0; chunk < num_kv_chunks; ++chunk) {
+          const accum_t* chunk_max = task_partials + chunk * size_per_partial;
+          const accum_t* chunk_sum = chunk_max + qSplitSize;
+          const accum_t* chunk_dst = chunk_sum + qSplitSize;
+          if (chunk_max[row] == -std::numeric_limits<accum_t>::infinity()) {
+            continue;
+          }
+          const accum_t weight = std::exp(chunk_max[row] - max);
+          sum += weight * chunk_sum[row];
+          vec::map2<accum_t>(
+              [weight](Vec x, Vec y) { return x + y * Vec(weight); },
+              out_row,
+              out_row,
+              chunk_dst + row * headSize,
+              headSize);
+        }
+        if (sum > 0) {
+          const accum_t sum_reciprocal = 1 / sum;
+          vec::map<scalar_t>(
+              [sum_reciprocal](Vec x) { return x * Vec(sum_reciprocal); },
+              out_row,
+              out_row,
+              headSize);
+        }
+      }
+      data_index_step(i, batchSize, j, num_head, k, qSlice);
+    }
+  };
+  torch::executor::parallel_for(0, num_q_tasks, 1, reduce_lambda);
 }
 } // namespace sdpa::impl
 } // namespace native
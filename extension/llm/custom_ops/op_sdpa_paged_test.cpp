@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h> // Declares the operator
+#include <executorch/extension/llm/custom_ops/op_update_cache.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::Error;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+constexpr int32_t kBatch = 2;
+constexpr int32_t kHeads = 4;
+constexpr int32_t kKVHeads = 2;
+constexpr int32_t kHeadDim = 8;
+constexpr int32_t kBlockSize = 16;
+constexpr int32_t kMaxBlocksPerSeq = 6;
+constexpr int32_t kMaxSeqLen = kBlockSize * kMaxBlocksPerSeq;
+constexpr int32_t kNumBlocks = 14;
+
+std::vector<float> random_data(size_t n, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(n);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+  return data;
+}
+
+// Gives each sequence distinct, non-adjacent pool blocks in shuffled order.
+std::vector<int64_t> shuffled_block_table() {
+  std::vector<int64_t> blocks(kNumBlocks);
+  for (int32_t i = 0; i < kNumBlocks; ++i) {
+    blocks[i] = i;
+  }
+  std::shuffle(blocks.begin(), blocks.end(), std::mt19937(7));
+  return std::vector<int64_t>(
+      blocks.begin(), blocks.begin() + kBatch * kMaxBlocksPerSeq);
+}
+
+// Slice [start, start + len) of dim 1 of a [kBatch, kMaxSeqLen, kKVHeads,
+// kHeadDim] buffer.
+std::vector<float>
+seq_slice(const std::vector<float>& full, int32_t start, int32_t len) {
+  const int32_t row = kKVHeads * kHeadDim;
+  std::vector<float> out;
+  for (int32_t b = 0; b < kBatch; ++b) {
+    const float* base = full.data() + (b * kMaxSeqLen + start) * row;
+    out.insert(out.end(), base, base + len * row);
+  }
+  return out;
+}
+
+// Attention of q, [kBatch, seq_len, kHeads, kHeadDim] at positions
+// [start_pos, start_pos + seq_len), over the first start_pos + seq_len tokens
+// of the contiguous k and v, computed naively.
+std::vector<float> reference_attention(
+    const std::vector<float>& q,
+    const std::vector<float>& k,
+    const std::vector<float>& v,
+    int32_t start_pos,
+    int32_t seq_len,
+    bool is_causal) {
+  const int32_t num_keys = start_pos + seq_len;
+  const double scale = 1.0 / std::sqrt(static_cast<double>(kHeadDim));
+  std::vector<float> out(q.size());
+  std::vector<double> p(num_keys);
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t s = 0; s < seq_len; ++s) {
+      for (int32_t h = 0; h < kHeads; ++h) {
+        const int32_t h_kv = h / (kHeads / kKVHeads);
+        const float* q_row = &q[((b * seq_len + s) * kHeads + h) * kHeadDim];
+        const int32_t last = is_causal ? start_pos + s + 1 : num_keys;
+        double max_logit = -1e30;
+        for (int32_t t = 0; t < last; ++t) {
+          const float* k_row =
+              &k[((b * kMaxSeqLen + t) * kKVHeads + h_kv) * kHeadDim];
+          double dot = 0;
+          for (int32_t d = 0; d < kHeadDim; ++d) {
+            dot += q_row[d] * k_row[d];
+          }
+          p[t] = dot * scale;
+          max_logit = std::max(max_logit, p[t]);
+        }
+        double sum = 0;
+        for (int32_t t = 0; t < last; ++t) {
+          p[t] = std::exp(p[t] - max_logit);
+          sum += p[t];
+        }
+        float* out_row = &out[((b * seq_len + s) * kHeads + h) * kHeadDim];
+        for (int32_t d = 0; d < kHeadDim; ++d) {
+          double acc = 0;
+          for (int32_t t = 0; t < last; ++t) {
+            acc += p[t] *
+                v[((b * kMaxSeqLen + t) * kKVHeads + h_kv) * kHeadDim + d];
+          }
+          out_row[d] = static_cast<float>(acc / sum);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+class OpSdpaPagedTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    k_full_ = random_data(kBatch * kMaxSeqLen * kKVHeads * kHeadDim, 1);
+    v_full_ = random_data(kBatch * kMaxSeqLen * kKVHeads * kHeadDim, 2);
+    table_ = tfl_.make({kBatch, kMaxBlocksPerSeq}, shuffled_block_table());
+  }
+
+  // Fills the contiguous caches and, through update_cache_paged, the block
+  // pools with tokens [0, len), written as a prefill of prefill_len tokens
+  // followed by single-token decode steps.
+  void fill_caches(int32_t len, int32_t prefill_len) {
+    const std::vector<int32_t> kv_sizes = {
+        kBatch, kMaxSeqLen, kKVHeads, kHeadDim};
+    k_cache_ = tf_.make(kv_sizes, k_full_);
+    v_cache_ = tf_.make(kv_sizes, v_full_);
+    k_pool_ = tf_.zeros({kNumBlocks, kBlockSize, kKVHeads, kHeadDim});
+    v_pool_ = tf_.zeros({kNumBlocks, kBlockSize, kKVHeads, kHeadDim});
+    int32_t pos = 0;
+    while (pos < len) {
+      const int32_t step = pos == 0 ? prefill_len : 1;
+      const std::vector<int32_t> step_sizes = {
+          kBatch, step, kKVHeads, kHeadDim};
+      Tensor k_step = tf_.make(step_sizes, seq_slice(k_full_, pos, step));
+      Tensor v_step = tf_.make(step_sizes, seq_slice(v_full_, pos, step));
+      Tensor unused = tf_.zeros({1});
+      KernelRuntimeContext context{};
+      torch::executor::native::update_cache_paged_out(
+          context, k_step, k_pool_, pos, table_, unused);
+      torch::executor::native::update_cache_paged_out(
+          context, v_step, v_pool_, pos, table_, unused);
+      ASSERT_EQ(context.failure_state(), Error::Ok);
+      pos += step;
+    }
+  }
+
+  void expect_paged_matches_contiguous(
+      int32_t start_pos,
+      int32_t seq_len,
+      bool is_causal) {
+    const std::vector<float> q_data =
+        random_data(kBatch * seq_len * kHeads * kHeadDim, 3);
+    Tensor q = tf_.make({kBatch, seq_len, kHeads, kHeadDim}, q_data);
+    Tensor expected = tf_.zeros({kBatch, seq_len, kHeads, kHeadDim});
+    Tensor out = tf_.zeros({kBatch, seq_len, kHeads, kHeadDim});
+
+    KernelRuntimeContext context{};
+    torch::executor::native::custom_sdpa_out(
+        context,
+        q,
+        k_cache_,
+        v_cache_,
+        start_pos,
+        {},
+        0.0,
+        is_causal,
+        {},
+        expected);
+    torch::executor::native::custom_sdpa_paged_out(
+        context,
+        q,
+        k_pool_,
+        v_pool_,
+        start_pos,
+        table_,
+        {},
+        0.0,
+        is_causal,
+        {},
+        out);
+    ASSERT_EQ(context.failure_state(), Error::Ok);
+    // The paged kernel splits keys at block boundaries, so the online softmax
+    // accumulates in a different order than over the contiguous cache.
+    EXPECT_TENSOR_CLOSE_WITH_TOL(out, expected, 1e-5, 1e-5);
+    EXPECT_TENSOR_CLOSE_WITH_TOL(
+        out,
+        tf_.make(
+            {kBatch, seq_len, kHeads, kHeadDim},
+            reference_attention(
+                q_data, k_full_, v_full_, start_pos, seq_len, is_causal)),
+        1e-5,
+        1e-5);
+  }
+
+  TensorFactory<ScalarType::Float> tf_;
+  TensorFactory<ScalarType::Long> tfl_;
+  std::vector<float> k_full_;
+  std::vector<float> v_full_;
+  Tensor table_ = tfl_.zeros({1});
+  Tensor k_cache_ = tf_.zeros({1});
+  Tensor v_cache_ = tf_.zeros({1});
+  Tensor k_pool_ = tf_.zeros({1});
+  Tensor v_pool_ = tf_.zeros({1});
+};
+
+} // namespace
+
+TEST_F(OpSdpaPagedTest, UpdateCachePagedWritesThroughBlockTable) {
+  fill_caches(/*len=*/37, /*prefill_len=*/35);
+  const int32_t row = kKVHeads * kHeadDim;
+  const float* pool = k_pool_.const_data_ptr<float>();
+  const int64_t* table = table_.const_data_ptr<int64_t>();
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t t = 0; t < 37; ++t) {
+      const int64_t block = table[b * kMaxBlocksPerSeq + t / kBlockSize];
+      const float* got = pool + (block * kBlockSize + t % kBlockSize) * row;
+      const float* want = k_full_.data() + (b * kMaxSeqLen + t) * row;
+      EXPECT_TRUE(std::equal(got, got + row, want))
+          << "batch " << b << " token " << t;
+    }
+  }
+}
+
+TEST_F(OpSdpaPagedTest, PrefillMatchesContiguousCache) {
+  // 40 tokens span three blocks and two query splits.
+  fill_caches(/*len=*/40, /*prefill_len=*/40);
+  expect_paged_matches_contiguous(/*start_pos=*/0, /*seq_len=*/40, true);
+}
+
+TEST_F(OpSdpaPagedTest, DecodeMatchesContiguousCache) {
+  fill_caches(/*len=*/kMaxSeqLen, /*prefill_len=*/70);
+  for (int32_t start_pos : {70, 79, 80, kMaxSeqLen - 1}) {
+    expect_paged_matches_contiguous(start_pos, /*seq_len=*/1, true);
+  }
+}
+
+TEST_F(OpSdpaPagedTest, ChunkedPrefillMatchesContiguousCache) {
+  fill_caches(/*len=*/kMaxSeqLen, /*prefill_len=*/kMaxSeqLen);
+  expect_paged_matches_contiguous(/*start_pos=*/17, /*seq_len=*/21, true);
+  expect_paged_matches_contiguous(/*start_pos=*/17, /*seq_len=*/21, false);
+}
+
+TEST_F(OpSdpaPagedTest, InvalidBlockIdFails) {
+  fill_caches(/*len=*/1, /*prefill_len=*/1);
+  std::vector<int64_t> bad_table(kBatch * kMaxBlocksPerSeq, 0);
+  bad_table[kMaxBlocksPerSeq] = kNumBlocks;
+  Tensor table = tfl_.make({kBatch, kMaxBlocksPerSeq}, bad_table);
+  Tensor q = tf_.zeros({kBatch, 1, kHeads, kHeadDim});
+  Tensor out = tf_.zeros({kBatch, 1, kHeads, kHeadDim});
+
+  KernelRuntimeContext context{};
+  torch::executor::native::custom_sdpa_paged_out(
+      context, q, k_pool_, v_pool_, 0, table, {}, 0.0, true, {}, out);
+  EXPECT_EQ(context.failure_state(), Error::InvalidArgument);
+
+  KernelRuntimeContext update_context{};
+  Tensor value = tf_.zeros({kBatch, 1, kKVHeads, kHeadDim});
+  Tensor unused = tf_.zeros({1});
+  torch::executor::native::update_cache_paged_out(
+      update_context, value, k_pool_, 0, table, unused);
+  EXPECT_EQ(update_context.failure_state(), Error::InvalidArgument);
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h> // Declares the operator
+#include <executorch/extension/llm/custom_ops/op_update_cache.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::Error;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+constexpr int32_t kBatch = 2;
+constexpr int32_t kHeads = 4;
+constexpr int32_t kKVHeads = 2;
+constexpr int32_t kHeadDim = 8;
+constexpr int32_t kSinkSize = 3;
+constexpr int32_t kWindowSize = 40;
+constexpr int32_t kCacheSize = kSinkSize + kWindowSize;
+// More tokens than the cache holds, so the ring wraps around twice.
+constexpr int32_t kMaxTokens = 110;
+constexpr int32_t kRow = kKVHeads * kHeadDim;
+
+std::vector<float> random_data(size_t n, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(n);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+  return data;
+}
+
+// Slice [start, start + len) of dim 1 of a [kBatch, kMaxTokens, kKVHeads,
+// kHeadDim] buffer.
+std::vector<float>
+seq_slice(const std::vector<float>& full, int32_t start, int32_t len) {
+  std::vector<float> out;
+  for (int32_t b = 0; b < kBatch; ++b) {
+    const float* base = full.data() + (b * kMaxTokens + start) * kRow;
+    out.insert(out.end(), base, base + len * kRow);
+  }
+  return out;
+}
+
+// Whether token t is still cached once num_tokens tokens have been written.
+bool is_cached(int32_t t, int32_t num_tokens) {
+  return t < kSinkSize || t >= num_tokens - kWindowSize;
+}
+
+// Attention of q, [kBatch, seq_len, kHeads, kHeadDim] at positions
+// [start_pos, start_pos + seq_len), over the cached tokens up to each query's
+// own position, computed naively from the full k and v.
+std::vector<float> reference_attention(
+    const std::vector<float>& q,
+    const std::vector<float>& k,
+    const std::vector<float>& v,
+    int32_t start_pos,
+    int32_t seq_len) {
+  const int32_t num_tokens = start_pos + seq_len;
+  const double scale = 1.0 / std::sqrt(static_cast<double>(kHeadDim));
+  std::vector<float> out(q.size());
+  std::vector<double> p(num_tokens);
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t s = 0; s < seq_len; ++s) {
+      for (int32_t h = 0; h < kHeads; ++h) {
+        const int32_t h_kv = h / (kHeads / kKVHeads);
+        const float* q_row = &q[((b * seq_len + s) * kHeads + h) * kHeadDim];
+        double max_logit = -1e30;
+        for (int32_t t = 0; t <= start_pos + s; ++t) {
+          if (!is_cached(t, num_tokens)) {
+            continue;
+          }
+          const float* k_row =
+              &k[(b * kMaxTokens + t) * kRow + h_kv * kHeadDim];
+          double dot = 0;
+          for (int32_t d = 0; d < kHeadDim; ++d) {
+            dot += q_row[d] * k_row[d];
+          }
+          p[t] = dot * scale;
+          max_logit = std::max(max_logit, p[t]);
+        }
+        double sum = 0;
+        for (int32_t t = 0; t <= start_pos + s; ++t) {
+          if (is_cached(t, num_tokens)) {
+            p[t] = std::exp(p[t] - max_logit);
+            sum += p[t];
+          }
+        }
+        float* out_row = &out[((b * seq_len + s) * kHeads + h) * kHeadDim];
+        for (int32_t d = 0; d < kHeadDim; ++d) {
+          double acc = 0;
+          for (int32_t t = 0; t <= start_pos + s; ++t) {
+            if (is_cached(t, num_tokens)) {
+              acc += p[t] *
+                  v[(b * kMaxTokens + t) * kRow + h_kv * kHeadDim + d];
+            }
+          }
+          out_row[d] = static_cast<float>(acc / sum);
+        }
+      }
+    }
+  }
+  return out;
+}
+
+class OpSdpaRingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    k_full_ = random_data(kBatch * kMaxTokens * kRow, 1);
+    v_full_ = random_data(kBatch * kMaxTokens * kRow, 2);
+    k_cache_ = tf_.zeros({kBatch, kCacheSize, kKVHeads, kHeadDim});
+    v_cache_ = tf_.zeros({kBatch, kCacheSize, kKVHeads, kHeadDim});
+  }
+
+  // Writes tokens [num_tokens_, num_tokens_ + len) through update_cache_ring.
+  void write(int32_t len) {
+    const std::vector<int32_t> sizes = {kBatch, len, kKVHeads, kHeadDim};
+    Tensor k = tf_.make(sizes, seq_slice(k_full_, num_tokens_, len));
+    Tensor v = tf_.make(sizes, seq_slice(v_full_, num_tokens_, len));
+    Tensor unused = tf_.zeros({1});
+    KernelRuntimeContext context{};
+    torch::executor::native::update_cache_ring_out(
+        context, k, k_cache_, num_tokens_, kSinkSize, unused);
+    torch::executor::native::update_cache_ring_out(
+        context, v, v_cache_, num_tokens_, kSinkSize, unused);
+    ASSERT_EQ(context.failure_state(), Error::Ok);
+    num_tokens_ += len;
+  }
+
+  // Writes a chunk of seq_len tokens and checks the attention of its queries
+  // over the ring against the reference.
+  void expect_chunk_matches_reference(int32_t seq_len) {
+    const int32_t start_pos = num_tokens_;
+    write(seq_len);
+    const std::vector<float> q_data =
+        random_data(kBatch * seq_len * kHeads * kHeadDim, start_pos + 3);
+    Tensor q = tf_.make({kBatch, seq_len, kHeads, kHeadDim}, q_data);
+    Tensor out = tf_.zeros({kBatch, seq_len, kHeads, kHeadDim});
+
+    KernelRuntimeContext context{};
+    torch::executor::native::custom_sdpa_ring_out(
+        context, q, k_cache_, v_cache_, start_pos, kSinkSize, 0.0, {}, out);
+    ASSERT_EQ(context.failure_state(), Error::Ok);
+    EXPECT_TENSOR_CLOSE_WITH_TOL(
+        out,
+        tf_.make(
+            {kBatch, seq_len, kHeads, kHeadDim},
+            reference_attention(
+                q_data, k_full_, v_full_, start_pos, seq_len)),
+        1e-5,
+        1e-5);
+  }
+
+  TensorFactory<ScalarType::Float> tf_;
+  std::vector<float> k_full_;
+  std::vector<float> v_full_;
+  Tensor k_cache_ = tf_.zeros({1});
+  Tensor v_cache_ = tf_.zeros({1});
+  int32_t num_tokens_ = 0;
+};
+
+} // namespace
+
+TEST_F(OpSdpaRingTest, UpdateCacheRingKeepsSinksAndWraps) {
+  write(/*len=*/30);
+  while (num_tokens_ + 7 <= kMaxTokens) {
+    write(/*len=*/7);
+  }
+  const float* cache = k_cache_.const_data_ptr<float>();
+  for (int32_t b = 0; b < kBatch; ++b) {
+    for (int32_t t = 0; t < num_tokens_; ++t) {
+      if (!is_cached(t, num_tokens_)) {
+        continue;
+      }
+      const int32_t row =
+          t < kSinkSize ? t : kSinkSize + (t - kSinkSize) % kWindowSize;
+      const float* got = cache + (b * kCacheSize + row) * kRow;
+      const float* want = k_full_.data() + (b * kMaxTokens + t) * kRow;
+      EXPECT_TRUE(std::equal(got, got + kRow, want))
+          << "batch " << b << " token " << t;
+    }
+  }
+}
+
+TEST_F(OpSdpaRingTest, PrefillBeforeWrapMatchesReference) {
+  expect_chunk_matches_reference(/*seq_len=*/kWindowSize);
+}
+
+TEST_F(OpSdpaRingTest, DecodeAfterWrapMatchesReference) {
+  write(/*len=*/kWindowSize);
+  write(/*len=*/kWindowSize);
+  while (num_tokens_ < kMaxTokens) {
+    expect_chunk_matches_reference(/*seq_len=*/1);
+  }
+}
+
+TEST_F(OpSdpaRingTest, ChunkedPrefillAcrossWrapMatchesReference) {
+  write(/*len=*/kCacheSize - 5);
+  // Straddles the end of the ring; its first queries must not see its last
+  // keys, which sit before them in the cache.
+  expect_chunk_matches_reference(/*seq_len=*/17);
+  expect_chunk_matches_reference(/*seq_len=*/kWindowSize);
+}
+
+TEST_F(OpSdpaRingTest, ChunkLongerThanWindowFails) {
+  Tensor value = tf_.zeros({kBatch, kWindowSize + 1, kKVHeads, kHeadDim});
+  Tensor unused = tf_.zeros({1});
+  KernelRuntimeContext update_context{};
+  torch::executor::native::update_cache_ring_out(
+      update_context, value, k_cache_, 0, kSinkSize, unused);
+  EXPECT_EQ(update_context.failure_state(), Error::InvalidArgument);
+
+  Tensor q = tf_.zeros({kBatch, kWindowSize + 1, kHeads, kHeadDim});
+  Tensor out = tf_.zeros({kBatch, kWindowSize + 1, kHeads, kHeadDim});
+  KernelRuntimeContext context{};
+  torch::executor::native::custom_sdpa_ring_out(
+      context, q, k_cache_, v_cache_, 0, kSinkSize, 0.0, {}, out);
+  EXPECT_EQ(context.failure_state(), Error::InvalidArgument);
+}
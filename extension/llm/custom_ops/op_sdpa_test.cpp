@@ -6,9 +6,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cmath>
 #include <limits>
+#include <random>
+#include <vector>
 
 #include <executorch/extension/llm/custom_ops/op_sdpa.h>
+#include <executorch/extension/threadpool/threadpool.h>
 
 #include <executorch/kernels/test/TestUtil.h>
 #include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
@@ -513,3 +517,87 @@ TEST(OpScaledDotProductAttentionTest, CorrectnessTest_51) {
       query, key, value, attn_mask, dropout_p, is_causal, scale, out);
   EXPECT_TENSOR_CLOSE(ret, ret_expected);
 }
+
+// A single query over a long KV cache. With 4 threads and 2 (batch, head)
+// pairs, this runs the split-KV path with two chunks per head. The first
+// chunk ends at or before key 4096 for any kv tile size, so the mask covers
+// all of it and its partial results are empty.
+TEST(OpScaledDotProductAttentionTest, DecodeLongKVMatchesReference) {
+  auto* threadpool = ::executorch::extension::threadpool::get_threadpool();
+  ASSERT_NE(threadpool, nullptr);
+  const uint32_t num_threads =
+      static_cast<uint32_t>(threadpool->get_thread_count());
+  ASSERT_TRUE(threadpool->_unsafe_reset_threadpool(4));
+
+  TensorFactory<executorch::aten::ScalarType::Float> tfFloat;
+  constexpr int32_t kHeads = 2;
+  constexpr int32_t kKVLen = 5000;
+  constexpr int32_t kHeadDim = 16;
+  constexpr int32_t kMasked = 4200;
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  auto random_vector = [&](size_t n) {
+    std::vector<float> data(n);
+    for (auto& v : data) {
+      v = dist(gen);
+    }
+    return data;
+  };
+  const std::vector<float> q = random_vector(kHeads * kHeadDim);
+  const std::vector<float> k = random_vector(kHeads * kKVLen * kHeadDim);
+  const std::vector<float> v = random_vector(kHeads * kKVLen * kHeadDim);
+  std::vector<float> mask(kKVLen, 0.0f);
+  std::fill(
+      mask.begin(),
+      mask.begin() + kMasked,
+      -std::numeric_limits<float>::infinity());
+
+  for (bool masked : {false, true}) {
+    std::vector<float> expected(kHeads * kHeadDim);
+    for (int32_t h = 0; h < kHeads; ++h) {
+      std::vector<double> p(kKVLen);
+      double max_logit = -std::numeric_limits<double>::infinity();
+      for (int32_t t = 0; t < kKVLen; ++t) {
+        double dot = 0;
+        for (int32_t d = 0; d < kHeadDim; ++d) {
+          dot += q[h * kHeadDim + d] * k[(h * kKVLen + t) * kHeadDim + d];
+        }
+        p[t] = dot / std::sqrt(static_cast<double>(kHeadDim)) +
+            (masked ? mask[t] : 0.0f);
+        max_logit = std::max(max_logit, p[t]);
+      }
+      double sum = 0;
+      for (int32_t t = 0; t < kKVLen; ++t) {
+        p[t] = std::exp(p[t] - max_logit);
+        sum += p[t];
+      }
+      for (int32_t d = 0; d < kHeadDim; ++d) {
+        double acc = 0;
+        for (int32_t t = 0; t < kKVLen; ++t) {
+          acc += p[t] * v[(h * kKVLen + t) * kHeadDim + d];
+        }
+        expected[h * kHeadDim + d] = static_cast<float>(acc / sum);
+      }
+    }
+
+    std::optional<executorch::aten::Tensor> attn_mask;
+    if (masked) {
+      attn_mask = tfFloat.make({1, kKVLen}, mask);
+    }
+    executorch::aten::Tensor out = tfFloat.zeros({1, kHeads, 1, kHeadDim});
+    executorch::aten::Tensor ret = op_scaled_dot_product_attention(
+        tfFloat.make({1, kHeads, 1, kHeadDim}, q),
+        tfFloat.make({1, kHeads, kKVLen, kHeadDim}, k),
+        tfFloat.make({1, kHeads, kKVLen, kHeadDim}, v),
+        attn_mask,
+        0.0,
+        false,
+        {},
+        out);
+    EXPECT_TENSOR_CLOSE_WITH_TOL(
+        ret, tfFloat.make({1, kHeads, 1, kHeadDim}, expected), 1e-5, 1e-5);
+  }
+
+  EXPECT_TRUE(threadpool->_unsafe_reset_threadpool(num_threads));
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/llm/custom_ops/op_sdpa_tuning.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
+#ifdef ET_USE_THREADPOOL
+#include <executorch/extension/threadpool/threadpool.h>
+#endif
+
+namespace torch {
+namespace executor {
+namespace native {
+namespace sdpa::tuning {
+
+namespace {
+
+// Shapes whose dimensions round up to the same powers of two share a choice.
+struct BucketKey {
+  int64_t element_size;
+  int64_t num_threads;
+  int64_t batch_heads;
+  int64_t q_len;
+  int64_t kv_len;
+  int64_t head_dim;
+
+  bool operator<(const BucketKey& other) const {
+    return std::tie(
+               element_size,
+               num_threads,
+               batch_heads,
+               q_len,
+               kv_len,
+               head_dim) <
+        std::tie(other.element_size,
+                 other.num_threads,
+                 other.batch_heads,
+                 other.q_len,
+                 other.kv_len,
+                 other.head_dim);
+  }
+};
+
+int64_t next_power_of_two(int64_t n) {
+  int64_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+int64_t num_threads() {
+#ifdef ET_USE_THREADPOOL
+  return ::executorch::extension::threadpool::get_threadpool()
+      ->get_thread_count();
+#else
+  return 1;
+#endif
+}
+
+BucketKey bucket_of(const ProblemShape& shape) {
+  return BucketKey{
+      static_cast<int64_t>(shape.element_size),
+      num_threads(),
+      next_power_of_two(shape.batch_heads),
+      next_power_of_two(shape.q_len),
+      next_power_of_two(shape.kv_len),
+      shape.head_dim};
+}
+
+size_t find_tile_config(int64_t q_split_size, int64_t kv_split_size) {
+  for (size_t i = 0; i < kNumTileConfigs; ++i) {
+    if (kTileConfigs[i].q_split_size == q_split_size &&
+        kTileConfigs[i].kv_split_size == kv_split_size) {
+      return i;
+    }
+  }
+  return kNumTileConfigs;
+}
+
+// Returns the next smaller q_split_size in kTileConfigs.
+int64_t smaller_q_split_size(int64_t q_split_size) {
+  int64_t smaller = kTileConfigs[0].q_split_size;
+  for (size_t i = 0; i < kNumTileConfigs; ++i) {
+    if (kTileConfigs[i].q_split_size < q_split_size) {
+      smaller = kTileConfigs[i].q_split_size;
+    }
+  }
+  return smaller;
+}
+
+std::atomic<bool> autotuning{false};
+std::mutex profile_mutex;
+std::map<BucketKey, TileConfig> profile;
+
+} // namespace
+
+size_t default_tile_config(const ProblemShape& shape) {
+  // Thresholds of the original fixed dispatch.
+  int64_t q_split_size = 32;
+  if (shape.q_len >= 768) {
+    q_split_size = 256;
+  } else if (shape.q_len >= 192) {
+    q_split_size = 64;
+  }
+  // Parallel work is split over (batch, head, q block). With few heads, use
+  // smaller q blocks so that every thread gets one.
+  const int64_t threads = num_threads();
+  while (q_split_size > kTileConfigs[0].q_split_size &&
+         shape.batch_heads *
+                 ((shape.q_len + q_split_size - 1) / q_split_size) <
+             threads) {
+    q_split_size = smaller_q_split_size(q_split_size);
+  }
+
+  // Keep the original kv tile. Other sizes are only chosen by autotuning,
+  // which times them on the device.
+  size_t best = find_tile_config(q_split_size, 512);
+
+  // With fewer q tasks than threads, as in decode, cpu_flash_attention also
+  // splits the keys, in chunks of whole kv tiles. Use smaller kv tiles when
+  // that is what it takes to give every thread a chunk.
+  const int64_t q_tasks = shape.batch_heads *
+      ((shape.q_len + q_split_size - 1) / q_split_size);
+  auto num_kv_tiles = [&shape](size_t index) {
+    const int64_t kv_split_size = kTileConfigs[index].kv_split_size;
+    return (shape.kv_len + kv_split_size - 1) / kv_split_size;
+  };
+  while (q_tasks < threads && q_tasks * num_kv_tiles(best) < threads &&
+         best > 0 && kTileConfigs[best - 1].q_split_size == q_split_size) {
+    --best;
+  }
+  return best;
+}
+
+size_t select_tile_config(
+    const ProblemShape& shape,
+    ::executorch::runtime::FunctionRef<void(size_t)> run) {
+  const BucketKey key = bucket_of(shape);
+  {
+    std::lock_guard<std::mutex> guard(profile_mutex);
+    auto it = profile.find(key);
+    if (it != profile.end()) {
+      return find_tile_config(
+          it->second.q_split_size, it->second.kv_split_size);
+    }
+  }
+  if (!autotuning.load(std::memory_order_relaxed)) {
+    return default_tile_config(shape);
+  }
+
+  // Tiles are clamped to the problem size, so candidates that clamp to the
+  // same effective tiles behave identically; time only the first of each.
+  size_t best = default_tile_config(shape);
+  double best_seconds = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < kNumTileConfigs; ++i) {
+    const int64_t q_tile = std::min(kTileConfigs[i].q_split_size, shape.q_len);
+    const int64_t kv_tile =
+        std::min(kTileConfigs[i].kv_split_size, shape.kv_len);
+    bool duplicate = false;
+    for (size_t j = 0; j < i; ++j) {
+      duplicate = duplicate ||
+          (std::min(kTileConfigs[j].q_split_size, shape.q_len) == q_tile &&
+           std::min(kTileConfigs[j].kv_split_size, shape.kv_len) == kv_tile);
+    }
+    if (duplicate) {
+      continue;
+    }
+    // The first run warms caches and the threadpool.
+    run(i);
+    const auto start = std::chrono::steady_clock::now();
+    run(i);
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    if (seconds < best_seconds) {
+      best_seconds = seconds;
+      best = i;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(profile_mutex);
+  profile[key] = kTileConfigs[best];
+  return best;
+}
+
+void set_autotuning_enabled(bool enabled) {
+  autotuning.store(enabled, std::memory_order_relaxed);
+}
+
+bool autotuning_enabled() {
+  return autotuning.load(std::memory_order_relaxed);
+}
+
+std::string save_tuning_profile() {
+  std::lock_guard<std::mutex> guard(profile_mutex);
+  std::ostringstream out;
+  for (const auto& entry : profile) {
+    const BucketKey& key = entry.first;
+    out << key.element_size << ' ' << key.num_threads << ' '
+        << key.batch_heads << ' ' << key.q_len << ' ' << key.kv_len << ' '
+        << key.head_dim << ' ' << entry.second.q_split_size << ' '
+        << entry.second.kv_split_size << '\n';
+  }
+  return out.str();
+}
+
+bool load_tuning_profile(const std::string& text) {
+  std::map<BucketKey, TileConfig> loaded;
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream fields(line);
+    BucketKey key{};
+    TileConfig tile{};
+    if (!(fields >> key.element_size >> key.num_threads >> key.batch_heads >>
+          key.q_len >> key.kv_len >> key.head_dim >> tile.q_split_size >>
+          tile.kv_split_size) ||
+        find_tile_config(tile.q_split_size, tile.kv_split_size) ==
+            kNumTileConfigs) {
+      return false;
+    }
+    loaded[key] = tile;
+  }
+  std::lock_guard<std::mutex> guard(profile_mutex);
+  for (const auto& entry : loaded) {
+    profile[entry.first] = entry.second;
+  }
+  return true;
+}
+
+void clear_tuning_profile() {
+  std::lock_guard<std::mutex> guard(profile_mutex);
+  profile.clear();
+}
+
+} // namespace sdpa::tuning
+} // namespace native
+} // namespace executor
+} // namespace torch
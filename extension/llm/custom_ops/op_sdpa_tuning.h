@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/function_ref.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Runtime selection of the q/kv tile sizes used by cpu_flash_attention.
+ *
+ * Every call picks one of kTileConfigs. By default the choice keeps the
+ * original kv tile of 512 and picks the q tile from the query length and the
+ * thread count; kv tiles only shrink when decode needs more chunks. With
+ * autotuning enabled, the first call for a shape bucket times every distinct
+ * candidate on the real inputs and remembers the fastest; the remembered
+ * choices can be saved to a profile and loaded in a later process, so tuning
+ * cost is paid once per device.
+ */
+
+namespace torch {
+namespace executor {
+namespace native {
+namespace sdpa::tuning {
+
+struct TileConfig {
+  int64_t q_split_size;
+  int64_t kv_split_size;
+};
+
+// The cpu_flash_attention instantiations that can be selected. Each has
+// kv_split_size > q_split_size, which the causal masking requires. Entries are
+// ordered by q_split_size and then by increasing kv_split_size.
+//
+// Every entry is instantiated for each dtype at each dispatch site in
+// op_sdpa.cpp. Builds that optimize for size define
+// ET_SDPA_MINIMAL_TILE_CONFIGS to keep only the tiles of the original fixed
+// dispatch, which leaves autotuning no choice of kv tile.
+#ifdef ET_SDPA_MINIMAL_TILE_CONFIGS
+inline constexpr TileConfig kTileConfigs[] = {
+    {32, 512},
+    {64, 512},
+    {256, 512},
+};
+#else
+inline constexpr TileConfig kTileConfigs[] = {
+    {32, 256},
+    {32, 512},
+    {32, 1024},
+    {32, 2048},
+    {64, 256},
+    {64, 512},
+    {64, 1024},
+    {128, 512},
+    {128, 1024},
+    {256, 512},
+    {256, 1024},
+};
+#endif // ET_SDPA_MINIMAL_TILE_CONFIGS
+
+inline constexpr size_t kNumTileConfigs =
+    sizeof(kTileConfigs) / sizeof(kTileConfigs[0]);
+
+// Exposes kTileConfigs[I] as compile-time constants.
+template <size_t I>
+struct TileConfigTag {
+  static constexpr int64_t q_split_size = kTileConfigs[I].q_split_size;
+  static constexpr int64_t kv_split_size = kTileConfigs[I].kv_split_size;
+};
+
+/**
+ * Calls `fn(TileConfigTag<index>{})`, so that `fn` can instantiate a kernel
+ * template with the tile sizes of kTileConfigs[index].
+ */
+template <size_t I = 0, typename Fn>
+void dispatch_tile_config(size_t index, const Fn& fn) {
+  if constexpr (I < kNumTileConfigs) {
+    if (index == I) {
+      fn(TileConfigTag<I>{});
+    } else {
+      dispatch_tile_config<I + 1>(index, fn);
+    }
+  }
+}
+
+struct ProblemShape {
+  // Number of (batch, head) pairs.
+  int64_t batch_heads;
+  int64_t q_len;
+  // Number of keys attended to.
+  int64_t kv_len;
+  int64_t head_dim;
+  size_t element_size;
+};
+
+/**
+ * Returns the index in kTileConfigs to use for `shape`. If autotuning is
+ * enabled and the bucket of `shape` has no recorded choice, each candidate is
+ * timed by calling `run` with its index, and the fastest is recorded. `run`
+ * must be safe to call repeatedly with the same inputs.
+ */
+size_t select_tile_config(
+    const ProblemShape& shape,
+    ::executorch::runtime::FunctionRef<void(size_t)> run);
+
+// The choice select_tile_config makes when there is nothing recorded.
+size_t default_tile_config(const ProblemShape& shape);
+
+void set_autotuning_enabled(bool enabled);
+
+bool autotuning_enabled();
+
+/**
+ * Serializes the recorded choices, one bucket per line, for
+ * load_tuning_profile.
+ */
+std::string save_tuning_profile();
+
+/**
+ * Adds the choices in `profile` to the recorded ones. Returns false, leaving
+ * the recorded choices unchanged, if `profile` is malformed or refers to a
+ * tile config that is not in kTileConfigs.
+ */
+bool load_tuning_profile(const std::string& profile);
+
+void clear_tuning_profile();
+
+} // namespace sdpa::tuning
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include <executorch/extension/llm/custom_ops/op_sdpa.h>
+#include <executorch/extension/llm/custom_ops/op_sdpa_tuning.h>
+
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::native::sdpa::tuning::kNumTileConfigs;
+using torch::executor::native::sdpa::tuning::kTileConfigs;
+using torch::executor::native::sdpa::tuning::ProblemShape;
+
+namespace tuning = torch::executor::native::sdpa::tuning;
+
+namespace {
+
+class OpSdpaTuningTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tuning::clear_tuning_profile();
+    tuning::set_autotuning_enabled(false);
+  }
+
+  void TearDown() override {
+    tuning::clear_tuning_profile();
+    tuning::set_autotuning_enabled(false);
+  }
+};
+
+Tensor random_tensor(
+    TensorFactory<ScalarType::Float>& tf,
+    const std::vector<int32_t>& sizes,
+    uint32_t seed) {
+  size_t numel = 1;
+  for (int32_t size : sizes) {
+    numel *= size;
+  }
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(numel);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+  return tf.make(sizes, data);
+}
+
+} // namespace
+
+TEST_F(OpSdpaTuningTest, DefaultConfigIsValid) {
+  for (int64_t q_len : {1, 7, 100, 300, 2000}) {
+    for (int64_t kv_len : {1, 64, 1000, 8192}) {
+      const ProblemShape shape{32, q_len, kv_len, 128, sizeof(float)};
+      const size_t index = tuning::default_tile_config(shape);
+      ASSERT_LT(index, kNumTileConfigs);
+      EXPECT_GT(
+          kTileConfigs[index].kv_split_size, kTileConfigs[index].q_split_size);
+      // 32 heads give every thread work, so the original kv tile is kept.
+      if (kv_len >= 1000) {
+        EXPECT_EQ(kTileConfigs[index].kv_split_size, 512);
+      }
+    }
+  }
+}
+
+TEST_F(OpSdpaTuningTest, AutotuningTimesCandidatesOnceAndRecordsChoice) {
+  tuning::set_autotuning_enabled(true);
+  const ProblemShape shape{8, 1, 4096, 64, sizeof(float)};
+  std::vector<size_t> calls;
+  const size_t chosen =
+      tuning::select_tile_config(shape, [&](size_t i) { calls.push_back(i); });
+  ASSERT_LT(chosen, kNumTileConfigs);
+  // With q_len = 1 the q tile is irrelevant, so only the distinct kv tiles
+  // are timed, each with a warm-up run.
+  std::set<int64_t> kv_split_sizes;
+  for (const auto& tile : kTileConfigs) {
+    kv_split_sizes.insert(tile.kv_split_size);
+  }
+  EXPECT_EQ(calls.size(), 2 * kv_split_sizes.size());
+
+  calls.clear();
+  EXPECT_EQ(
+      tuning::select_tile_config(shape, [&](size_t i) { calls.push_back(i); }),
+      chosen);
+  EXPECT_TRUE(calls.empty());
+
+  // Shapes in the same power-of-two bucket reuse the choice.
+  const ProblemShape similar{8, 1, 3000, 64, sizeof(float)};
+  EXPECT_EQ(
+      tuning::select_tile_config(
+          similar, [&](size_t i) { calls.push_back(i); }),
+      chosen);
+  EXPECT_TRUE(calls.empty());
+}
+
+TEST_F(OpSdpaTuningTest, ProfileRoundTrips) {
+  tuning::set_autotuning_enabled(true);
+  const ProblemShape shape{4, 300, 300, 32, sizeof(float)};
+  const size_t chosen = tuning::select_tile_config(shape, [](size_t) {});
+  const std::string profile = tuning::save_tuning_profile();
+  EXPECT_FALSE(profile.empty());
+
+  tuning::clear_tuning_profile();
+  tuning::set_autotuning_enabled(false);
+  ASSERT_TRUE(tuning::load_tuning_profile(profile));
+  EXPECT_EQ(tuning::save_tuning_profile(), profile);
+  bool ran = false;
+  EXPECT_EQ(
+      tuning::select_tile_config(shape, [&](size_t) { ran = true; }), chosen);
+  EXPECT_FALSE(ran);
+}
+
+TEST_F(OpSdpaTuningTest, MalformedProfileIsRejected) {
+  EXPECT_FALSE(tuning::load_tuning_profile("4 1 8 1 4096 64 32"));
+  // 48 x 96 is not one of the instantiated tile configs.
+  EXPECT_FALSE(tuning::load_tuning_profile("4 1 8 1 4096 64 48 96\n"));
+  EXPECT_TRUE(tuning::save_tuning_profile().empty());
+}
+
+TEST_F(OpSdpaTuningTest, AutotunedAttentionMatchesDefault) {
+  TensorFactory<ScalarType::Float> tf;
+  const std::vector<int32_t> sizes = {1, 2, 200, 16};
+  Tensor query = random_tensor(tf, sizes, 1);
+  Tensor key = random_tensor(tf, sizes, 2);
+  Tensor value = random_tensor(tf, sizes, 3);
+  Tensor expected = tf.zeros(sizes);
+  Tensor out = tf.zeros(sizes);
+
+  KernelRuntimeContext context{};
+  torch::executor::native::flash_attention_kernel_out(
+      context, query, key, value, {}, 0.0, true, {}, expected);
+  tuning::set_autotuning_enabled(true);
+  torch::executor::native::flash_attention_kernel_out(
+      context, query, key, value, {}, 0.0, true, {}, out);
+  EXPECT_EQ(context.failure_state(), executorch::runtime::Error::Ok);
+  EXPECT_TENSOR_CLOSE_WITH_TOL(out, expected, 1e-5, 1e-6);
+  EXPECT_FALSE(tuning::save_tuning_profile().empty());
+}
@@ -14,6 +14,8 @@
 
 #include <executorch/extension/kernel_util/make_boxed_from_unboxed_functor.h>
 
+#include <algorithm>
+
 namespace torch {
 namespace executor {
 
@@ -87,6 +89,127 @@ bool validate_cache_params(
   return true;
 }
 
+// Helper function to validate paged cache parameters
+bool validate_paged_cache_params(
+    const Tensor& value,
+    const Tensor& cache,
+    int64_t start_pos,
+    const Tensor& block_table) {
+  ET_CHECK_OR_RETURN_FALSE(
+      cache.dim() == 4,
+      "cache must be a 4D tensor [num_blocks, block_size, num_heads, head_dim]");
+
+  ET_CHECK_OR_RETURN_FALSE(value.dim() == 4, "value must be a 4D tensor");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      value.size(2) == cache.size(2) && value.size(3) == cache.size(3),
+      "value heads and head dim must match those of the cache");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      value.scalar_type() == cache.scalar_type(),
+      "value and cache must have the same dtype");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.dim() == 2,
+      "block_table must be a 2D tensor [batch_size, max_blocks_per_seq]");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.scalar_type() == ScalarType::Long,
+      "block_table must be of Long (int64_t) type");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      block_table.size(0) == value.size(0),
+      "block_table batch dimension must match value batch dimension");
+
+  const int64_t block_size = cache.size(1);
+  const int64_t capacity = block_table.size(1) * block_size;
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0 && start_pos + value.size(1) <= capacity,
+      "start_pos + seq_length must be at most the block table capacity."
+      "start pos: %" PRId64 ", seq_length: %zd, capacity: %" PRId64,
+      start_pos,
+      value.size(1),
+      capacity);
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(
+          block_table.dim_order().data(), block_table.dim()),
+      "block_table must be in contiguous dim order");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(cache.dim_order().data(), cache.dim()),
+      "cache must be in contiguous dim order");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(value.dim_order().data(), value.dim()),
+      "value must be in contiguous dim order");
+
+  // Only the blocks that this update writes need to be valid.
+  const int64_t* table = block_table.const_data_ptr<int64_t>();
+  const int64_t first_block = start_pos / block_size;
+  const int64_t end_block = (start_pos + value.size(1) + block_size - 1) /
+      block_size;
+  for (int64_t b = 0; b < block_table.size(0); ++b) {
+    for (int64_t blk = first_block; blk < end_block; ++blk) {
+      const int64_t block = table[b * block_table.size(1) + blk];
+      ET_CHECK_OR_RETURN_FALSE(
+          block >= 0 && block < cache.size(0),
+          "block_table[%" PRId64 "][%" PRId64 "] = %" PRId64
+          " not in [0, %zd)",
+          b,
+          blk,
+          block,
+          cache.size(0));
+    }
+  }
+
+  return true;
+}
+
+// Helper function to validate ring-buffer cache parameters
+bool validate_ring_cache_params(
+    const Tensor& value,
+    const Tensor& cache,
+    int64_t start_pos,
+    int64_t sink_size) {
+  ET_CHECK_OR_RETURN_FALSE(cache.dim() == 4, "cache must be a 4D tensor");
+
+  ET_CHECK_OR_RETURN_FALSE(value.dim() == 4, "value must be a 4D tensor");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      value.size(0) == cache.size(0) && value.size(2) == cache.size(2) &&
+          value.size(3) == cache.size(3),
+      "value batch size, heads and head dim must match those of the cache");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      value.scalar_type() == cache.scalar_type(),
+      "value and cache must have the same dtype");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      sink_size >= 0 && sink_size < cache.size(1),
+      "sink_size: %" PRId64 " must be in [0, %zd)",
+      sink_size,
+      cache.size(1));
+
+  // A longer update would overwrite its own first tokens.
+  ET_CHECK_OR_RETURN_FALSE(
+      start_pos >= 0 && value.size(1) <= cache.size(1) - sink_size,
+      "seq_length: %zd must be at most the ring window: %zd, start_pos: %" PRId64,
+      value.size(1),
+      cache.size(1) - sink_size,
+      start_pos);
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(cache.dim_order().data(), cache.dim()),
+      "cache must be in contiguous dim order");
+
+  ET_CHECK_OR_RETURN_FALSE(
+      is_contiguous_dim_order(value.dim_order().data(), value.dim()),
+      "value must be in contiguous dim order");
+
+  return true;
+}
+
 // Helper function for the actual update operation
 Tensor& update_cache_impl(
     RuntimeContext& ctx,
@@ -205,6 +328,98 @@ Tensor& update_cache_impl(
   // Noone uses output. Just a placeholder.
   return output;
 }
+// Writes token s of sequence b to row (start_pos + s) % block_size of its
+// pool block. Tokens that land in the same block are contiguous there, so
+// each run up to a block boundary is a single copy.
+Tensor& update_cache_paged_impl(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    Tensor& output) {
+  const uint8_t* value_data =
+      static_cast<const uint8_t*>(value.const_data_ptr());
+  uint8_t* cache_data = static_cast<uint8_t*>(cache.mutable_data_ptr());
+  const int64_t* table = block_table.const_data_ptr<int64_t>();
+
+  ET_CHECK_MSG(value_data, "projected_value data is null");
+  ET_CHECK_MSG(cache_data, "cache data is null");
+
+  const int64_t block_size = cache.size(1);
+  const int64_t seq_len = value.size(1);
+  const size_t element_size = value.element_size();
+  const size_t bytes_per_token = value.size(2) * value.size(3) * element_size;
+  const size_t cache_block_bytes = cache.strides()[0] * element_size;
+  const size_t value_batch_bytes = value.strides()[0] * element_size;
+
+  for (int64_t batch_line = 0; batch_line < value.size(0); ++batch_line) {
+    const int64_t* batch_table = table + batch_line * block_table.size(1);
+    int64_t seq_idx = 0;
+    while (seq_idx < seq_len) {
+      const int64_t pos = start_pos + seq_idx;
+      const int64_t block_offset = pos % block_size;
+      const int64_t run =
+          std::min(block_size - block_offset, seq_len - seq_idx);
+      std::memcpy(
+          cache_data + batch_table[pos / block_size] * cache_block_bytes +
+              block_offset * bytes_per_token,
+          value_data + batch_line * value_batch_bytes +
+              seq_idx * bytes_per_token,
+          run * bytes_per_token);
+      seq_idx += run;
+    }
+  }
+
+  // Noone uses output. Just a placeholder.
+  return output;
+}
+
+// Writes token t to row t if it is one of the first sink_size tokens, and to
+// row sink_size + (t - sink_size) % window_size otherwise, where window_size
+// is the number of cache rows after the sinks. Tokens between wrap-arounds
+// are contiguous in the cache, so each run is a single copy.
+Tensor& update_cache_ring_impl(
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output) {
+  const uint8_t* value_data =
+      static_cast<const uint8_t*>(value.const_data_ptr());
+  uint8_t* cache_data = static_cast<uint8_t*>(cache.mutable_data_ptr());
+
+  ET_CHECK_MSG(value_data, "projected_value data is null");
+  ET_CHECK_MSG(cache_data, "cache data is null");
+
+  const int64_t window_size = cache.size(1) - sink_size;
+  const int64_t seq_len = value.size(1);
+  const size_t element_size = value.element_size();
+  const size_t bytes_per_token = value.size(2) * value.size(3) * element_size;
+  const size_t cache_batch_bytes = cache.strides()[0] * element_size;
+  const size_t value_batch_bytes = value.strides()[0] * element_size;
+
+  for (int64_t batch_line = 0; batch_line < value.size(0); ++batch_line) {
+    int64_t seq_idx = 0;
+    while (seq_idx < seq_len) {
+      const int64_t pos = start_pos + seq_idx;
+      int64_t row = pos;
+      int64_t run = std::min(sink_size - pos, seq_len - seq_idx);
+      if (pos >= sink_size) {
+        row = sink_size + (pos - sink_size) % window_size;
+        run = std::min(sink_size + window_size - row, seq_len - seq_idx);
+      }
+      std::memcpy(
+          cache_data + batch_line * cache_batch_bytes + row * bytes_per_token,
+          value_data + batch_line * value_batch_bytes +
+              seq_idx * bytes_per_token,
+          run * bytes_per_token);
+      seq_idx += run;
+    }
+  }
+
+  // Noone uses output. Just a placeholder.
+  return output;
+}
 } // anonymous namespace
 
 // Original update_cache_out function without indices parameter
@@ -242,6 +457,40 @@ Tensor& update_cache_with_indices_out(
   return update_cache_impl(ctx, value, cache, start_pos, output, indices);
 }
 
+// Paged variant: cache is a pool of blocks addressed through block_table
+Tensor& update_cache_paged_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    Tensor& output) {
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_paged_cache_params(value, cache, start_pos, block_table),
+      InvalidArgument,
+      output);
+
+  return update_cache_paged_impl(value, cache, start_pos, block_table, output);
+}
+
+// Ring-buffer variant: writes wrap around the rows after the sink_size sinks
+Tensor& update_cache_ring_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output) {
+  ET_KERNEL_CHECK(
+      ctx,
+      validate_ring_cache_params(value, cache, start_pos, sink_size),
+      InvalidArgument,
+      output);
+
+  return update_cache_ring_impl(value, cache, start_pos, sink_size, output);
+}
+
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -262,3 +511,15 @@ EXECUTORCH_LIBRARY(
     llama,
     "update_cache_with_indices.out",
     torch::executor::native::update_cache_with_indices_out);
+
+// Register the update_cache_paged.out op
+EXECUTORCH_LIBRARY(
+    llama,
+    "update_cache_paged.out",
+    torch::executor::native::update_cache_paged_out);
+
+// Register the update_cache_ring.out op
+EXECUTORCH_LIBRARY(
+    llama,
+    "update_cache_ring.out",
+    torch::executor::native::update_cache_ring_out);
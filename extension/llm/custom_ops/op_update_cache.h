@@ -31,6 +31,25 @@ Tensor& update_cache_with_indices_out(
     const int64_t start_pos,
     const Tensor& indices,
     Tensor& output);
+
+// Paged variant: cache is a pool of blocks addressed through block_table
+Tensor& update_cache_paged_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const Tensor& block_table,
+    Tensor& output);
+
+// Ring-buffer variant: the first sink_size rows of the cache keep the first
+// tokens, and later tokens wrap around the remaining rows
+Tensor& update_cache_ring_out(
+    RuntimeContext& ctx,
+    const Tensor& value,
+    Tensor& cache,
+    const int64_t start_pos,
+    const int64_t sink_size,
+    Tensor& output);
 } // namespace native
 } // namespace executor
 } // namespace torch
@@ -21,6 +21,15 @@ def _get_quantized_preproc_flags():
     else:
         return ["-DENABLE_CUSTOM_QUANTIZED_SDPA"]
 
+def _get_sdpa_tile_preproc_flags():
+    """
+    Size constrained builds can set executorch.sdpa_minimal_tile_configs to
+    instantiate only the flash attention tiles of the original fixed dispatch.
+    """
+    if native.read_config("executorch", "sdpa_minimal_tile_configs", "0") != "0":
+        return ["-DET_SDPA_MINIMAL_TILE_CONFIGS"]
+    return []
+
 def define_common_targets():
     """Defines targets that should be shared between fbcode and xplat.
 
@@ -33,20 +42,24 @@ def define_common_targets():
             srcs = [
                 "op_fallback.cpp",
                 "op_fast_hadamard_transform.cpp",
+                "op_rope_update_cache.cpp",
                 "op_sdpa.cpp",
+                "op_sdpa_tuning.cpp",
                 "op_update_cache.cpp",
             ],
             exported_headers = [
                 "op_fallback.h",
                 "op_fast_hadamard_transform.h",
+                "op_rope_update_cache.h",
                 "op_sdpa.h",
+                "op_sdpa_tuning.h",
                 "op_update_cache.h",
             ],
             headers = [
                 "op_sdpa_impl.h",
             ],
             exported_preprocessor_flags = get_vec_preprocessor_flags() +
-                _get_quantized_preproc_flags(),
+                _get_quantized_preproc_flags() + _get_sdpa_tile_preproc_flags(),
             exported_deps = [
                 "//executorch/runtime/kernel:kernel_includes",
                 "//executorch/kernels/portable/cpu:scalar_utils",
@@ -139,6 +152,62 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "op_sdpa_paged_test",
+        srcs = [
+            "op_sdpa_paged_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "op_sdpa_ring_test",
+        srcs = [
+            "op_sdpa_ring_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "op_rope_update_cache_test",
+        srcs = [
+            "op_rope_update_cache_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
+    runtime.cxx_test(
+        name = "op_sdpa_tuning_test",
+        srcs = [
+            "op_sdpa_tuning_test.cpp",
+        ],
+        visibility = ["//executorch/..."],
+        deps = [
+            "//executorch/runtime/core/exec_aten:lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/kernels/test:test_util",
+            ":custom_ops",
+        ],
+    )
+
     ## For preprocess
     runtime.python_library(
         name = "preprocess_custom_ops_py",
@@ -542,3 +542,91 @@ class SDPATestForCustomQuantizedSDPA(unittest.TestCase):
             seq_len,
             is_seq_at_dim_2=False,
         )
+
+    def _quantize_groupwise(self, x, num_groups, bits):
+        """
+        Asymmetric quantization of each group of head_dim / num_groups
+        channels. Returns int8 values, or int4 values packed two per uint8 with
+        the even channel in the low nibble, the float32 scales and int8 zero
+        points of shape [..., num_groups], and the dequantized values.
+        """
+        qmin, qmax = (-128, 127) if bits == 8 else (0, 15)
+        groups = x.reshape(*x.shape[:-1], num_groups, -1)
+        min_val = groups.amin(dim=-1, keepdim=True).clamp(max=0)
+        max_val = groups.amax(dim=-1, keepdim=True).clamp(min=0)
+        scales = ((max_val - min_val) / (qmax - qmin)).clamp(min=1e-9)
+        zero_points = (qmin - torch.round(min_val / scales)).clamp(qmin, qmax)
+        quantized = (torch.round(groups / scales) + zero_points).clamp(qmin, qmax)
+        dequantized = ((quantized - zero_points) * scales).reshape(x.shape)
+        quantized = quantized.reshape(x.shape)
+        if bits == 4:
+            quantized = quantized.to(torch.uint8)
+            quantized = quantized[..., 0::2] | (quantized[..., 1::2] << 4)
+        else:
+            quantized = quantized.to(torch.int8)
+        return (
+            quantized,
+            scales.squeeze(-1).to(torch.float32),
+            zero_points.squeeze(-1).to(torch.int8),
+            dequantized,
+        )
+
+    def _test_groupwise_common(self, num_groups, bits, start_pos, seq_len):
+        n_heads_q = 8
+        n_heads_kv = 4
+        head_dim = 64
+        max_seq_len = 128
+        n_reps = n_heads_q // n_heads_kv
+        q = torch.rand(self.n_batch, seq_len, n_heads_q, head_dim) * 4 - 2
+        k = torch.rand(self.n_batch, max_seq_len, n_heads_kv, head_dim) * 4 - 2
+        v = torch.rand(self.n_batch, max_seq_len, n_heads_kv, head_dim) * 4 - 2
+        q_quantized, q_scale, q_zero_point, q_dequantized = (
+            self._quantize_groupwise(q, 1, 8)
+        )
+        k_quantized, k_scale, k_zero_point, k_dequantized = (
+            self._quantize_groupwise(k, num_groups, bits)
+        )
+        v_quantized, v_scale, v_zero_point, v_dequantized = (
+            self._quantize_groupwise(v, num_groups, bits)
+        )
+
+        num_keys = start_pos + seq_len
+        k_ref = k_dequantized[:, :num_keys].repeat_interleave(n_reps, dim=2)
+        v_ref = v_dequantized[:, :num_keys].repeat_interleave(n_reps, dim=2)
+        attn_mask = torch.full((seq_len, num_keys), float("-inf")).triu(
+            diagonal=start_pos + 1
+        )
+        ref_output = F.scaled_dot_product_attention(
+            q_dequantized.transpose(1, 2),
+            k_ref.transpose(1, 2),
+            v_ref.transpose(1, 2),
+            attn_mask=attn_mask,
+        ).transpose(1, 2)
+
+        op_output = torch.ops.llama.custom_quantized_sdpa(
+            q_quantized,
+            k_quantized,
+            v_quantized,
+            start_pos,
+            None,
+            0,
+            True,
+            None,
+            q_zero_point,
+            q_scale,
+            k_zero_point,
+            k_scale,
+            v_zero_point,
+            v_scale,
+            False,
+        )
+        self.assertTrue(torch.allclose(ref_output, op_output, atol=1e-4))
+
+    def test_sdpa_with_custom_quantized_groupwise_int8(self):
+        self._test_groupwise_common(num_groups=2, bits=8, start_pos=0, seq_len=24)
+        self._test_groupwise_common(num_groups=2, bits=8, start_pos=100, seq_len=1)
+
+    def test_sdpa_with_custom_quantized_int4(self):
+        self._test_groupwise_common(num_groups=1, bits=4, start_pos=90, seq_len=1)
+        self._test_groupwise_common(num_groups=4, bits=4, start_pos=0, seq_len=24)
+        self._test_groupwise_common(num_groups=4, bits=4, start_pos=100, seq_len=1)
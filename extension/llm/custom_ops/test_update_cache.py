@@ -431,3 +431,75 @@ class UpdateQuantizedKVCacheTest(unittest.TestCase):
         self._update_and_validate(
             k, v, k_scales, v_scales, k_zero_points, v_zero_points, start_pos
         )
+
+    def test_update_paged_cache(self):
+        block_size = 4
+        num_blocks = 9
+        batch_size = 2
+        # Sequence 0 owns blocks 5, 1, 7 and sequence 1 owns blocks 0, 8, 3.
+        block_table = torch.tensor([[5, 1, 7], [0, 8, 3]], dtype=torch.int64)
+        cache = torch.zeros((num_blocks, block_size, 8, 4), dtype=torch.int8)
+        expected = torch.zeros((batch_size, 3 * block_size, 8, 4), dtype=torch.int8)
+
+        # A prefill that crosses a block boundary, then a decode step.
+        for start_pos, seq_len in [(0, 6), (6, 1)]:
+            k = torch.randint(0, 50, (batch_size, seq_len, 8, 4), dtype=torch.int8)
+            expected[:, start_pos : start_pos + seq_len] = k
+            torch.ops.llama.update_cache_paged(k, cache, start_pos, block_table)
+
+        for b in range(batch_size):
+            gathered = cache[block_table[b]].reshape(3 * block_size, 8, 4)
+            self.assertTrue(torch.equal(gathered[:7], expected[b, :7]))
+
+    def test_rope_update_cache(self):
+        batch_size, max_seq_len, n_heads, n_kv_heads, head_dim = 2, 10, 4, 2, 8
+        k_cache = torch.zeros((batch_size, max_seq_len, n_kv_heads, head_dim))
+        v_cache = torch.zeros((batch_size, max_seq_len, n_kv_heads, head_dim))
+        inv_freq = 1.0 / (10000 ** (torch.arange(0, head_dim, 2).float() / head_dim))
+        angles = torch.outer(torch.arange(max_seq_len).float(), inv_freq)
+
+        def rotate(x, cos, sin):
+            # apply_rotary_emb of examples/models/llama/rope.py.
+            x_r, x_i = x.reshape(x.shape[:-1] + (-1, 2)).unbind(-1)
+            cos, sin = cos[None, :, None, :], sin[None, :, None, :]
+            return torch.stack(
+                [x_r * cos - x_i * sin, x_r * sin + x_i * cos], dim=-1
+            ).flatten(3)
+
+        # A prefill, then a decode step.
+        for start_pos, seq_len in [(0, 6), (6, 1)]:
+            q = torch.rand((batch_size, seq_len, n_heads, head_dim))
+            k = torch.rand((batch_size, seq_len, n_kv_heads, head_dim))
+            v = torch.rand((batch_size, seq_len, n_kv_heads, head_dim))
+            cos = torch.cos(angles[start_pos : start_pos + seq_len])
+            sin = torch.sin(angles[start_pos : start_pos + seq_len])
+
+            out = torch.ops.llama.rope_update_cache(
+                q, k, v, cos, sin, k_cache, v_cache, start_pos
+            )
+            end = start_pos + seq_len
+            self.assertTrue(torch.allclose(out, rotate(q, cos, sin), atol=1e-6))
+            self.assertTrue(
+                torch.allclose(
+                    k_cache[:, start_pos:end], rotate(k, cos, sin), atol=1e-6
+                )
+            )
+            self.assertTrue(torch.equal(v_cache[:, start_pos:end], v))
+
+    def test_update_ring_cache(self):
+        sink_size, window_size = 2, 5
+        cache = torch.zeros((1, sink_size + window_size, 2, 4), dtype=torch.int8)
+        tokens = torch.randint(0, 50, (1, 13, 2, 4), dtype=torch.int8)
+
+        # A prefill, then decode steps that wrap around the window twice.
+        start_pos = 0
+        for seq_len in [4, 3] + [1] * 6:
+            torch.ops.llama.update_cache_ring(
+                tokens[:, start_pos : start_pos + seq_len], cache, start_pos, sink_size
+            )
+            start_pos += seq_len
+
+        self.assertTrue(torch.equal(cache[:, :sink_size], tokens[:, :sink_size]))
+        for t in range(start_pos - window_size, start_pos):
+            row = sink_size + (t - sink_size) % window_size
+            self.assertTrue(torch.equal(cache[:, row], tokens[:, t]))
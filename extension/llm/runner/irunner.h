@@ -39,6 +39,11 @@ struct GenerationConfig {
   // Whether this is a warmup run (affects perf benchmarking)
   bool warming = false;
 
+  // Whether to print the generated text to stdout as it is generated. The
+  // token callback is called either way. Benchmarks that time tokens from the
+  // callback turn this off, so that terminal I/O doesn't count as latency.
+  bool print_output = true;
+
   // Maximum number of total tokens
   // If the .pte file contains the max_context_len metadata, it will override
   // this value if it's smaller. If this field is -1, we will use the
@@ -246,6 +246,55 @@ TEST_F(RunnerTest, GenerateCallsCallbackExactlyMaxNewTokensTimes) {
   EXPECT_EQ(err, Error::Ok);
 }
 
+// Test that generate() leaves stdout to the caller when print_output is off
+TEST_F(RunnerTest, GenerateWithoutPrintOutputOnlyCallsCallback) {
+  auto tokenizer = createMockTokenizer();
+  auto text_decoder_runner = createMockTextDecoderRunner();
+  auto text_prefiller = createMockTextPrefiller(text_decoder_runner.get());
+
+  EXPECT_CALL(*tokenizer, encode(_, _, _))
+      .WillOnce(Return(::tokenizers::Result<std::vector<uint64_t>>(
+          std::vector<uint64_t>{1, 2, 3})));
+  EXPECT_CALL(*text_prefiller, prefill(_, _))
+      .WillOnce(Return(Result<uint64_t>(4)));
+  EXPECT_CALL(*text_prefiller, is_loaded()).WillRepeatedly(Return(true));
+
+  std::unique_ptr<executorch::llm::Stats> stats =
+      std::make_unique<executorch::llm::Stats>();
+  auto text_token_generator = createTextTokenGenerator(
+      tokenizer.get(), text_decoder_runner.get(), stats.get());
+
+  TextLLMRunner runner(
+      createDefaultMetadata(),
+      std::unique_ptr<::tokenizers::Tokenizer>(tokenizer.release()),
+      std::make_unique<MockModule>(),
+      std::move(text_decoder_runner),
+      std::unique_ptr<::executorch::extension::llm::TextPrefiller>(
+          text_prefiller.release()),
+      std::move(text_token_generator),
+      std::move(stats));
+  runner.load();
+
+  GenerationConfig config;
+  config.max_new_tokens = 5;
+  config.echo = false;
+  config.print_output = false;
+
+  CallbackCounter counter;
+  testing::internal::CaptureStdout();
+  Error err = runner.generate(
+      "test prompt", config, [&counter](const std::string& token) {
+        counter.callback(token);
+      });
+  const std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(counter.getCount(), config.max_new_tokens);
+  // Every piece decodes to "token". Only the stats report, which is printed
+  // after generation, remains.
+  EXPECT_EQ(output.find("tokentoken"), std::string::npos);
+}
+
 // Test that warmup() calls generate with the warming flag set
 TEST_F(RunnerTest, WarmupCallsGenerateWithWarmingFlag) {
   // Create mock instances using helper functions
@@ -102,7 +102,7 @@ Error TextLLMRunner::generate_from_pos(
   // Wrap the token_callback with print function
   std::function<void(const std::string&)> wrapped_callback =
       [token_callback, config](const std::string& piece) {
-        if (!config.warming) {
+        if (!config.warming && config.print_output) {
           llm::safe_printf(piece.c_str());
           fflush(stdout);
         }
@@ -195,7 +195,7 @@ Error TextLLMRunner::generate_from_pos(
       wrapped_callback));
 
   stats_->inference_end_ms = time_in_ms();
-  if (!config.warming) {
+  if (!config.warming && config.print_output) {
     printf("\n");
   }
   RUNNER_ET_LOG(
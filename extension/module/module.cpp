@@ -215,8 +215,13 @@ runtime::Error Module::load_method(
               method_holder.planned_spans.size()));
       planned_memory = method_holder.planned_memory.get();
     }
+    method_holder.dynamic_allocator =
+        std::make_unique<runtime::SizeClassAllocator>();
     method_holder.memory_manager = std::make_unique<runtime::MemoryManager>(
-        memory_allocator_.get(), planned_memory, temp_allocator_.get());
+        memory_allocator_.get(),
+        planned_memory,
+        temp_allocator_.get(),
+        method_holder.dynamic_allocator.get());
     method_holder.method = ET_UNWRAP_UNIQUE(program_->load_method(
         method_name.c_str(),
         method_holder.memory_manager.get(),
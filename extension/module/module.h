@@ -15,6 +15,7 @@
 #include <vector>
 
 #include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/executor/size_class_allocator.h>
 
 #ifdef USE_ATEN_LIB
 #define ET_MODULE_NAMESPACE module::aten
@@ -500,6 +501,7 @@ class Module {
     std::vector<std::vector<uint8_t>> planned_buffers;
     std::vector<runtime::Span<uint8_t>> planned_spans;
     std::unique_ptr<runtime::HierarchicalAllocator> planned_memory;
+    std::unique_ptr<runtime::SizeClassAllocator> dynamic_allocator;
     std::unique_ptr<runtime::MemoryManager> memory_manager;
     std::unique_ptr<Method> method;
     std::vector<runtime::EValue> inputs;
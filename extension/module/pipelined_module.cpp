@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/pipelined_module.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+PipelinedModule::PipelinedModule(
+    Module& module,
+    std::string method_name,
+    size_t num_input_sets)
+    : module_(module),
+      method_name_(std::move(method_name)),
+      num_input_sets_(num_input_sets) {}
+
+runtime::Error PipelinedModule::allocate_input_sets() {
+  const auto meta = ET_UNWRAP(module_.method_meta(method_name_));
+  input_sets_.resize(num_input_sets_);
+  for (auto& inputs : input_sets_) {
+    inputs.resize(meta.num_inputs());
+    for (size_t i = 0; i < meta.num_inputs(); ++i) {
+      if (ET_UNWRAP(meta.input_tag(i)) != runtime::Tag::Tensor) {
+        continue;
+      }
+      const auto tensor_meta = ET_UNWRAP(meta.input_tensor_meta(i));
+      const auto sizes = tensor_meta.sizes();
+      const auto dim_order = tensor_meta.dim_order();
+      std::vector<executorch::aten::StridesType> strides(sizes.size());
+      runtime::dim_order_to_stride_nocheck(
+          sizes.data(), dim_order.data(), sizes.size(), strides.data());
+      auto tensor = empty_strided(
+          {sizes.begin(), sizes.end()},
+          std::move(strides),
+          tensor_meta.scalar_type());
+      inputs[i] = *tensor;
+      input_tensors_.push_back(std::move(tensor));
+    }
+  }
+  return runtime::Error::Ok;
+}
+
+runtime::Error PipelinedModule::run(
+    const Producer& producer,
+    const Consumer& consumer) {
+  ET_CHECK_OR_RETURN_ERROR(
+      num_input_sets_ >= 2,
+      InvalidArgument,
+      "Pipelining needs at least two input sets, got %zu",
+      num_input_sets_);
+  // Load on this thread, so that the producer thread never touches the module.
+  ET_CHECK_OK_OR_RETURN_ERROR(module_.load_method(method_name_));
+  if (input_sets_.empty()) {
+    ET_CHECK_OK_OR_RETURN_ERROR(allocate_input_sets());
+  }
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<size_t> free_sets;
+  // (request index, input set) pairs ready to execute, in request order.
+  std::deque<std::pair<size_t, size_t>> ready_sets;
+  bool produced_all = false;
+  bool stopped = false;
+  for (size_t set = 0; set < num_input_sets_; ++set) {
+    free_sets.push_back(set);
+  }
+
+  std::thread producer_thread([&]() {
+    for (size_t index = 0;; ++index) {
+      size_t set = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return stopped || !free_sets.empty(); });
+        if (stopped) {
+          return;
+        }
+        set = free_sets.front();
+        free_sets.pop_front();
+      }
+      const bool produced = producer(index, input_sets_[set]);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (produced) {
+          ready_sets.emplace_back(index, set);
+        } else {
+          produced_all = true;
+        }
+      }
+      condition.notify_all();
+      if (!produced) {
+        return;
+      }
+    }
+  });
+
+  runtime::Error error = runtime::Error::Ok;
+  for (;;) {
+    std::pair<size_t, size_t> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(
+          lock, [&]() { return produced_all || !ready_sets.empty(); });
+      if (ready_sets.empty()) {
+        break;
+      }
+      request = ready_sets.front();
+      ready_sets.pop_front();
+    }
+    auto outputs = module_.execute(method_name_, input_sets_[request.second]);
+    if (!outputs.ok()) {
+      error = outputs.error();
+      break;
+    }
+    error = consumer(request.first, outputs.get());
+    if (error != runtime::Error::Ok) {
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free_sets.push_back(request.second);
+    }
+    condition.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+  }
+  condition.notify_all();
+  producer_thread.join();
+  return error;
+}
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor.h>
+
+namespace executorch {
+namespace extension {
+namespace ET_MODULE_NAMESPACE {
+
+/**
+ * Runs a stream of requests through a method of a Module, preparing the inputs
+ * of the next request on a background thread while the current one executes.
+ *
+ * The pipeline owns a few sets of input tensors, allocated once with the
+ * shapes and dtypes of the method inputs. A producer callback fills a free set
+ * on the background thread; the calling thread executes the method on filled
+ * sets in order and hands the outputs to a consumer callback, after which the
+ * set goes back to the producer. With two sets, preparing request N + 1
+ * overlaps with executing request N; more sets absorb jitter in the producer.
+ *
+ * The Module must not be used by anything else while run() is in progress.
+ */
+class ET_EXPERIMENTAL PipelinedModule final {
+ public:
+  /**
+   * Fills the inputs of a request.
+   *
+   * Called on the background thread with the index of the request and an
+   * input set holding one preallocated tensor per tensor input of the method,
+   * and None for other inputs. The producer writes the data of the tensors in
+   * place, may resize them within their bounds or replace any of the values,
+   * and leaves None values unchanged to reuse the previous value of that
+   * input. Returns false, without filling the set, when the stream has ended.
+   */
+  using Producer =
+      std::function<bool(size_t index, std::vector<runtime::EValue>& inputs)>;
+
+  /**
+   * Takes the outputs of a request.
+   *
+   * Called on the thread that called run(), in request order. The outputs
+   * may alias memory of the method, so they are only valid during the call.
+   * Returning an error stops the pipeline.
+   */
+  using Consumer = std::function<runtime::Error(
+      size_t index,
+      const std::vector<runtime::EValue>& outputs)>;
+
+  /**
+   * Constructs a pipeline over a method of a module.
+   *
+   * @param[in] module The module to execute. Must outlive the pipeline.
+   * @param[in] method_name The name of the method to execute.
+   * @param[in] num_input_sets The number of input sets in rotation, at least
+   * two.
+   */
+  explicit PipelinedModule(
+      Module& module,
+      std::string method_name = "forward",
+      size_t num_input_sets = 2);
+
+  PipelinedModule(const PipelinedModule&) = delete;
+  PipelinedModule& operator=(const PipelinedModule&) = delete;
+  PipelinedModule(PipelinedModule&&) = delete;
+  PipelinedModule& operator=(PipelinedModule&&) = delete;
+  ~PipelinedModule() = default;
+
+  /**
+   * Runs requests until the producer reports the end of the stream. Loads the
+   * method and allocates the input sets on the first call.
+   *
+   * @param[in] producer Fills the inputs of each request.
+   * @param[in] consumer Takes the outputs of each request.
+   *
+   * @returns Error::Ok once every produced request has been consumed, or the
+   * first error from loading or executing the method or from the consumer.
+   */
+  ET_NODISCARD runtime::Error run(
+      const Producer& producer,
+      const Consumer& consumer);
+
+  /**
+   * The number of input sets in rotation.
+   */
+  size_t num_input_sets() const {
+    return num_input_sets_;
+  }
+
+ private:
+  runtime::Error allocate_input_sets();
+
+  Module& module_;
+  const std::string method_name_;
+  const size_t num_input_sets_;
+  std::vector<std::vector<runtime::EValue>> input_sets_;
+  std::vector<TensorPtr> input_tensors_;
+};
+
+} // namespace ET_MODULE_NAMESPACE
+} // namespace extension
+} // namespace executorch
+
+namespace executorch {
+namespace extension {
+using ::executorch::extension::ET_MODULE_NAMESPACE::PipelinedModule;
+} // namespace extension
+} // namespace executorch
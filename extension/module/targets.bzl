@@ -32,6 +32,23 @@ def define_common_targets():
             ],
         )
 
+        runtime.cxx_library(
+            name = "pipelined_module" + aten_suffix,
+            srcs = [
+                "pipelined_module.cpp",
+            ],
+            exported_headers = [
+                "pipelined_module.h",
+            ],
+            visibility = [
+                "@EXECUTORCH_CLIENTS",
+            ],
+            exported_deps = [
+                "//executorch/extension/module:module" + aten_suffix,
+                "//executorch/extension/tensor:tensor" + aten_suffix,
+            ],
+        )
+
         runtime.cxx_library(
             name = "bundled_module" + aten_suffix,
             srcs = [
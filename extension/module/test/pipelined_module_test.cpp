@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/module/pipelined_module.h>
+
+#include <gtest/gtest.h>
+
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+
+using namespace ::executorch::extension;
+using namespace ::executorch::runtime;
+
+class PipelinedModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    model_path_ = std::getenv("ET_MODULE_ADD_PATH");
+  }
+
+  static inline std::string model_path_;
+};
+
+TEST_F(PipelinedModuleTest, TestRunsRequestsInOrder) {
+  Module module(model_path_);
+  PipelinedModule pipeline(module, "forward", 3);
+
+  constexpr size_t kNumRequests = 7;
+  std::vector<size_t> consumed;
+  const auto error = pipeline.run(
+      [&](size_t index, std::vector<EValue>& inputs) {
+        if (index == kNumRequests) {
+          return false;
+        }
+        // ModuleAdd computes x + alpha * y over 2x2 float tensors.
+        EXPECT_EQ(inputs.size(), 3);
+        for (size_t i = 0; i < 2; ++i) {
+          auto& tensor = inputs[i].toTensor();
+          EXPECT_EQ(tensor.numel(), 4);
+          std::fill_n(tensor.mutable_data_ptr<float>(), 4, float(index));
+        }
+        inputs[2] = 1.0;
+        return true;
+      },
+      [&](size_t index, const std::vector<EValue>& outputs) {
+        const auto expected = full({2, 2}, 2.f * index);
+        EXPECT_TENSOR_CLOSE(outputs.at(0).toTensor(), *expected);
+        consumed.push_back(index);
+        return Error::Ok;
+      });
+
+  EXPECT_EQ(error, Error::Ok);
+  ASSERT_EQ(consumed.size(), kNumRequests);
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    EXPECT_EQ(consumed[i], i);
+  }
+}
+
+TEST_F(PipelinedModuleTest, TestConsumerErrorStopsPipeline) {
+  Module module(model_path_);
+  PipelinedModule pipeline(module);
+
+  size_t consumed = 0;
+  const auto error = pipeline.run(
+      [&](size_t, std::vector<EValue>& inputs) {
+        inputs[2] = 1.0;
+        return true;
+      },
+      [&](size_t index, const std::vector<EValue>&) {
+        ++consumed;
+        return index == 2 ? Error::Internal : Error::Ok;
+      });
+
+  EXPECT_EQ(error, Error::Internal);
+  EXPECT_EQ(consumed, 3);
+}
+
+TEST_F(PipelinedModuleTest, TestNeedsTwoInputSets) {
+  Module module(model_path_);
+  PipelinedModule pipeline(module, "forward", 1);
+
+  const auto error = pipeline.run(
+      [](size_t, std::vector<EValue>&) { return false; },
+      [](size_t, const std::vector<EValue>&) { return Error::Ok; });
+
+  EXPECT_EQ(error, Error::InvalidArgument);
+}
+
+TEST_F(PipelinedModuleTest, TestNonExistentMethod) {
+  Module module(model_path_);
+  PipelinedModule pipeline(module, "backward");
+
+  const auto error = pipeline.run(
+      [](size_t, std::vector<EValue>&) { return false; },
+      [](size_t, const std::vector<EValue>&) { return Error::Ok; });
+
+  EXPECT_NE(error, Error::Ok);
+}
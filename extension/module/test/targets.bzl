@@ -43,6 +43,24 @@ def define_common_targets(is_fbcode=False):
                 ],
             )
 
+            runtime.cxx_test(
+                name = "pipelined_test" + aten_suffix,
+                srcs = [
+                    "pipelined_module_test.cpp",
+                ],
+                deps = [
+                    "//executorch/kernels/portable:generated_lib" + aten_suffix,
+                    "//executorch/extension/module:pipelined_module" + aten_suffix,
+                    "//executorch/extension/tensor:tensor" + aten_suffix,
+                    "//executorch/runtime/core/exec_aten/testing_util:tensor_util" + aten_suffix,
+                ],
+                env = modules_env,
+                platforms = [CXX, ANDROID],  # Cannot bundle resources on Apple platform.
+                compiler_flags = [
+                    "-Wno-error=deprecated-declarations",
+                ],
+            )
+
             runtime.cxx_test(
                 name = "bundled_test" + aten_suffix,
                 srcs = [
@@ -7,11 +7,16 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <pybind11/iostream.h>
 #include <pybind11/pybind11.h>
@@ -154,6 +159,413 @@ void setup_output_storage(
   }
 }
 
+/// A wrapper/util class for executorch memory allocations/manager.
+class ProgramMemory {
+ public:
+  explicit ProgramMemory(std::vector<std::vector<uint8_t>>&& non_const_buffers)
+      : runtime_allocator_(),
+        non_const_buffers_(std::move(non_const_buffers)),
+        non_const_spans_(create_non_const_spans()),
+        non_const_allocator_(
+            {non_const_spans_.data(), non_const_spans_.size()}),
+        mem_manager_(
+            &const_allocator_,
+            &non_const_allocator_,
+            &runtime_allocator_,
+            &temp_allocator_) {}
+
+  /// Returns a pointer to the internal memory manager, the Memory instance
+  /// must outlive this pointer.
+  MemoryManager* mem_manager() {
+    return &mem_manager_;
+  }
+
+  ProgramMemory(const ProgramMemory&) = delete;
+  ProgramMemory& operator=(const ProgramMemory&) = delete;
+
+ private:
+  MemoryAllocator const_allocator_{MemoryAllocator(0, nullptr)};
+
+  MallocMemoryAllocator runtime_allocator_;
+
+  MemoryAllocator temp_allocator_{MemoryAllocator(0, nullptr)};
+
+  std::vector<std::vector<uint8_t>> non_const_buffers_;
+
+  std::vector<Span<uint8_t>> non_const_spans_;
+
+  HierarchicalAllocator non_const_allocator_;
+
+  MemoryManager mem_manager_;
+
+  std::vector<Span<uint8_t>> create_non_const_spans() {
+    std::vector<Span<uint8_t>> result;
+    for (size_t i = 0; i < non_const_buffers_.size(); i++) {
+      result.push_back(
+          {non_const_buffers_[i].data(), non_const_buffers_[i].size()});
+    }
+    return result;
+  }
+};
+
+/// One sample of a run_many() batch: its inputs, and its outputs once it has
+/// run.
+struct RunManySample final {
+  std::vector<EValue> inputs;
+#ifndef USE_ATEN_LIB
+  // The ETensors that the tensors in `inputs` point to.
+  std::vector<TensorPtr> input_tensors;
+#endif
+  // Non-tensor outputs. Tensor outputs are None here and in `output_tensors`
+  // instead.
+  std::vector<EValue> outputs;
+  std::vector<at::Tensor> output_tensors;
+  Error error = Error::Ok;
+};
+
+/// Returns the ATen dtype of the items of a buffer protocol object, or throws
+/// if there is none.
+c10::ScalarType buffer_scalar_type(const py::buffer_info& info) {
+  // Skip any byte order or alignment prefix.
+  const char kind = info.format.empty() ? '\0' : info.format.back();
+  switch (kind) {
+    case '?':
+      return c10::ScalarType::Bool;
+    case 'B':
+      if (info.itemsize == 1) {
+        return c10::ScalarType::Byte;
+      }
+      break;
+    case 'b':
+    case 'h':
+    case 'i':
+    case 'l':
+    case 'q':
+      switch (info.itemsize) {
+        case 1:
+          return c10::ScalarType::Char;
+        case 2:
+          return c10::ScalarType::Short;
+        case 4:
+          return c10::ScalarType::Int;
+        case 8:
+          return c10::ScalarType::Long;
+      }
+      break;
+    case 'e':
+      return c10::ScalarType::Half;
+    case 'f':
+      return c10::ScalarType::Float;
+    case 'd':
+      return c10::ScalarType::Double;
+  }
+  throw std::runtime_error(
+      "Unsupported buffer format '" + info.format + "' with item size " +
+      std::to_string(info.itemsize));
+}
+
+/// Appends a Python input to `sample` without copying its data. Tensors and
+/// buffer protocol objects, such as numpy arrays, are aliased, so they must
+/// stay alive until the sample has run.
+void append_run_many_input(
+    const py::handle& python_input,
+    size_t index,
+    RunManySample& sample) {
+  const std::string& type_str = py::str(python_input.get_type());
+  at::Tensor at_tensor;
+  if (type_str == "<class 'torch.Tensor'>") {
+    at_tensor = python_input.cast<at::Tensor>();
+  } else if (py::isinstance<py::none>(python_input)) {
+    sample.inputs.emplace_back();
+    return;
+  } else if (py::isinstance<py::bool_>(python_input)) {
+    sample.inputs.emplace_back(py::cast<bool>(python_input));
+    return;
+  } else if (py::isinstance<py::int_>(python_input)) {
+    sample.inputs.emplace_back(py::cast<int64_t>(python_input));
+    return;
+  } else if (py::isinstance<py::buffer>(python_input)) {
+    const py::buffer_info info =
+        py::reinterpret_borrow<py::buffer>(python_input).request();
+    std::vector<int64_t> strides(info.strides.size());
+    for (size_t d = 0; d < strides.size(); ++d) {
+      if (info.strides[d] % info.itemsize != 0) {
+        throw std::runtime_error(
+            "Input " + std::to_string(index) +
+            " has strides that are not a multiple of its item size.");
+      }
+      strides[d] = info.strides[d] / info.itemsize;
+    }
+    at_tensor = at::from_blob(
+        info.ptr,
+        std::vector<int64_t>(info.shape.begin(), info.shape.end()),
+        strides,
+        at::TensorOptions().dtype(buffer_scalar_type(info)));
+  } else {
+    throw std::runtime_error(
+        "Unsupported python type " + type_str +
+        ". Ensure that inputs are passed as a flat list of tensors.");
+  }
+
+#ifdef USE_ATEN_LIB
+  sample.inputs.emplace_back(at_tensor);
+#else
+  const size_t dim = at_tensor.dim();
+  // Only works for MemoryFormat::Contiguous or MemoryFormat::ChannelsLast
+  // inputs
+  std::vector<torch::executor::Tensor::DimOrderType> dim_order;
+  if (at_tensor.is_contiguous()) {
+    for (size_t cur_dim = 0; cur_dim < dim; cur_dim++) {
+      dim_order.push_back(cur_dim);
+    }
+  } else if (
+      at_tensor.is_contiguous(at::MemoryFormat::ChannelsLast) &&
+      at_tensor.dim() == 4) {
+    dim_order = decltype(dim_order)({0, 2, 3, 1});
+  } else {
+    throw std::runtime_error(
+        "Input " + std::to_string(index) +
+        " should be contiguous or channels-last.");
+  }
+  sample.input_tensors.push_back(
+      for_blob(
+          at_tensor.data_ptr(),
+          std::vector<int>(at_tensor.sizes().begin(), at_tensor.sizes().end()),
+          torch_to_executorch_scalar_type(at_tensor.options().dtype()))
+          .strides(std::vector<int>(
+              at_tensor.strides().begin(), at_tensor.strides().end()))
+          .dim_order(std::move(dim_order))
+          .dynamism(aten::TensorShapeDynamism::STATIC)
+          .make_tensor_ptr());
+  sample.inputs.emplace_back(sample.input_tensors.back());
+#endif
+}
+
+/// Runs one sample on `method`. Doesn't need the GIL.
+Error run_sample(Method& method, RunManySample& sample) {
+  Error err = method.set_inputs(
+      executorch::aten::ArrayRef<EValue>(
+          sample.inputs.data(), sample.inputs.size()));
+  if (err != Error::Ok) {
+    return err;
+  }
+
+  // Outputs that aren't memory planned are written straight into tensors
+  // that Python will own.
+  const auto meta = method.method_meta();
+  const size_t num_outputs = method.outputs_size();
+  std::vector<at::Tensor> output_storages(num_outputs);
+  for (size_t i = 0; i < num_outputs; ++i) {
+    auto output_type = meta.output_tag(i);
+    if (!output_type.ok() || output_type.get() != Tag::Tensor) {
+      continue;
+    }
+    auto output_tensor_meta = meta.output_tensor_meta(i);
+    if (!output_tensor_meta.ok() ||
+        output_tensor_meta->is_memory_planned() ||
+        output_tensor_meta->nbytes() == 0) {
+      continue;
+    }
+    output_storages[i] = at::empty(
+        {static_cast<int64_t>(output_tensor_meta->nbytes())}, at::kByte);
+    err = method.set_output_data_ptr(
+        output_storages[i].data_ptr(), output_tensor_meta->nbytes(), i);
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
+  err = method.execute();
+  if (err != Error::Ok) {
+    return err;
+  }
+  sample.outputs.resize(num_outputs);
+  err = method.get_outputs(sample.outputs.data(), num_outputs);
+  if (err != Error::Ok) {
+    return err;
+  }
+
+  sample.output_tensors.resize(num_outputs);
+  for (size_t i = 0; i < num_outputs; ++i) {
+    if (!sample.outputs[i].isTensor()) {
+      continue;
+    }
+#ifdef USE_ATEN_LIB
+    at::Tensor view = sample.outputs[i].toTensor();
+#else
+    at::Tensor view = alias_attensor_to_etensor(sample.outputs[i].toTensor());
+#endif
+    if (output_storages[i].defined()) {
+      // Keeps the storage alive for as long as the view.
+      sample.output_tensors[i] = at::from_blob(
+          view.data_ptr(),
+          view.sizes(),
+          view.strides(),
+          [storage = output_storages[i]](void*) {},
+          view.options());
+    } else {
+      // Memory planned, so the next sample would overwrite it.
+      sample.output_tensors[i] = view.clone();
+    }
+    // The EValue points into the method's memory.
+    sample.outputs[i] = EValue();
+  }
+  return Error::Ok;
+}
+
+/// Instances of one method for run_many(), each with its own memory so that
+/// they can execute at the same time. Instances are loaded on first use and
+/// kept for later batches.
+class MethodPool final {
+ public:
+  MethodPool(const Program* program, std::string method_name)
+      : program_(program), method_name_(std::move(method_name)) {}
+
+  MethodPool(const MethodPool&) = delete;
+  MethodPool& operator=(const MethodPool&) = delete;
+
+  /// Runs every sample on up to `num_workers` instances, each on its own
+  /// thread, and returns once all have run. Must be called without the GIL.
+  /// Concurrent calls run one after another.
+  Error run(std::vector<RunManySample>& samples, size_t num_workers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_workers = std::max<size_t>(1, std::min(num_workers, samples.size()));
+    while (instances_.size() < num_workers) {
+      Error err = add_instance();
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+
+    // Samples are handed out one at a time, so that slow samples don't hold
+    // up the rest of a worker's share.
+    std::atomic<size_t> next_sample{0};
+    auto work = [&](Method& method) {
+#ifdef USE_ATEN_LIB
+      // See [TLS handling] in Module::run_method().
+      c10::impl::ExcludeDispatchKeyGuard no_autograd(
+          c10::autograd_dispatch_keyset);
+#endif
+      for (size_t i = next_sample++; i < samples.size(); i = next_sample++) {
+        samples[i].error = run_sample(method, samples[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < num_workers; ++w) {
+      threads.emplace_back(work, std::ref(*instances_[w].method));
+    }
+    work(*instances_[0].method);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return Error::Ok;
+  }
+
+ private:
+  struct Instance {
+    std::unique_ptr<ProgramMemory> memory;
+    std::unique_ptr<Method> method;
+  };
+
+  Error add_instance() {
+    Result<torch::executor::MethodMeta> meta =
+        program_->method_meta(method_name_.c_str());
+    if (!meta.ok()) {
+      return meta.error();
+    }
+    std::vector<std::vector<uint8_t>> non_const_buffers;
+    for (size_t i = 0; i < meta->num_non_const_buffers(); ++i) {
+      non_const_buffers.emplace_back(meta->non_const_buffer_size(i).get());
+    }
+    Instance instance;
+    instance.memory =
+        std::make_unique<ProgramMemory>(std::move(non_const_buffers));
+    // No event tracer, since ETDumpGen isn't thread-safe.
+    Result<Method> method = program_->load_method(
+        method_name_.c_str(), instance.memory->mem_manager());
+    if (!method.ok()) {
+      return method.error();
+    }
+    instance.method = std::make_unique<Method>(std::move(method.get()));
+    instances_.push_back(std::move(instance));
+    return Error::Ok;
+  }
+
+  const Program* program_;
+  const std::string method_name_;
+  std::mutex mutex_;
+  std::vector<Instance> instances_;
+};
+
+/// Runs each sequence of inputs in `inputs_list` through `pool` and returns
+/// a list with the outputs of each. Converts the inputs with the GIL held,
+/// then releases it for the whole batch.
+py::list run_many_on_pool(
+    MethodPool& pool,
+    const std::string& method_name,
+    const py::sequence& inputs_list,
+    size_t num_workers) {
+  if (num_workers == 0) {
+    throw std::invalid_argument("num_workers must be at least 1");
+  }
+  const size_t num_samples = py::len(inputs_list);
+  std::vector<RunManySample> samples(num_samples);
+  for (size_t i = 0; i < num_samples; ++i) {
+    const auto inputs = inputs_list[i].cast<py::sequence>();
+    const size_t num_inputs = py::len(inputs);
+    samples[i].inputs.reserve(num_inputs);
+#ifndef USE_ATEN_LIB
+    samples[i].input_tensors.reserve(num_inputs);
+#endif
+    for (size_t j = 0; j < num_inputs; ++j) {
+      append_run_many_input(inputs[j], j, samples[i]);
+    }
+  }
+
+  Error err = Error::Ok;
+  {
+    py::gil_scoped_release no_gil;
+    err = pool.run(samples, num_workers);
+  }
+  THROW_IF_ERROR(
+      err,
+      "loading method '%s' for run_many failed with error 0x%" PRIx32,
+      method_name.c_str(),
+      static_cast<uint32_t>(err));
+
+  py::list results(num_samples);
+  for (size_t i = 0; i < num_samples; ++i) {
+    RunManySample& sample = samples[i];
+    THROW_IF_ERROR(
+        sample.error,
+        "running sample %zu of method '%s' failed with error 0x%" PRIx32,
+        i,
+        method_name.c_str(),
+        static_cast<uint32_t>(sample.error));
+    py::list outputs(sample.outputs.size());
+    for (size_t j = 0; j < sample.outputs.size(); ++j) {
+      const EValue& v = sample.outputs[j];
+      if (sample.output_tensors[j].defined()) {
+        outputs[j] = py::cast(std::move(sample.output_tensors[j]));
+      } else if (Tag::None == v.tag) {
+        outputs[j] = py::none();
+      } else if (Tag::Int == v.tag) {
+        outputs[j] = py::cast(v.toInt());
+      } else if (Tag::Double == v.tag) {
+        outputs[j] = py::cast(v.toDouble());
+      } else if (Tag::Bool == v.tag) {
+        outputs[j] = py::cast(v.toBool());
+      } else if (Tag::String == v.tag) {
+        outputs[j] = py::cast(std::string(v.toString().data()));
+      } else {
+        ET_ASSERT_UNREACHABLE_MSG("Invalid model output type");
+      }
+    }
+    results[i] = std::move(outputs);
+  }
+  return results;
+}
+
 class Module final {
  public:
   explicit Module(
@@ -303,6 +715,10 @@ class Module final {
     return *methods_[method_name].get();
   }
 
+  const Program* program() const {
+    return program_.get();
+  }
+
   /// Returns the names of all methods in the program.
   std::vector<std::string> method_names() const {
     std::vector<std::string> names;
@@ -812,6 +1228,22 @@ struct PyModule final {
     return run_method("forward", inputs, clone_outputs);
   }
 
+  /// Runs the method on each sequence of inputs in `inputs_list` with the GIL
+  /// released, on up to `num_workers` threads. Uses its own instances of the
+  /// method rather than the one that run_method() uses.
+  py::list run_many(
+      const std::string& method_name,
+      const py::sequence& inputs_list,
+      size_t num_workers = 1) {
+    // Fail on unknown methods before loading any instances.
+    module_->get_method(method_name);
+    auto& pool = run_many_pools_[method_name];
+    if (!pool) {
+      pool = std::make_unique<MethodPool>(module_->program(), method_name);
+    }
+    return run_many_on_pool(*pool, method_name, inputs_list, num_workers);
+  }
+
   py::list forward_single_input(
       const torch::Tensor& inputTensor,
       bool clone_outputs = true) {
@@ -966,6 +1398,8 @@ struct PyModule final {
   // Need to keep-alive output storages until they can be compared in case of
   // bundled programs.
   std::vector<std::vector<uint8_t>> output_storages_;
+  // Method instances for run_many(), by method name.
+  std::unordered_map<std::string, std::unique_ptr<MethodPool>> run_many_pools_;
 
   std::vector<std::vector<uint8_t>> make_output_storages(const Method& method) {
     const auto num_outputs = method.outputs_size();
@@ -1032,55 +1466,6 @@ inline std::shared_ptr<ProgramState> load_program(
       std::move(loader), std::make_unique<Program>(std::move(res.get())));
 }
 
-/// A wrapper/util class for executorch memory allocations/manager.
-class ProgramMemory {
- public:
-  explicit ProgramMemory(std::vector<std::vector<uint8_t>>&& non_const_buffers)
-      : runtime_allocator_(),
-        non_const_buffers_(std::move(non_const_buffers)),
-        non_const_spans_(create_non_const_spans()),
-        non_const_allocator_(
-            {non_const_spans_.data(), non_const_spans_.size()}),
-        mem_manager_(
-            &const_allocator_,
-            &non_const_allocator_,
-            &runtime_allocator_,
-            &temp_allocator_) {}
-
-  /// Returns a pointer to the internal memory manager, the Memory instance
-  /// must outlive this pointer.
-  MemoryManager* mem_manager() {
-    return &mem_manager_;
-  }
-
-  ProgramMemory(const ProgramMemory&) = delete;
-  ProgramMemory& operator=(const ProgramMemory&) = delete;
-
- private:
-  MemoryAllocator const_allocator_{MemoryAllocator(0, nullptr)};
-
-  MallocMemoryAllocator runtime_allocator_;
-
-  MemoryAllocator temp_allocator_{MemoryAllocator(0, nullptr)};
-
-  std::vector<std::vector<uint8_t>> non_const_buffers_;
-
-  std::vector<Span<uint8_t>> non_const_spans_;
-
-  HierarchicalAllocator non_const_allocator_;
-
-  MemoryManager mem_manager_;
-
-  std::vector<Span<uint8_t>> create_non_const_spans() {
-    std::vector<Span<uint8_t>> result;
-    for (size_t i = 0; i < non_const_buffers_.size(); i++) {
-      result.push_back(
-          {non_const_buffers_[i].data(), non_const_buffers_[i].size()});
-    }
-    return result;
-  }
-};
-
 struct PyMethod final {
   explicit PyMethod(
       std::shared_ptr<ProgramMemory> memory,
@@ -1235,6 +1620,18 @@ struct PyMethod final {
     return call(py_list, clone_outputs);
   }
 
+  /// Like PyModule::run_many(). The extra instances of the method are loaded
+  /// from the same program as this one.
+  py::list run_many(const py::sequence& inputs_list, size_t num_workers = 1) {
+    const std::string method_name = method_->method_meta().name();
+    if (!run_many_pool_) {
+      run_many_pool_ =
+          std::make_unique<MethodPool>(state_->program_.get(), method_name);
+    }
+    return run_many_on_pool(
+        *run_many_pool_, method_name, inputs_list, num_workers);
+  }
+
   py::object get_attribute(const std::string& name) {
     Result<executorch::aten::Tensor> attr = method_->get_attribute(name);
     THROW_IF_ERROR(
@@ -1264,6 +1661,8 @@ struct PyMethod final {
   // Need to keep-alive output storages until they can be compared in case of
   // bundled programs.
   std::vector<std::vector<uint8_t>> output_storages_;
+  // Method instances for run_many().
+  std::unique_ptr<MethodPool> run_many_pool_;
 
   void allocate_output_storages() {
     const auto num_outputs = method_->outputs_size();
@@ -1618,6 +2017,13 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
           call_guard)
+      .def(
+          "run_many",
+          &PyModule::run_many,
+          py::arg("method_name"),
+          py::arg("inputs_list"),
+          py::arg("num_workers") = 1,
+          call_guard)
       .def("has_etdump", &PyModule::has_etdump, call_guard)
       .def(
           "write_etdump_result_to_file",
@@ -1726,6 +2132,12 @@ PYBIND11_MODULE(EXECUTORCH_PYTHON_MODULE_NAME, m) {
           py::arg("inputs") = py::list(),
           py::arg("clone_outputs") = true,
           call_guard)
+      .def(
+          "run_many",
+          &PyMethod::run_many,
+          py::arg("inputs_list"),
+          py::arg("num_workers") = 1,
+          call_guard)
       .def(
           "get_attribute",
           &PyMethod::get_attribute,
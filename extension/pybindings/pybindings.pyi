@@ -48,6 +48,24 @@ class ExecuTorchModule:
         clone_outputs: bool = True,
     ) -> List[Any]: ...
     # pyre-ignore[3]: "Any" in return type annotations.
+    def run_many(
+        self,
+        method_name: str,
+        inputs_list: Sequence[Sequence[Any]],  # pyre-ignore[2]
+        num_workers: int = 1,
+    ) -> List[List[Any]]:
+        """Runs the method once for each sequence of inputs in `inputs_list`
+        and returns the outputs of each run.
+
+        Tensor inputs, and inputs that support the buffer protocol such as
+        numpy arrays, are passed without copying. The GIL is released while
+        the batch runs, spread over up to `num_workers` native threads, each
+        with its own instance of the method. Outputs are owned by Python:
+        outputs that are not memory planned are written directly into the
+        returned tensors, and memory planned outputs are copied.
+        """
+        ...
+    # pyre-ignore[3]: "Any" in return type annotations.
     def plan_execute(self) -> List[Any]: ...
     # Bundled program methods.
     def load_bundled_input(
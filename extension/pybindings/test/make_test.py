@@ -934,6 +934,77 @@ def make_test(  # noqa: C901
             tester.assertEqual(output_tensor.nbytes(), 16)
             tester.assertEqual(str(output_tensor), tensor_info)
 
+        def test_run_many(tester) -> None:
+            import numpy as np
+
+            exported_program, _ = create_program(ModuleAdd())
+            executorch_module = load_fn(exported_program.buffer)
+
+            inputs_list = [
+                (torch.full((2, 2), float(i)), torch.ones(2, 2)) for i in range(5)
+            ]
+            # Inputs that support the buffer protocol work like tensors.
+            inputs_list.append(
+                (np.full((2, 2), 5, dtype=np.float32), np.ones((2, 2), np.float32))
+            )
+            for num_workers in (1, 3):
+                outputs = executorch_module.run_many(
+                    "forward", inputs_list, num_workers=num_workers
+                )
+                tester.assertEqual(len(outputs), len(inputs_list))
+                for i, sample_outputs in enumerate(outputs):
+                    tester.assertEqual(len(sample_outputs), 1)
+                    tester.assertTrue(
+                        torch.allclose(sample_outputs[0], torch.full((2, 2), i + 1.0))
+                    )
+
+            # The outputs outlive the module.
+            del executorch_module
+            tester.assertTrue(torch.allclose(outputs[0][0], torch.ones(2, 2)))
+
+        def test_run_many_not_memory_planned(tester) -> None:
+            exported_program, _ = create_program(
+                ModuleAddConstReturn(),
+                et_config=ExecutorchBackendConfig(
+                    memory_planning_pass=MemoryPlanningPass(alloc_graph_output=False)
+                ),
+            )
+            executorch_module = load_fn(exported_program.buffer)
+
+            inputs_list = [(torch.full((2, 2), float(i)),) for i in range(4)]
+            outputs = executorch_module.run_many("forward", inputs_list, num_workers=2)
+            for i, sample_outputs in enumerate(outputs):
+                tester.assertTrue(
+                    torch.allclose(sample_outputs[0], torch.full((2, 2), i + 1.0))
+                )
+                tester.assertTrue(torch.allclose(sample_outputs[1], torch.ones(2, 2)))
+
+        def test_run_many_errors(tester) -> None:
+            exported_program, inputs = create_program(ModuleAdd())
+            executorch_module = load_fn(exported_program.buffer)
+
+            with tester.assertRaises(RuntimeError):
+                executorch_module.run_many("not_a_method", [inputs])
+            with tester.assertRaises(RuntimeError):
+                # Too many inputs for the second sample.
+                executorch_module.run_many("forward", [inputs, (*inputs, 1)])
+            with tester.assertRaises(ValueError):
+                executorch_module.run_many("forward", [inputs], num_workers=0)
+
+        def test_method_run_many(tester) -> None:
+            exported_program, _ = create_program(ModuleAdd())
+            executorch_program = load_prog_fn(exported_program.buffer)
+            executorch_method = executorch_program.load_method("forward")
+
+            inputs_list = [
+                (torch.full((2, 2), float(i)), torch.ones(2, 2)) for i in range(4)
+            ]
+            outputs = executorch_method.run_many(inputs_list, num_workers=2)
+            for i, sample_outputs in enumerate(outputs):
+                tester.assertTrue(
+                    torch.allclose(sample_outputs[0], torch.full((2, 2), i + 1.0))
+                )
+
         ######### RUN TEST CASES #########
         test_e2e(tester)
         test_multiple_entry(tester)
@@ -971,5 +1042,9 @@ def make_test(  # noqa: C901
         test_method_attribute(tester)
         test_program_method_meta(tester)
         test_method_method_meta(tester)
+        test_run_many(tester)
+        test_run_many_not_memory_planned(tester)
+        test_run_many_errors(tester)
+        test_method_run_many(tester)
 
     return wrapper
@@ -10,9 +10,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cinttypes>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <executorch/extension/threadpool/threadpool_guard.h>
+#include <executorch/runtime/core/error.h>
 #include <executorch/runtime/platform/assert.h>
 
 #include <cpuinfo.h>
@@ -142,4 +146,40 @@ pthreadpool_t get_pthreadpool() {
   return threadpool->threadpool_.get();
 }
 
+bool parallel_for_on_new_threads(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    runtime::FunctionRef<void(int64_t, int64_t)> f) {
+  ET_CHECK_OR_RETURN_FALSE(
+      begin >= 0 && end >= 0 && end >= begin,
+      "begin = %" PRId64 ", end = %" PRId64,
+      begin,
+      end);
+  ET_CHECK_OR_RETURN_FALSE(grain_size > 0, "grain_size = %" PRId64, grain_size);
+  if (begin == end) {
+    return true;
+  }
+  ThreadPool* const threadpool = get_threadpool();
+  const int64_t num_threads = NoThreadPoolGuard::is_enabled() ||
+          threadpool == nullptr
+      ? 1
+      : std::max<int64_t>(1, threadpool->get_thread_count());
+  const int64_t chunk_size = std::max(
+      grain_size, (end - begin + num_threads - 1) / num_threads);
+
+  // The calling thread runs the first chunk.
+  std::vector<std::thread> threads;
+  for (int64_t start = begin + chunk_size; start < end; start += chunk_size) {
+    threads.emplace_back([&f, start, end, chunk_size]() {
+      f(start, std::min(end, start + chunk_size));
+    });
+  }
+  f(begin, std::min(end, begin + chunk_size));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return true;
+}
+
 } // namespace executorch::extension::threadpool
@@ -8,10 +8,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 
+#include <executorch/runtime/core/function_ref.h>
 #include <pthreadpool.h>
 
 namespace executorch::extension::threadpool {
@@ -85,6 +87,23 @@ ThreadPool* get_threadpool();
  */
 pthreadpool_t get_pthreadpool();
 
+/**
+ * Like parallel_for(), but runs the chunks on the calling thread and on new
+ * threads rather than on the threadpool, using as many threads as the
+ * threadpool has. Returns once every chunk has run.
+ *
+ * Meant for a few long, independent tasks that may use the threadpool
+ * themselves, such as initializing backend delegates: pass it to
+ * Program::load_method(). Inside a threadpool task, get_pthreadpool() returns
+ * null, so a backend that binds the threadpool at init would run
+ * single-threaded if initialized there.
+ */
+bool parallel_for_on_new_threads(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    runtime::FunctionRef<void(int64_t, int64_t)> f);
+
 } // namespace executorch::extension::threadpool
 
 namespace torch::executorch::threadpool { // DEPRECATED
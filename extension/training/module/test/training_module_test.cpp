@@ -153,3 +153,101 @@ TEST_F(TrainingModuleTest, SeperateDataTest) {
   ASSERT_EQ(res.error(), Error::Ok);
   ASSERT_EQ(res.get().size(), 1);
 }
+
+TEST_F(TrainingModuleTest, GradientAccumulationTest) {
+  const char* path = std::getenv("ET_MODULE_SIMPLE_TRAIN_PATH");
+  Result<FileDataLoader> loader_res = FileDataLoader::from(path);
+  ASSERT_EQ(loader_res.error(), Error::Ok);
+  Result<FileDataLoader> accumulating_loader_res = FileDataLoader::from(path);
+  ASSERT_EQ(accumulating_loader_res.error(), Error::Ok);
+
+  auto mod = executorch::extension::training::TrainingModule(
+      std::make_unique<FileDataLoader>(std::move(loader_res.get())));
+  auto accumulating_mod = executorch::extension::training::TrainingModule(
+      std::make_unique<FileDataLoader>(
+          std::move(accumulating_loader_res.get())));
+  EXPECT_EQ(
+      accumulating_mod.set_gradient_accumulation_steps("forward", 0),
+      Error::InvalidArgument);
+  ASSERT_EQ(
+      accumulating_mod.set_gradient_accumulation_steps("forward", 2),
+      Error::Ok);
+
+  TensorFactory<ScalarType::Float> tf;
+  std::vector<std::vector<executorch::runtime::EValue>> batches = {
+      {tf.make({3}, {1.0, 1.0, 1.0}), tf.make({3}, {1.0, 0.0, 0.0})},
+      {tf.make({3}, {0.5, -1.0, 2.0}), tf.make({3}, {0.0, 0.0, 1.0})}};
+
+  // The mean of the gradients of each batch on its own.
+  std::map<std::string, std::vector<float>> expected;
+  for (const auto& batch : batches) {
+    ASSERT_EQ(
+        mod.execute_forward_backward("forward", batch).error(), Error::Ok);
+    EXPECT_TRUE(mod.gradients_ready("forward"));
+    for (const auto& [fqn, grad] : mod.named_gradients("forward").get()) {
+      auto& sum = expected[std::string(fqn)];
+      sum.resize(grad.numel());
+      for (size_t i = 0; i < sum.size(); ++i) {
+        sum[i] += grad.const_data_ptr<float>()[i] / batches.size();
+      }
+    }
+  }
+
+  ASSERT_EQ(
+      accumulating_mod.execute_forward_backward("forward", batches[0]).error(),
+      Error::Ok);
+  EXPECT_FALSE(accumulating_mod.gradients_ready("forward"));
+  ASSERT_EQ(
+      accumulating_mod.execute_forward_backward("forward", batches[1]).error(),
+      Error::Ok);
+  EXPECT_TRUE(accumulating_mod.gradients_ready("forward"));
+
+  auto grad_res = accumulating_mod.named_gradients("forward");
+  ASSERT_EQ(grad_res.error(), Error::Ok);
+  ASSERT_EQ(grad_res.get().size(), expected.size());
+  for (const auto& [fqn, grad] : grad_res.get()) {
+    const auto& want = expected.at(std::string(fqn));
+    ASSERT_EQ(grad.numel(), want.size());
+    for (size_t i = 0; i < want.size(); ++i) {
+      EXPECT_NEAR(grad.const_data_ptr<float>()[i], want[i], 1e-6);
+    }
+  }
+}
+
+TEST_F(TrainingModuleTest, MixedPrecisionFloatProgramTest) {
+  const char* path = std::getenv("ET_MODULE_SIMPLE_TRAIN_PATH");
+  Result<FileDataLoader> loader_res = FileDataLoader::from(path);
+  ASSERT_EQ(loader_res.error(), Error::Ok);
+  auto mod = executorch::extension::training::TrainingModule(
+      std::make_unique<FileDataLoader>(std::move(loader_res.get())));
+
+  executorch::extension::training::MixedPrecisionOptions options;
+  options.loss_scale = 0;
+  EXPECT_EQ(
+      mod.enable_mixed_precision("forward", options), Error::InvalidArgument);
+  ASSERT_EQ(mod.enable_mixed_precision("forward"), Error::Ok);
+  EXPECT_EQ(mod.enable_mixed_precision("forward"), Error::InvalidArgument);
+  EXPECT_EQ(mod.loss_scale("forward"), 1);
+
+  TensorFactory<ScalarType::Float> tf;
+  std::vector<executorch::runtime::EValue> inputs = {
+      tf.make({3}, {1.0, 1.0, 1.0}), tf.make({3}, {1.0, 0.0, 0.0})};
+  EXPECT_FALSE(mod.gradients_ready("forward"));
+  ASSERT_EQ(mod.execute_forward_backward("forward", inputs).error(), Error::Ok);
+  EXPECT_TRUE(mod.gradients_ready("forward"));
+
+  // Float parameters are their own master copies, and the gradients are
+  // float buffers of the module.
+  auto param_res = mod.named_parameters("forward");
+  ASSERT_EQ(param_res.error(), Error::Ok);
+  ASSERT_EQ(param_res.get().size(), 2);
+  for (const auto& [fqn, param] : param_res.get()) {
+    EXPECT_EQ(param.scalar_type(), ScalarType::Float);
+  }
+  auto grad_res = mod.named_gradients("forward");
+  ASSERT_EQ(grad_res.error(), Error::Ok);
+  ASSERT_EQ(grad_res.get().size(), 2);
+  for (const auto& [fqn, grad] : grad_res.get()) {
+    EXPECT_EQ(grad.scalar_type(), ScalarType::Float);
+  }
+}
@@ -8,6 +8,12 @@
 
 #include <executorch/extension/training/module/training_module.h>
 
+#include <cmath>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::Error;
+
 namespace executorch {
 namespace extension {
 namespace training {
@@ -26,8 +32,157 @@ std::string make_fqn_method_name(const std::string& method_name) {
   return "__et_training_fqn_" + method_name;
 }
 
+template <typename CTYPE>
+void widen(const CTYPE* in, float* out, size_t numel) {
+  for (size_t i = 0; i < numel; ++i) {
+    out[i] = static_cast<float>(in[i]);
+  }
+}
+
+template <typename CTYPE>
+void narrow(const float* in, CTYPE* out, size_t numel) {
+  for (size_t i = 0; i < numel; ++i) {
+    out[i] = static_cast<CTYPE>(in[i]);
+  }
+}
+
+// Copies a float, bfloat16 or half tensor into a float tensor.
+Error copy_to_float(const Tensor& in, Tensor& out) {
+  float* data = out.mutable_data_ptr<float>();
+  switch (in.scalar_type()) {
+    case ScalarType::Float:
+      std::copy_n(in.const_data_ptr<float>(), in.numel(), data);
+      return Error::Ok;
+    case ScalarType::BFloat16:
+      widen(in.const_data_ptr<executorch::aten::BFloat16>(), data, in.numel());
+      return Error::Ok;
+    case ScalarType::Half:
+      widen(in.const_data_ptr<executorch::aten::Half>(), data, in.numel());
+      return Error::Ok;
+    default:
+      return Error::InvalidArgument;
+  }
+}
+
+// Rounds a float tensor into a bfloat16 or half tensor.
+Error copy_from_float(const Tensor& in, Tensor& out) {
+  const float* data = in.const_data_ptr<float>();
+  switch (out.scalar_type()) {
+    case ScalarType::BFloat16:
+      narrow(
+          data, out.mutable_data_ptr<executorch::aten::BFloat16>(), in.numel());
+      return Error::Ok;
+    case ScalarType::Half:
+      narrow(data, out.mutable_data_ptr<executorch::aten::Half>(), in.numel());
+      return Error::Ok;
+    default:
+      return Error::InvalidArgument;
+  }
+}
+
+/**
+ * Writes (or, if accumulate is set, adds) scale * grad into out. Returns
+ * whether every scaled gradient is finite.
+ */
+template <typename CTYPE>
+bool scale_into(
+    const CTYPE* grad,
+    float* out,
+    size_t numel,
+    float scale,
+    bool accumulate) {
+  // inf * 0 and nan * 0 are nan, so this stays 0 only if every value is
+  // finite, without a branch per element.
+  float check = 0;
+  for (size_t i = 0; i < numel; ++i) {
+    const float g = static_cast<float>(grad[i]) * scale;
+    out[i] = accumulate ? out[i] + g : g;
+    check += g * 0.0f;
+  }
+  return check == 0;
+}
+
 } // namespace
 
+Error TrainingModule::accumulate_gradients(
+    TrainingState& state,
+    const std::map<std::string_view, Tensor>& gradients) {
+  if (state.gradients.empty()) {
+    std::vector<Tensor> likes;
+    likes.reserve(gradients.size());
+    for (const auto& [fqn, grad] : gradients) {
+      likes.push_back(grad);
+    }
+    auto buffers = state.arena.allocate(likes);
+    size_t i = 0;
+    for (const auto& [fqn, grad] : gradients) {
+      state.gradients.insert({fqn, buffers[i++]});
+    }
+  }
+
+  // The buffers hold the mean over the micro-steps of the unscaled gradients.
+  const float scale = 1.0f / (state.accumulation_steps * state.loss_scale);
+  const bool accumulate = state.micro_step > 0;
+  bool finite = true;
+  for (const auto& [fqn, grad] : gradients) {
+    Tensor& buffer = state.gradients.at(fqn);
+    float* out = buffer.mutable_data_ptr<float>();
+    const size_t numel = grad.numel();
+    switch (grad.scalar_type()) {
+      case ScalarType::Float:
+        finite &= scale_into(
+            grad.const_data_ptr<float>(), out, numel, scale, accumulate);
+        break;
+      case ScalarType::BFloat16:
+        finite &= scale_into(
+            grad.const_data_ptr<executorch::aten::BFloat16>(),
+            out,
+            numel,
+            scale,
+            accumulate);
+        break;
+      case ScalarType::Half:
+        finite &= scale_into(
+            grad.const_data_ptr<executorch::aten::Half>(),
+            out,
+            numel,
+            scale,
+            accumulate);
+        break;
+      default:
+        ET_LOG(
+            Error,
+            "Gradient %.*s has unsupported dtype %hhd",
+            static_cast<int>(fqn.size()),
+            fqn.data(),
+            static_cast<int8_t>(grad.scalar_type()));
+        return Error::InvalidArgument;
+    }
+  }
+  state.found_non_finite |= state.mixed_precision && !finite;
+
+  if (++state.micro_step < state.accumulation_steps) {
+    state.gradients_ready = false;
+    return Error::Ok;
+  }
+  state.micro_step = 0;
+  state.gradients_ready = !state.found_non_finite;
+  if (state.mixed_precision &&
+      state.mixed_precision_options.dynamic_loss_scale) {
+    if (state.found_non_finite) {
+      state.loss_scale *= 0.5f;
+      state.steps_since_overflow = 0;
+    } else if (
+        ++state.steps_since_overflow ==
+        state.mixed_precision_options.growth_interval) {
+      state.loss_scale *= 2.0f;
+      state.steps_since_overflow = 0;
+    }
+  }
+  state.found_non_finite = false;
+  return Error::Ok;
+}
+
 runtime::Result<std::vector<runtime::EValue>>
 TrainingModule::execute_forward_backward(
     const std::string& method_name,
@@ -52,8 +207,32 @@ TrainingModule::execute_forward_backward(
 
   uint64_t param_start = param_res.get()[0].toInt();
 
+  auto state_it = method_training_state_.find(method_name);
+  TrainingState* state = state_it == method_training_state_.end()
+      ? nullptr
+      : state_it->second.get();
+
+  // In mixed precision, round the master parameters into the method at the
+  // start of each accumulation and pass the loss scale as the last input.
+  std::vector<runtime::EValue> scaled_input;
+  if (state != nullptr && state->mixed_precision) {
+    if (state->micro_step == 0) {
+      for (auto& [param, master] : state->low_precision_parameters) {
+        copy_from_float(master, param);
+      }
+    }
+    if (state->loss_scale_input != nullptr) {
+      state->loss_scale_input->mutable_data_ptr<float>()[0] =
+          state->loss_scale;
+      scaled_input.reserve(input.size() + 1);
+      scaled_input.insert(scaled_input.end(), input.begin(), input.end());
+      scaled_input.emplace_back(*state->loss_scale_input);
+    }
+  }
+
   // Execute the forward and backward pass.
-  auto outputs = torch::executor::Module::execute(method_name, input);
+  auto outputs = torch::executor::Module::execute(
+      method_name, scaled_input.empty() ? input : scaled_input);
   if (!outputs.ok()) {
     return outputs.error();
   }
@@ -94,6 +273,16 @@ TrainingModule::execute_forward_backward(
     }
   }
 
+  if (state != nullptr && state->uses_buffers()) {
+    auto e = accumulate_gradients(
+        *state, method_named_gradients_.at(method_name));
+    if (e != Error::Ok) {
+      return e;
+    }
+  } else if (state != nullptr) {
+    state->gradients_ready = true;
+  }
+
   return user_outputs;
 }
 
@@ -141,6 +330,11 @@ TrainingModule::named_parameters(const std::string& method_name) {
       method_named_parameters_.at(method_name).insert({fqn, param});
     }
   }
+  auto state_it = method_training_state_.find(method_name);
+  if (state_it != method_training_state_.end() &&
+      state_it->second->mixed_precision) {
+    return state_it->second->master_parameters;
+  }
   return method_named_parameters_.at(method_name);
 }
 
@@ -151,9 +345,123 @@ TrainingModule::named_gradients(const std::string& method_name) {
     ET_LOG(Error, "No gradients found for method %s", method_name.c_str());
     return executorch::runtime::Error::InvalidArgument;
   }
+  auto state_it = method_training_state_.find(method_name);
+  if (state_it != method_training_state_.end() &&
+      state_it->second->uses_buffers() &&
+      !state_it->second->gradients.empty()) {
+    return state_it->second->gradients;
+  }
   return method_named_gradients_.at(method_name);
 }
 
+Error TrainingModule::set_gradient_accumulation_steps(
+    const std::string& method_name,
+    size_t num_micro_steps) {
+  ET_CHECK_OR_RETURN_ERROR(
+      num_micro_steps > 0,
+      InvalidArgument,
+      "Gradient accumulation needs at least one micro-step");
+  auto& state = method_training_state_[method_name];
+  if (state == nullptr) {
+    state = std::make_unique<TrainingState>();
+  }
+  state->accumulation_steps = num_micro_steps;
+  state->micro_step = 0;
+  state->found_non_finite = false;
+  state->gradients_ready = false;
+  return Error::Ok;
+}
+
+Error TrainingModule::enable_mixed_precision(
+    const std::string& method_name,
+    const MixedPrecisionOptions& options) {
+  ET_CHECK_OR_RETURN_ERROR(
+      options.loss_scale > 0,
+      InvalidArgument,
+      "Loss scale must be positive, got %f",
+      static_cast<double>(options.loss_scale));
+  ET_CHECK_OR_RETURN_ERROR(
+      options.growth_interval > 0,
+      InvalidArgument,
+      "Loss scale growth interval must be positive");
+  auto& state = method_training_state_[method_name];
+  if (state == nullptr) {
+    state = std::make_unique<TrainingState>();
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      !state->mixed_precision,
+      InvalidArgument,
+      "Method %s is already in mixed precision",
+      method_name.c_str());
+
+  auto params_res = named_parameters(method_name);
+  if (!params_res.ok()) {
+    return params_res.error();
+  }
+  std::vector<Tensor> low_precision;
+  std::vector<std::string_view> low_precision_names;
+  for (const auto& [fqn, param] : params_res.get()) {
+    switch (param.scalar_type()) {
+      case ScalarType::Float:
+        state->master_parameters.insert({fqn, param});
+        break;
+      case ScalarType::BFloat16:
+      case ScalarType::Half:
+        low_precision.push_back(param);
+        low_precision_names.push_back(fqn);
+        break;
+      default:
+        ET_LOG(
+            Error,
+            "Parameter %.*s has unsupported dtype %hhd for mixed precision",
+            static_cast<int>(fqn.size()),
+            fqn.data(),
+            static_cast<int8_t>(param.scalar_type()));
+        state->master_parameters.clear();
+        return Error::InvalidArgument;
+    }
+  }
+
+  auto masters = state->arena.allocate(low_precision);
+  for (size_t i = 0; i < masters.size(); ++i) {
+    copy_to_float(low_precision[i], masters[i]);
+    state->master_parameters.insert({low_precision_names[i], masters[i]});
+    state->low_precision_parameters.emplace_back(
+        low_precision[i], masters[i]);
+  }
+
+  state->mixed_precision = true;
+  state->mixed_precision_options = options;
+  state->loss_scale = options.loss_scale;
+  state->steps_since_overflow = 0;
+  if (options.loss_scale != 1 || options.dynamic_loss_scale) {
+    state->loss_scale_input =
+        make_tensor_ptr({1}, std::vector<float>{options.loss_scale});
+  }
+  state->micro_step = 0;
+  state->found_non_finite = false;
+  state->gradients_ready = false;
+  return Error::Ok;
+}
+
+bool TrainingModule::gradients_ready(const std::string& method_name) const {
+  auto state_it = method_training_state_.find(method_name);
+  if (state_it != method_training_state_.end()) {
+    return state_it->second->gradients_ready;
+  }
+  return method_named_gradients_.find(method_name) !=
+      method_named_gradients_.end();
+}
+
+float TrainingModule::loss_scale(const std::string& method_name) const {
+  auto state_it = method_training_state_.find(method_name);
+  if (state_it != method_training_state_.end() &&
+      state_it->second->mixed_precision) {
+    return state_it->second->loss_scale;
+  }
+  return 1;
+}
+
 } // namespace training
 } // namespace extension
 } // namespace executorch
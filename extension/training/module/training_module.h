@@ -15,6 +15,8 @@
 #include <vector>
 
 #include <executorch/extension/module/module.h>
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/extension/training/optimizer/state_arena.h>
 #include <executorch/runtime/core/evalue.h>
 #include <executorch/runtime/executor/program.h>
 
@@ -22,9 +24,51 @@ namespace executorch {
 namespace extension {
 namespace training {
 
+/**
+ * Options for mixed-precision training with TrainingModule.
+ */
+struct ET_EXPERIMENTAL MixedPrecisionOptions {
+  /**
+   * The initial factor the loss is multiplied by before the backward pass, so
+   * that small gradients do not flush to zero in reduced precision. 1 disables
+   * loss scaling. Otherwise the joint graph must take the scale as its last
+   * input, a float tensor with one element, and multiply its loss by it; the
+   * module passes the current scale there and divides the gradients by it.
+   * The outputs of execute_forward_backward() are those of the program, so a
+   * returned loss includes the scale.
+   */
+  float loss_scale = 1;
+
+  /**
+   * Whether to adjust the loss scale as training goes: when the gradients of a
+   * step overflow the step is skipped and the scale is halved, and after
+   * growth_interval steps without overflow the scale is doubled.
+   */
+  bool dynamic_loss_scale = false;
+
+  // The number of steps without overflow before the loss scale is doubled.
+  int64_t growth_interval = 2000;
+};
+
 /**
  * A facade class for loading programs for on-device training and executing
  * methods within them.
+ *
+ * By default every call to execute_forward_backward() replaces the gradients
+ * of the method. The module can also accumulate gradients over several
+ * micro-batches (see set_gradient_accumulation_steps()) and train programs
+ * exported in bfloat16 or half against float master parameters (see
+ * enable_mixed_precision()). In both cases the gradients are kept in float
+ * buffers owned by the module, and a training loop looks like:
+ *
+ * @code
+ * for (const auto& batch : batches) {
+ *   module.execute_forward_backward("forward", batch);
+ *   if (module.gradients_ready("forward")) {
+ *     optimizer.step(module.named_gradients("forward").get());
+ *   }
+ * }
+ * @endcode
  */
 class ET_EXPERIMENTAL TrainingModule final
     : public executorch::extension::Module {
@@ -78,6 +122,60 @@ class ET_EXPERIMENTAL TrainingModule final
   runtime::Result<const std::map<std::string_view, executorch::aten::Tensor>>
   named_parameters(const std::string& method_name);
 
+  /**
+   * Accumulate the gradients of a joint graph method over several calls to
+   * execute_forward_backward() before they are used for an optimizer step.
+   * The gradients are added in place to float buffers, scaled so that after
+   * the last micro-step they hold the mean of the gradients of the
+   * micro-steps. Any micro-steps already accumulated are dropped.
+   *
+   * @param[in] method_name The name of the joint graph method.
+   * @param[in] num_micro_steps The number of micro-steps per optimizer step.
+   * 1, the default, uses the gradients of every call on its own.
+   *
+   * @returns Error::Ok on success, or Error::InvalidArgument if
+   * num_micro_steps is 0.
+   */
+  ET_EXPERIMENTAL runtime::Error set_gradient_accumulation_steps(
+      const std::string& method_name,
+      size_t num_micro_steps);
+
+  /**
+   * Train a joint graph method whose parameters are in bfloat16 or half
+   * against float master copies of them. Afterwards named_parameters()
+   * returns the master parameters, which the optimizer should update, and
+   * named_gradients() returns float gradients. The first micro-step of every
+   * accumulation rounds the master parameters into the parameters of the
+   * method. Float parameters of the method are their own master copies.
+   *
+   * @param[in] method_name The name of the joint graph method.
+   * @param[in] options The loss scaling options.
+   *
+   * @returns Error::Ok on success, Error::InvalidArgument if the method has
+   * parameters of another dtype or is already in mixed precision, or the error
+   * from loading the method.
+   */
+  ET_EXPERIMENTAL runtime::Error enable_mixed_precision(
+      const std::string& method_name,
+      const MixedPrecisionOptions& options = {});
+
+  /**
+   * Whether the gradients of a joint graph method are ready for an optimizer
+   * step: the latest execute_forward_backward() completed an accumulation
+   * and, in mixed precision, none of the accumulated gradients overflowed.
+   *
+   * @param[in] method_name The name of the joint graph method.
+   */
+  ET_EXPERIMENTAL bool gradients_ready(const std::string& method_name) const;
+
+  /**
+   * The loss scale the next execute_forward_backward() of a joint graph method
+   * will use; 1 unless loss scaling is enabled.
+   *
+   * @param[in] method_name The name of the joint graph method.
+   */
+  ET_EXPERIMENTAL float loss_scale(const std::string& method_name) const;
+
   /**
    * Retrieve the latest gradients for a joint graph method.
    *
@@ -87,13 +185,50 @@ class ET_EXPERIMENTAL TrainingModule final
    * @returns A Result object containing a map of the fully qualified name to
    * gradient tensor associated with that parameter from the latest
    * forward_backward execution, or an error if the method is not a joint graph
-   * or has not been executed yet.
+   * or has not been executed yet. With gradient accumulation or mixed
+   * precision these are the float buffers of the current accumulation.
    */
   ET_EXPERIMENTAL
   runtime::Result<const std::map<std::string_view, executorch::aten::Tensor>>
   named_gradients(const std::string& method_name);
 
  private:
+  // Gradient accumulation and mixed precision state of a joint graph method.
+  struct TrainingState {
+    size_t accumulation_steps = 1;
+    // Micro-steps accumulated towards the next optimizer step.
+    size_t micro_step = 0;
+    bool found_non_finite = false;
+    bool gradients_ready = false;
+
+    bool mixed_precision = false;
+    MixedPrecisionOptions mixed_precision_options;
+    float loss_scale = 1;
+    int64_t steps_since_overflow = 0;
+    TensorPtr loss_scale_input;
+
+    // Float gradient buffers, created on first use.
+    std::map<std::string_view, executorch::aten::Tensor> gradients;
+    // Float master parameters, and the (method, master) pairs that need
+    // rounding into the method before each execution.
+    std::map<std::string_view, executorch::aten::Tensor> master_parameters;
+    std::vector<std::pair<executorch::aten::Tensor, executorch::aten::Tensor>>
+        low_precision_parameters;
+    optimizer::StateArena arena;
+
+    // Whether the method's gradients go through the buffers above.
+    bool uses_buffers() const {
+      return accumulation_steps > 1 || mixed_precision;
+    }
+  };
+
+  runtime::Error accumulate_gradients(
+      TrainingState& state,
+      const std::map<std::string_view, executorch::aten::Tensor>& gradients);
+
+  std::unordered_map<std::string, std::unique_ptr<TrainingState>>
+      method_training_state_;
+
   std::unordered_map<
       std::string,
       std::map<std::string_view, executorch::aten::Tensor>>
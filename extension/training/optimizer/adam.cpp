@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/training/optimizer/adam.h>
+
+#include <executorch/extension/training/optimizer/fused_update.h>
+#include <executorch/runtime/core/error.h>
+
+#include <cinttypes>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using ::executorch::runtime::Error;
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+
+void Adam::add_param_group(const AdamParamGroup& param_group) {
+  AdamParamGroup param_group_(param_group.named_parameters());
+  if (!param_group.has_options()) {
+    param_group_.set_options(defaults_->clone());
+  } else {
+    param_group_.set_options(param_group.options().clone());
+  }
+  param_groups_.emplace_back(std::move(param_group_));
+}
+
+Error Adam::step(const std::map<std::string_view, executorch::aten::Tensor>&
+                     named_gradients) {
+  std::vector<std::vector<internal::ParamUpdate>> group_updates(
+      param_groups_.size());
+  // Parameters getting their first gradient, which need running averages, as
+  // (group index, update index) pairs.
+  std::vector<std::pair<size_t, size_t>> new_states;
+  std::vector<Tensor> new_state_params;
+  std::vector<AdamParamState*> stepped_states;
+
+  for (size_t group_index = 0; group_index < param_groups_.size();
+       ++group_index) {
+    const auto& group = param_groups_[group_index];
+    auto& updates = group_updates[group_index];
+
+    for (const auto& [name, p] : group.named_parameters()) {
+      // if param name and gradient name match, run the optimizer step
+      const auto& named_gradient = named_gradients.find(name);
+      if (named_gradient == named_gradients.end()) {
+        continue;
+      }
+      const auto& d_p = named_gradient->second;
+      ET_CHECK_OR_RETURN_ERROR(
+          p.scalar_type() == ScalarType::Float &&
+              d_p.scalar_type() == ScalarType::Float,
+          InvalidArgument,
+          "Adam only supports float parameters and gradients");
+      ET_CHECK_OR_RETURN_ERROR(
+          p.numel() == d_p.numel(),
+          InvalidArgument,
+          "Gradient has %" PRId64 " elements, expected %" PRId64,
+          static_cast<int64_t>(d_p.numel()),
+          static_cast<int64_t>(p.numel()));
+
+      internal::ParamUpdate update{
+          p.mutable_data_ptr<float>(),
+          d_p.const_data_ptr<float>(),
+          {nullptr, nullptr},
+          static_cast<int64_t>(p.numel()),
+          /*step=*/1};
+      auto param_state = state_.find(p.unsafeGetTensorImpl());
+      if (param_state == state_.end()) {
+        new_states.emplace_back(group_index, updates.size());
+        new_state_params.push_back(p);
+      } else {
+        auto& state = *param_state->second;
+        update.state[0] = state.exp_avg().mutable_data_ptr<float>();
+        update.state[1] = state.exp_avg_sq().mutable_data_ptr<float>();
+        update.step = state.step() + 1;
+        stepped_states.push_back(&state);
+      }
+      updates.push_back(update);
+    }
+  }
+
+  // create the missing running averages, zeroed and all in one block.
+  std::vector<Tensor> likes;
+  likes.reserve(2 * new_state_params.size());
+  for (const auto& p : new_state_params) {
+    likes.push_back(p);
+    likes.push_back(p);
+  }
+  auto buffers = state_arena_.allocate(likes);
+  for (size_t i = 0; i < new_state_params.size(); ++i) {
+    const auto [group_index, update_index] = new_states[i];
+    auto& update = group_updates[group_index][update_index];
+    update.state[0] = buffers[2 * i].mutable_data_ptr<float>();
+    update.state[1] = buffers[2 * i + 1].mutable_data_ptr<float>();
+    auto state =
+        std::make_unique<AdamParamState>(buffers[2 * i], buffers[2 * i + 1]);
+    stepped_states.push_back(state.get());
+    state_[new_state_params[i].unsafeGetTensorImpl()] = std::move(state);
+  }
+
+  for (size_t group_index = 0; group_index < param_groups_.size();
+       ++group_index) {
+    const auto& options = param_groups_[group_index].options();
+    internal::adam_update(
+        group_updates[group_index],
+        {static_cast<float>(options.lr()),
+         static_cast<float>(options.beta1()),
+         static_cast<float>(options.beta2()),
+         static_cast<float>(options.eps()),
+         static_cast<float>(options.weight_decay()),
+         decoupled_weight_decay_});
+  }
+  for (auto* state : stepped_states) {
+    state->set_step(state->step() + 1);
+  }
+  return Error::Ok;
+}
+
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
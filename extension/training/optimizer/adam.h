@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Adam and AdamW optimizers to perform on-device training.
+ *
+ * These follow torch.optim.Adam and torch.optim.AdamW without amsgrad, but
+ * without the dependency on ATen Tensors and autograd.
+ */
+#pragma once
+
+#include <executorch/extension/training/optimizer/param_group.h>
+#include <executorch/extension/training/optimizer/state_arena.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+
+/**
+ * Adam optimizer state. This keeps track of the state of a given parameter to
+ * be used in later epochs.
+ */
+class ET_EXPERIMENTAL AdamParamState {
+ public:
+  /**
+   * Constructs a new Adam param state.
+   *
+   * @param[in] exp_avg A tensor that stores the running average of the
+   * gradient.
+   * @param[in] exp_avg_sq A tensor that stores the running average of the
+   * squared gradient.
+   */
+  AdamParamState(
+      executorch::aten::Tensor& exp_avg,
+      executorch::aten::Tensor& exp_avg_sq)
+      : exp_avg_(exp_avg), exp_avg_sq_(exp_avg_sq) {}
+
+  executorch::aten::Tensor& exp_avg() {
+    return exp_avg_;
+  }
+
+  executorch::aten::Tensor& exp_avg_sq() {
+    return exp_avg_sq_;
+  }
+
+  // The number of steps that updated the parameter.
+  int64_t step() const {
+    return step_;
+  }
+
+  void set_step(int64_t step) {
+    step_ = step;
+  }
+
+ private:
+  executorch::aten::Tensor exp_avg_;
+  executorch::aten::Tensor exp_avg_sq_;
+  int64_t step_ = 0;
+};
+
+/**
+ * Adam optimizer options. This contains options for performing training on a
+ * param group, such as the learning rate.
+ */
+class ET_EXPERIMENTAL AdamOptions {
+ public:
+  /**
+   * Constructs a new Adam optimizer options.
+   *
+   * This is used for customizing the Adam or AdamW optimizer for a given group
+   * of parameters.
+   *
+   * @param[in] lr The learning rate.
+   * @param[in] beta1 The coefficient of the running average of the gradient.
+   * @param[in] beta2 The coefficient of the running average of the squared
+   *   gradient.
+   * @param[in] eps The term added to the denominator of the update for
+   *   numerical stability.
+   * @param[in] weight_decay The weight decay value. Adam adds it times the
+   *   parameter to the gradient, while AdamW directly shrinks the parameter
+   *   by lr * weight_decay of itself. torch.optim.AdamW defaults it to 1e-2.
+   */
+  explicit AdamOptions(
+      double lr = 1e-3,
+      double beta1 = 0.9,
+      double beta2 = 0.999,
+      double eps = 1e-8,
+      double weight_decay = 0)
+      : lr_(lr),
+        beta1_(beta1),
+        beta2_(beta2),
+        eps_(eps),
+        weight_decay_(weight_decay) {}
+
+  std::unique_ptr<AdamOptions> clone() const {
+    return std::make_unique<AdamOptions>(
+        static_cast<const AdamOptions&>(*this));
+  }
+
+  double lr() const {
+    return lr_;
+  }
+
+  double beta1() const {
+    return beta1_;
+  }
+
+  double beta2() const {
+    return beta2_;
+  }
+
+  double eps() const {
+    return eps_;
+  }
+
+  double weight_decay() const {
+    return weight_decay_;
+  }
+
+ private:
+  double lr_;
+  double beta1_;
+  double beta2_;
+  double eps_;
+  double weight_decay_;
+};
+
+/**
+ * Adam optimizer param group. This contains the parameters and
+ * the AdamOptions associated to it.
+ */
+using AdamParamGroup = ParamGroup<AdamOptions>;
+
+/**
+ * Adam optimizer class. This is responsible for performing the optimization
+ * step.
+ *
+ * Each step updates every parameter in a single vectorized pass over the
+ * parameter, its gradient and its two running averages, split across threads.
+ * The gradients are left unchanged. The running averages of all the parameters
+ * that get their first gradient in a step are allocated together, in one
+ * block.
+ */
+class ET_EXPERIMENTAL Adam {
+ public:
+  explicit Adam(
+      const std::vector<AdamParamGroup>& param_groups,
+      AdamOptions defaults)
+      : Adam(param_groups, defaults, /*decoupled_weight_decay=*/false) {}
+
+  explicit Adam(
+      const std::map<std::string_view, executorch::aten::Tensor>&
+          named_parameters,
+      AdamOptions defaults)
+      : Adam({AdamParamGroup(named_parameters)}, defaults) {}
+
+  virtual ~Adam() = default;
+
+  // Adds the given param_group to the optimizer's param_group list.
+  void add_param_group(const AdamParamGroup& param_group);
+
+  /**
+   * Performs the optimization step.
+   *
+   * @param[in] named_gradients The gradients of the tensors specified by the
+   * fully qualified name.
+   *
+   * @returns Error::InvalidArgument if a parameter or gradient is not a float
+   * tensor, or if a gradient does not have as many elements as its parameter.
+   */
+  ::executorch::runtime::Error step(
+      const std::map<std::string_view, executorch::aten::Tensor>&
+          named_gradients);
+
+ protected:
+  Adam(
+      const std::vector<AdamParamGroup>& param_groups,
+      AdamOptions defaults,
+      bool decoupled_weight_decay)
+      : defaults_(std::make_unique<AdamOptions>(defaults)),
+        decoupled_weight_decay_(decoupled_weight_decay) {
+    for (const auto& param_group : param_groups) {
+      add_param_group(param_group);
+    }
+  }
+
+ private:
+  std::vector<AdamParamGroup> param_groups_;
+  std::unordered_map<void*, std::unique_ptr<AdamParamState>> state_;
+  std::unique_ptr<AdamOptions> defaults_;
+  const bool decoupled_weight_decay_;
+  StateArena state_arena_;
+};
+
+/**
+ * AdamW optimizer class. This is Adam with the weight decay decoupled from the
+ * gradient: each step shrinks the parameters by lr * weight_decay of
+ * themselves before the Adam update.
+ */
+class ET_EXPERIMENTAL AdamW final : public Adam {
+ public:
+  explicit AdamW(
+      const std::vector<AdamParamGroup>& param_groups,
+      AdamOptions defaults)
+      : Adam(param_groups, defaults, /*decoupled_weight_decay=*/true) {}
+
+  explicit AdamW(
+      const std::map<std::string_view, executorch::aten::Tensor>&
+          named_parameters,
+      AdamOptions defaults)
+      : AdamW({AdamParamGroup(named_parameters)}, defaults) {}
+};
+
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/training/optimizer/fused_update.h>
+
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+#include <ATen/cpu/vec/vec.h>
+#endif // ET_USE_PYTORCH_HEADERS
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+namespace internal {
+
+namespace {
+
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+using Vec = at::vec::Vectorized<float>;
+
+inline Vec sqrt_of(const Vec& x) {
+  return x.sqrt();
+}
+#endif // ET_USE_PYTORCH_HEADERS
+
+inline float sqrt_of(float x) {
+  return std::sqrt(x);
+}
+
+/**
+ * Calls fn(param, begin, end) for every parameter with the range of its
+ * elements in a chunk. The parameters are split as one flat range, so chunks
+ * can span several small parameters or cover part of a large one.
+ */
+template <typename Fn>
+void for_each_param_chunk(
+    const std::vector<ParamUpdate>& params,
+    const Fn& fn) {
+  std::vector<int64_t> ends;
+  ends.reserve(params.size());
+  int64_t total = 0;
+  for (const auto& param : params) {
+    total += param.numel;
+    ends.push_back(total);
+  }
+  ::executorch::extension::parallel_for(
+      0,
+      total,
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](int64_t begin, int64_t end) {
+        size_t i = std::upper_bound(ends.begin(), ends.end(), begin) -
+            ends.begin();
+        for (; i < params.size() && begin < end; ++i) {
+          const int64_t param_begin = ends[i] - params[i].numel;
+          const int64_t chunk_end = std::min(end, ends[i]);
+          fn(params[i], begin - param_begin, chunk_end - param_begin);
+          begin = chunk_end;
+        }
+      });
+}
+
+/**
+ * Applies op(p, g, s) to elements [begin, end) of a parameter, where p is the
+ * parameter, g the gradient and s an array of the kNumStates state values; op
+ * updates p and s in place. op is a generic lambda called with
+ * Vectorized<float> values when the vector library is available and with
+ * floats for the rest.
+ */
+template <size_t kNumStates, typename Op>
+void map_param(
+    const ParamUpdate& u,
+    int64_t begin,
+    int64_t end,
+    const Op& op) {
+  int64_t i = begin;
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+  for (; i + Vec::size() <= end; i += Vec::size()) {
+    Vec p = Vec::loadu(u.param + i);
+    std::array<Vec, kNumStates> s;
+    for (size_t j = 0; j < kNumStates; ++j) {
+      s[j] = Vec::loadu(u.state[j] + i);
+    }
+    op(p, Vec::loadu(u.grad + i), s);
+    p.store(u.param + i);
+    for (size_t j = 0; j < kNumStates; ++j) {
+      s[j].store(u.state[j] + i);
+    }
+  }
+#endif // ET_USE_PYTORCH_HEADERS
+  for (; i < end; ++i) {
+    float p = u.param[i];
+    std::array<float, kNumStates> s;
+    for (size_t j = 0; j < kNumStates; ++j) {
+      s[j] = u.state[j][i];
+    }
+    op(p, u.grad[i], s);
+    u.param[i] = p;
+    for (size_t j = 0; j < kNumStates; ++j) {
+      u.state[j][i] = s[j];
+    }
+  }
+}
+
+} // namespace
+
+void sgd_update(
+    const std::vector<ParamUpdate>& params,
+    const SGDHyperParams& hp) {
+  if (hp.momentum == 0) {
+    for_each_param_chunk(
+        params, [&](const ParamUpdate& u, int64_t begin, int64_t end) {
+          map_param<0>(u, begin, end, [&](auto& p, const auto& grad, auto&) {
+            using V = std::decay_t<decltype(p)>;
+            V g = grad;
+            if (hp.weight_decay != 0) {
+              g = g + V(hp.weight_decay) * p;
+            }
+            p = p - V(hp.lr) * g;
+          });
+        });
+    return;
+  }
+
+  for_each_param_chunk(
+      params, [&](const ParamUpdate& u, int64_t begin, int64_t end) {
+        const bool first_step = u.step == 1;
+        map_param<1>(u, begin, end, [&](auto& p, const auto& grad, auto& s) {
+          using V = std::decay_t<decltype(p)>;
+          V g = grad;
+          if (hp.weight_decay != 0) {
+            g = g + V(hp.weight_decay) * p;
+          }
+          if (first_step) {
+            s[0] = g;
+          } else {
+            s[0] = V(hp.momentum) * s[0] + V(1 - hp.dampening) * g;
+          }
+          if (hp.nesterov) {
+            g = g + V(hp.momentum) * s[0];
+          } else {
+            g = s[0];
+          }
+          p = p - V(hp.lr) * g;
+        });
+      });
+}
+
+void adam_update(
+    const std::vector<ParamUpdate>& params,
+    const AdamHyperParams& hp) {
+  const float decay = 1 - hp.lr * hp.weight_decay;
+  for_each_param_chunk(
+      params, [&](const ParamUpdate& u, int64_t begin, int64_t end) {
+        const float bias_correction1 =
+            1 - std::pow(hp.beta1, static_cast<float>(u.step));
+        const float bias_correction2 =
+            1 - std::pow(hp.beta2, static_cast<float>(u.step));
+        const float step_size = hp.lr / bias_correction1;
+        const float inv_bias_correction2_sqrt =
+            1 / std::sqrt(bias_correction2);
+        map_param<2>(u, begin, end, [&](auto& p, const auto& grad, auto& s) {
+          using V = std::decay_t<decltype(p)>;
+          V g = grad;
+          if (hp.weight_decay != 0) {
+            if (hp.decoupled_weight_decay) {
+              p = p * V(decay);
+            } else {
+              g = g + V(hp.weight_decay) * p;
+            }
+          }
+          s[0] = V(hp.beta1) * s[0] + V(1 - hp.beta1) * g;
+          s[1] = V(hp.beta2) * s[1] + V(1 - hp.beta2) * g * g;
+          const V denom =
+              sqrt_of(s[1]) * V(inv_bias_correction2_sqrt) + V(hp.eps);
+          p = p - V(step_size) * s[0] / denom;
+        });
+      });
+}
+
+} // namespace internal
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Fused parameter update kernels shared by the optimizers.
+ *
+ * Each kernel updates a list of parameters in a single pass over their data,
+ * gradients and optimizer state, reading and writing every element once. The
+ * parameters are treated as one flat range split across threads with
+ * parallel_for, so a step over many small parameters parallelizes as well as
+ * a step over a few large ones.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+namespace internal {
+
+/**
+ * A contiguous float parameter to update, with its gradient and state. The
+ * gradient and the state buffers must have the same dim order as the
+ * parameter. The gradient is only read.
+ */
+struct ParamUpdate {
+  float* param;
+  const float* grad;
+  // The optimizer state buffers of the parameter; unused ones are null.
+  float* state[2];
+  int64_t numel;
+  // The number of updates of the parameter so far, including this one.
+  int64_t step;
+};
+
+struct SGDHyperParams {
+  float lr;
+  float momentum;
+  float dampening;
+  float weight_decay;
+  bool nesterov;
+};
+
+/**
+ * SGD update. With non-zero momentum, state[0] is the momentum buffer, which
+ * is set to the gradient on the first step of a parameter.
+ */
+void sgd_update(
+    const std::vector<ParamUpdate>& params,
+    const SGDHyperParams& hyper_params);
+
+struct AdamHyperParams {
+  float lr;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  // Decays the parameter directly, as in AdamW, rather than adding the
+  // weight decay to the gradient.
+  bool decoupled_weight_decay;
+};
+
+/**
+ * Adam update. state[0] and state[1] are the running averages of the gradient
+ * and of its square.
+ */
+void adam_update(
+    const std::vector<ParamUpdate>& params,
+    const AdamHyperParams& hyper_params);
+
+} // namespace internal
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <map>
+#include <memory>
+#include <string_view>
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+
+/**
+ * Optimizer param group. This contains the parameters and the options of type
+ * OptionsT associated to them. OptionsT must provide a clone() method
+ * returning a std::unique_ptr<OptionsT>.
+ */
+template <typename OptionsT>
+class ET_EXPERIMENTAL ParamGroup {
+ public:
+  // NOTE: In order to store `ParamGroup` in a `std::vector`, it has to be
+  // copy-constructible.
+  ParamGroup(const ParamGroup& param_group)
+      : named_parameters_(param_group.named_parameters()),
+        options_(
+            param_group.has_options() ? param_group.options().clone()
+                                      : nullptr) {}
+  ParamGroup& operator=(const ParamGroup& param_group) {
+    this->named_parameters_ = param_group.named_parameters_;
+    this->options_ =
+        param_group.has_options() ? param_group.options().clone() : nullptr;
+    return *this;
+  }
+  ParamGroup(ParamGroup&&) = default;
+  ParamGroup& operator=(ParamGroup&&) = default;
+
+  /**
+   * Constructs a param group.
+   *
+   * @param[in] named_parameters The parameters to be optimized and their fully
+   * qualified names.
+   */
+  /* implicit */ ParamGroup(
+      const std::map<std::string_view, executorch::aten::Tensor>&
+          named_parameters)
+      : named_parameters_(named_parameters) {}
+  ParamGroup(
+      const std::map<std::string_view, executorch::aten::Tensor>&
+          named_parameters,
+      std::unique_ptr<OptionsT> options)
+      : named_parameters_(named_parameters), options_(std::move(options)) {}
+
+  bool has_options() const {
+    return options_ != nullptr;
+  }
+
+  OptionsT& options() {
+    return *options_.get();
+  }
+
+  const OptionsT& options() const {
+    return *options_.get();
+  }
+
+  void set_options(std::unique_ptr<OptionsT> options) {
+    options_ = std::move(options);
+  }
+
+  const std::map<std::string_view, executorch::aten::Tensor>& named_parameters()
+      const {
+    return named_parameters_;
+  }
+
+ private:
+  std::map<std::string_view, executorch::aten::Tensor> named_parameters_;
+  std::unique_ptr<OptionsT> options_;
+};
+
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
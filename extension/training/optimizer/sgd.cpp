@@ -8,10 +8,13 @@
 
 #include <executorch/extension/training/optimizer/sgd.h>
 
+#include <executorch/extension/training/optimizer/fused_update.h>
 #include <executorch/runtime/core/error.h>
 
+#include <cinttypes>
+
+using executorch::aten::ScalarType;
 using executorch::aten::Tensor;
-using executorch::aten::TensorImpl;
 using ::executorch::runtime::Error;
 
 namespace executorch {
@@ -19,58 +22,6 @@ namespace extension {
 namespace training {
 namespace optimizer {
 
-namespace {
-void add_out_hack(
-    const Tensor& a,
-    const Tensor& b,
-    const double alpha,
-    Tensor& out) {
-  auto a_ptr = a.const_data_ptr<float>();
-  auto b_ptr = b.const_data_ptr<float>();
-  auto out_ptr = out.mutable_data_ptr<float>();
-  for (size_t i = 0; i < a.numel(); ++i) {
-    out_ptr[i] = a_ptr[i] + b_ptr[i] * alpha;
-  }
-}
-
-void mul_out_hack(const Tensor& a, const double alpha, Tensor& out) {
-  auto a_ptr = a.const_data_ptr<float>();
-  auto out_ptr = out.mutable_data_ptr<float>();
-  for (size_t i = 0; i < a.numel(); ++i) {
-    out_ptr[i] = a_ptr[i] * alpha;
-  }
-}
-
-void clone_out_hack(const Tensor& a, Tensor& out) {
-  auto a_ptr = a.const_data_ptr<float>();
-  auto out_ptr = out.mutable_data_ptr<float>();
-  for (size_t i = 0; i < a.numel(); ++i) {
-    out_ptr[i] = a_ptr[i];
-  }
-}
-} // namespace
-
-bool SGDParamGroup::has_options() const {
-  return options_ != nullptr;
-}
-
-SGDOptions& SGDParamGroup::options() {
-  return *options_.get();
-}
-
-const SGDOptions& SGDParamGroup::options() const {
-  return *options_.get();
-}
-
-void SGDParamGroup::set_options(std::unique_ptr<SGDOptions> options) {
-  options_ = std::move(options);
-}
-
-const std::map<std::string_view, executorch::aten::Tensor>&
-SGDParamGroup::named_parameters() const {
-  return named_parameters_;
-}
-
 void SGD::add_param_group(const SGDParamGroup& param_group) {
   SGDParamGroup param_group_(param_group.named_parameters());
   if (!param_group.has_options()) {
@@ -83,84 +34,85 @@ void SGD::add_param_group(const SGDParamGroup& param_group) {
 
 Error SGD::step(const std::map<std::string_view, executorch::aten::Tensor>&
                     named_gradients) {
-  for (auto& group : param_groups_) {
-    auto& options = static_cast<SGDOptions&>(group.options());
-    auto weight_decay = options.weight_decay();
-    auto momentum = options.momentum();
-    auto dampening = options.dampening();
-    auto nesterov = options.nesterov();
-
-    for (auto param_iter = group.named_parameters().begin();
-         param_iter != group.named_parameters().end();
-         ++param_iter) {
+  std::vector<std::vector<internal::ParamUpdate>> group_updates(
+      param_groups_.size());
+  // Parameters getting their first gradient, which need a momentum buffer,
+  // as (group index, update index) pairs.
+  std::vector<std::pair<size_t, size_t>> new_states;
+  std::vector<Tensor> new_state_params;
+
+  for (size_t group_index = 0; group_index < param_groups_.size();
+       ++group_index) {
+    const auto& group = param_groups_[group_index];
+    const bool use_momentum = group.options().momentum() != 0;
+    auto& updates = group_updates[group_index];
+
+    for (const auto& [name, p] : group.named_parameters()) {
       // if param name and gradient name match, run the optimizer step
-      const auto& named_gradient = named_gradients.find(param_iter->first);
-      if (named_gradient != named_gradients.end()) {
-        auto d_p = named_gradient->second;
-        auto p = param_iter->second;
-        if (weight_decay != 0) {
-          // uses weight_decay specified and adds it to the gradient
-          add_out_hack(d_p, p, weight_decay, d_p);
-        }
-        if (momentum != 0) {
-          Tensor buf(nullptr);
-          auto param_state = state_.find(p.unsafeGetTensorImpl());
-          // look for the momentum buffer for the given parameter. this is the
-          // momentum as of the previous epoch
-          if (param_state == state_.end()) {
-            // create a new momentum buffer if it doesn't exist. this memory
-            // needs to be freed when the optimizer is destroyed
-            void* buf_ptr = malloc(d_p.nbytes());
-
-#ifdef USE_ATEN_LIB
-            std::vector<int64_t> sizes(d_p.sizes().begin(), d_p.sizes().end());
-            buf = torch::from_blob(buf_ptr, sizes, d_p.scalar_type());
-#else
-            TensorImpl* buf_impl = new TensorImpl(
-                d_p.scalar_type(),
-                d_p.sizes().size(),
-                const_cast<TensorImpl::SizesType*>(d_p.sizes().data()),
-                buf_ptr,
-                const_cast<TensorImpl::DimOrderType*>(d_p.dim_order().data()));
-            buf = Tensor(buf_impl);
-#endif
-            clone_out_hack(d_p, buf);
-
-            // save the state of the momentum buffer to be reused in later
-            // epochs
-            auto state = std::make_unique<SGDParamState>(buf);
-            state_[p.unsafeGetTensorImpl()] = std::move(state);
-          } else {
-            buf = static_cast<SGDParamState&>(*param_state->second)
-                      .momentum_buffer();
-
-            // update the momentum buffer and apply dampening
-            mul_out_hack(buf, momentum, buf);
-            add_out_hack(buf, d_p, 1 - dampening, buf);
-          }
-          if (nesterov) {
-            // apply nesterov momentum
-            add_out_hack(d_p, buf, momentum, d_p);
-          } else {
-            d_p = buf;
-          }
+      const auto& named_gradient = named_gradients.find(name);
+      if (named_gradient == named_gradients.end()) {
+        continue;
+      }
+      const auto& d_p = named_gradient->second;
+      ET_CHECK_OR_RETURN_ERROR(
+          p.scalar_type() == ScalarType::Float &&
+              d_p.scalar_type() == ScalarType::Float,
+          InvalidArgument,
+          "SGD only supports float parameters and gradients");
+      ET_CHECK_OR_RETURN_ERROR(
+          p.numel() == d_p.numel(),
+          InvalidArgument,
+          "Gradient has %" PRId64 " elements, expected %" PRId64,
+          static_cast<int64_t>(d_p.numel()),
+          static_cast<int64_t>(p.numel()));
+
+      internal::ParamUpdate update{
+          p.mutable_data_ptr<float>(),
+          d_p.const_data_ptr<float>(),
+          {nullptr, nullptr},
+          static_cast<int64_t>(p.numel()),
+          // Only whether this is the first update matters to SGD.
+          /*step=*/2};
+      if (use_momentum) {
+        // look for the momentum buffer for the given parameter. this is the
+        // momentum as of the previous epoch
+        auto param_state = state_.find(p.unsafeGetTensorImpl());
+        if (param_state == state_.end()) {
+          update.step = 1;
+          new_states.emplace_back(group_index, updates.size());
+          new_state_params.push_back(p);
+        } else {
+          update.state[0] =
+              param_state->second->momentum_buffer().mutable_data_ptr<float>();
         }
-        // update the parameter using the gradient and learning rate
-        add_out_hack(p, d_p, -1 * options.lr(), p);
       }
+      updates.push_back(update);
     }
   }
-  return Error::Ok;
-}
 
-SGD::~SGD() {
-  for (const auto& state_kv : state_) {
-    auto state_tensor = static_cast<SGDParamState&>(*state_kv.second);
-    free(state_tensor.momentum_buffer().unsafeGetTensorImpl()->mutable_data());
-#ifndef USE_ATEN_LIB
-    delete state_tensor.momentum_buffer().unsafeGetTensorImpl();
-#endif
+  // create the missing momentum buffers, all in one block. the kernel sets
+  // them to the gradient on the first step.
+  auto buffers = state_arena_.allocate(new_state_params);
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    const auto [group_index, update_index] = new_states[i];
+    group_updates[group_index][update_index].state[0] =
+        buffers[i].mutable_data_ptr<float>();
+    state_[new_state_params[i].unsafeGetTensorImpl()] =
+        std::make_unique<SGDParamState>(buffers[i]);
   }
+
+  for (size_t group_index = 0; group_index < param_groups_.size();
+       ++group_index) {
+    const auto& options = param_groups_[group_index].options();
+    internal::sgd_update(
+        group_updates[group_index],
+        {static_cast<float>(options.lr()),
+         static_cast<float>(options.momentum()),
+         static_cast<float>(options.dampening()),
+         static_cast<float>(options.weight_decay()),
+         options.nesterov()});
+  }
+  return Error::Ok;
 }
 
 } // namespace optimizer
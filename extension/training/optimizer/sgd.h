@@ -16,6 +16,8 @@
  */
 #pragma once
 
+#include <executorch/extension/training/optimizer/param_group.h>
+#include <executorch/extension/training/optimizer/state_arena.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <map>
@@ -128,53 +130,16 @@ class ET_EXPERIMENTAL SGDOptions {
  * SGD optimizer param group. This contains the parameters and
  * the SGDOptions associated to it.
  */
-class ET_EXPERIMENTAL SGDParamGroup {
- public:
-  // NOTE: In order to store `SGDParamGroup` in a `std::vector`, it has
-  // to be copy-constructible.
-  SGDParamGroup(const SGDParamGroup& param_group)
-      : named_parameters_(param_group.named_parameters()),
-        options_(
-            param_group.has_options() ? param_group.options().clone()
-                                      : nullptr) {}
-  SGDParamGroup& operator=(const SGDParamGroup& param_group) {
-    this->named_parameters_ = param_group.named_parameters_;
-    this->options_ =
-        param_group.has_options() ? param_group.options().clone() : nullptr;
-    return *this;
-  }
-
-  /**
-   * Constructs a SGD param group.
-   *
-   * @param[in] named_parameters The parameters to be optimized and their fully
-   * qualified names.
-   */
-  /* implicit */ SGDParamGroup(
-      const std::map<std::string_view, executorch::aten::Tensor>&
-          named_parameters)
-      : named_parameters_(named_parameters) {}
-  SGDParamGroup(
-      const std::map<std::string_view, executorch::aten::Tensor>&
-          named_parameters,
-      std::unique_ptr<SGDOptions> options)
-      : named_parameters_(named_parameters), options_(std::move(options)) {}
-
-  bool has_options() const;
-  SGDOptions& options();
-  const SGDOptions& options() const;
-  void set_options(std::unique_ptr<SGDOptions> options);
-  const std::map<std::string_view, executorch::aten::Tensor>& named_parameters()
-      const;
-
- private:
-  std::map<std::string_view, executorch::aten::Tensor> named_parameters_;
-  std::unique_ptr<SGDOptions> options_;
-};
+using SGDParamGroup = ParamGroup<SGDOptions>;
 
 /**
  * SGD optimizer class. This is responsible for performing the optimization
  * step.
+ *
+ * Each step updates every parameter in a single vectorized pass over the
+ * parameter, its gradient and its momentum buffer, split across threads. The
+ * gradients are left unchanged. The momentum buffers of all the parameters that
+ * get their first gradient in a step are allocated together, in one block.
  */
 class ET_EXPERIMENTAL SGD {
  public:
@@ -196,13 +161,14 @@ class ET_EXPERIMENTAL SGD {
   // Adds the given param_group to the optimizer's param_group list.
   void add_param_group(const SGDParamGroup& param_group);
 
-  ~SGD();
-
   /**
    * Performs the optimization step.
    *
    * @param[in] named_gradients The gradients of the tensors specified by the
    * fully qualified name.
+   *
+   * @returns Error::InvalidArgument if a parameter or gradient is not a float
+   * tensor, or if a gradient does not have as many elements as its parameter.
    */
   ::executorch::runtime::Error step(
       const std::map<std::string_view, executorch::aten::Tensor>&
@@ -212,6 +178,7 @@ class ET_EXPERIMENTAL SGD {
   std::vector<SGDParamGroup> param_groups_;
   std::unordered_map<void*, std::unique_ptr<SGDParamState>> state_;
   std::unique_ptr<SGDOptions> defaults_;
+  StateArena state_arena_;
 };
 
 } // namespace optimizer
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/training/optimizer/state_arena.h>
+
+#include <executorch/runtime/core/exec_aten/util/dim_order_util.h>
+
+#include <cstdint>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::aten::TensorImpl;
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+
+namespace {
+// Every state tensor starts on its own cache line, so that threads updating
+// neighbouring tensors do not share lines and vector loads stay aligned.
+constexpr size_t kAlignment = 64;
+constexpr size_t kAlignmentElements = kAlignment / sizeof(float);
+
+size_t round_up(size_t numel) {
+  return (numel + kAlignmentElements - 1) / kAlignmentElements *
+      kAlignmentElements;
+}
+} // namespace
+
+struct StateArena::Block {
+  std::unique_ptr<float[]> storage;
+#ifndef USE_ATEN_LIB
+  // TensorImpl does not own its metadata, so the block keeps it alive.
+  std::vector<std::vector<TensorImpl::SizesType>> sizes;
+  std::vector<std::vector<TensorImpl::DimOrderType>> dim_orders;
+  std::vector<std::vector<TensorImpl::StridesType>> strides;
+  std::vector<std::unique_ptr<TensorImpl>> impls;
+#endif
+};
+
+StateArena::StateArena() = default;
+
+StateArena::~StateArena() = default;
+
+std::vector<Tensor> StateArena::allocate(const std::vector<Tensor>& likes) {
+  std::vector<Tensor> tensors;
+  if (likes.empty()) {
+    return tensors;
+  }
+
+  std::vector<size_t> offsets;
+  offsets.reserve(likes.size());
+  size_t total = 0;
+  for (const auto& like : likes) {
+    offsets.push_back(total);
+    total += round_up(like.numel());
+  }
+
+  auto block = std::make_unique<Block>();
+  // One extra cache line to align the start of the block. make_unique
+  // value-initializes the array, so the state starts out zeroed.
+  block->storage = std::make_unique<float[]>(total + kAlignmentElements);
+  const auto address = reinterpret_cast<uintptr_t>(block->storage.get());
+  float* base = reinterpret_cast<float*>(
+      (address + kAlignment - 1) / kAlignment * kAlignment);
+
+  tensors.reserve(likes.size());
+#ifndef USE_ATEN_LIB
+  block->sizes.reserve(likes.size());
+  block->dim_orders.reserve(likes.size());
+  block->strides.reserve(likes.size());
+  block->impls.reserve(likes.size());
+#endif
+  for (size_t i = 0; i < likes.size(); ++i) {
+    const Tensor& like = likes[i];
+    float* data = base + offsets[i];
+#ifdef USE_ATEN_LIB
+    std::vector<int64_t> sizes(like.sizes().begin(), like.sizes().end());
+    tensors.push_back(torch::from_blob(data, sizes, ScalarType::Float));
+#else
+    auto& sizes = block->sizes.emplace_back(
+        like.sizes().begin(), like.sizes().end());
+    auto& dim_order = block->dim_orders.emplace_back(
+        like.dim_order().begin(), like.dim_order().end());
+    auto& strides = block->strides.emplace_back(like.dim());
+    executorch::runtime::dim_order_to_stride_nocheck(
+        sizes.data(), dim_order.data(), like.dim(), strides.data());
+    auto& impl = block->impls.emplace_back(std::make_unique<TensorImpl>(
+        ScalarType::Float,
+        like.dim(),
+        sizes.data(),
+        data,
+        dim_order.data(),
+        strides.data()));
+    tensors.emplace_back(impl.get());
+#endif
+  }
+
+  nbytes_ += total * sizeof(float);
+  blocks_.push_back(std::move(block));
+  return tensors;
+}
+
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
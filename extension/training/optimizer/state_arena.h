@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <memory>
+#include <vector>
+
+namespace executorch {
+namespace extension {
+namespace training {
+namespace optimizer {
+
+/**
+ * Owns the per-parameter state of an optimizer, such as momentum buffers or
+ * moment estimates.
+ *
+ * Instead of one heap allocation per state tensor, all the tensors requested
+ * by one call to allocate() share a single block, with each tensor starting on
+ * a cache line boundary. Optimizers allocate the state of every parameter that
+ * gets a gradient in a step at once, so in a usual training loop all of the
+ * state lives in one contiguous block.
+ */
+class ET_EXPERIMENTAL StateArena final {
+ public:
+  StateArena();
+  StateArena(const StateArena&) = delete;
+  StateArena& operator=(const StateArena&) = delete;
+  StateArena(StateArena&&) = delete;
+  StateArena& operator=(StateArena&&) = delete;
+  ~StateArena();
+
+  /**
+   * Allocates a zero-initialized float tensor with the sizes and dim order of
+   * each of `likes`, all in one block.
+   *
+   * @param[in] likes The tensors whose shape the state tensors should have.
+   *
+   * @returns The state tensors, in the order of `likes`. They stay valid for
+   * the lifetime of the arena.
+   */
+  std::vector<executorch::aten::Tensor> allocate(
+      const std::vector<executorch::aten::Tensor>& likes);
+
+  // The number of bytes allocated for state tensors so far.
+  size_t nbytes() const {
+    return nbytes_;
+  }
+
+ private:
+  struct Block;
+  std::vector<std::unique_ptr<Block>> blocks_;
+  size_t nbytes_ = 0;
+};
+
+} // namespace optimizer
+} // namespace training
+} // namespace extension
+} // namespace executorch
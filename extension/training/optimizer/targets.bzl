@@ -24,6 +24,30 @@ def define_common_targets():
         #         "//executorch/kernels/portable:generated_lib_headers",
         #     ]
 
+        runtime.cxx_library(
+            name = "optimizer_common" + aten_suffix,
+            srcs = [
+                "fused_update.cpp",
+                "state_arena.cpp",
+            ],
+            exported_headers = [
+                "fused_update.h",
+                "param_group.h",
+                "state_arena.h",
+            ],
+            deps = [
+                "//executorch/extension/threadpool:threadpool",
+                "//executorch/runtime/core/portable_type/c10/c10:aten_headers_for_executorch",
+            ],
+            exported_deps = [
+                "//executorch/runtime/core:core",
+                "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
+            ],
+            visibility = [
+                "//executorch/extension/training/...",
+            ],
+        )
+
         runtime.cxx_library(
             name = "sgd" + aten_suffix,
             srcs = [
@@ -33,6 +57,7 @@ def define_common_targets():
                 "sgd.h",
             ],
             exported_deps = [
+                ":optimizer_common" + aten_suffix,
                 "//executorch/runtime/core:core",
                 "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
             ],  # + kernel_deps,
@@ -40,3 +65,21 @@ def define_common_targets():
                 "@EXECUTORCH_CLIENTS",
             ],
         )
+
+        runtime.cxx_library(
+            name = "adam" + aten_suffix,
+            srcs = [
+                "adam.cpp",
+            ],
+            exported_headers = [
+                "adam.h",
+            ],
+            exported_deps = [
+                ":optimizer_common" + aten_suffix,
+                "//executorch/runtime/core:core",
+                "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
+            ],
+            visibility = [
+                "@EXECUTORCH_CLIENTS",
+            ],
+        )
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/extension/training/optimizer/adam.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+// @lint-ignore-every CLANGTIDY facebook-hte-CArray
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using ::executorch::extension::training::optimizer::Adam;
+using ::executorch::extension::training::optimizer::AdamOptions;
+using ::executorch::extension::training::optimizer::AdamParamGroup;
+using ::executorch::extension::training::optimizer::AdamW;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+std::vector<float> make_data(int32_t numel, float scale, float offset) {
+  std::vector<float> data(numel);
+  for (int32_t i = 0; i < numel; ++i) {
+    data[i] = std::sin(scale * i + offset);
+  }
+  return data;
+}
+
+// torch.optim.Adam and torch.optim.AdamW, in double precision.
+struct ReferenceAdam {
+  AdamOptions options;
+  bool decoupled_weight_decay;
+  std::vector<double> param;
+  std::vector<double> exp_avg;
+  std::vector<double> exp_avg_sq;
+  int64_t step = 0;
+
+  void update(const std::vector<float>& grad) {
+    exp_avg.resize(param.size());
+    exp_avg_sq.resize(param.size());
+    ++step;
+    const double bias_correction1 = 1 - std::pow(options.beta1(), step);
+    const double bias_correction2 = 1 - std::pow(options.beta2(), step);
+    for (size_t i = 0; i < param.size(); ++i) {
+      double g = grad[i];
+      if (decoupled_weight_decay) {
+        param[i] *= 1 - options.lr() * options.weight_decay();
+      } else {
+        g += options.weight_decay() * param[i];
+      }
+      exp_avg[i] = options.beta1() * exp_avg[i] + (1 - options.beta1()) * g;
+      exp_avg_sq[i] =
+          options.beta2() * exp_avg_sq[i] + (1 - options.beta2()) * g * g;
+      const double denom = std::sqrt(exp_avg_sq[i] / bias_correction2) +
+          options.eps();
+      param[i] -= options.lr() / bias_correction1 * exp_avg[i] / denom;
+    }
+  }
+};
+
+} // namespace
+
+class AdamOptimizerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+  }
+
+  // Runs a few steps over parameters whose sizes are not multiples of the
+  // vector width and compares with the reference.
+  template <typename Optimizer>
+  void expect_matches_reference(
+      const AdamOptions& options,
+      bool decoupled_weight_decay) {
+    TensorFactory<ScalarType::Float> tf;
+    const std::vector<int32_t> numels = {1, 37, 1000};
+    const std::vector<std::string> names = {"bias", "weight", "embedding"};
+
+    std::map<std::string_view, Tensor> named_parameters;
+    std::vector<ReferenceAdam> references;
+    for (size_t i = 0; i < numels.size(); ++i) {
+      const auto data = make_data(numels[i], 0.37f, i);
+      named_parameters.insert({names[i], tf.make({numels[i]}, data)});
+      references.push_back(
+          {options,
+           decoupled_weight_decay,
+           std::vector<double>(data.begin(), data.end())});
+    }
+
+    Optimizer optimizer(named_parameters, options);
+    for (int step = 0; step < 5; ++step) {
+      std::map<std::string_view, Tensor> named_gradients;
+      std::vector<std::vector<float>> grads;
+      for (size_t i = 0; i < numels.size(); ++i) {
+        grads.push_back(make_data(numels[i], 1.3f, step + 0.1f * i));
+        named_gradients.insert({names[i], tf.make({numels[i]}, grads[i])});
+        references[i].update(grads[i]);
+      }
+      ASSERT_EQ(optimizer.step(named_gradients), Error::Ok);
+
+      for (size_t i = 0; i < numels.size(); ++i) {
+        const float* grad =
+            named_gradients.at(names[i]).template const_data_ptr<float>();
+        EXPECT_TRUE(std::equal(grad, grad + numels[i], grads[i].begin()));
+        const float* param =
+            named_parameters.at(names[i]).template const_data_ptr<float>();
+        for (int32_t j = 0; j < numels[i]; ++j) {
+          EXPECT_NEAR(param[j], references[i].param[j], 1e-5)
+              << names[i] << "[" << j << "] at step " << step;
+        }
+      }
+    }
+  }
+};
+
+TEST_F(AdamOptimizerTest, AdamOptionsDefaultValuesTest) {
+  AdamOptions options;
+
+  EXPECT_EQ(options.lr(), 1e-3);
+  EXPECT_EQ(options.beta1(), 0.9);
+  EXPECT_EQ(options.beta2(), 0.999);
+  EXPECT_EQ(options.eps(), 1e-8);
+  EXPECT_EQ(options.weight_decay(), 0);
+}
+
+TEST_F(AdamOptimizerTest, AdamMatchesReference) {
+  expect_matches_reference<Adam>(
+      AdamOptions(0.01, 0.9, 0.99, 1e-8, 0.1),
+      /*decoupled_weight_decay=*/false);
+}
+
+TEST_F(AdamOptimizerTest, AdamWMatchesReference) {
+  expect_matches_reference<AdamW>(
+      AdamOptions(0.01, 0.8, 0.999, 1e-6, 0.1),
+      /*decoupled_weight_decay=*/true);
+}
+
+TEST_F(AdamOptimizerTest, ParamGroupOptionsOverrideDefaults) {
+  TensorFactory<ScalarType::Float> tf;
+  std::map<std::string_view, Tensor> frozen = {
+      {"frozen", tf.make({2}, {1, 1})}};
+  std::map<std::string_view, Tensor> trained = {
+      {"trained", tf.make({2}, {1, 1})}};
+  std::map<std::string_view, Tensor> named_gradients = {
+      {"frozen", tf.make({2}, {1, -1})}, {"trained", tf.make({2}, {1, -1})}};
+
+  std::vector<AdamParamGroup> param_groups = {
+      AdamParamGroup(frozen, std::make_unique<AdamOptions>(0.0)),
+      AdamParamGroup(trained)};
+  Adam optimizer(param_groups, AdamOptions(0.1));
+  ASSERT_EQ(optimizer.step(named_gradients), Error::Ok);
+
+  // The first Adam step moves each element by lr against its gradient sign.
+  const float* f = frozen.at("frozen").const_data_ptr<float>();
+  const float* t = trained.at("trained").const_data_ptr<float>();
+  EXPECT_FLOAT_EQ(f[0], 1);
+  EXPECT_FLOAT_EQ(f[1], 1);
+  EXPECT_NEAR(t[0], 0.9, 1e-6);
+  EXPECT_NEAR(t[1], 1.1, 1e-6);
+}
+
+TEST_F(AdamOptimizerTest, NonFloatParameterFails) {
+  TensorFactory<ScalarType::Int> tf_int;
+  TensorFactory<ScalarType::Float> tf;
+  std::map<std::string_view, Tensor> named_parameters = {
+      {"param", tf_int.make({2}, {1, 2})}};
+  std::map<std::string_view, Tensor> named_gradients = {
+      {"param", tf.make({2}, {1, 1})}};
+
+  Adam optimizer(named_parameters, AdamOptions());
+  EXPECT_EQ(optimizer.step(named_gradients), Error::InvalidArgument);
+}
@@ -14,6 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
 // @lint-ignore-every CLANGTIDY facebook-hte-CArray
 
 using namespace ::testing;
@@ -112,3 +115,64 @@ TEST_F(SGDOptimizerTest, SGDOptimizerComplex) {
   EXPECT_NEAR(p1[0], 0.540303, 0.1);
   EXPECT_NEAR(p2[0], 0.620909, 0.1);
 }
+
+TEST_F(SGDOptimizerTest, SGDOptimizerMatchesReference) {
+  TensorFactory<ScalarType::Float> tf;
+
+  // Not a multiple of the vector width, so both the vector and scalar paths
+  // run.
+  constexpr int32_t kNumel = 1003;
+  std::vector<float> param_data(kNumel);
+  for (int32_t i = 0; i < kNumel; ++i) {
+    param_data[i] = std::cos(0.1f * i);
+  }
+  std::map<std::string_view, executorch::aten::Tensor> named_parameters;
+  named_parameters.insert({"param1", tf.make({kNumel}, param_data)});
+
+  for (bool nesterov : {false, true}) {
+    SCOPED_TRACE(nesterov ? "nesterov" : "momentum");
+    const SGDOptions options{0.05, 0.9, nesterov ? 0 : 0.1, 0.01, nesterov};
+    SGD optimizer(named_parameters, options);
+
+    std::vector<double> param(kNumel);
+    std::vector<double> buf(kNumel);
+    const float* p1 = named_parameters.at("param1").const_data_ptr<float>();
+    std::copy(p1, p1 + kNumel, param.begin());
+    for (int step = 0; step < 4; ++step) {
+      std::vector<float> grad_data(kNumel);
+      for (int32_t i = 0; i < kNumel; ++i) {
+        grad_data[i] = std::sin(0.7f * i + step);
+      }
+      std::map<std::string_view, executorch::aten::Tensor> named_gradients;
+      named_gradients.insert({"param1", tf.make({kNumel}, grad_data)});
+      ASSERT_EQ(optimizer.step(named_gradients), Error::Ok);
+
+      // torch.optim.SGD, which leaves the gradient unchanged.
+      const float* grad =
+          named_gradients.at("param1").const_data_ptr<float>();
+      for (int32_t i = 0; i < kNumel; ++i) {
+        ASSERT_EQ(grad[i], grad_data[i]);
+        double g = grad_data[i] + options.weight_decay() * param[i];
+        buf[i] = step == 0
+            ? g
+            : options.momentum() * buf[i] + (1 - options.dampening()) * g;
+        g = nesterov ? g + options.momentum() * buf[i] : buf[i];
+        param[i] -= options.lr() * g;
+        EXPECT_NEAR(p1[i], param[i], 1e-5) << i << " at step " << step;
+      }
+    }
+  }
+}
+
+TEST_F(SGDOptimizerTest, SGDOptimizerMismatchedGradientFails) {
+  TensorFactory<ScalarType::Float> tf;
+
+  std::map<std::string_view, executorch::aten::Tensor> named_parameters;
+  std::map<std::string_view, executorch::aten::Tensor> named_gradients;
+  named_parameters.insert({"param1", tf.make({2}, {1, 2})});
+  named_gradients.insert({"param1", tf.make({3}, {1, 1, 1})});
+
+  SGD optimizer(named_parameters, SGDOptions{0.1});
+  EXPECT_EQ(optimizer.step(named_gradients), Error::InvalidArgument);
+  EXPECT_EQ(named_parameters.at("param1").const_data_ptr<float>()[0], 1);
+}
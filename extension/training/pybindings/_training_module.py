@@ -6,7 +6,9 @@
 
 # pyre-unsafe
 
-from typing import Any, Dict, List, Sequence
+from typing import Any, Dict, List, Optional, Sequence
+
+import torch
 
 from executorch.exir._warnings import experimental
 
@@ -20,6 +22,16 @@ from torch import Tensor
 
 @experimental("This API is experimental and subject to change without notice.")
 class TrainingModule:
+    """
+    Runs the joint forward/backward graph of a program exported for training.
+
+    By default every forward_backward replaces the gradients. The module can
+    also accumulate gradients over micro-batches, see
+    set_gradient_accumulation_steps, and train programs exported in bfloat16
+    or half against float master parameters, see enable_mixed_precision.
+    Either way, step the optimizer only when gradients_ready() returns True.
+    """
+
     def __init__(self, module: ExecuTorchModule):
         self.model = module
 
@@ -30,6 +42,135 @@ class TrainingModule:
         self.named_grads = None
         self.named_params = None
 
+        # Gradient accumulation and mixed precision state, see the C++
+        # TrainingModule for the matching semantics.
+        self.accumulation_steps = 1
+        self.micro_step = 0
+        self.ready = False
+        self.mixed_precision = False
+        self.current_loss_scale = 1.0
+        self.dynamic_loss_scale = False
+        self.growth_interval = 2000
+        self.steps_since_overflow = 0
+        self.pass_loss_scale = False
+        self.master_params: Optional[Dict[str, Tensor]] = None
+        self.grad_buffers: Optional[Dict[str, Tensor]] = None
+
+    def set_gradient_accumulation_steps(self, num_micro_steps: int) -> None:
+        """
+        Accumulates gradients in place over num_micro_steps calls to
+        forward_backward. After the last micro-step named_gradients() holds the
+        mean of the gradients of the micro-steps.
+        """
+        if num_micro_steps < 1:
+            raise ValueError(
+                f"num_micro_steps must be at least 1, got {num_micro_steps}"
+            )
+        self.accumulation_steps = num_micro_steps
+        self.micro_step = 0
+        self.ready = False
+
+    def enable_mixed_precision(
+        self,
+        loss_scale: float = 1.0,
+        dynamic_loss_scale: bool = False,
+        growth_interval: int = 2000,
+    ) -> None:
+        """
+        Trains a program whose parameters are in bfloat16 or half against float
+        master copies, which named_parameters() returns afterwards. Gradients
+        are returned in float.
+
+        With a loss_scale other than 1 or dynamic_loss_scale, the program must
+        take the loss scale as its last input, a float tensor with one element,
+        and multiply its loss by it. The module passes the current scale and
+        divides the gradients by it. With dynamic_loss_scale an overflowing
+        step is skipped and halves the scale, and growth_interval steps without
+        overflow double it.
+        """
+        if self.mixed_precision:
+            raise RuntimeError("Mixed precision is already enabled")
+        if loss_scale <= 0:
+            raise ValueError(f"loss_scale must be positive, got {loss_scale}")
+        if growth_interval < 1:
+            raise ValueError(
+                f"growth_interval must be positive, got {growth_interval}"
+            )
+        self.mixed_precision = True
+        self.current_loss_scale = float(loss_scale)
+        self.dynamic_loss_scale = dynamic_loss_scale
+        self.growth_interval = growth_interval
+        self.steps_since_overflow = 0
+        self.pass_loss_scale = loss_scale != 1 or dynamic_loss_scale
+        self.micro_step = 0
+        self.ready = False
+        if self.named_params is not None:
+            self._make_master_params()
+
+    def gradients_ready(self) -> bool:
+        """
+        Whether the latest forward_backward completed an accumulation whose
+        gradients, in mixed precision, did not overflow.
+        """
+        return self.ready
+
+    def loss_scale(self) -> float:
+        return self.current_loss_scale
+
+    def _uses_buffers(self) -> bool:
+        return self.accumulation_steps > 1 or self.mixed_precision
+
+    def _make_master_params(self) -> None:
+        assert self.named_params is not None
+        masters = {}
+        for name, param in self.named_params.items():
+            if param.dtype == torch.float32:
+                masters[name] = param
+            elif param.dtype in (torch.bfloat16, torch.float16):
+                masters[name] = param.float()
+            else:
+                raise RuntimeError(
+                    f"Parameter {name} has unsupported dtype {param.dtype} for "
+                    "mixed precision"
+                )
+        self.master_params = masters
+
+    def _accumulate(self, named_grads: Dict[str, Tensor]) -> None:
+        if self.grad_buffers is None:
+            self.grad_buffers = {
+                name: torch.zeros_like(grad, dtype=torch.float32)
+                for name, grad in named_grads.items()
+            }
+        self.named_grads = self.grad_buffers
+        # The buffers hold the mean over the micro-steps of the unscaled
+        # gradients.
+        scale = 1.0 / (self.accumulation_steps * self.current_loss_scale)
+        for name, grad in named_grads.items():
+            buffer = self.named_grads[name]
+            if self.micro_step == 0:
+                buffer.copy_(grad).mul_(scale)
+            else:
+                buffer.add_(grad.float(), alpha=scale)
+
+        self.micro_step += 1
+        if self.micro_step < self.accumulation_steps:
+            self.ready = False
+            return
+        self.micro_step = 0
+        overflow = self.mixed_precision and not all(
+            torch.isfinite(buffer).all() for buffer in self.named_grads.values()
+        )
+        self.ready = not overflow
+        if self.dynamic_loss_scale:
+            if overflow:
+                self.current_loss_scale *= 0.5
+                self.steps_since_overflow = 0
+            else:
+                self.steps_since_overflow += 1
+                if self.steps_since_overflow == self.growth_interval:
+                    self.current_loss_scale *= 2.0
+                    self.steps_since_overflow = 0
+
     def forward_backward(self, method_name: str, inputs: Sequence[Any]) -> List[Any]:
         # The default ET model returns a large list of outputs that can logically be
         # separated into [user outputs, gradients, parameters]. Can use these metadata
@@ -41,6 +182,19 @@ class TrainingModule:
             self.parameters_method_prefix + method_name, ()
         )[0]
 
+        # In mixed precision, round the master parameters into the program at the
+        # start of each accumulation.
+        if self.master_params is not None and self.micro_step == 0:
+            assert self.named_params is not None
+            for name, master in self.master_params.items():
+                param = self.named_params[name]
+                if param is not master:
+                    param.copy_(master)
+        if self.pass_loss_scale:
+            inputs = tuple(inputs) + (
+                torch.tensor([self.current_loss_scale], dtype=torch.float32),
+            )
+
         # Important that the outputs are not cloned because we need the optimizer to
         # be able to mutate the actual weights and not clones of them.
         full_outputs = self.model.run_method(method_name, inputs, clone_outputs=False)
@@ -48,14 +202,20 @@ class TrainingModule:
         user_outs = full_outputs[:grad_start_idx]
         user_outs = [x.clone() for x in user_outs]
         grads = full_outputs[grad_start_idx:params_start_idx]
-        grads = [grad.clone() for grad in grads]
 
         fqn = self.model.run_method(self.fqn_method_prefix + method_name, ())
 
-        self.named_grads = dict(zip(fqn, grads))
+        if self._uses_buffers():
+            self._accumulate(dict(zip(fqn, grads)))
+        else:
+            grads = [grad.clone() for grad in grads]
+            self.named_grads = dict(zip(fqn, grads))
+            self.ready = True
         if self.named_params is None:
             params = full_outputs[params_start_idx:]
             self.named_params = dict(zip(fqn, params))
+            if self.mixed_precision:
+                self._make_master_params()
 
         return user_outs
 
@@ -69,6 +229,8 @@ class TrainingModule:
             raise RuntimeError(
                 "Must call forward_backward before named_params. This will be fixed in a later version"
             )
+        if self.master_params is not None:
+            return self.master_params
         return self.named_params
 
 
@@ -65,3 +65,62 @@ class TestTraining(unittest.TestCase):
         # the same inputs again and seeing that the loss is different.
         second_loss = tm.forward_backward("forward", m.get_inputs())
         self.assertFalse(torch.allclose(orig_loss[0], second_loss[0]))
+
+    def _load_training_module(self, m):
+        ep = torch.export.export(m, m.get_inputs(), strict=True)
+        ep = _export_forward_backward(ep)
+        ep = to_edge(ep)
+        ep = ep.to_executorch()
+        return _load_for_executorch_for_training_from_buffer(ep.buffer)
+
+    def test_gradient_accumulation(self):
+        m = self.ModuleSimpleTrain()
+        batches = [
+            m.get_inputs(),
+            (torch.tensor([0.5, -1.0, 2.0]), torch.tensor([0.0, 0.0, 1.0])),
+        ]
+
+        tm = self._load_training_module(m)
+        expected = None
+        for batch in batches:
+            tm.forward_backward("forward", batch)
+            self.assertTrue(tm.gradients_ready())
+            grads = {k: v / len(batches) for k, v in tm.named_gradients().items()}
+            if expected is None:
+                expected = grads
+            else:
+                expected = {k: expected[k] + grads[k] for k in expected}
+
+        accumulating_tm = self._load_training_module(m)
+        with self.assertRaises(ValueError):
+            accumulating_tm.set_gradient_accumulation_steps(0)
+        accumulating_tm.set_gradient_accumulation_steps(len(batches))
+        accumulating_tm.forward_backward("forward", batches[0])
+        self.assertFalse(accumulating_tm.gradients_ready())
+        accumulating_tm.forward_backward("forward", batches[1])
+        self.assertTrue(accumulating_tm.gradients_ready())
+
+        grads = accumulating_tm.named_gradients()
+        self.assertEqual(grads.keys(), expected.keys())
+        for name, grad in grads.items():
+            self.assertTrue(torch.allclose(grad, expected[name], atol=1e-6))
+
+    def test_mixed_precision_float_program(self):
+        m = self.ModuleSimpleTrain()
+        tm = self._load_training_module(m)
+        with self.assertRaises(ValueError):
+            tm.enable_mixed_precision(loss_scale=0)
+        tm.enable_mixed_precision()
+        self.assertEqual(tm.loss_scale(), 1.0)
+
+        orig_loss = tm.forward_backward("forward", m.get_inputs())
+        self.assertTrue(tm.gradients_ready())
+        for grad in tm.named_gradients().values():
+            self.assertEqual(grad.dtype, torch.float32)
+
+        # Float parameters are their own master copies, so stepping them
+        # changes the program.
+        optimizer = get_sgd_optimizer(tm.named_parameters(), 0.1, 0, 0, 0, False)
+        optimizer.step(tm.named_gradients())
+        second_loss = tm.forward_backward("forward", m.get_inputs())
+        self.assertFalse(torch.allclose(orig_loss[0], second_loss[0]))
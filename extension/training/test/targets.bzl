@@ -35,3 +35,21 @@ def define_common_targets(is_fbcode = False):
             ],
             env = modules_env,
         )
+
+    runtime.cxx_binary(
+        name = "training_loop_benchmark",
+        srcs = [
+            "training_loop_benchmark.cpp",
+        ],
+        deps = [
+            "//executorch/extension/data_loader:file_data_loader",
+            "//executorch/extension/tensor:tensor",
+            "//executorch/extension/threadpool:cpuinfo_utils",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/extension/training/module:training_module",
+            "//executorch/extension/training/optimizer:adam",
+            "//executorch/extension/training/optimizer:sgd",
+            "//executorch/kernels/portable:generated_lib",
+        ],
+        external_deps = ["gflags"],
+    )
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Times the optimizer step of an on-device training loop.
+ *
+ * Without --model_path, steps each optimizer over a synthetic set of
+ * transformer-shaped parameters and reports the step time and the effective
+ * memory bandwidth. With --model_path, runs forward_backward on the joint
+ * graph of the program with random inputs and reports how the iteration time
+ * splits between forward_backward and the optimizer step.
+ */
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/extension/training/module/training_module.h>
+#include <executorch/extension/training/optimizer/adam.h>
+#include <executorch/extension/training/optimizer/sgd.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <gflags/gflags.h>
+
+#if defined(ET_USE_THREADPOOL)
+#include <executorch/extension/threadpool/cpuinfo_utils.h>
+#include <executorch/extension/threadpool/threadpool.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+DEFINE_string(
+    model_path,
+    "",
+    "Optional training program. Without it, synthetic parameters are used.");
+DEFINE_string(ptd_path, "", "Model weights serialized in flatbuffer format.");
+DEFINE_string(method, "forward", "Joint graph method of --model_path to run.");
+DEFINE_string(
+    optimizer,
+    "all",
+    "One of sgd, sgd_momentum, adam, adamw, or all.");
+DEFINE_int32(dim, 512, "Width of the synthetic model.");
+DEFINE_int32(num_layers, 8, "Number of layers of the synthetic model.");
+DEFINE_int32(warmup, 3, "Untimed iterations before measuring.");
+DEFINE_int32(iterations, 20, "Timed iterations.");
+DEFINE_int32(
+    cpu_threads,
+    -1,
+    "Number of CPU threads. Defaults to -1, which uses the number of performant cores.");
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::extension::TensorPtr;
+using executorch::extension::training::optimizer::Adam;
+using executorch::extension::training::optimizer::AdamOptions;
+using executorch::extension::training::optimizer::AdamW;
+using executorch::extension::training::optimizer::SGD;
+using executorch::extension::training::optimizer::SGDOptions;
+using executorch::runtime::Error;
+
+namespace {
+
+using NamedTensors = std::map<std::string_view, Tensor>;
+using StepFn = std::function<Error(const NamedTensors&)>;
+
+struct OptimizerCase {
+  std::string name;
+  // Floats read or written per parameter element by one step.
+  int floats_per_element;
+  std::function<StepFn(const NamedTensors&)> make;
+};
+
+template <typename Optimizer, typename Options>
+std::function<StepFn(const NamedTensors&)> make_optimizer(Options options) {
+  return [options](const NamedTensors& named_parameters) {
+    auto optimizer = std::make_shared<Optimizer>(named_parameters, options);
+    return [optimizer](const NamedTensors& named_gradients) {
+      return optimizer->step(named_gradients);
+    };
+  };
+}
+
+std::vector<OptimizerCase> selected_optimizers() {
+  std::vector<OptimizerCase> cases = {
+      // param and grad in, param out.
+      {"sgd", 3, make_optimizer<SGD>(SGDOptions(1e-3))},
+      // plus the momentum buffer in and out.
+      {"sgd_momentum", 5, make_optimizer<SGD>(SGDOptions(1e-3, 0.9))},
+      // plus both running averages in and out.
+      {"adam", 7, make_optimizer<Adam>(AdamOptions(1e-3))},
+      {"adamw",
+       7,
+       make_optimizer<AdamW>(AdamOptions(1e-3, 0.9, 0.999, 1e-8, 1e-2))},
+  };
+  if (FLAGS_optimizer != "all") {
+    cases.erase(
+        std::remove_if(
+            cases.begin(),
+            cases.end(),
+            [](const OptimizerCase& c) { return c.name != FLAGS_optimizer; }),
+        cases.end());
+  }
+  return cases;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+struct Timing {
+  double mean_ms = 0;
+  double min_ms = 0;
+};
+
+Timing summarize(const std::vector<double>& times_ms) {
+  Timing timing;
+  if (times_ms.empty()) {
+    return timing;
+  }
+  for (double t : times_ms) {
+    timing.mean_ms += t;
+  }
+  timing.mean_ms /= times_ms.size();
+  timing.min_ms = *std::min_element(times_ms.begin(), times_ms.end());
+  return timing;
+}
+
+// Weights, gradients and names of a transformer-shaped synthetic model.
+struct SyntheticModel {
+  std::vector<std::string> names;
+  std::vector<TensorPtr> params;
+  std::vector<TensorPtr> grads;
+  NamedTensors named_parameters;
+  NamedTensors named_gradients;
+  int64_t numel = 0;
+
+  SyntheticModel(int32_t dim, int32_t num_layers) {
+    const std::vector<std::pair<std::string, std::vector<int32_t>>> layer = {
+        {"attention.wq", {dim, dim}},
+        {"attention.wk", {dim, dim}},
+        {"attention.wv", {dim, dim}},
+        {"attention.wo", {dim, dim}},
+        {"feed_forward.w1", {4 * dim, dim}},
+        {"feed_forward.w2", {dim, 4 * dim}},
+        {"feed_forward.w3", {4 * dim, dim}},
+        {"attention_norm.weight", {dim}},
+        {"ffn_norm.weight", {dim}},
+    };
+    // The maps refer to the names, so they must not move.
+    names.reserve(num_layers * layer.size());
+    for (int32_t i = 0; i < num_layers; ++i) {
+      for (const auto& [name, sizes] : layer) {
+        names.push_back("layers." + std::to_string(i) + "." + name);
+        params.push_back(executorch::extension::rand(sizes));
+        grads.push_back(executorch::extension::rand(sizes));
+        named_parameters.insert({names.back(), *params.back()});
+        named_gradients.insert({names.back(), *grads.back()});
+        numel += params.back()->numel();
+      }
+    }
+  }
+};
+
+int run_synthetic() {
+  SyntheticModel model(FLAGS_dim, FLAGS_num_layers);
+  printf(
+      "%d layers of dim %d: %zu parameters, %.2f M elements\n",
+      FLAGS_num_layers,
+      FLAGS_dim,
+      model.names.size(),
+      model.numel / 1e6);
+  printf(
+      "%-14s %12s %12s %12s\n", "optimizer", "mean ms", "min ms", "GB/s");
+
+  for (const auto& optimizer_case : selected_optimizers()) {
+    auto step = optimizer_case.make(model.named_parameters);
+    std::vector<double> times_ms;
+    for (int i = 0; i < FLAGS_warmup + FLAGS_iterations; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      if (step(model.named_gradients) != Error::Ok) {
+        ET_LOG(Error, "%s step failed", optimizer_case.name.c_str());
+        return 1;
+      }
+      if (i >= FLAGS_warmup) {
+        times_ms.push_back(elapsed_ms(start));
+      }
+    }
+    const Timing timing = summarize(times_ms);
+    const double bytes = static_cast<double>(model.numel) *
+        optimizer_case.floats_per_element * sizeof(float);
+    printf(
+        "%-14s %12.3f %12.3f %12.2f\n",
+        optimizer_case.name.c_str(),
+        timing.mean_ms,
+        timing.min_ms,
+        bytes / (timing.min_ms * 1e6));
+  }
+  return 0;
+}
+
+int run_model() {
+  auto loader_res =
+      executorch::extension::FileDataLoader::from(FLAGS_model_path.c_str());
+  if (loader_res.error() != Error::Ok) {
+    ET_LOG(Error, "Failed to open model file: %s", FLAGS_model_path.c_str());
+    return 1;
+  }
+  std::unique_ptr<executorch::extension::FileDataLoader> ptd_loader = nullptr;
+  if (!FLAGS_ptd_path.empty()) {
+    auto ptd_loader_res =
+        executorch::extension::FileDataLoader::from(FLAGS_ptd_path.c_str());
+    if (ptd_loader_res.error() != Error::Ok) {
+      ET_LOG(Error, "Failed to open ptd file: %s", FLAGS_ptd_path.c_str());
+      return 1;
+    }
+    ptd_loader = std::make_unique<executorch::extension::FileDataLoader>(
+        std::move(ptd_loader_res.get()));
+  }
+  executorch::extension::training::TrainingModule mod(
+      std::make_unique<executorch::extension::FileDataLoader>(
+          std::move(loader_res.get())),
+      nullptr,
+      nullptr,
+      nullptr,
+      std::move(ptd_loader));
+
+  // Random floats and zero integers (valid labels) for every tensor input.
+  auto method_meta = mod.method_meta(FLAGS_method);
+  if (!method_meta.ok()) {
+    ET_LOG(Error, "Failed to get method meta for %s", FLAGS_method.c_str());
+    return 1;
+  }
+  std::vector<TensorPtr> input_tensors;
+  std::vector<executorch::runtime::EValue> inputs;
+  for (size_t i = 0; i < method_meta->num_inputs(); ++i) {
+    auto tensor_meta = method_meta->input_tensor_meta(i);
+    if (!tensor_meta.ok()) {
+      ET_LOG(Error, "Input %zu is not a tensor", i);
+      return 1;
+    }
+    std::vector<executorch::aten::SizesType> sizes(
+        tensor_meta->sizes().begin(), tensor_meta->sizes().end());
+    const auto type = tensor_meta->scalar_type();
+    input_tensors.push_back(
+        type == ScalarType::Float ? executorch::extension::rand(sizes, type)
+                                  : executorch::extension::zeros(sizes, type));
+    inputs.emplace_back(*input_tensors.back());
+  }
+
+  if (!mod.execute_forward_backward(FLAGS_method, inputs).ok()) {
+    ET_LOG(Error, "Failed to execute forward_backward");
+    return 1;
+  }
+  auto param_res = mod.named_parameters(FLAGS_method);
+  if (param_res.error() != Error::Ok) {
+    ET_LOG(Error, "Failed to get named parameters");
+    return 1;
+  }
+  int64_t numel = 0;
+  for (const auto& [name, param] : param_res.get()) {
+    numel += param.numel();
+  }
+  printf(
+      "%s: %zu parameters, %.2f M elements\n",
+      FLAGS_model_path.c_str(),
+      param_res.get().size(),
+      numel / 1e6);
+  printf(
+      "%-14s %18s %12s %12s\n",
+      "optimizer",
+      "fwd+bwd mean ms",
+      "step mean ms",
+      "step share");
+
+  for (const auto& optimizer_case : selected_optimizers()) {
+    auto step = optimizer_case.make(param_res.get());
+    std::vector<double> forward_backward_ms;
+    std::vector<double> step_ms;
+    for (int i = 0; i < FLAGS_warmup + FLAGS_iterations; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      if (!mod.execute_forward_backward(FLAGS_method, inputs).ok()) {
+        ET_LOG(Error, "Failed to execute forward_backward");
+        return 1;
+      }
+      const double forward_backward = elapsed_ms(start);
+      start = std::chrono::steady_clock::now();
+      if (step(mod.named_gradients(FLAGS_method).get()) != Error::Ok) {
+        ET_LOG(Error, "%s step failed", optimizer_case.name.c_str());
+        return 1;
+      }
+      if (i >= FLAGS_warmup) {
+        forward_backward_ms.push_back(forward_backward);
+        step_ms.push_back(elapsed_ms(start));
+      }
+    }
+    const Timing forward_backward = summarize(forward_backward_ms);
+    const Timing step_timing = summarize(step_ms);
+    printf(
+        "%-14s %18.3f %12.3f %11.1f%%\n",
+        optimizer_case.name.c_str(),
+        forward_backward.mean_ms,
+        step_timing.mean_ms,
+        100 * step_timing.mean_ms /
+            (forward_backward.mean_ms + step_timing.mean_ms));
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  executorch::runtime::runtime_init();
+
+#if defined(ET_USE_THREADPOOL)
+  const uint32_t num_threads = FLAGS_cpu_threads == -1
+      ? ::executorch::extension::cpuinfo::get_num_performant_cores()
+      : static_cast<uint32_t>(FLAGS_cpu_threads);
+  if (num_threads > 0) {
+    ::executorch::extension::threadpool::get_threadpool()
+        ->_unsafe_reset_threadpool(num_threads);
+  }
+  printf(
+      "threads: %zu\n",
+      ::executorch::extension::threadpool::get_threadpool()
+          ->get_thread_count());
+#endif
+
+  if (selected_optimizers().empty()) {
+    ET_LOG(Error, "Unknown optimizer: %s", FLAGS_optimizer.c_str());
+    return 1;
+  }
+  return FLAGS_model_path.empty() ? run_synthetic() : run_model();
+}
@@ -0,0 +1,641 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * @file
+ *
+ * Micro-benchmarks the kernels registered by the kernel library that this
+ * binary is linked with, over a grid of shapes, dtypes and thread counts.
+ * Kernels are looked up in the operator registry by name and tensor meta and
+ * called with boxed arguments and a KernelRuntimeContext, the way Method calls
+ * them, so the numbers include the unboxing done by the generated
+ * registration code.
+ *
+ * The same source is linked with the portable, optimized and quantized
+ * kernels, and every benchmark is named after its operator, dtype, shape and
+ * thread count, e.g. "aten::add.out/Float/256x1024/threads:1". The results of
+ * two libraries can then be compared with Google Benchmark's compare.py:
+ *
+ *   kernel_benchmark_portable --benchmark_out=portable.json
+ *   kernel_benchmark_optimized --benchmark_out=optimized.json
+ *   compare.py benchmarks portable.json optimized.json
+ *
+ * With CMake, -DEXECUTORCH_BUILD_KERNEL_BENCHMARKS=ON builds a binary for every
+ * enabled kernel library. It needs Google Benchmark to be installed.
+ *
+ * Flags, in addition to the Google Benchmark ones:
+ *   --kernel_threads=1,2,4    Thread counts to run every benchmark with.
+ *                             Ignored without threadpool support.
+ *   --list_uncovered_kernels  Print the registered operators that have no
+ *                             benchmark case, and exit.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <executorch/extension/memory_allocator/malloc_memory_allocator.h>
+#include <executorch/extension/tensor/tensor.h>
+#include <executorch/runtime/core/evalue.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/kernel/operator_registry.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#if defined(ET_USE_THREADPOOL)
+#include <executorch/extension/threadpool/threadpool.h>
+#endif
+
+using executorch::aten::DimOrderType;
+using executorch::aten::Scalar;
+using executorch::aten::ScalarType;
+using executorch::aten::SizesType;
+using executorch::extension::MallocMemoryAllocator;
+using executorch::extension::TensorPtr;
+using executorch::runtime::BoxedEvalueList;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::get_op_function_from_registry;
+using executorch::runtime::get_registered_kernels;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::OpFunction;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+using executorch::runtime::TensorMeta;
+
+namespace {
+
+/**
+ * The arguments of one kernel call, boxed in EValues the way the executor
+ * passes them: every argument of the schema in order, followed by the values
+ * returned, which alias the out arguments.
+ */
+class KernelArgs final {
+ public:
+  KernelArgs& input(TensorPtr tensor) {
+    values_.emplace_back(*tensor);
+    tensors_.push_back(std::move(tensor));
+    return *this;
+  }
+
+  KernelArgs& out(TensorPtr tensor) {
+    outs_.push_back(values_.size());
+    return input(std::move(tensor));
+  }
+
+  KernelArgs& value(EValue value) {
+    values_.push_back(std::move(value));
+    return *this;
+  }
+
+  KernelArgs& none() {
+    return value(EValue());
+  }
+
+  KernelArgs& int_list(std::vector<int64_t> list) {
+    std::vector<EValue>& items = list_items_.emplace_back();
+    std::vector<EValue*>& pointers = list_pointers_.emplace_back();
+    for (int64_t item : list) {
+      items.emplace_back(item);
+    }
+    for (EValue& item : items) {
+      pointers.push_back(&item);
+    }
+    list_storage_.push_back(std::move(list));
+    return value(BoxedEvalueList<int64_t>(
+        pointers.data(),
+        list_storage_.back().data(),
+        static_cast<int>(pointers.size())));
+  }
+
+  /// The argument stack to call the kernel with.
+  EValue** stack() {
+    stack_.clear();
+    for (EValue& value : values_) {
+      stack_.push_back(&value);
+    }
+    for (size_t index : outs_) {
+      stack_.push_back(&values_[index]);
+    }
+    return stack_.data();
+  }
+
+  /// The meta of every tensor in the stack, used to select the kernel.
+  Result<std::vector<TensorMeta>> tensor_meta() {
+    std::vector<TensorMeta> meta;
+    EValue** args = stack();
+    dim_orders_.clear();
+    for (size_t i = 0; i < stack_.size(); ++i) {
+      if (!args[i]->isTensor()) {
+        continue;
+      }
+      const executorch::aten::Tensor& tensor = args[i]->toTensor();
+      std::vector<DimOrderType>& dim_order =
+          dim_orders_.emplace_back(tensor.dim());
+      Error err = executorch::runtime::get_dim_order(
+          tensor, dim_order.data(), dim_order.size());
+      if (err != Error::Ok) {
+        return err;
+      }
+      meta.emplace_back(
+          tensor.scalar_type(),
+          Span<DimOrderType>(dim_order.data(), dim_order.size()));
+    }
+    return meta;
+  }
+
+  /// The bytes read and written by the call, counting every tensor once.
+  size_t nbytes() const {
+    size_t total = 0;
+    for (const TensorPtr& tensor : tensors_) {
+      total += tensor->nbytes();
+    }
+    return total;
+  }
+
+ private:
+  std::vector<TensorPtr> tensors_;
+  // Deques, so that pointers to the elements stay valid as they grow.
+  std::deque<EValue> values_;
+  std::deque<std::vector<EValue>> list_items_;
+  std::deque<std::vector<EValue*>> list_pointers_;
+  std::deque<std::vector<int64_t>> list_storage_;
+  std::deque<std::vector<DimOrderType>> dim_orders_;
+  std::vector<size_t> outs_;
+  std::vector<EValue*> stack_;
+};
+
+using Shape = std::vector<SizesType>;
+
+/**
+ * Benchmarks one operator. `make_args` builds the arguments for one shape of
+ * `shapes` and one dtype of `dtypes`.
+ */
+struct BenchmarkCase {
+  const char* op;
+  std::vector<ScalarType> dtypes;
+  std::vector<Shape> shapes;
+  std::function<KernelArgs(const Shape&, ScalarType)> make_args;
+};
+
+const std::vector<ScalarType> kFloatTypes = {
+    ScalarType::Float,
+    ScalarType::Half,
+    ScalarType::BFloat16};
+
+// Elementwise shapes, from a vector to an activation of an LLM.
+const std::vector<Shape> kElementwiseShapes = {
+    {4096},
+    {256, 1024},
+    {16, 512, 512}};
+
+// {rows, cols}, reduced or normalized over cols.
+const std::vector<Shape> kRowShapes = {{128, 1024}, {1024, 4096}};
+
+// {M, K, N}, from a matrix-vector product to a prefill-sized GEMM.
+const std::vector<Shape> kMatmulShapes = {
+    {1, 1024, 1024},
+    {64, 512, 512},
+    {256, 1024, 1024}};
+
+// {B, M, K, N}
+const std::vector<Shape> kBatchedMatmulShapes = {
+    {8, 64, 64, 64},
+    {16, 128, 64, 128}};
+
+// {num_embeddings, embedding_dim, num_indices}
+const std::vector<Shape> kEmbeddingShapes = {
+    {32000, 1024, 1},
+    {32000, 1024, 128}};
+
+TensorPtr rand(const Shape& shape, ScalarType dtype) {
+  return executorch::extension::rand(shape, dtype);
+}
+
+TensorPtr empty(const Shape& shape, ScalarType dtype) {
+  return executorch::extension::empty(shape, dtype);
+}
+
+KernelArgs binary_args(const Shape& shape, ScalarType dtype, bool alpha) {
+  KernelArgs args;
+  args.input(rand(shape, dtype))
+      .input(executorch::extension::full(shape, 3, dtype));
+  if (alpha) {
+    args.value(Scalar(int64_t(1)));
+  }
+  args.out(empty(shape, dtype));
+  return args;
+}
+
+KernelArgs unary_args(const Shape& shape, ScalarType dtype) {
+  KernelArgs args;
+  args.input(rand(shape, dtype)).out(empty(shape, dtype));
+  return args;
+}
+
+BenchmarkCase binary_case(const char* op, bool alpha) {
+  return {
+      op,
+      kFloatTypes,
+      kElementwiseShapes,
+      [alpha](const Shape& shape, ScalarType dtype) {
+        return binary_args(shape, dtype, alpha);
+      }};
+}
+
+BenchmarkCase unary_case(const char* op) {
+  return {op, kFloatTypes, kElementwiseShapes, unary_args};
+}
+
+// Over the last dimension.
+KernelArgs softmax_args(const Shape& shape, ScalarType dtype) {
+  KernelArgs args;
+  args.input(rand(shape, dtype))
+      .value(int64_t(1))
+      .value(false)
+      .out(empty(shape, dtype));
+  return args;
+}
+
+// Over the last dimension.
+KernelArgs reduction_args(const Shape& shape, ScalarType dtype) {
+  KernelArgs args;
+  args.input(rand(shape, dtype))
+      .int_list({1})
+      .value(false)
+      .none()
+      .out(empty({shape[0]}, dtype));
+  return args;
+}
+
+BenchmarkCase softmax_case(const char* op) {
+  return {op, kFloatTypes, kRowShapes, softmax_args};
+}
+
+BenchmarkCase reduction_case(const char* op) {
+  return {op, kFloatTypes, kRowShapes, reduction_args};
+}
+
+std::vector<BenchmarkCase> make_cases() {
+  std::vector<BenchmarkCase> cases = {
+      binary_case("aten::add.out", /*alpha=*/true),
+      binary_case("aten::sub.out", /*alpha=*/true),
+      binary_case("aten::mul.out", /*alpha=*/false),
+      binary_case("aten::div.out", /*alpha=*/false),
+      unary_case("aten::exp.out"),
+      unary_case("aten::relu.out"),
+      unary_case("aten::sigmoid.out"),
+      unary_case("aten::tanh.out"),
+      softmax_case("aten::_softmax.out"),
+      softmax_case("aten::_log_softmax.out"),
+      reduction_case("aten::sum.IntList_out"),
+      reduction_case("aten::mean.out"),
+  };
+
+  cases.push_back(
+      {"aten::gelu.out",
+       kFloatTypes,
+       kElementwiseShapes,
+       [](const Shape& shape, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand(shape, dtype))
+             .value(EValue("none", 4))
+             .out(empty(shape, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::le.Tensor_out",
+       kFloatTypes,
+       kElementwiseShapes,
+       [](const Shape& shape, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand(shape, dtype))
+             .input(rand(shape, dtype))
+             .out(empty(shape, ScalarType::Bool));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::where.self_out",
+       kFloatTypes,
+       kElementwiseShapes,
+       [](const Shape& shape, ScalarType dtype) {
+         KernelArgs args;
+         args
+             .input(executorch::extension::randint(
+                 0, 2, shape, ScalarType::Bool))
+             .input(rand(shape, dtype))
+             .input(rand(shape, dtype))
+             .out(empty(shape, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::native_layer_norm.out",
+       kFloatTypes,
+       kRowShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand(s, dtype))
+             .int_list({s[1]})
+             .input(rand({s[1]}, dtype))
+             .input(rand({s[1]}, dtype))
+             .value(1e-5)
+             .out(empty(s, dtype))
+             .out(empty({s[0], 1}, dtype))
+             .out(empty({s[0], 1}, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::mm.out",
+       kFloatTypes,
+       kMatmulShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand({s[0], s[1]}, dtype))
+             .input(rand({s[1], s[2]}, dtype))
+             .out(empty({s[0], s[2]}, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::addmm.out",
+       kFloatTypes,
+       kMatmulShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand({s[0], s[2]}, dtype))
+             .input(rand({s[0], s[1]}, dtype))
+             .input(rand({s[1], s[2]}, dtype))
+             .value(Scalar(int64_t(1)))
+             .value(Scalar(int64_t(1)))
+             .out(empty({s[0], s[2]}, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::linear.out",
+       kFloatTypes,
+       kMatmulShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand({s[0], s[1]}, dtype))
+             .input(rand({s[2], s[1]}, dtype))
+             .input(rand({s[2]}, dtype))
+             .out(empty({s[0], s[2]}, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"aten::bmm.out",
+       kFloatTypes,
+       kBatchedMatmulShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand({s[0], s[1], s[2]}, dtype))
+             .input(rand({s[0], s[2], s[3]}, dtype))
+             .out(empty({s[0], s[1], s[3]}, dtype));
+         return args;
+       }});
+
+  // The dtype of the quantized cases is that of the floating point tensors.
+  cases.push_back(
+      {"quantized_decomposed::quantize_per_tensor.out",
+       {ScalarType::Float},
+       kElementwiseShapes,
+       [](const Shape& shape, ScalarType dtype) {
+         KernelArgs args;
+         args.input(rand(shape, dtype))
+             .value(0.05)
+             .value(int64_t(0))
+             .value(int64_t(-128))
+             .value(int64_t(127))
+             .value(static_cast<int64_t>(ScalarType::Char))
+             .out(empty(shape, ScalarType::Char));
+         return args;
+       }});
+  cases.push_back(
+      {"quantized_decomposed::dequantize_per_tensor.out",
+       {ScalarType::Float},
+       kElementwiseShapes,
+       [](const Shape& shape, ScalarType dtype) {
+         KernelArgs args;
+         args.input(executorch::extension::randint(
+                 -128, 128, shape, ScalarType::Char))
+             .value(0.05)
+             .value(int64_t(0))
+             .value(int64_t(-128))
+             .value(int64_t(127))
+             .value(static_cast<int64_t>(ScalarType::Char))
+             .none()
+             .out(empty(shape, dtype));
+         return args;
+       }});
+  cases.push_back(
+      {"quantized_decomposed::embedding_byte.out",
+       {ScalarType::Float},
+       kEmbeddingShapes,
+       [](const Shape& s, ScalarType dtype) {
+         KernelArgs args;
+         args.input(executorch::extension::randint(
+                 -128, 128, {s[0], s[1]}, ScalarType::Char))
+             .input(rand({s[0]}, dtype))
+             .none()
+             .value(int64_t(-128))
+             .value(int64_t(127))
+             .input(executorch::extension::randint(
+                 0, s[0], {s[2]}, ScalarType::Long))
+             .out(empty({s[2], s[1]}, dtype));
+         return args;
+       }});
+  return cases;
+}
+
+std::string shape_label(const Shape& shape) {
+  std::string label;
+  for (SizesType size : shape) {
+    label += (label.empty() ? "" : "x") + std::to_string(size);
+  }
+  return label;
+}
+
+/// Parses a comma-separated list of positive integers. Returns an empty list
+/// on malformed input.
+std::vector<uint32_t> parse_list(const std::string& list) {
+  std::vector<uint32_t> values;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    char* end = nullptr;
+    const unsigned long value = strtoul(item.c_str(), &end, 10);
+    if (item.empty() || *end != '\0' || value == 0 || value > UINT32_MAX) {
+      return {};
+    }
+    values.push_back(static_cast<uint32_t>(value));
+  }
+  return values;
+}
+
+void set_num_threads(uint32_t num_threads) {
+#if defined(ET_USE_THREADPOOL)
+  static uint32_t current = 0;
+  if (num_threads != current) {
+    ::executorch::extension::threadpool::get_threadpool()
+        ->_unsafe_reset_threadpool(num_threads);
+    current = num_threads;
+  }
+#else
+  (void)num_threads;
+#endif // ET_USE_THREADPOOL
+}
+
+void run_case(
+    benchmark::State& state,
+    const BenchmarkCase& benchmark_case,
+    const Shape& shape,
+    ScalarType dtype,
+    uint32_t num_threads) {
+  set_num_threads(num_threads);
+  KernelArgs args = benchmark_case.make_args(shape, dtype);
+  Result<std::vector<TensorMeta>> meta = args.tensor_meta();
+  if (!meta.ok()) {
+    state.SkipWithError("Could not get the dim order of the arguments");
+    return;
+  }
+  Result<OpFunction> op = get_op_function_from_registry(
+      benchmark_case.op, {meta->data(), meta->size()});
+  if (!op.ok()) {
+    state.SkipWithError("No kernel for these arguments");
+    return;
+  }
+
+  // Like Method, free the temporary allocations after every call.
+  MallocMemoryAllocator temp_allocator;
+  KernelRuntimeContext context(/*event_tracer=*/nullptr, &temp_allocator);
+  EValue** stack = args.stack();
+  op.get()(context, stack);
+  temp_allocator.reset();
+  if (context.failure_state() != Error::Ok) {
+    state.SkipWithError("The kernel failed; see the log");
+    return;
+  }
+  for (auto _ : state) {
+    op.get()(context, stack);
+    temp_allocator.reset();
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations()) *
+      static_cast<int64_t>(args.nbytes()));
+}
+
+/// The names of the registered operators, with or without a fallback kernel.
+std::set<std::string> registered_ops() {
+  std::set<std::string> names;
+  for (const auto& kernel : get_registered_kernels()) {
+    names.insert(kernel.name_);
+  }
+  return names;
+}
+
+/// Registers a benchmark for every case whose operator has a kernel, and
+/// every dtype, shape and thread count.
+void register_benchmarks(
+    const std::vector<BenchmarkCase>& cases,
+    const std::vector<uint32_t>& thread_counts) {
+  const std::set<std::string> registered = registered_ops();
+  for (const BenchmarkCase& benchmark_case : cases) {
+    if (registered.count(benchmark_case.op) == 0) {
+      continue;
+    }
+    for (ScalarType dtype : benchmark_case.dtypes) {
+      for (const Shape& shape : benchmark_case.shapes) {
+        for (uint32_t num_threads : thread_counts) {
+          const std::string name = std::string(benchmark_case.op) + "/" +
+              executorch::runtime::toString(dtype) + "/" + shape_label(shape) +
+              "/threads:" + std::to_string(num_threads);
+          benchmark::RegisterBenchmark(
+              name.c_str(),
+              [&benchmark_case, shape, dtype, num_threads](
+                  benchmark::State& state) {
+                run_case(state, benchmark_case, shape, dtype, num_threads);
+              })
+              ->Unit(benchmark::kMicrosecond)
+              ->UseRealTime();
+        }
+      }
+    }
+  }
+}
+
+/// Prints the registered operators without a benchmark case.
+void list_uncovered_kernels(const std::vector<BenchmarkCase>& cases) {
+  std::set<std::string> covered;
+  for (const BenchmarkCase& benchmark_case : cases) {
+    covered.insert(benchmark_case.op);
+  }
+  for (const std::string& name : registered_ops()) {
+    if (covered.count(name) == 0) {
+      printf("%s\n", name.c_str());
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+
+  // Consume the flags of this binary before Google Benchmark parses the rest.
+  std::string threads = "1";
+  bool list_uncovered = false;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--kernel_threads=", 17) == 0) {
+      threads = argv[i] + 17;
+    } else if (strcmp(argv[i], "--list_uncovered_kernels") == 0) {
+      list_uncovered = true;
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argc = kept;
+
+  const std::vector<BenchmarkCase> cases = make_cases();
+  if (list_uncovered) {
+    list_uncovered_kernels(cases);
+    return 0;
+  }
+
+  std::vector<uint32_t> thread_counts = parse_list(threads);
+  if (thread_counts.empty()) {
+    ET_LOG(Error, "Invalid --kernel_threads '%s'", threads.c_str());
+    return 1;
+  }
+#if !defined(ET_USE_THREADPOOL)
+  if (thread_counts.size() > 1 || thread_counts[0] != 1) {
+    ET_LOG(Info, "Built without threadpool support, using one thread.");
+    thread_counts = {1};
+  }
+#endif // !ET_USE_THREADPOOL
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  register_benchmarks(cases, thread_counts);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
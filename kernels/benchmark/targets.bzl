@@ -0,0 +1,33 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
+
+def define_common_targets():
+    """Defines targets that should be shared between fbcode and xplat.
+
+    The directory containing this targets.bzl file should also contain both
+    TARGETS and BUCK files that call this function.
+    """
+
+    # One benchmark binary per kernel library, built from the same source so
+    # that their results can be compared. The quantized library only has
+    # quantized ops, so it is linked with the portable ones like in a runner.
+    for name, kernel_deps in (
+        ("portable", ["//executorch/kernels/portable:generated_lib"]),
+        ("optimized", ["//executorch/kernels/optimized:generated_lib"]),
+        ("quantized", [
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/kernels/quantized:generated_lib",
+        ]),
+    ):
+        runtime.cxx_binary(
+            name = "kernel_benchmark_" + name,
+            srcs = ["kernel_benchmark.cpp"],
+            compiler_flags = ["-Wno-global-constructors"],
+            define_static_target = False,
+            deps = [
+                "//executorch/extension/memory_allocator:malloc_memory_allocator",
+                "//executorch/extension/tensor:tensor",
+                "//executorch/extension/threadpool:threadpool",
+                "//executorch/runtime/kernel:operator_registry",
+                "//third-party/benchmark:benchmark",
+            ] + kernel_deps,
+        )
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <executorch/kernels/portable/cpu/fusible_elementwise_ops.h>
+#include <executorch/kernels/portable/cpu/math_constants.h>
+#include <executorch/kernels/portable/cpu/scalar_utils.h>
+#include <executorch/kernels/portable/cpu/util/elementwise_util.h>
+#include <executorch/kernels/portable/cpu/util/math_util.h>
+#include <executorch/runtime/kernel/elementwise_fusion.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using ::executorch::ET_RUNTIME_NAMESPACE::ElementwiseParallelForFn;
+using ::executorch::ET_RUNTIME_NAMESPACE::FusibleElementwiseOp;
+using ::executorch::ET_RUNTIME_NAMESPACE::get_registered_kernels;
+using ::executorch::ET_RUNTIME_NAMESPACE::OpFunction;
+using ::executorch::runtime::Error;
+using ::executorch::runtime::FunctionRef;
+
+namespace {
+
+// Each tile function computes the same per-element lambda as the
+// corresponding portable kernel, over one contiguous tile of floats. Argument
+// indices follow the kernel's unboxed argument stack: schema arguments in
+// order, then the returned value.
+
+template <typename Op>
+void apply_unary_tile(
+    const Op& compute_fun,
+    const float* in,
+    float* out,
+    size_t n) {
+  utils::internal::apply_elementwise_fn_to_contiguous_range<float, float>(
+      compute_fun,
+      std::array<const float*, 1>{in},
+      out,
+      0,
+      static_cast<int64_t>(n));
+}
+
+template <typename Op>
+void apply_binary_tile(
+    const Op& compute_fun,
+    const float* in,
+    const EValue* other,
+    float* out,
+    size_t begin,
+    size_t n) {
+  utils::internal::apply_elementwise_fn_to_contiguous_range<float, float>(
+      compute_fun,
+      std::array<const float*, 2>{
+          in, other->toTensor().const_data_ptr<float>() + begin},
+      out,
+      0,
+      static_cast<int64_t>(n));
+}
+
+// sigmoid.out(Tensor self, *, Tensor(a!) out)
+void sigmoid_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile(
+      [](const auto val_in) {
+        const auto one = static_cast<decltype(val_in)>(1.0);
+        return one / (one + executorch::math::exp(-val_in));
+      },
+      in,
+      out,
+      n);
+}
+
+// relu.out(Tensor self, *, Tensor(a!) out)
+void relu_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile(
+      [](const float val_in) {
+        return (std::isnan(val_in) || val_in >= 0.0f) ? val_in : 0.0f;
+      },
+      in,
+      out,
+      n);
+}
+
+// tanh.out(Tensor self, *, Tensor(a!) out)
+void tanh_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile(
+      [](const auto val_in) { return executorch::math::tanh(val_in); },
+      in,
+      out,
+      n);
+}
+
+// exp.out(Tensor self, *, Tensor(a!) out)
+void exp_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile(
+      [](const auto val_in) { return executorch::math::exp(val_in); },
+      in,
+      out,
+      n);
+}
+
+// neg.out(Tensor self, *, Tensor(a!) out)
+void neg_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile([](const auto val_in) { return -val_in; }, in, out, n);
+}
+
+// abs.out(Tensor self, *, Tensor(a!) out)
+void abs_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  apply_unary_tile(
+      [](const float val_in) { return std::fabs(val_in); }, in, out, n);
+}
+
+// gelu.out rejects any other approximation.
+bool gelu_can_fuse(EValue** args) {
+  const auto approximate = args[1]->toString();
+  return approximate == "none" || approximate == "tanh";
+}
+
+// gelu.out(Tensor self, *, str approximate='none', Tensor(a!) out)
+void gelu_tile(EValue** args, const float* in, float* out, size_t, size_t n) {
+  if (args[1]->toString() == "tanh") {
+    apply_unary_tile(
+        [](const float x) {
+          if (x == -std::numeric_limits<float>::infinity()) {
+            return 0.0f;
+          } else if (x == std::numeric_limits<float>::infinity()) {
+            return std::numeric_limits<float>::infinity();
+          }
+          const float kBeta = M_SQRT2 * M_2_SQRTPI * 0.5;
+          const float kKappa = 0.044715f;
+          const float x_cubed = x * x * x;
+          const float inner = kBeta * (x + kKappa * x_cubed);
+          return 0.5f * x * (1.0f + std::tanh(inner));
+        },
+        in,
+        out,
+        n);
+  } else {
+    apply_unary_tile(
+        [](const float x) {
+          if (x == -std::numeric_limits<float>::infinity()) {
+            return 0.0f;
+          } else if (x == std::numeric_limits<float>::infinity()) {
+            return std::numeric_limits<float>::infinity();
+          }
+          return static_cast<float>(0.5 * x * (1 + std::erf(x * M_SQRT1_2)));
+        },
+        in,
+        out,
+        n);
+  }
+}
+
+// clamp.out rejects a call without bounds, and a bound outside the range of
+// the output dtype. Fused chains only take the fused path for float outputs.
+bool clamp_can_fuse(EValue** args) {
+  for (size_t i = 1; i <= 2; ++i) {
+    if (args[i]->isDouble()) {
+      const double bound = args[i]->toDouble();
+      if (std::isfinite(bound) &&
+          (bound < std::numeric_limits<float>::lowest() ||
+           bound > std::numeric_limits<float>::max())) {
+        return false;
+      }
+    }
+  }
+  return !args[1]->isNone() || !args[2]->isNone();
+}
+
+// clamp.out(Tensor self, Scalar? min=None, Scalar? max=None, *,
+//           Tensor(a!) out)
+void clamp_tile(EValue** args, const float* in, float* out, size_t, size_t n) {
+  const auto min_opt = args[1]->toOptional<Scalar>();
+  const auto max_opt = args[2]->toOptional<Scalar>();
+  const bool has_min = min_opt.has_value();
+  const bool has_max = max_opt.has_value();
+  const float val_min = has_min ? utils::scalar_to<float>(min_opt.value()) : 0;
+  const float val_max = has_max ? utils::scalar_to<float>(max_opt.value()) : 0;
+  apply_unary_tile(
+      [has_min, val_min, has_max, val_max](const float val_in) {
+        float val_out = val_in;
+        if (has_min) {
+          val_out = utils::max_override(val_out, val_min);
+        }
+        if (has_max) {
+          val_out = utils::min_override(val_out, val_max);
+        }
+        return val_out;
+      },
+      in,
+      out,
+      n);
+}
+
+// add.out(Tensor self, Tensor other, *, Scalar alpha=1, Tensor(a!) out)
+void add_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n) {
+  const float val_alpha = utils::scalar_to<float>(args[2]->toScalar());
+  apply_binary_tile(
+      [val_alpha](const auto val_a, const auto val_b) {
+        return val_a + val_alpha * val_b;
+      },
+      in,
+      args[1],
+      out,
+      begin,
+      n);
+}
+
+// sub.out(Tensor self, Tensor other, *, Scalar alpha=1, Tensor(a!) out)
+void sub_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n) {
+  const float val_alpha = utils::scalar_to<float>(args[2]->toScalar());
+  apply_binary_tile(
+      [val_alpha](const auto val_a, const auto val_b) {
+        return val_a - val_alpha * val_b;
+      },
+      in,
+      args[1],
+      out,
+      begin,
+      n);
+}
+
+// mul.out(Tensor self, Tensor other, *, Tensor(a!) out)
+void mul_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n) {
+  apply_binary_tile(
+      [](const auto val_a, const auto val_b) { return val_a * val_b; },
+      in,
+      args[1],
+      out,
+      begin,
+      n);
+}
+
+// div.out(Tensor self, Tensor other, *, Tensor(a!) out)
+void div_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n) {
+  apply_binary_tile(
+      [](const auto val_a, const auto val_b) { return val_a / val_b; },
+      in,
+      args[1],
+      out,
+      begin,
+      n);
+}
+
+// add.Scalar_out(Tensor self, Scalar other, Scalar alpha=1, *,
+//                Tensor(a!) out)
+void add_scalar_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t,
+    size_t n) {
+  const float val_b = utils::scalar_to<float>(args[1]->toScalar()) *
+      utils::scalar_to<float>(args[2]->toScalar());
+  apply_unary_tile(
+      [val_b](const auto val_a) { return val_a + val_b; },
+      in,
+      out,
+      n);
+}
+
+// mul.Scalar_out(Tensor self, Scalar other, *, Tensor(a!) out)
+void mul_scalar_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t,
+    size_t n) {
+  const float val_b = utils::scalar_to<float>(args[1]->toScalar());
+  apply_unary_tile(
+      [val_b](const auto val_a) { return val_a * val_b; },
+      in,
+      out,
+      n);
+}
+
+#ifdef ET_USE_THREADPOOL
+// Splits fused chains across threads exactly when the portable kernels split
+// their own work.
+bool fused_parallel_for(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    FunctionRef<void(int64_t, int64_t)> f) {
+  return ::executorch::extension::parallel_for(begin, end, grain_size, f);
+}
+constexpr ElementwiseParallelForFn kParallelFor = fused_parallel_for;
+#else // ET_USE_THREADPOOL
+constexpr ElementwiseParallelForFn kParallelFor = nullptr;
+#endif // ET_USE_THREADPOOL
+
+// kernel_ is bound to the registered kernel by register_fusible_ops().
+// @lint-ignore CLANGTIDY facebook-hte-CArray
+const FusibleElementwiseOp fusible_ops[] = {
+    {"aten::sigmoid.out", 3, 0, 1, sigmoid_tile, nullptr, kParallelFor},
+    {"aten::relu.out", 3, 0, 1, relu_tile, nullptr, kParallelFor},
+    {"aten::tanh.out", 3, 0, 1, tanh_tile, nullptr, kParallelFor},
+    {"aten::exp.out", 3, 0, 1, exp_tile, nullptr, kParallelFor},
+    {"aten::neg.out", 3, 0, 1, neg_tile, nullptr, kParallelFor},
+    {"aten::abs.out", 3, 0, 1, abs_tile, nullptr, kParallelFor},
+    {"aten::gelu.out", 4, 0, 2, gelu_tile, gelu_can_fuse, kParallelFor},
+    {"aten::clamp.out", 5, 0, 3, clamp_tile, clamp_can_fuse, kParallelFor},
+    {"aten::add.out", 5, 0, 3, add_tile, nullptr, kParallelFor},
+    {"aten::sub.out", 5, 0, 3, sub_tile, nullptr, kParallelFor},
+    {"aten::mul.out", 4, 0, 2, mul_tile, nullptr, kParallelFor},
+    {"aten::div.out", 4, 0, 2, div_tile, nullptr, kParallelFor},
+    {"aten::add.Scalar_out", 5, 0, 3, add_scalar_tile, nullptr, kParallelFor},
+    {"aten::mul.Scalar_out", 4, 0, 2, mul_scalar_tile, nullptr, kParallelFor},
+};
+
+constexpr size_t kNumFusibleOps = sizeof(fusible_ops) / sizeof(fusible_ops[0]);
+
+// Returns the kernel registered for `name` without a kernel key, or nullptr.
+// Unlike get_op_function_from_registry, doesn't log when there is none.
+OpFunction registered_fallback_kernel(const char* name) {
+  for (const auto& kernel : get_registered_kernels()) {
+    if (kernel.kernel_key_.is_fallback() && strcmp(kernel.name_, name) == 0) {
+      return kernel.op_;
+    }
+  }
+  return nullptr;
+}
+
+Error register_fusible_ops() {
+  // @lint-ignore CLANGTIDY facebook-hte-CArray
+  FusibleElementwiseOp ops[kNumFusibleOps];
+  size_t num_ops = 0;
+  for (const auto& op : fusible_ops) {
+    const OpFunction kernel = registered_fallback_kernel(op.name_);
+    if (kernel != nullptr) {
+      ops[num_ops] = op;
+      ops[num_ops].kernel_ = kernel;
+      ++num_ops;
+    }
+  }
+  return ::executorch::ET_RUNTIME_NAMESPACE::register_fusible_elementwise_ops(
+      {ops, num_ops});
+}
+
+} // namespace
+
+Error register_portable_fusible_elementwise_ops() {
+  static const Error error = register_fusible_ops();
+  return error;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
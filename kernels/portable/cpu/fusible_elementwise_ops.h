@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+/**
+ * Lets Method::init fuse chains of the portable float elementwise kernels
+ * (sigmoid, relu, add, mul, ...) into a single tiled kernel. Methods loaded
+ * before this is called are not affected.
+ *
+ * Each operator is bound to the kernel registered for it without a kernel
+ * key, which must be the portable kernel; operators that have no such kernel
+ * are skipped, and instructions that resolve to any other kernel are never
+ * fused. Must be called after the kernels have been registered. Calling it
+ * again has no effect and returns the result of the first call.
+ */
+ET_NODISCARD ::executorch::runtime::Error
+register_portable_fusible_elementwise_ops();
+
+} // namespace native
+} // namespace executor
+} // namespace torch
@@ -7,9 +7,11 @@
  */
 
 #include <c10/util/irange.h>
-#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <tuple>
 
+#include <executorch/kernels/portable/cpu/util/topk_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
 
 namespace torch {
@@ -57,92 +59,6 @@ bool get_topk_target_size(
   return true;
 }
 
-template <typename T>
-bool float_less_than(T x, T y) {
-  if constexpr (std::is_integral_v<T>) {
-    return x < y;
-  }
-  return (!std::isnan(x) && std::isnan(y)) || x < y;
-}
-
-template <typename CTYPE, typename elem_t = std::pair<CTYPE, int64_t>>
-void perform_topk(
-    const Tensor& in,
-    int64_t k,
-    int64_t dim,
-    bool largest,
-    bool sorted,
-    Tensor& values,
-    Tensor& indices,
-    elem_t* queue) {
-  const CTYPE* const in_data = in.const_data_ptr<CTYPE>();
-  CTYPE* values_data = values.mutable_data_ptr<CTYPE>();
-  long* indices_data = indices.mutable_data_ptr<long>();
-
-  if (in.dim() == 0) {
-    values_data[0] = in_data[0];
-    indices_data[0] = 0;
-    return;
-  }
-
-  if (k == 0) {
-    return;
-  }
-
-  const size_t outer_size = getLeadingDims(in, dim);
-
-  const size_t dim_size = in.size(dim);
-  const size_t dim_stride = in.strides()[dim];
-
-  const size_t outer_stride_in = dim_size * dim_stride;
-  const size_t outer_stride_out = k * dim_stride;
-
-  bool use_partial_sort = k * 64 <= static_cast<int64_t>(dim_size);
-
-  // Loop through all outer dimensions
-  for (const auto outer_idx : c10::irange(outer_size)) {
-    size_t outer_in = outer_idx * outer_stride_in;
-    size_t outer_out = outer_idx * outer_stride_out;
-    // Loop through all inner dimensions
-    for (const auto inner_idx : c10::irange(dim_stride)) {
-      size_t base_in = outer_in + inner_idx;
-      size_t base_out = outer_out + inner_idx;
-
-      // Populate the queue with the values from the input tensor
-      for (const auto i : c10::irange(dim_size)) {
-        size_t in_ix = base_in + i * dim_stride;
-        queue[i].first = in_data[in_ix];
-        queue[i].second = i;
-      }
-
-      // Perform topk on the queue
-      const auto elem_greater = [](const elem_t& x, const elem_t& y) -> bool {
-        return float_less_than(y.first, x.first);
-      };
-      const auto elem_less = [](const elem_t& x, const elem_t& y) -> bool {
-        return float_less_than(x.first, y.first);
-      };
-      const auto cmp = largest ? elem_greater : elem_less;
-      if (use_partial_sort) {
-        std::partial_sort(queue, queue + k, queue + dim_size, cmp);
-      } else {
-        std::nth_element(queue, queue + k - 1, queue + dim_size, cmp);
-        if (sorted) {
-          std::sort(queue, queue + k - 1, cmp);
-        }
-      }
-
-      // Write the topk values and indices to the output tensors
-      for (const auto i : c10::irange(k)) {
-        size_t out_ix = base_out + i * dim_stride;
-
-        values_data[out_ix] = queue[i].first;
-        indices_data[out_ix] = queue[i].second;
-      }
-    }
-  }
-}
-
 void* allocate_temp_memory(KernelRuntimeContext& ctx, size_t size) {
   Result<void*> temp_mem_res = ctx.allocate_temp(size);
   return temp_mem_res.ok() ? temp_mem_res.get() : nullptr;
@@ -191,22 +107,50 @@ std::tuple<Tensor&, Tensor&> topk_values(
     return out;
   }
 
+  if (in.dim() == 0) {
+    // A single element; k must be 1.
+    ET_SWITCH_REALHBF16_TYPES(in.scalar_type(), ctx, name, CTYPE, [&]() {
+      values.mutable_data_ptr<CTYPE>()[0] = in.const_data_ptr<CTYPE>()[0];
+    });
+    indices.mutable_data_ptr<int64_t>()[0] = 0;
+    return out;
+  }
+
+  const size_t dim_size = in.size(dim);
+  ET_KERNEL_CHECK_MSG(
+      ctx,
+      dim_size <= std::numeric_limits<uint32_t>::max(),
+      InvalidArgument,
+      out,
+      "topk dim size %zu is too large",
+      dim_size);
+  const size_t inner_size = getTrailingDims(in, dim);
+  const size_t num_rows = getLeadingDims(in, dim) * inner_size;
+
   bool temp_mem_allocated = false;
+  bool success = true;
 
   ET_SWITCH_REALHBF16_TYPES(in.scalar_type(), ctx, name, CTYPE, [&]() {
-    using elem_t = std::pair<CTYPE, int64_t>;
-    size_t temp_mem_size = nonempty_size(in, dim) * sizeof(elem_t);
-
-    elem_t* queue = (elem_t*)allocate_temp_memory(ctx, temp_mem_size);
-    if (queue == nullptr) {
+    const TopkPlan plan = make_topk_plan<CTYPE>(num_rows, dim_size, k);
+    void* scratch = allocate_temp_memory(ctx, topk_scratch_bytes<CTYPE>(plan));
+    if (scratch == nullptr) {
       return;
     }
     temp_mem_allocated = true;
 
-    perform_topk<CTYPE>(in, k, dim, largest, sorted, values, indices, queue);
+    success = topk_rows<CTYPE>(
+        plan,
+        in.const_data_ptr<CTYPE>(),
+        inner_size,
+        largest,
+        sorted,
+        values.mutable_data_ptr<CTYPE>(),
+        indices.mutable_data_ptr<int64_t>(),
+        scratch);
   });
 
   ET_KERNEL_CHECK(ctx, temp_mem_allocated, MemoryAllocationFailed, out);
+  ET_KERNEL_CHECK_MSG(ctx, success, Internal, out, "parallel_for failed");
 
   return out;
 }
@@ -86,6 +86,29 @@ def define_common_targets():
         ],
     )
 
+    # Opt-in fusion of the float elementwise ops in Method::init. See
+    # runtime/kernel/elementwise_fusion.h.
+    runtime.cxx_library(
+        name = "fusible_elementwise_ops",
+        srcs = ["fusible_elementwise_ops.cpp"],
+        exported_headers = ["fusible_elementwise_ops.h"],
+        visibility = [
+            "//executorch/...",
+            "@EXECUTORCH_CLIENTS",
+        ],
+        deps = [
+            ":math_constants",
+            ":scalar_utils",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/kernels/portable/cpu/util:elementwise_util",
+            "//executorch/kernels/portable/cpu/util:math_util",
+            "//executorch/runtime/kernel:elementwise_fusion",
+        ],
+        exported_deps = [
+            "//executorch/runtime/core:core",
+        ],
+    )
+
     # Used for dtype selective build. Collect source and header files.
     runtime.filegroup(
         name = "portable_source_files",
@@ -23,6 +23,7 @@
 #endif // ET_USE_PYTORCH_HEADERS
 
 #include <array>
+#include <cstddef>
 #include <utility>
 
 namespace torch {
@@ -71,6 +72,104 @@ constexpr bool can_use_vectorized() {
 }
 #endif // ET_USE_PYTORCH_HEADERS
 
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+template <typename CTYPE_COMPUTE, typename Op, std::size_t... Is>
+constexpr bool can_use_vectorized_n(std::index_sequence<Is...>) {
+  return can_use_vectorized<
+      CTYPE_COMPUTE,
+      Op,
+      std::integral_constant<std::size_t, Is>...>();
+}
+#endif // ET_USE_PYTORCH_HEADERS
+
+/**
+ * Applies compute_fun to elements [begin, end) of contiguous,
+ * non-broadcasted inputs and writes each result to the same element of
+ * data_out. Uses at::vec::Vectorized if it is available and compute_fun
+ * accepts it (see [NOTE: Generic lambdas]).
+ *
+ * Elementwise kernels call this on each parallel_for chunk; fused elementwise
+ * chains call it on each tile, where data_out may alias an input.
+ */
+template <
+    typename CTYPE_COMPUTE,
+    typename CTYPE_OUT,
+    typename Op,
+    std::size_t kNumInputs>
+inline void apply_elementwise_fn_to_contiguous_range(
+    const Op& compute_fun,
+    const std::array<const CTYPE_COMPUTE*, kNumInputs>& inputs_data_ptrs,
+    CTYPE_OUT* const data_out,
+    const int64_t begin,
+    const int64_t end) {
+#if defined(ET_USE_PYTORCH_HEADERS) && ET_USE_PYTORCH_HEADERS
+  if constexpr (can_use_vectorized_n<CTYPE_COMPUTE, Op>(
+                    std::make_index_sequence<kNumInputs>())) {
+    using Vec = at::vec::Vectorized<CTYPE_COMPUTE>;
+    const auto vectorized_begin =
+        begin + (Vec::size() - begin % Vec::size()) % Vec::size();
+    const auto vectorized_end = end - (end % Vec::size());
+    // Scalar prologue.
+    for (const auto idx : c10::irange(begin, vectorized_begin)) {
+      // In debug mode, always use Vectorized so that even
+      // small-sized tests will test whether using Vectorized broke our
+      // lambda.
+#ifndef NDEBUG
+      std::array<Vec, kNumInputs> loaded_inputs;
+#else // NDEBUG
+      std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs;
+#endif // NDEBUG
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        loaded_inputs[input_idx] = inputs_data_ptrs[input_idx][idx];
+      }
+#ifndef NDEBUG
+      std::apply(compute_fun, loaded_inputs).store(&data_out[idx], 1);
+#else // NDEBUG
+      data_out[idx] = std::apply(compute_fun, loaded_inputs);
+#endif // NDEBUG
+    }
+
+    // Main vectorized loop.
+    for (auto idx = vectorized_begin; idx < vectorized_end;
+         idx += Vec::size()) {
+      std::array<Vec, kNumInputs> loaded_vec_inputs;
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        loaded_vec_inputs[input_idx] =
+            Vec::loadu(&inputs_data_ptrs[input_idx][idx]);
+      }
+      auto result_vec = std::apply(compute_fun, loaded_vec_inputs);
+      result_vec.store(&data_out[idx]);
+    }
+
+    // Scalar epilogue.
+    for (const auto idx : c10::irange(vectorized_end, end)) {
+#ifndef NDEBUG
+      std::array<Vec, kNumInputs> loaded_inputs;
+#else // NDEBUG
+      std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs;
+#endif // NDEBUG
+      for (const auto input_idx : c10::irange(kNumInputs)) {
+        loaded_inputs[input_idx] = inputs_data_ptrs[input_idx][idx];
+      }
+#ifndef NDEBUG
+      std::apply(compute_fun, loaded_inputs).store(&data_out[idx], 1);
+#else // NDEBUG
+      data_out[idx] = std::apply(compute_fun, loaded_inputs);
+#endif // NDEBUG
+    }
+    return;
+  }
+#endif // ET_USE_PYTORCH_HEADERS
+
+  for (const auto idx : c10::irange(begin, end)) {
+    std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs;
+    for (const auto input_idx : c10::irange(kNumInputs)) {
+      loaded_inputs[input_idx] = inputs_data_ptrs[input_idx][idx];
+    }
+    data_out[idx] = std::apply(compute_fun, loaded_inputs);
+  }
+}
+
 template <
     typename CTYPE_COMPUTE,
     typename CTYPE_OUT,
@@ -99,7 +198,6 @@ inline void dtype_specialized_elementwise_fn_impl(
               inputs.first->sizes(), out.sizes()) &&
           ...);
     if (!any_is_broadcasted) {
-      using Vec = at::vec::Vectorized<CTYPE_COMPUTE>;
       ::executorch::extension::parallel_for(
           0,
           out.numel(),
@@ -110,57 +208,8 @@ inline void dtype_specialized_elementwise_fn_impl(
 
             CTYPE_OUT* const data_out = out.mutable_data_ptr<CTYPE_OUT>();
 
-            const auto vectorized_begin =
-                begin + (Vec::size() - begin % Vec::size()) % Vec::size();
-            const auto vectorized_end = end - (end % Vec::size());
-            // Scalar prologue.
-            for (const auto idx : c10::irange(begin, vectorized_begin)) {
-          // In debug mode, always use Vectorized so that even
-          // small-sized tests will test whether using Vectorized broke our
-          // lambda.
-#ifndef NDEBUG
-              std::array<Vec, kNumInputs> loaded_inputs;
-#else // NDEBUG
-              std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs;
-#endif // NDEBUG
-              for (const auto input_idx : c10::irange(kNumInputs)) {
-                loaded_inputs[input_idx] = inputs_data_ptrs[input_idx][idx];
-              }
-#ifndef NDEBUG
-              std::apply(compute_fun, loaded_inputs).store(&data_out[idx], 1);
-#else // NDEBUG
-              data_out[idx] = std::apply(compute_fun, loaded_inputs);
-#endif // NDEBUG
-            }
-
-            // Main vectorized loop.
-            for (auto idx = vectorized_begin; idx < vectorized_end;
-                 idx += Vec::size()) {
-              std::array<Vec, kNumInputs> loaded_vec_inputs;
-              for (const auto input_idx : c10::irange(kNumInputs)) {
-                loaded_vec_inputs[input_idx] =
-                    Vec::loadu(&inputs_data_ptrs[input_idx][idx]);
-              }
-              auto result_vec = std::apply(compute_fun, loaded_vec_inputs);
-              result_vec.store(&data_out[idx]);
-            }
-
-            // Scalar epilogue.
-            for (const auto idx : c10::irange(vectorized_end, end)) {
-#ifndef NDEBUG
-              std::array<Vec, kNumInputs> loaded_inputs;
-#else // NDEBUG
-              std::array<CTYPE_COMPUTE, kNumInputs> loaded_inputs;
-#endif // NDEBUG
-              for (const auto input_idx : c10::irange(kNumInputs)) {
-                loaded_inputs[input_idx] = inputs_data_ptrs[input_idx][idx];
-              }
-#ifndef NDEBUG
-              std::apply(compute_fun, loaded_inputs).store(&data_out[idx], 1);
-#else // NDEBUG
-              data_out[idx] = std::apply(compute_fun, loaded_inputs);
-#endif // NDEBUG
-            }
+            apply_elementwise_fn_to_contiguous_range(
+                compute_fun, inputs_data_ptrs, data_out, begin, end);
           });
       return;
     }
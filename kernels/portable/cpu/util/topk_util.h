@@ -0,0 +1,571 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <c10/util/irange.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Top-k selection over the rows of a strided tensor.
+ *
+ * Every element is mapped to an unsigned integer key whose unsigned order is
+ * the order topk ranks elements in: NaN above everything for largest=true,
+ * below everything for largest=false. Keys have the width of the element
+ * type, so Half and BFloat16 rows are selected on 16-bit keys without being
+ * widened to float. Equal keys are ranked by index, so results don't depend
+ * on how the work is split.
+ *
+ * Each row is handled by one of three strategies:
+ *  - k much smaller than the row: a single streaming pass that keeps the
+ *    best k seen so far and skips whole blocks of keys that can't beat the
+ *    current k-th best;
+ *  - short rows, or k close to the row size: sort (key, index) pairs;
+ *  - otherwise: a radix select on the key bytes, which finds a threshold
+ *    that only a little more than k keys reach, followed by a pass that
+ *    copies just those candidates out and sorts them.
+ *
+ * Rows are split across the threadpool. When there are fewer rows than
+ * threads could use, long rows are also split into chunks whose local top-k
+ * are merged at the end. With k equal to the
+ * row size this is a full sort/argsort of each row.
+ */
+
+namespace torch {
+namespace executor {
+
+template <typename KEY>
+struct TopkCandidate {
+  KEY key;
+  uint32_t index;
+};
+
+enum class TopkStrategy : uint8_t { Full, Streaming, Radix };
+
+// Rows no longer than this are sorted outright unless k is small.
+constexpr size_t kTopkSmallRow = 256;
+// Largest k the streaming strategy keeps in a sorted array rather than a
+// heap. Any k this small is streamed.
+constexpr size_t kTopkStreamingMaxK = 16;
+// Larger k are streamed when the row is at least this many times longer;
+// otherwise too many elements end up displacing a candidate.
+constexpr size_t kTopkStreamingMinRatio = 16;
+// The radix select stops refining once the threshold bucket holds at most
+// this many keys.
+constexpr size_t kTopkRadixBucketCap = 1024;
+// With a threadpool, rows at least twice this long may be split into chunks
+// of about this size.
+constexpr size_t kTopkSplitChunk = 16384;
+// Number of keys loaded and tested together by the prefilters.
+constexpr size_t kTopkBlock = 64;
+// Scratch memory beyond which rows are processed by fewer parallel tasks.
+constexpr size_t kTopkMaxParallelScratchBytes = 4 * 1024 * 1024;
+
+template <typename CTYPE>
+using topk_key_t = std::conditional_t<
+    sizeof(CTYPE) == 1,
+    uint8_t,
+    std::conditional_t<
+        sizeof(CTYPE) == 2,
+        uint16_t,
+        std::conditional_t<sizeof(CTYPE) == 4, uint32_t, uint64_t>>>;
+
+/**
+ * Maps a value to a key that orders like the value does, with NaN above
+ * everything. Keys are bit patterns, so -0.0 ranks just below +0.0.
+ */
+template <typename CTYPE>
+inline topk_key_t<CTYPE> topk_key(CTYPE value) {
+  using KEY = topk_key_t<CTYPE>;
+  constexpr int kBits = 8 * sizeof(KEY);
+  constexpr KEY kSignBit = static_cast<KEY>(KEY(1) << (kBits - 1));
+  if constexpr (std::is_integral_v<CTYPE>) {
+    if constexpr (std::is_signed_v<CTYPE>) {
+      return static_cast<KEY>(static_cast<KEY>(value) ^ kSignBit);
+    } else {
+      return static_cast<KEY>(value);
+    }
+  } else {
+    KEY bits;
+    bool is_nan;
+    if constexpr (std::is_same_v<CTYPE, executorch::aten::Half>) {
+      bits = value.x;
+      is_nan = (bits & 0x7fff) > 0x7c00;
+    } else if constexpr (std::is_same_v<CTYPE, executorch::aten::BFloat16>) {
+      bits = value.x;
+      is_nan = (bits & 0x7fff) > 0x7f80;
+    } else {
+      std::memcpy(&bits, &value, sizeof(bits));
+      is_nan = value != value;
+    }
+    // Negative values have all bits flipped so that larger magnitudes sort
+    // lower; positive values only have the sign bit set.
+    const KEY negative = static_cast<KEY>(KEY(0) - (bits >> (kBits - 1)));
+    const KEY key = static_cast<KEY>(bits ^ (negative | kSignBit));
+    return is_nan ? static_cast<KEY>(~KEY(0)) : key;
+  }
+}
+
+/**
+ * Loads the keys of n <= kTopkBlock elements spaced stride apart into a
+ * block, padding it with zero keys. flip is all ones to rank smallest first.
+ * Full contiguous blocks get a fixed trip count, which compilers vectorize
+ * more readily.
+ */
+template <typename CTYPE, typename KEY = topk_key_t<CTYPE>>
+inline void load_topk_keys(
+    const CTYPE* in,
+    size_t stride,
+    size_t n,
+    KEY flip,
+    KEY* keys) {
+  if (stride == 1 && n == kTopkBlock) {
+    for (size_t i = 0; i < kTopkBlock; ++i) {
+      keys[i] = static_cast<KEY>(topk_key(in[i]) ^ flip);
+    }
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = static_cast<KEY>(topk_key(in[i * stride]) ^ flip);
+  }
+  std::fill(keys + n, keys + kTopkBlock, KEY(0));
+}
+
+// Whether any key of a block is above threshold; a reduction the compiler
+// can vectorize, used to skip whole blocks of keys that can't make it into
+// the result.
+template <typename KEY>
+inline bool any_topk_key_above(const KEY* keys, KEY threshold) {
+  uint32_t above = 0;
+  for (size_t i = 0; i < kTopkBlock; ++i) {
+    above |= static_cast<uint32_t>(keys[i] > threshold);
+  }
+  return above != 0;
+}
+
+template <typename KEY>
+inline bool topk_better(
+    const TopkCandidate<KEY>& a,
+    const TopkCandidate<KEY>& b) {
+  return a.key > b.key || (a.key == b.key && a.index < b.index);
+}
+
+inline TopkStrategy choose_topk_strategy(size_t n, size_t k) {
+  if (k >= n) {
+    return TopkStrategy::Full;
+  }
+  if (k <= kTopkStreamingMaxK) {
+    return TopkStrategy::Streaming;
+  }
+  if (n <= kTopkSmallRow || k * 4 >= n) {
+    return TopkStrategy::Full;
+  }
+  if (k * kTopkStreamingMinRatio <= n) {
+    return TopkStrategy::Streaming;
+  }
+  return TopkStrategy::Radix;
+}
+
+// Number of candidates a strategy needs room for when selecting k out of n.
+inline size_t topk_candidates_needed(size_t n, size_t k) {
+  switch (choose_topk_strategy(n, k)) {
+    case TopkStrategy::Full:
+      return n;
+    case TopkStrategy::Streaming:
+      return k;
+    case TopkStrategy::Radix:
+      return std::min(n, k + kTopkRadixBucketCap);
+  }
+  return n;
+}
+
+/**
+ * Moves the best k of the m candidates to the front, sorted if requested.
+ */
+template <typename KEY>
+void select_topk_candidates(
+    TopkCandidate<KEY>* candidates,
+    size_t m,
+    size_t k,
+    bool sorted) {
+  const auto better = [](const TopkCandidate<KEY>& a,
+                         const TopkCandidate<KEY>& b) {
+    return topk_better(a, b);
+  };
+  if (k < m) {
+    if (k * 64 <= m) {
+      std::partial_sort(candidates, candidates + k, candidates + m, better);
+      return;
+    }
+    std::nth_element(candidates, candidates + k - 1, candidates + m, better);
+  }
+  if (sorted) {
+    std::sort(candidates, candidates + k, better);
+  }
+}
+
+template <typename CTYPE, typename KEY = topk_key_t<CTYPE>>
+size_t topk_full(
+    const CTYPE* in,
+    size_t stride,
+    size_t n,
+    size_t k,
+    KEY flip,
+    bool sorted,
+    TopkCandidate<KEY>* out) {
+  KEY keys[kTopkBlock];
+  for (size_t begin = 0; begin < n; begin += kTopkBlock) {
+    const size_t len = std::min(kTopkBlock, n - begin);
+    load_topk_keys(in + begin * stride, stride, len, flip, keys);
+    for (const auto i : c10::irange(len)) {
+      out[begin + i] = {keys[i], static_cast<uint32_t>(begin + i)};
+    }
+  }
+  select_topk_candidates(out, n, k, sorted);
+  return k;
+}
+
+template <typename CTYPE, typename KEY = topk_key_t<CTYPE>>
+size_t topk_streaming(
+    const CTYPE* in,
+    size_t stride,
+    size_t n,
+    size_t k,
+    KEY flip,
+    bool sorted,
+    TopkCandidate<KEY>* best) {
+  using Candidate = TopkCandidate<KEY>;
+  const auto better = [](const Candidate& a, const Candidate& b) {
+    return topk_better(a, b);
+  };
+  // Small k keeps best[] sorted best first. Larger k keeps it as a heap
+  // with the worst candidate on top.
+  const bool use_heap = k > kTopkStreamingMaxK;
+  size_t filled = 0;
+  KEY threshold = 0;
+  KEY keys[kTopkBlock];
+  for (size_t begin = 0; begin < n; begin += kTopkBlock) {
+    const size_t len = std::min(kTopkBlock, n - begin);
+    load_topk_keys(in + begin * stride, stride, len, flip, keys);
+    // Once k candidates are held, later elements only get in with a
+    // strictly larger key than the worst of them, since they lose ties on
+    // index.
+    if (filled == k && !any_topk_key_above(keys, threshold)) {
+      continue;
+    }
+    for (const auto i : c10::irange(len)) {
+      if (filled == k && keys[i] <= threshold) {
+        continue;
+      }
+      const Candidate candidate = {keys[i], static_cast<uint32_t>(begin + i)};
+      if (use_heap) {
+        if (filled == k) {
+          std::pop_heap(best, best + k, better);
+          --filled;
+        }
+        best[filled++] = candidate;
+        std::push_heap(best, best + filled, better);
+        threshold = best[0].key;
+        continue;
+      }
+      size_t pos = filled < k ? filled++ : k - 1;
+      while (pos > 0 && better(candidate, best[pos - 1])) {
+        best[pos] = best[pos - 1];
+        --pos;
+      }
+      best[pos] = candidate;
+      threshold = best[k - 1].key;
+    }
+  }
+  if (use_heap && sorted) {
+    std::sort_heap(best, best + k, better);
+  }
+  return k;
+}
+
+template <typename CTYPE, typename KEY = topk_key_t<CTYPE>>
+size_t topk_radix(
+    const CTYPE* in,
+    size_t stride,
+    size_t n,
+    size_t k,
+    KEY flip,
+    bool sorted,
+    TopkCandidate<KEY>* out) {
+  constexpr int kBits = 8 * sizeof(KEY);
+  KEY keys[kTopkBlock];
+
+  // Find the longest key prefix that at least k keys reach, one byte at a
+  // time, until the keys sharing that prefix are few enough to sort.
+  // Since the prefix's low bits are zero, a key reaches it exactly when
+  // key >= prefix.
+  KEY prefix = 0;
+  KEY low_mask = static_cast<KEY>(~KEY(0));
+  // Number of keys still needed from those sharing the prefix.
+  size_t remaining = k;
+  size_t bucket_count = n;
+  int shift = kBits;
+  while (shift > 0 && bucket_count > kTopkRadixBucketCap) {
+    shift -= 8;
+    // Keys outside the prefix's bucket are counted in the extra last bin.
+    // Consecutive keys are counted in separate histograms, since most keys
+    // land in a few bins and repeated increments of one counter serialize.
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    uint32_t histograms[4][257] = {};
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    uint16_t bins[kTopkBlock];
+    for (size_t begin = 0; begin < n; begin += kTopkBlock) {
+      const size_t len = std::min(kTopkBlock, n - begin);
+      load_topk_keys(in + begin * stride, stride, len, flip, keys);
+      for (size_t i = 0; i < kTopkBlock; ++i) {
+        const bool in_bucket =
+            static_cast<KEY>(keys[i] - prefix) <= static_cast<KEY>(low_mask);
+        bins[i] = in_bucket ? static_cast<uint16_t>((keys[i] >> shift) & 0xff)
+                            : uint16_t(256);
+      }
+      for (size_t i = 0; i < len; ++i) {
+        histograms[i % 4][bins[i]]++;
+      }
+    }
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    uint32_t histogram[256];
+    for (const auto b : c10::irange(256)) {
+      histogram[b] = histograms[0][b] + histograms[1][b] + histograms[2][b] +
+          histograms[3][b];
+    }
+    int digit = 255;
+    while (histogram[digit] < remaining) {
+      remaining -= histogram[digit];
+      --digit;
+    }
+    prefix = static_cast<KEY>(prefix | (static_cast<KEY>(digit) << shift));
+    low_mask = static_cast<KEY>(low_mask >> 8);
+    bucket_count = histogram[digit];
+  }
+
+  // Copy out every key above the prefix's bucket and the keys inside it.
+  // Once the prefix covers the whole key, it is the k-th best key itself,
+  // and only the first `remaining` copies of it are needed.
+  const KEY upper = static_cast<KEY>(prefix | low_mask);
+  size_t tied_budget = shift == 0 ? remaining : bucket_count;
+  size_t m = 0;
+  for (size_t begin = 0; begin < n; begin += kTopkBlock) {
+    const size_t len = std::min(kTopkBlock, n - begin);
+    load_topk_keys(in + begin * stride, stride, len, flip, keys);
+    if (prefix > 0 && !any_topk_key_above(keys, KEY(prefix - 1))) {
+      continue;
+    }
+    for (const auto i : c10::irange(len)) {
+      if (keys[i] < prefix) {
+        continue;
+      }
+      if (keys[i] <= upper) {
+        if (tied_budget == 0) {
+          continue;
+        }
+        --tied_budget;
+      }
+      out[m++] = {keys[i], static_cast<uint32_t>(begin + i)};
+    }
+  }
+  select_topk_candidates(out, m, k, sorted);
+  return k;
+}
+
+/**
+ * Writes the best min(k, n) candidates of the n elements spaced stride apart
+ * to the front of `candidates`, which must have room for
+ * topk_candidates_needed(n, k) entries. Indices are relative to `in`.
+ */
+template <typename CTYPE, typename KEY = topk_key_t<CTYPE>>
+size_t topk_row_candidates(
+    const CTYPE* in,
+    size_t stride,
+    size_t n,
+    size_t k,
+    bool largest,
+    bool sorted,
+    TopkCandidate<KEY>* candidates) {
+  const KEY flip = largest ? KEY(0) : static_cast<KEY>(~KEY(0));
+  k = std::min(k, n);
+  switch (choose_topk_strategy(n, k)) {
+    case TopkStrategy::Full:
+      return topk_full(in, stride, n, k, flip, sorted, candidates);
+    case TopkStrategy::Streaming:
+      return topk_streaming(in, stride, n, k, flip, sorted, candidates);
+    case TopkStrategy::Radix:
+      return topk_radix(in, stride, n, k, flip, sorted, candidates);
+  }
+  return 0;
+}
+
+/**
+ * How topk work over a tensor is divided up, and the scratch memory it needs.
+ */
+struct TopkPlan {
+  size_t num_rows;
+  size_t row_size;
+  size_t k;
+  // Long rows may be split into chunks, each reduced to k candidates that
+  // are merged at the end.
+  size_t chunk_size;
+  size_t chunks_per_row;
+  // Each task handles a contiguous range of chunks with its own scratch.
+  size_t num_tasks;
+  size_t task_candidates;
+  size_t merge_candidates;
+};
+
+template <typename CTYPE>
+TopkPlan make_topk_plan(size_t num_rows, size_t row_size, size_t k) {
+  TopkPlan plan{};
+  plan.num_rows = num_rows;
+  plan.row_size = row_size;
+  plan.k = k;
+  plan.chunk_size = row_size;
+  plan.chunks_per_row = 1;
+#ifdef ET_USE_THREADPOOL
+  // Splitting only pays off when there are too few rows to keep the
+  // threadpool busy; each chunk redoes the work of filling up k candidates.
+  const size_t max_chunks = row_size / kTopkSplitChunk;
+  if (max_chunks >= 2 && num_rows < max_chunks &&
+      k * 8 <= kTopkSplitChunk) {
+    // Round the chunk size up so that the last chunk isn't a short tail;
+    // every chunk then holds at least k elements.
+    plan.chunks_per_row = max_chunks;
+    plan.chunk_size = (row_size + max_chunks - 1) / max_chunks;
+    plan.merge_candidates = num_rows * max_chunks * k;
+  }
+#endif // ET_USE_THREADPOOL
+  plan.task_candidates = topk_candidates_needed(plan.chunk_size, k);
+
+  const size_t num_items = num_rows * plan.chunks_per_row;
+#ifdef ET_USE_THREADPOOL
+  const size_t task_bytes =
+      plan.task_candidates * sizeof(TopkCandidate<topk_key_t<CTYPE>>);
+  const size_t min_elements_per_task =
+      static_cast<size_t>(executorch::extension::internal::GRAIN_SIZE);
+  plan.num_tasks = std::min(
+      {num_items,
+       std::max<size_t>(1, num_rows * row_size / min_elements_per_task),
+       std::max<size_t>(1, kTopkMaxParallelScratchBytes / task_bytes)});
+#else // ET_USE_THREADPOOL
+  plan.num_tasks = std::min<size_t>(num_items, 1);
+#endif // ET_USE_THREADPOOL
+  return plan;
+}
+
+template <typename CTYPE>
+size_t topk_scratch_bytes(const TopkPlan& plan) {
+  return (plan.num_tasks * plan.task_candidates + plan.merge_candidates) *
+      sizeof(TopkCandidate<topk_key_t<CTYPE>>);
+}
+
+/**
+ * Computes topk along the middle dimension of an [outer, n, inner] tensor,
+ * where plan.num_rows == outer * inner and plan.row_size == n. `scratch`
+ * must be at least topk_scratch_bytes<CTYPE>(plan) bytes, suitably aligned
+ * for TopkCandidate. Returns false if the threadpool failed.
+ */
+template <typename CTYPE>
+[[nodiscard]] bool topk_rows(
+    const TopkPlan& plan,
+    const CTYPE* in,
+    size_t inner_size,
+    bool largest,
+    bool sorted,
+    CTYPE* values,
+    int64_t* indices,
+    void* scratch) {
+  using KEY = topk_key_t<CTYPE>;
+  using Candidate = TopkCandidate<KEY>;
+  const size_t n = plan.row_size;
+  const size_t k = plan.k;
+  const size_t chunks = plan.chunks_per_row;
+  Candidate* const task_scratch = static_cast<Candidate*>(scratch);
+  Candidate* const merge_scratch =
+      task_scratch + plan.num_tasks * plan.task_candidates;
+
+  const auto write_row = [&](size_t row, const Candidate* best) {
+    const size_t outer = row / inner_size;
+    const size_t inner = row % inner_size;
+    const CTYPE* in_row = in + outer * n * inner_size + inner;
+    const size_t out_base = outer * k * inner_size + inner;
+    for (const auto i : c10::irange(k)) {
+      values[out_base + i * inner_size] = in_row[best[i].index * inner_size];
+      indices[out_base + i * inner_size] = best[i].index;
+    }
+  };
+
+  const size_t num_items = plan.num_rows * chunks;
+  const size_t num_tasks = plan.num_tasks;
+  const bool success = executorch::extension::parallel_for(
+      0, num_tasks, 1, [&](const auto task_begin, const auto task_end) {
+        for (const auto task : c10::irange(task_begin, task_end)) {
+          Candidate* candidates = task_scratch + task * plan.task_candidates;
+          const size_t item_begin = task * num_items / num_tasks;
+          const size_t item_end = (task + 1) * num_items / num_tasks;
+          for (const auto item : c10::irange(item_begin, item_end)) {
+            const size_t row = item / chunks;
+            const size_t chunk_begin = (item % chunks) * plan.chunk_size;
+            const size_t chunk_len =
+                std::min(plan.chunk_size, n - chunk_begin);
+            const size_t outer = row / inner_size;
+            const size_t inner = row % inner_size;
+            const CTYPE* in_chunk = in + outer * n * inner_size + inner +
+                chunk_begin * inner_size;
+            if (chunks == 1) {
+              topk_row_candidates(
+                  in_chunk,
+                  inner_size,
+                  chunk_len,
+                  k,
+                  largest,
+                  sorted,
+                  candidates);
+              write_row(row, candidates);
+              continue;
+            }
+            const size_t found = topk_row_candidates(
+                in_chunk,
+                inner_size,
+                chunk_len,
+                k,
+                largest,
+                /*sorted=*/false,
+                candidates);
+            Candidate* merge = merge_scratch + item * k;
+            for (const auto i : c10::irange(found)) {
+              merge[i] = {
+                  candidates[i].key,
+                  static_cast<uint32_t>(candidates[i].index + chunk_begin)};
+            }
+          }
+        }
+      });
+  if (!success || chunks == 1) {
+    return success;
+  }
+
+  // Each chunk contributed exactly k candidates.
+  for (const auto row : c10::irange(plan.num_rows)) {
+    Candidate* merge = merge_scratch + row * chunks * k;
+    select_topk_candidates(merge, chunks * k, k, sorted);
+    write_row(row, merge);
+  }
+  return true;
+}
+
+} // namespace executor
+} // namespace torch
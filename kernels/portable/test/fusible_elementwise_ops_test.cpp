@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/portable/NativeFunctions.h> // Declares the operator
+#include <executorch/kernels/portable/cpu/fusible_elementwise_ops.h>
+#include <executorch/kernels/test/TestUtil.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/kernel/elementwise_fusion.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace ::testing;
+using executorch::aten::optional;
+using executorch::aten::Scalar;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::ET_RUNTIME_NAMESPACE::FusibleElementwiseOp;
+using executorch::ET_RUNTIME_NAMESPACE::get_fusible_elementwise_op;
+using executorch::ET_RUNTIME_NAMESPACE::get_op_function_from_registry;
+using executorch::ET_RUNTIME_NAMESPACE::KernelRuntimeContext;
+using executorch::runtime::EValue;
+using torch::executor::native::register_portable_fusible_elementwise_ops;
+using torch::executor::testing::TensorFactory;
+
+// Checks that the tile functions that the portable library registers for
+// elementwise fusion compute the same values as the portable kernels.
+
+namespace {
+
+// Number of elements passed to each tile function call. Odd, so that the
+// tiles don't line up with any vector width and the last tile is partial.
+constexpr size_t kTestTileSize = 7;
+
+// Runs the fusible op registered under `name` over `args`, its kernel's
+// argument stack, one tile at a time.
+void run_tiles(const char* name, std::vector<EValue*> args) {
+  const FusibleElementwiseOp* op = get_fusible_elementwise_op(name);
+  ASSERT_NE(op, nullptr) << name;
+  ASSERT_EQ(op->num_args_, args.size()) << name;
+  if (op->can_fuse_fn_ != nullptr) {
+    ASSERT_TRUE(op->can_fuse_fn_(args.data())) << name;
+  }
+  const Tensor& in = args[op->in_arg_]->toTensor();
+  Tensor& out = args[op->out_arg_]->toTensor();
+  const size_t numel = in.numel();
+  for (size_t begin = 0; begin < numel; begin += kTestTileSize) {
+    const size_t n = std::min(kTestTileSize, numel - begin);
+    op->tile_fn_(
+        args.data(),
+        in.const_data_ptr<float>() + begin,
+        out.mutable_data_ptr<float>() + begin,
+        begin,
+        n);
+  }
+}
+
+class FusibleElementwiseOpsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    torch::executor::runtime_init();
+    ASSERT_EQ(
+        register_portable_fusible_elementwise_ops(),
+        torch::executor::Error::Ok);
+  }
+
+  // Returns `numel` values in [-8, 8), with the special values that the
+  // kernels handle explicitly at the front.
+  std::vector<float> make_values(size_t numel, float offset = 0.0f) {
+    const float special[] = {
+        0.0f,
+        -0.0f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        NAN};
+    std::vector<float> values(numel);
+    for (size_t i = 0; i < numel; ++i) {
+      values[i] = i < 5 && offset == 0.0f
+          ? special[i]
+          : static_cast<float>((i * 37) % 128) / 8.0f - 8.0f + offset;
+    }
+    return values;
+  }
+
+  // Shapes with an odd number of elements, including one that spans several
+  // of the tiles used by execute_fused_elementwise().
+  const std::vector<std::vector<int32_t>> sizes_list_ = {{1}, {5, 7}, {1027}};
+
+  KernelRuntimeContext context_{};
+  TensorFactory<ScalarType::Float> tf_;
+};
+
+} // namespace
+
+TEST_F(FusibleElementwiseOpsTest, BoundToRegisteredKernels) {
+  for (const char* name :
+       {"aten::sigmoid.out",
+        "aten::gelu.out",
+        "aten::add.out",
+        "aten::mul.Scalar_out"}) {
+    SCOPED_TRACE(name);
+    const FusibleElementwiseOp* op = get_fusible_elementwise_op(name);
+    ASSERT_NE(op, nullptr);
+    auto kernel = get_op_function_from_registry(name);
+    ASSERT_TRUE(kernel.ok());
+    EXPECT_EQ(op->kernel_, kernel.get());
+  }
+}
+
+TEST_F(FusibleElementwiseOpsTest, UnaryOps) {
+  using UnaryKernel =
+      Tensor& (*)(KernelRuntimeContext&, const Tensor&, Tensor&);
+  const struct {
+    const char* name;
+    UnaryKernel kernel;
+  } ops[] = {
+      {"aten::sigmoid.out", torch::executor::native::sigmoid_out},
+      {"aten::relu.out", torch::executor::native::relu_out},
+      {"aten::tanh.out", torch::executor::native::tanh_out},
+      {"aten::exp.out", torch::executor::native::exp_out},
+      {"aten::neg.out", torch::executor::native::neg_out},
+      {"aten::abs.out", torch::executor::native::abs_out},
+  };
+  for (const auto& op : ops) {
+    for (const auto& sizes : sizes_list_) {
+      SCOPED_TRACE(op.name);
+      Tensor in = tf_.make(sizes, make_values(tf_.zeros(sizes).numel()));
+      Tensor expected = tf_.zeros(sizes);
+      Tensor actual = tf_.zeros(sizes);
+      op.kernel(context_, in, expected);
+      ASSERT_EQ(context_.failure_state(), torch::executor::Error::Ok);
+
+      EValue in_value(in);
+      EValue out_value(actual);
+      EValue ret_value(actual);
+      run_tiles(op.name, {&in_value, &out_value, &ret_value});
+      EXPECT_TENSOR_CLOSE(actual, expected);
+    }
+  }
+}
+
+TEST_F(FusibleElementwiseOpsTest, Gelu) {
+  for (const char* approximate : {"none", "tanh"}) {
+    for (const auto& sizes : sizes_list_) {
+      SCOPED_TRACE(approximate);
+      Tensor in = tf_.make(sizes, make_values(tf_.zeros(sizes).numel()));
+      Tensor expected = tf_.zeros(sizes);
+      Tensor actual = tf_.zeros(sizes);
+      torch::executor::native::gelu_out(context_, in, approximate, expected);
+      ASSERT_EQ(context_.failure_state(), torch::executor::Error::Ok);
+
+      EValue in_value(in);
+      EValue approximate_value(approximate, strlen(approximate));
+      EValue out_value(actual);
+      EValue ret_value(actual);
+      run_tiles(
+          "aten::gelu.out",
+          {&in_value, &approximate_value, &out_value, &ret_value});
+      EXPECT_TENSOR_CLOSE(actual, expected);
+    }
+  }
+}
+
+TEST_F(FusibleElementwiseOpsTest, GeluRejectsUnknownApproximation) {
+  const FusibleElementwiseOp* op = get_fusible_elementwise_op("aten::gelu.out");
+  ASSERT_NE(op, nullptr);
+  ASSERT_NE(op->can_fuse_fn_, nullptr);
+
+  Tensor in = tf_.zeros({3});
+  EValue in_value(in);
+  EValue approximate_value("sigmoid", strlen("sigmoid"));
+  EValue out_value(in);
+  EValue* args[] = {&in_value, &approximate_value, &out_value, &out_value};
+  EXPECT_FALSE(op->can_fuse_fn_(args));
+}
+
+TEST_F(FusibleElementwiseOpsTest, Clamp) {
+  const optional<Scalar> none;
+  const struct {
+    optional<Scalar> min;
+    optional<Scalar> max;
+  } bounds[] = {
+      {Scalar(-2.5), Scalar(3.0)},
+      {Scalar(-1), none},
+      {none, Scalar(4)},
+  };
+  for (const auto& bound : bounds) {
+    for (const auto& sizes : sizes_list_) {
+      Tensor in = tf_.make(sizes, make_values(tf_.zeros(sizes).numel()));
+      Tensor expected = tf_.zeros(sizes);
+      Tensor actual = tf_.zeros(sizes);
+      torch::executor::native::clamp_out(
+          context_, in, bound.min, bound.max, expected);
+      ASSERT_EQ(context_.failure_state(), torch::executor::Error::Ok);
+
+      EValue in_value(in);
+      EValue min_value =
+          bound.min.has_value() ? EValue(bound.min.value()) : EValue();
+      EValue max_value =
+          bound.max.has_value() ? EValue(bound.max.value()) : EValue();
+      EValue out_value(actual);
+      EValue ret_value(actual);
+      run_tiles(
+          "aten::clamp.out",
+          {&in_value, &min_value, &max_value, &out_value, &ret_value});
+      EXPECT_TENSOR_CLOSE(actual, expected);
+    }
+  }
+}
+
+TEST_F(FusibleElementwiseOpsTest, ClampRejectsArgumentsTheKernelRejects) {
+  const FusibleElementwiseOp* op =
+      get_fusible_elementwise_op("aten::clamp.out");
+  ASSERT_NE(op, nullptr);
+  ASSERT_NE(op->can_fuse_fn_, nullptr);
+
+  Tensor in = tf_.zeros({3});
+  EValue in_value(in);
+  EValue none_value;
+  EValue too_large_value(1e300);
+  EValue out_value(in);
+
+  EValue* no_bounds[] = {
+      &in_value, &none_value, &none_value, &out_value, &out_value};
+  EXPECT_FALSE(op->can_fuse_fn_(no_bounds));
+
+  EValue* out_of_range[] = {
+      &in_value, &too_large_value, &none_value, &out_value, &out_value};
+  EXPECT_FALSE(op->can_fuse_fn_(out_of_range));
+}
+
+TEST_F(FusibleElementwiseOpsTest, BinaryOps) {
+  for (const auto& sizes : sizes_list_) {
+    const size_t numel = tf_.zeros(sizes).numel();
+    Tensor a = tf_.make(sizes, make_values(numel));
+    // Shifted by a non-integer so that div never divides by zero.
+    Tensor b = tf_.make(sizes, make_values(numel, 0.25f));
+    const Scalar alpha(1.5);
+
+    Tensor expected = tf_.zeros(sizes);
+    Tensor actual = tf_.zeros(sizes);
+    EValue a_value(a);
+    EValue b_value(b);
+    EValue alpha_value(alpha);
+    EValue out_value(actual);
+    EValue ret_value(actual);
+
+    torch::executor::native::add_out(context_, a, b, alpha, expected);
+    run_tiles(
+        "aten::add.out",
+        {&a_value, &b_value, &alpha_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    torch::executor::native::sub_out(context_, a, b, alpha, expected);
+    run_tiles(
+        "aten::sub.out",
+        {&a_value, &b_value, &alpha_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    torch::executor::native::mul_out(context_, a, b, expected);
+    run_tiles("aten::mul.out", {&a_value, &b_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    torch::executor::native::div_out(context_, a, b, expected);
+    run_tiles("aten::div.out", {&a_value, &b_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    ASSERT_EQ(context_.failure_state(), torch::executor::Error::Ok);
+  }
+}
+
+TEST_F(FusibleElementwiseOpsTest, ScalarOps) {
+  for (const auto& sizes : sizes_list_) {
+    Tensor in = tf_.make(sizes, make_values(tf_.zeros(sizes).numel()));
+    const Scalar other(0.75);
+    const Scalar alpha(2);
+
+    Tensor expected = tf_.zeros(sizes);
+    Tensor actual = tf_.zeros(sizes);
+    EValue in_value(in);
+    EValue other_value(other);
+    EValue alpha_value(alpha);
+    EValue out_value(actual);
+    EValue ret_value(actual);
+
+    torch::executor::native::add_scalar_out(
+        context_, in, other, alpha, expected);
+    run_tiles(
+        "aten::add.Scalar_out",
+        {&in_value, &other_value, &alpha_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    torch::executor::native::mul_scalar_out(context_, in, other, expected);
+    run_tiles(
+        "aten::mul.Scalar_out",
+        {&in_value, &other_value, &out_value, &ret_value});
+    EXPECT_TENSOR_CLOSE(actual, expected);
+
+    ASSERT_EQ(context_.failure_state(), torch::executor::Error::Ok);
+  }
+}
@@ -44,6 +44,20 @@ def define_common_targets():
         op_test(name = "op_gelu_test")
         op_test(name = "op_mul_test")
 
+        runtime.cxx_test(
+            name = "fusible_elementwise_ops_test",
+            srcs = ["fusible_elementwise_ops_test.cpp"],
+            deps = [
+                "//executorch/kernels/portable/cpu:cpu",
+                "//executorch/kernels/portable/cpu:fusible_elementwise_ops",
+                "//executorch/kernels/portable:generated_lib",
+                "//executorch/kernels/portable:generated_lib_headers",
+                "//executorch/kernels/test:gtest_utils",
+                "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+                "//executorch/runtime/kernel:elementwise_fusion",
+            ],
+        )
+
     if is_xplat():
         et_operator_library(
             name = "add_float",
@@ -73,3 +87,14 @@ def define_common_targets():
                 "//executorch/kernels/portable/cpu:scalar_utils",
             ],
         )
+
+    runtime.cxx_binary(
+        name = "topk_benchmark",
+        srcs = ["topk_benchmark.cpp"],
+        deps = [
+            "//executorch/kernels/portable/cpu:op_topk",
+            "//executorch/kernels/portable:generated_lib_headers",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Micro-benchmark for topk.values over (rows, n, k) grids for the two
+ * workloads that use it most: MoE routing, with many short rows, and
+ * sampling over a vocabulary, with a few very long rows.
+ *
+ * Usage: topk_benchmark [iterations]
+ *
+ * Prints the median time per call and the throughput in input elements.
+ */
+
+#include <executorch/kernels/portable/NativeFunctions.h> // Declares the operator
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::MemoryAllocator;
+using torch::executor::native::topk_values;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+struct Problem {
+  const char* workload;
+  int32_t rows;
+  int32_t n;
+  int32_t k;
+};
+
+const Problem kProblems[] = {
+    // Expert routing: one row per token, one column per expert.
+    {"moe", 1, 8, 2},
+    {"moe", 32, 64, 2},
+    {"moe", 512, 64, 8},
+    {"moe", 4096, 64, 2},
+    {"moe", 4096, 256, 8},
+    // Sampling: one row per sequence, one column per vocabulary entry.
+    {"vocab", 1, 32000, 1},
+    {"vocab", 1, 32000, 40},
+    {"vocab", 1, 128256, 50},
+    {"vocab", 1, 128256, 1024},
+    {"vocab", 8, 128256, 50},
+    // Full sort of a row, as used for top-p.
+    {"sort", 1, 32000, 32000},
+};
+
+// Large enough for the scratch of every problem above.
+constexpr size_t kTempMemoryBytes = 64 * 1024 * 1024;
+
+template <typename Fn>
+double median_us(int iterations, const Fn& fn) {
+  // Warm up caches and the threadpool.
+  fn();
+  std::vector<double> times(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    times[i] = std::chrono::duration<double, std::micro>(end - start).count();
+  }
+  std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+  return times[iterations / 2];
+}
+
+template <ScalarType DTYPE>
+void bench_problem(
+    const char* dtype_name,
+    const Problem& p,
+    int iterations,
+    MemoryAllocator& allocator) {
+  TensorFactory<DTYPE> tf;
+  TensorFactory<ScalarType::Long> tfl;
+  using CTYPE = typename TensorFactory<DTYPE>::ctype;
+
+  std::vector<CTYPE> data(static_cast<size_t>(p.rows) * p.n);
+  std::mt19937 gen(0);
+  std::normal_distribution<float> dist(0.0f, 4.0f);
+  for (auto& v : data) {
+    v = static_cast<CTYPE>(dist(gen));
+  }
+  Tensor input = tf.make({p.rows, p.n}, data);
+  Tensor values = tf.zeros({p.rows, p.k});
+  Tensor indices = tfl.zeros({p.rows, p.k});
+
+  const double us = median_us(iterations, [&]() {
+    allocator.reset();
+    KernelRuntimeContext context(nullptr, &allocator);
+    topk_values(context, input, p.k, 1, true, true, values, indices);
+  });
+  printf(
+      "%-6s %-5s rows=%-5" PRId32 " n=%-7" PRId32 " k=%-6" PRId32
+      " %10.2f us %8.1f Melem/s\n",
+      p.workload,
+      dtype_name,
+      p.rows,
+      p.n,
+      p.k,
+      us,
+      static_cast<double>(data.size()) / us);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+  const int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 20;
+  std::vector<uint8_t> temp_memory(kTempMemoryBytes);
+  MemoryAllocator allocator(temp_memory.size(), temp_memory.data());
+  for (const auto& problem : kProblems) {
+    bench_problem<ScalarType::Float>("float", problem, iterations, allocator);
+    bench_problem<ScalarType::Half>("half", problem, iterations, allocator);
+  }
+  return 0;
+}
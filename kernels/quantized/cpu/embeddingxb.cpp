@@ -7,7 +7,9 @@
  */
 
 #include <executorch/kernels/quantized/cpu/embeddingxb.h>
+#include <executorch/kernels/quantized/cpu/xbit_unpack.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 #include <algorithm>
 #include <cassert>
 #include <cinttypes>
@@ -23,33 +25,8 @@ using ScalarType = executorch::aten::ScalarType;
 
 namespace {
 
-static inline int32_t
-weight_value(const unsigned char* w_data, int32_t index, int32_t weight_nbit) {
-  if (weight_nbit == 2) {
-    int32_t subbyte = index % 4;
-    index >>= 2;
-    switch (subbyte) {
-      case 0:
-        return (int32_t)(w_data[index] & 3) - 2;
-      case 1:
-        return (int32_t)((w_data[index] & 12) >> 2) - 2;
-      case 2:
-        return (int32_t)((w_data[index] & 48) >> 4) - 2;
-      case 3:
-        return (int32_t)((w_data[index] & 192) >> 6) - 2;
-    }
-  } else if (weight_nbit == 4) {
-    int32_t odd = index & 1;
-    index >>= 1;
-    if (odd) {
-      return (int32_t)(w_data[index] & 0x0F) - 8;
-    } else {
-      return (int32_t)((w_data[index] >> 4) & 0x0F) - 8;
-    }
-  }
-
-  ET_CHECK_MSG(false, "invalid weight_nbit");
-}
+// Number of weights unpacked at a time.
+constexpr int32_t kChunkSize = 256;
 
 static inline int32_t get_embedding_dim(
     int32_t packed_dim,
@@ -73,6 +50,10 @@ void check_embedding_xbit_args(
     Tensor& out,
     int weight_nbit) {
   ET_CHECK_MSG(8 % weight_nbit == 0, "nbit must divide 8");
+  ET_CHECK_MSG(
+      weight_nbit == 2 || weight_nbit == 4,
+      "weight_nbit must be 2 or 4 but got %d",
+      weight_nbit);
 
   ET_CHECK_MSG(
       weight.dim() == 2, "weight must be 2D but got() %zd dims", weight.dim());
@@ -126,9 +107,10 @@ void check_embedding_xbit_args(
         static_cast<int8_t>(weight_scales.dim()));
 
     ET_CHECK_MSG(
-        opt_weight_zero_points.value().scalar_type() == out.scalar_type(),
+        opt_weight_zero_points.value().scalar_type() ==
+            weight_scales.scalar_type(),
         "weight zero points scalar type %" PRId8
-        " does not match out.scalar_type()",
+        " does not match weight_scales.scalar_type()",
         static_cast<int8_t>(opt_weight_zero_points.value().scalar_type()));
 
     for (int32_t i = 0; i < weight_scales.dim(); ++i) {
@@ -164,7 +146,8 @@ void check_embedding_xbit_args(
 
 /**
  * Retrieves the embeddings specified by indices, dequantizes them, and stores
- * them in out. Weight will always be uint8
+ * them in out. Weight will always be uint8. Rows are unpacked and dequantized
+ * a chunk at a time, and indices are split across threads.
  */
 template <typename CTYPE_PARAMS, typename CTYPE_OUT>
 void embedding_xbit_per_channel(
@@ -191,33 +174,52 @@ void embedding_xbit_per_channel(
     zero_points = opt_weight_zero_points.value().const_data_ptr<CTYPE_PARAMS>();
   }
 
-  for (int i = 0; i < indices.numel(); i++) {
-    int64_t index = indices_ptr[i];
-    // If using groupwise embedding
-    int32_t qparams_index = index * num_groups_per_channel;
-    CTYPE_PARAMS zp = 0.0;
-    const CTYPE_PARAMS* scale_ptr = scales + qparams_index;
-    const CTYPE_PARAMS* zero_points_ptr = nullptr;
-    if (opt_weight_zero_points.has_value()) {
-      zero_points_ptr = zero_points + qparams_index;
-    }
-
-    const uint8_t* w_data =
-        weight.const_data_ptr<uint8_t>() + weight.size(1) * index;
-
-    for (int j = 0; j < embedding_dim; ++j) {
-      int32_t group_id = j / group_size;
-      const CTYPE_PARAMS scale = scale_ptr[group_id];
-      if (opt_weight_zero_points.has_value()) {
-        zp = zero_points_ptr[group_id];
-      }
-      out_data[j] = static_cast<CTYPE_OUT>(
-          (static_cast<float>(weight_value(w_data, j, weight_nbit)) -
-           static_cast<float>(zp)) *
-          static_cast<float>(scale));
-    }
-    out_data += embedding_dim;
-  }
+  const int64_t grain_size = std::max<int64_t>(
+      1,
+      ::executorch::extension::internal::GRAIN_SIZE /
+          std::max<int64_t>(1, embedding_dim));
+  const bool success = ::executorch::extension::parallel_for(
+      0, indices.numel(), grain_size, [&](int64_t begin, int64_t end) {
+        // @lint-ignore CLANGTIDY facebook-hte-CArray
+        uint8_t unpacked[kChunkSize];
+        for (int64_t i = begin; i < end; i++) {
+          int64_t index = indices_ptr[i];
+          // If using groupwise embedding
+          int64_t qparams_index = index * num_groups_per_channel;
+          const uint8_t* w_data =
+              weight.const_data_ptr<uint8_t>() + weight.size(1) * index;
+          CTYPE_OUT* out_row = out_data + i * embedding_dim;
+
+          // Unpack up to kChunkSize weights at a time, made of whole groups
+          // if groups are that small, or else of part of a single group.
+          for (int32_t j = 0; j < embedding_dim;) {
+            const int32_t chunk_end = group_size >= kChunkSize
+                ? std::min(j + kChunkSize, (j / group_size + 1) * group_size)
+                : std::min(
+                      embedding_dim,
+                      j + (kChunkSize / group_size) * group_size);
+            xbit::unpack_weights(
+                w_data, j, chunk_end - j, weight_nbit, unpacked);
+            const int32_t segment_size = std::min(group_size, chunk_end - j);
+            for (int32_t k = j; k < chunk_end; k += segment_size) {
+              const int32_t g = k / group_size;
+              const float scale = static_cast<float>(scales[qparams_index + g]);
+              const float zp = zero_points == nullptr
+                  ? 0.0f
+                  : static_cast<float>(zero_points[qparams_index + g]);
+              xbit::dequantize_weights(
+                  unpacked + (k - j),
+                  segment_size,
+                  weight_nbit,
+                  zp,
+                  scale,
+                  out_row + k);
+            }
+            j = chunk_end;
+          }
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in quantized_embedding_xbit_out");
 }
 
 void resize_out_tensor(
@@ -0,0 +1,735 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/quantized/cpu/linearxb.h>
+#include <executorch/kernels/quantized/cpu/xbit_unpack.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = executorch::aten::Tensor;
+using Scalar = executorch::aten::Scalar;
+using ScalarType = executorch::aten::ScalarType;
+
+namespace {
+
+using xbit::dequantize_weights;
+using xbit::unpack_weights;
+using xbit::values_per_byte;
+using xbit::weight_offset;
+
+// Number of input rows that are multiplied with an unpacked tile of weights
+// while they stay in L1.
+constexpr int64_t kTileM = 8;
+// Number of weight rows, i.e. output columns, unpacked together into a tile.
+constexpr int64_t kTileN = 16;
+// Number of weights of each row unpacked at a time. A tile of kTileN by
+// kTileK weights, plus the kTileM input rows it is multiplied with, stays in
+// L1.
+constexpr int64_t kTileK = 256;
+// Number of rows whose float accumulators are kept on the stack, for outputs
+// that can't accumulate in place.
+constexpr int64_t kBlockM = 64;
+
+float dot_product(const float* a, const float* b, int64_t n) {
+  int64_t i = 0;
+  float sum = 0;
+#if defined(__AVX2__)
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_add_ps(
+        acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    acc1 = _mm256_add_ps(
+        acc1,
+        _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+  }
+  acc0 = _mm256_add_ps(acc0, acc1);
+  __m128 acc = _mm_add_ps(
+      _mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+  acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+  acc = _mm_add_ss(acc, _mm_movehdup_ps(acc));
+  sum = _mm_cvtss_f32(acc);
+#endif
+  for (; i < n; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+/**
+ * Returns sum over segments s of scales[s] * sum(w[i] * a[i]) for the
+ * num_segments consecutive segments of segment_size unpacked, still offset
+ * weights w and int8 activations a.
+ */
+float dot_product_segments(
+    const uint8_t* w,
+    const int8_t* a,
+    int64_t segment_size,
+    int64_t num_segments,
+    const float* scales) {
+  int64_t s = 0;
+  float sum = 0;
+#if defined(__AVX2__)
+  if (segment_size % 32 == 0) {
+    // w < 16 and |a| <= 127, so the pairwise int16 sums of maddubs can't
+    // saturate.
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256 acc = _mm256_setzero_ps();
+    for (; s < num_segments; ++s) {
+      __m256i segment_acc = _mm256_setzero_si256();
+      for (int64_t i = s * segment_size; i < (s + 1) * segment_size; i += 32) {
+        const __m256i prod = _mm256_maddubs_epi16(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        segment_acc =
+            _mm256_add_epi32(segment_acc, _mm256_madd_epi16(prod, ones));
+      }
+      acc = _mm256_add_ps(
+          acc,
+          _mm256_mul_ps(
+              _mm256_cvtepi32_ps(segment_acc), _mm256_set1_ps(scales[s])));
+    }
+    __m128 acc128 =
+        _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    acc128 = _mm_add_ps(acc128, _mm_movehl_ps(acc128, acc128));
+    acc128 = _mm_add_ss(acc128, _mm_movehdup_ps(acc128));
+    sum = _mm_cvtss_f32(acc128);
+  }
+#endif
+  for (; s < num_segments; ++s) {
+    int32_t segment_sum = 0;
+    for (int64_t i = s * segment_size; i < (s + 1) * segment_size; ++i) {
+      segment_sum += static_cast<int32_t>(w[i]) * a[i];
+    }
+    sum += scales[s] * static_cast<float>(segment_sum);
+  }
+  return sum;
+}
+
+/**
+ * Asserts that the parameters are valid.
+ */
+void check_linear_xbit_args(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    const int64_t weight_quant_min,
+    const int64_t weight_quant_max,
+    Tensor& out,
+    int weight_nbit) {
+  ET_CHECK_MSG(
+      weight_nbit == 2 || weight_nbit == 4,
+      "weight_nbit must be 2 or 4 but got %d",
+      weight_nbit);
+
+  ET_CHECK_MSG(
+      weight.dim() == 2, "weight must be 2D but got() %zd dims", weight.dim());
+
+  ET_CHECK_MSG(input.dim() >= 1, "input must be at least 1D");
+
+  ET_CHECK_MSG(
+      input.size(input.dim() - 1) ==
+          weight.size(1) * values_per_byte(weight_nbit),
+      "input.size(-1)=%zd must match the unpacked weight.size(1)=%zd",
+      input.size(input.dim() - 1),
+      weight.size(1) * values_per_byte(weight_nbit));
+
+  ET_CHECK_MSG(
+      weight_scales.dim() == 1 || weight_scales.dim() == 2,
+      "weight_scales must be 1D or 2D but got() %zd dims",
+      weight_scales.dim());
+
+  ET_CHECK_MSG(
+      weight_scales.size(0) == weight.size(0),
+      "Number of scales must be == weight.size(0)=%zd"
+      ", but got %zd",
+      weight_scales.size(0),
+      weight.size(0));
+
+  if (weight_scales.dim() == 2) {
+    auto num_groups = weight_scales.size(1);
+    ET_CHECK_MSG(
+        num_groups > 0 &&
+            (weight.size(1) * values_per_byte(weight_nbit)) % num_groups == 0,
+        "Number of groups must divide the unpacked weight.size(1)=%zd"
+        ", but got # of groups = %zd",
+        weight.size(1) * values_per_byte(weight_nbit),
+        num_groups);
+  }
+
+  ET_CHECK_MSG(
+      weight.scalar_type() == ScalarType::Byte,
+      "weight.scalar_type() %" PRId8 " is not supported:",
+      static_cast<int8_t>(weight.scalar_type()));
+
+  ET_CHECK_MSG(
+      out.scalar_type() == input.scalar_type(),
+      "out.scalar_type() %" PRId8 " must match input.scalar_type() %" PRId8,
+      static_cast<int8_t>(out.scalar_type()),
+      static_cast<int8_t>(input.scalar_type()));
+
+  if (opt_weight_zero_points.has_value()) {
+    const Tensor& weight_zero_points = opt_weight_zero_points.value();
+    ET_CHECK_MSG(
+        weight_zero_points.scalar_type() == weight_scales.scalar_type(),
+        "weight zero points scalar type %" PRId8
+        " does not match weight_scales.scalar_type()",
+        static_cast<int8_t>(weight_zero_points.scalar_type()));
+
+    ET_CHECK_MSG(
+        weight_zero_points.dim() == weight_scales.dim(),
+        "weight_zero_points's rank match that of weight_scales. "
+        "weight_zero_points rank: %" PRId8 ", weight_scales rank: %" PRId8,
+        static_cast<int8_t>(weight_zero_points.dim()),
+        static_cast<int8_t>(weight_scales.dim()));
+
+    for (int32_t i = 0; i < weight_scales.dim(); ++i) {
+      ET_CHECK_MSG(
+          weight_zero_points.size(i) == weight_scales.size(i),
+          "Dimension size mismatch at dim %" PRIi32
+          "Weight_zero_point size = %zd"
+          ", weight_scales size = %zd.",
+          i,
+          weight_zero_points.size(i),
+          weight_scales.size(i));
+    }
+  }
+
+  ET_CHECK_MSG(
+      weight_quant_min <= weight_quant_max,
+      "weight quant min: %" PRId64
+      " is greater than weight quant max: %" PRId64,
+      weight_quant_min,
+      weight_quant_max);
+}
+
+// Returns the number of rows of input viewed as [m, k], which is well defined
+// even when k is 0.
+int64_t leading_dims_numel(const Tensor& input) {
+  int64_t m = 1;
+  for (ssize_t i = 0; i + 1 < input.dim(); ++i) {
+    m *= input.size(i);
+  }
+  return m;
+}
+
+// An empty inner dimension makes every output element an empty sum.
+void zero_out_tensor(Tensor& out) {
+  if (out.nbytes() > 0) {
+    std::memset(out.mutable_data_ptr(), 0, out.nbytes());
+  }
+}
+
+void resize_out_tensor(const Tensor& input, const Tensor& weight, Tensor& out) {
+  executorch::aten::SizesType expected_output_size[kTensorDimensionLimit];
+  for (ssize_t i = 0; i + 1 < input.dim(); i++) {
+    expected_output_size[i] = input.size(i);
+  }
+  expected_output_size[input.dim() - 1] = weight.size(0);
+
+  executorch::aten::ArrayRef<executorch::aten::SizesType> output_size{
+      expected_output_size, static_cast<size_t>(input.dim())};
+
+  torch::executor::Error err = resize_tensor(out, output_size);
+  ET_CHECK_MSG(
+      err == torch::executor::Error::Ok,
+      "Failed to resize out Tensor in quantized_linear_xbit_out");
+}
+
+/**
+ * Shapes and quantization parameters shared by both variants. The input is
+ * viewed as [m, k] and the output as [m, n].
+ */
+template <typename CTYPE_PARAMS>
+struct LinearXbitParams {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  int64_t num_groups;
+  int64_t group_size;
+  int weight_nbit;
+  const uint8_t* weight;
+  int64_t packed_k;
+  const CTYPE_PARAMS* scales;
+  const CTYPE_PARAMS* zero_points;
+
+  LinearXbitParams(
+      const Tensor& input,
+      const Tensor& weight_t,
+      const Tensor& weight_scales,
+      const std::optional<Tensor>& opt_weight_zero_points,
+      int nbit)
+      : n(weight_t.size(0)),
+        k(input.size(input.dim() - 1)),
+        num_groups(weight_scales.dim() == 2 ? weight_scales.size(1) : 1),
+        weight_nbit(nbit),
+        weight(weight_t.const_data_ptr<uint8_t>()),
+        packed_k(weight_t.size(1)),
+        scales(weight_scales.const_data_ptr<CTYPE_PARAMS>()),
+        zero_points(
+            opt_weight_zero_points.has_value()
+                ? opt_weight_zero_points.value()
+                      .template const_data_ptr<CTYPE_PARAMS>()
+                : nullptr) {
+    m = leading_dims_numel(input);
+    group_size = k / num_groups;
+  }
+
+  float zero_point(int64_t j, int64_t g) const {
+    return zero_points == nullptr
+        ? 0.0f
+        : static_cast<float>(zero_points[j * num_groups + g]);
+  }
+
+  // Value subtracted from an unpacked, still offset weight of group g in row
+  // j to dequantize it, before scaling.
+  float bias(int64_t j, int64_t g) const {
+    return static_cast<float>(weight_offset(weight_nbit)) + zero_point(j, g);
+  }
+
+  float scale(int64_t j, int64_t g) const {
+    return static_cast<float>(scales[j * num_groups + g]);
+  }
+
+  // Returns the end of the chunk of weights that starts at k0: up to kTileK
+  // weights, made of whole groups if groups are that small, or else of part
+  // of a single group. Either way, the chunk is made of equally sized
+  // segments that each belong to one group.
+  int64_t chunk_end(int64_t k0) const {
+    if (group_size >= kTileK) {
+      return std::min(k0 + kTileK, (k0 / group_size + 1) * group_size);
+    }
+    return std::min(k, k0 + (kTileK / group_size) * group_size);
+  }
+
+  int64_t segment_size(int64_t chunk_size) const {
+    return std::min(group_size, chunk_size);
+  }
+};
+
+/**
+ * Splits output columns across threads so that each task does roughly
+ * GRAIN_SIZE multiply-adds.
+ */
+template <typename Func>
+void parallel_for_each_column_block(int64_t m, int64_t n, int64_t k, Func f) {
+  const int64_t work_per_column = std::max<int64_t>(1, m * k);
+  const int64_t grain_size = std::max<int64_t>(
+      1, ::executorch::extension::internal::GRAIN_SIZE / work_per_column);
+  const bool success =
+      ::executorch::extension::parallel_for(0, n, grain_size, f);
+  ET_CHECK_MSG(success, "parallel_for failed in quantized_linear_xbit_out");
+}
+
+/**
+ * out = input @ dequantize(weight).T, unpacking and dequantizing up to kTileK
+ * weights of kTileN columns at a time so that the full precision weight is
+ * never materialized. Each unpacked tile is reused for a whole block of rows:
+ * all of them for float outputs, which accumulate in place, and kBlockM of
+ * them for other outputs, which accumulate in float on the stack.
+ */
+template <typename CTYPE, typename CTYPE_PARAMS>
+void linear_xbit_per_channel(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    Tensor& out,
+    int weight_nbit) {
+  const LinearXbitParams<CTYPE_PARAMS> p(
+      input, weight, weight_scales, opt_weight_zero_points, weight_nbit);
+  const CTYPE* in_data = input.const_data_ptr<CTYPE>();
+  CTYPE* out_data = out.mutable_data_ptr<CTYPE>();
+  constexpr bool kAccumulateInOut = std::is_same_v<CTYPE, float>;
+  const int64_t block_m = kAccumulateInOut ? p.m : kBlockM;
+
+  const auto compute_columns = [&](int64_t begin, int64_t end) {
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    uint8_t w_unpacked[kTileK];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float w_tile[kTileN * kTileK];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float in_chunk[kTileM * kTileK];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float acc_block[kAccumulateInOut ? 1 : kBlockM * kTileN];
+
+    for (int64_t n0 = begin; n0 < end; n0 += kTileN) {
+      const int64_t tile_n = std::min(kTileN, end - n0);
+      for (int64_t r0 = 0; r0 < p.m; r0 += block_m) {
+        const int64_t r1 = std::min(p.m, r0 + block_m);
+        float* acc = acc_block;
+        int64_t acc_stride = kTileN;
+        if constexpr (kAccumulateInOut) {
+          acc = out_data + r0 * p.n + n0;
+          acc_stride = p.n;
+        }
+        for (int64_t i = 0; i < r1 - r0; ++i) {
+          std::fill(acc + i * acc_stride, acc + i * acc_stride + tile_n, 0.0f);
+        }
+        for (int64_t k0 = 0; k0 < p.k;) {
+          const int64_t k1 = p.chunk_end(k0);
+          const int64_t tile_k = k1 - k0;
+          const int64_t segment_size = p.segment_size(tile_k);
+          for (int64_t j = 0; j < tile_n; ++j) {
+            const int64_t col = n0 + j;
+            unpack_weights(
+                p.weight + col * p.packed_k,
+                k0,
+                tile_k,
+                weight_nbit,
+                w_unpacked);
+            for (int64_t s = 0; s < tile_k; s += segment_size) {
+              const int64_t g = (k0 + s) / p.group_size;
+              dequantize_weights(
+                  w_unpacked + s,
+                  segment_size,
+                  weight_nbit,
+                  p.zero_point(col, g),
+                  p.scale(col, g),
+                  w_tile + j * kTileK + s);
+            }
+          }
+          for (int64_t m0 = r0; m0 < r1; m0 += kTileM) {
+            const int64_t tile_m = std::min(kTileM, r1 - m0);
+            // Rows of input, in float, shared by every column of the tile.
+            const float* in_rows = nullptr;
+            int64_t in_stride = 0;
+            if constexpr (std::is_same_v<CTYPE, float>) {
+              in_rows = in_data + m0 * p.k + k0;
+              in_stride = p.k;
+            } else {
+              for (int64_t i = 0; i < tile_m; ++i) {
+                const CTYPE* src = in_data + (m0 + i) * p.k + k0;
+                for (int64_t kk = 0; kk < tile_k; ++kk) {
+                  in_chunk[i * kTileK + kk] = static_cast<float>(src[kk]);
+                }
+              }
+              in_rows = in_chunk;
+              in_stride = kTileK;
+            }
+            float* acc_rows = acc + (m0 - r0) * acc_stride;
+            for (int64_t j = 0; j < tile_n; ++j) {
+              for (int64_t i = 0; i < tile_m; ++i) {
+                acc_rows[i * acc_stride + j] += dot_product(
+                    in_rows + i * in_stride, w_tile + j * kTileK, tile_k);
+              }
+            }
+          }
+          k0 = k1;
+        }
+        if constexpr (!kAccumulateInOut) {
+          for (int64_t i = r0; i < r1; ++i) {
+            for (int64_t j = 0; j < tile_n; ++j) {
+              out_data[i * p.n + n0 + j] =
+                  static_cast<CTYPE>(acc[(i - r0) * kTileN + j]);
+            }
+          }
+        }
+      }
+    }
+  };
+  parallel_for_each_column_block(p.m, p.n, p.k, compute_columns);
+}
+
+/**
+ * Quantizes each row of input to int8 with a symmetric per row scale, and
+ * records the sum of each group of quantized values, which is what the
+ * weight zero point multiplies.
+ */
+template <typename CTYPE>
+void quantize_input_rows(
+    const CTYPE* in_data,
+    int64_t m,
+    int64_t k,
+    int64_t num_groups,
+    int8_t* q_data,
+    float* q_scales,
+    int32_t* q_group_sums) {
+  const int64_t group_size = k / num_groups;
+  const int64_t grain_size = std::max<int64_t>(
+      1,
+      ::executorch::extension::internal::GRAIN_SIZE /
+          std::max<int64_t>(1, k));
+  const bool success = ::executorch::extension::parallel_for(
+      0, m, grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const CTYPE* row = in_data + i * k;
+          float max_abs = 0;
+          for (int64_t kk = 0; kk < k; ++kk) {
+            max_abs = std::max(max_abs, std::fabs(static_cast<float>(row[kk])));
+          }
+          const float inv_scale = max_abs > 0 ? 127.0f / max_abs : 0.0f;
+          q_scales[i] = max_abs / 127.0f;
+          int8_t* q_row = q_data + i * k;
+          for (int64_t g = 0; g < num_groups; ++g) {
+            int32_t sum = 0;
+            for (int64_t kk = g * group_size; kk < (g + 1) * group_size; ++kk) {
+              const float q =
+                  std::nearbyint(static_cast<float>(row[kk]) * inv_scale);
+              q_row[kk] =
+                  static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+              sum += q_row[kk];
+            }
+            q_group_sums[i * num_groups + g] = sum;
+          }
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in quantized_linear_xbit_out");
+}
+
+/**
+ * Like linear_xbit_per_channel, but with the input quantized to int8 per row,
+ * so that the inner products are computed on integers:
+ *
+ *   out[i][j] = in_scale[i] * sum over groups g of
+ *       w_scale[j][g] * (sum(w * q_in) - bias[j][g] * sum(q_in))
+ *
+ * where w are the unpacked, still offset weights of group g and bias folds the
+ * packing offset and the zero point together.
+ */
+template <typename CTYPE, typename CTYPE_PARAMS>
+void linear_xbit_dynamic_per_channel(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    const int8_t* q_data,
+    const float* q_scales,
+    const int32_t* q_group_sums,
+    Tensor& out,
+    int weight_nbit) {
+  const LinearXbitParams<CTYPE_PARAMS> p(
+      input, weight, weight_scales, opt_weight_zero_points, weight_nbit);
+  CTYPE* out_data = out.mutable_data_ptr<CTYPE>();
+
+  const auto compute_columns = [&](int64_t begin, int64_t end) {
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    uint8_t w_unpacked[kTileK];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float segment_scales[kTileK];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float acc[kTileM];
+
+    for (int64_t m0 = 0; m0 < p.m; m0 += kTileM) {
+      const int64_t tile_m = std::min(kTileM, p.m - m0);
+      for (int64_t col = begin; col < end; ++col) {
+        std::fill(acc, acc + tile_m, 0.0f);
+        for (int64_t k0 = 0; k0 < p.k;) {
+          const int64_t k1 = p.chunk_end(k0);
+          const int64_t tile_k = k1 - k0;
+          const int64_t segment_size = p.segment_size(tile_k);
+          const int64_t num_segments = tile_k / segment_size;
+          for (int64_t s = 0; s < num_segments; ++s) {
+            segment_scales[s] =
+                p.scale(col, (k0 + s * segment_size) / p.group_size);
+          }
+          unpack_weights(
+              p.weight + col * p.packed_k,
+              k0,
+              tile_k,
+              weight_nbit,
+              w_unpacked);
+          for (int64_t i = 0; i < tile_m; ++i) {
+            acc[i] += dot_product_segments(
+                w_unpacked,
+                q_data + (m0 + i) * p.k + k0,
+                segment_size,
+                num_segments,
+                segment_scales);
+          }
+          k0 = k1;
+        }
+        for (int64_t g = 0; g < p.num_groups; ++g) {
+          const float scaled_bias = p.scale(col, g) * p.bias(col, g);
+          for (int64_t i = 0; i < tile_m; ++i) {
+            acc[i] -= scaled_bias *
+                static_cast<float>(q_group_sums[(m0 + i) * p.num_groups + g]);
+          }
+        }
+        for (int64_t i = 0; i < tile_m; ++i) {
+          out_data[(m0 + i) * p.n + col] =
+              static_cast<CTYPE>(q_scales[m0 + i] * acc[i]);
+        }
+      }
+    }
+  };
+  parallel_for_each_column_block(p.m, p.n, p.k, compute_columns);
+}
+
+// The dtypes that the kernels below instantiate for input and params.
+bool is_float_or_half(ScalarType dtype) {
+  return dtype == ScalarType::Float || dtype == ScalarType::Half;
+}
+
+void* allocate_temp_memory(KernelRuntimeContext& ctx, size_t size) {
+  Result<void*> temp_mem_res = ctx.allocate_temp(size);
+  return temp_mem_res.ok() ? temp_mem_res.get() : nullptr;
+}
+
+} // namespace
+
+/**
+ * Computes out = input @ dequantize(weight).T, where weight is quantized to
+ * weight_nbit bits per channel or per group along its last dimension, and
+ * packed into bytes the same way as for quantized_embedding_xbit_out. The
+ * weight is dequantized on the fly, a tile at a time, and never materialized
+ * in full precision.
+ *
+ * NOTE: quant_min and quant_max are not used in computation, but rather
+ * metadata that is passed around which can be useful for pattern matching. See
+ * https://github.com/pytorch/pytorch/pull/87093#discussion_r1000841181 for more
+ * info.
+ */
+Tensor& quantized_linear_xbit_out(
+    KernelRuntimeContext& context,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    int64_t weight_quant_min,
+    int64_t weight_quant_max,
+    Tensor& out,
+    int weight_nbit) {
+  check_linear_xbit_args(
+      input,
+      weight,
+      weight_scales,
+      opt_weight_zero_points,
+      weight_quant_min,
+      weight_quant_max,
+      out,
+      weight_nbit);
+  resize_out_tensor(input, weight, out);
+
+  if (input.size(input.dim() - 1) == 0) {
+    zero_out_tensor(out);
+    return out;
+  }
+
+  ScalarType params_type = weight_scales.scalar_type();
+  ScalarType in_type = input.scalar_type();
+  ET_KERNEL_CHECK(context, is_float_or_half(in_type), InvalidArgument, out);
+  ET_KERNEL_CHECK(context, is_float_or_half(params_type), InvalidArgument, out);
+
+  constexpr auto name = "quantized_decomposed::linear_xbit.out";
+  ET_SWITCH_TWO_TYPES(Float, Half, params_type, context, name, CTYPE_P, [&]() {
+    ET_SWITCH_TWO_TYPES(Float, Half, in_type, context, name, CTYPE, [&]() {
+      linear_xbit_per_channel<CTYPE, CTYPE_P>(
+          input,
+          weight,
+          weight_scales,
+          opt_weight_zero_points,
+          out,
+          weight_nbit);
+    });
+  });
+
+  return out;
+}
+
+/**
+ * Like quantized_linear_xbit_out, but quantizes each row of input to int8 on
+ * the fly, with a symmetric per row scale, and accumulates the products with
+ * the unpacked weights in int32. Needs temp memory from the context for the
+ * quantized input.
+ */
+Tensor& quantized_linear_xbit_dynamic_out(
+    KernelRuntimeContext& context,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    int64_t weight_quant_min,
+    int64_t weight_quant_max,
+    Tensor& out,
+    int weight_nbit) {
+  check_linear_xbit_args(
+      input,
+      weight,
+      weight_scales,
+      opt_weight_zero_points,
+      weight_quant_min,
+      weight_quant_max,
+      out,
+      weight_nbit);
+  resize_out_tensor(input, weight, out);
+
+  ScalarType params_type = weight_scales.scalar_type();
+  ScalarType in_type = input.scalar_type();
+  ET_KERNEL_CHECK(context, is_float_or_half(in_type), InvalidArgument, out);
+  ET_KERNEL_CHECK(context, is_float_or_half(params_type), InvalidArgument, out);
+
+  const int64_t k = input.size(input.dim() - 1);
+  const int64_t m = leading_dims_numel(input);
+  const int64_t num_groups =
+      weight_scales.dim() == 2 ? weight_scales.size(1) : 1;
+  if (m == 0) {
+    return out;
+  }
+  if (k == 0) {
+    zero_out_tensor(out);
+    return out;
+  }
+
+  // Quantized input, then per row scales, then per row and group sums.
+  const size_t q_data_size = (static_cast<size_t>(m * k) + 3) & ~size_t(3);
+  const size_t temp_size = q_data_size + m * sizeof(float) +
+      m * num_groups * sizeof(int32_t);
+  auto* temp =
+      static_cast<uint8_t*>(allocate_temp_memory(context, temp_size));
+  ET_KERNEL_CHECK(context, temp != nullptr, MemoryAllocationFailed, out);
+  int8_t* q_data = reinterpret_cast<int8_t*>(temp);
+  float* q_scales = reinterpret_cast<float*>(temp + q_data_size);
+  int32_t* q_group_sums =
+      reinterpret_cast<int32_t*>(temp + q_data_size + m * sizeof(float));
+
+  constexpr auto name = "quantized_decomposed::linear_xbit.dynamic_out";
+  ET_SWITCH_TWO_TYPES(Float, Half, in_type, context, name, CTYPE, [&]() {
+    quantize_input_rows<CTYPE>(
+        input.const_data_ptr<CTYPE>(),
+        m,
+        k,
+        num_groups,
+        q_data,
+        q_scales,
+        q_group_sums);
+    ET_SWITCH_TWO_TYPES(
+        Float, Half, params_type, context, name, CTYPE_P, [&]() {
+          linear_xbit_dynamic_per_channel<CTYPE, CTYPE_P>(
+              input,
+              weight,
+              weight_scales,
+              opt_weight_zero_points,
+              q_data,
+              q_scales,
+              q_group_sums,
+              out,
+              weight_nbit);
+        });
+  });
+
+  return out;
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
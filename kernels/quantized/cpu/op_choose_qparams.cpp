@@ -6,12 +6,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <executorch/kernels/portable/cpu/vec_ops.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <limits>
 #include <tuple>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
  */
@@ -27,6 +31,10 @@ namespace {
 
 constexpr float SMALL_SCALE_THRESHOLD = 6.1e-5f;
 
+// Upper bound on the number of partial results computed in parallel when
+// reducing a whole tensor to its min and max.
+constexpr int64_t kMaxMinMaxChunks = 64;
+
 /**
  * Asserts that the parameters are valid.
  */
@@ -170,6 +178,50 @@ void calculate_scale_and_zero_point(
   return;
 }
 
+/**
+ * Computes the min and max of `n` contiguous floats in a single pass over the
+ * data. Returns +inf/-inf for an empty range.
+ */
+void find_min_max(const float* x, int64_t n, float& min_out, float& max_out) {
+  float min = std::numeric_limits<float>::infinity();
+  float max = -std::numeric_limits<float>::infinity();
+  int64_t i = 0;
+#if defined(__AVX2__)
+  constexpr int64_t kVecSize = 16;
+  if (n >= kVecSize) {
+    // Two independent accumulators per bound hide the min/max latency.
+    __m256 min_0 = _mm256_loadu_ps(x);
+    __m256 min_1 = _mm256_loadu_ps(x + 8);
+    __m256 max_0 = min_0;
+    __m256 max_1 = min_1;
+    for (i = kVecSize; i + kVecSize <= n; i += kVecSize) {
+      const __m256 v_0 = _mm256_loadu_ps(x + i);
+      const __m256 v_1 = _mm256_loadu_ps(x + i + 8);
+      min_0 = _mm256_min_ps(min_0, v_0);
+      min_1 = _mm256_min_ps(min_1, v_1);
+      max_0 = _mm256_max_ps(max_0, v_0);
+      max_1 = _mm256_max_ps(max_1, v_1);
+    }
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float mins[8];
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float maxs[8];
+    _mm256_storeu_ps(mins, _mm256_min_ps(min_0, min_1));
+    _mm256_storeu_ps(maxs, _mm256_max_ps(max_0, max_1));
+    for (int j = 0; j < 8; j++) {
+      min = std::min(min, mins[j]);
+      max = std::max(max, maxs[j]);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    min = std::min(min, x[i]);
+    max = std::max(max, x[i]);
+  }
+  min_out = min;
+  max_out = max;
+}
+
 void choose_qparams(
     const Tensor& input,
     int32_t qmin,
@@ -177,9 +229,38 @@ void choose_qparams(
     Tensor& scale_out,
     Tensor& zero_point_out) {
   const float* x_fp32 = input.const_data_ptr<float>();
-  // Compute x_min, x_max and q_params (scale, zero_point)
-  float min = torch::executor::vec_minf(x_fp32, input.numel());
-  float max = torch::executor::vec_maxf(x_fp32, input.numel());
+  const int64_t numel = input.numel();
+  // Compute x_min, x_max and q_params (scale, zero_point). Large inputs are
+  // split into chunks whose partial results are reduced afterwards.
+  const int64_t num_chunks = std::max<int64_t>(
+      1,
+      std::min<int64_t>(
+          kMaxMinMaxChunks,
+          numel / ::executorch::extension::internal::GRAIN_SIZE));
+  const int64_t chunk_size = (numel + num_chunks - 1) / num_chunks;
+  // @lint-ignore CLANGTIDY facebook-hte-CArray
+  float chunk_mins[kMaxMinMaxChunks];
+  // @lint-ignore CLANGTIDY facebook-hte-CArray
+  float chunk_maxs[kMaxMinMaxChunks];
+  const bool success = ::executorch::extension::parallel_for(
+      0, num_chunks, 1, [&](const auto begin, const auto end) {
+        for (int64_t chunk = begin; chunk < end; chunk++) {
+          const int64_t start = chunk * chunk_size;
+          const int64_t len = std::min(chunk_size, numel - start);
+          find_min_max(
+              x_fp32 + start,
+              std::max<int64_t>(len, 0),
+              chunk_mins[chunk],
+              chunk_maxs[chunk]);
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in choose_qparams");
+  float min = chunk_mins[0];
+  float max = chunk_maxs[0];
+  for (int64_t chunk = 1; chunk < num_chunks; chunk++) {
+    min = std::min(min, chunk_mins[chunk]);
+    max = std::max(max, chunk_maxs[chunk]);
+  }
 
   double scale;
   int32_t zero_point;
@@ -196,24 +277,33 @@ void choose_qparams_per_token(
     Tensor& scale_out,
     Tensor& zero_point_out) {
   const float* x_fp32 = input.const_data_ptr<float>();
+  double* scale_data = scale_out.mutable_data_ptr<double>();
+  int64_t* zero_point_data = zero_point_out.mutable_data_ptr<int64_t>();
   // Compute x_min, x_max and q_params (scale, zero_point)
-  auto num_tokens = 1;
+  int64_t num_tokens = 1;
   for (auto i = 0; i < input.dim() - 1; i++) {
     num_tokens *= input.size(i);
   }
-  auto token_dim_size = input.size(input.dim() - 1);
-  for (auto i = 0; i < num_tokens; i++) {
-    // vec_minf uses std::min_element. Check if it actually
-    // gets vectorized.
-    float min = torch::executor::vec_minf(x_fp32, token_dim_size);
-    float max = torch::executor::vec_maxf(x_fp32, token_dim_size);
-    double scale;
-    int32_t zero_point;
-    calculate_scale_and_zero_point(min, max, qmin, qmax, scale, zero_point);
-    scale_out.mutable_data_ptr<double>()[i] = scale;
-    zero_point_out.mutable_data_ptr<int64_t>()[i] = zero_point;
-    x_fp32 += token_dim_size;
-  }
+  const int64_t token_dim_size = input.size(input.dim() - 1);
+  const int64_t grain_size = std::max<int64_t>(
+      1,
+      ::executorch::extension::internal::GRAIN_SIZE /
+          std::max<int64_t>(token_dim_size, 1));
+  const bool success = ::executorch::extension::parallel_for(
+      0, num_tokens, grain_size, [&](const auto begin, const auto end) {
+        for (int64_t i = begin; i < end; i++) {
+          float min;
+          float max;
+          find_min_max(x_fp32 + i * token_dim_size, token_dim_size, min, max);
+          double scale;
+          int32_t zero_point;
+          calculate_scale_and_zero_point(
+              min, max, qmin, qmax, scale, zero_point);
+          scale_data[i] = scale;
+          zero_point_data[i] = zero_point;
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in choose_qparams_per_token");
 }
 } // namespace
 
@@ -8,12 +8,18 @@
 
 #include <executorch/kernels/portable/cpu/util/reduce_util.h>
 #include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <limits>
+#include <type_traits>
 #if defined(__aarch64__) || defined(__ARM_NEON)
 #include <arm_neon.h>
 #endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
@@ -69,40 +75,82 @@ void check_dequantize_per_tensor_args(
 }
 
 /**
- * Useful to reduce a tensor `in` over a given dimension `dim` using the
- * reduce function `fn`, which should have the following signature:
- * void fn(const size_t size, const size_t stride, const size_t base_ix)
- * where `size` and `stride` are the size and stride of the dimension being
- * reduced and `base_ix` is the index of the first element of the reduction.
+ * Dequantizes `numel` contiguous 8-bit elements that share a scale and zero
+ * point into floats, computing (in - zero_point) * scale in float. Vectorized
+ * with NEON for int8 and with AVX2 for int8 and uint8.
  */
-template <typename Fn>
-void apply_over_unpacked_dim(
-    const Fn& fn,
-    const executorch::aten::Tensor& in,
-    const int64_t& dim) {
-  if (in.numel() == 0) {
-    return;
+template <typename CTYPE_IN>
+void dequantize_8bit_to_float(
+    const CTYPE_IN* in,
+    const float scale,
+    const int32_t zero_point,
+    float* out,
+    int64_t numel) {
+  int64_t i = 0;
+#if defined(__aarch64__) || defined(__ARM_NEON)
+  if constexpr (std::is_same_v<CTYPE_IN, int8_t>) {
+    if (zero_point >= std::numeric_limits<int8_t>::min() &&
+        zero_point <= std::numeric_limits<int8_t>::max()) {
+      int8x8_t zero_point_vec = vdup_n_s8(zero_point);
+      float32x4_t scales = vdupq_n_f32(scale);
+      constexpr int32_t kVecSize = 16;
+      for (; i + kVecSize <= numel; i += kVecSize) {
+        int8x16_t in_vec = vld1q_s8(in + i);
+        int16x8_t sub_vec_0_7 = vsubl_s8(vget_low_s8(in_vec), zero_point_vec);
+        int32x4_t sub_vec_0_3 = vmovl_s16(vget_low_s16(sub_vec_0_7));
+        int32x4_t sub_vec_4_7 = vmovl_s16(vget_high_s16(sub_vec_0_7));
+        float32x4_t out_vec_0_3 = vmulq_f32(vcvtq_f32_s32(sub_vec_0_3), scales);
+        float32x4_t out_vec_4_7 = vmulq_f32(vcvtq_f32_s32(sub_vec_4_7), scales);
+
+        int16x8_t sub_vec_8_15 =
+            vsubl_s8(vget_high_s8(in_vec), zero_point_vec);
+        int32x4_t sub_vec_8_11 = vmovl_s16(vget_low_s16(sub_vec_8_15));
+        int32x4_t sub_vec_12_15 = vmovl_s16(vget_high_s16(sub_vec_8_15));
+        float32x4_t out_vec_8_11 =
+            vmulq_f32(vcvtq_f32_s32(sub_vec_8_11), scales);
+        float32x4_t out_vec_12_15 =
+            vmulq_f32(vcvtq_f32_s32(sub_vec_12_15), scales);
+        vst1q_f32(out + i + 0, out_vec_0_3);
+        vst1q_f32(out + i + 4, out_vec_4_7);
+        vst1q_f32(out + i + 8, out_vec_8_11);
+        vst1q_f32(out + i + 12, out_vec_12_15);
+      }
+    }
   }
-
-  ET_CHECK_MSG(in.dim() > 0, "Input tensor must have at least one dimension");
-  ET_CHECK_VALID_DIM(dim, in.dim());
-
-  const size_t d = ET_NORMALIZE_IX(dim, in.dim());
-  const size_t dim_size = in.size(d);
-  const size_t outer_size = getLeadingDims(in, d);
-  const size_t inner_size = getTrailingDims(in, d);
-  // Loop through all outer dimensions
-  for (size_t outer_idx = 0; outer_idx < outer_size; ++outer_idx) {
-    // Loop through dim
-    for (size_t unpacked_dim_idx = 0; unpacked_dim_idx < dim_size;
-         ++unpacked_dim_idx) {
-      fn(inner_size, outer_idx, unpacked_dim_idx);
+#elif defined(__AVX2__)
+  const __m256 scale_vec = _mm256_set1_ps(scale);
+  const __m256i zero_point_vec = _mm256_set1_epi32(zero_point);
+  const auto widen = [](__m128i v) {
+    if constexpr (std::is_same_v<CTYPE_IN, int8_t>) {
+      return _mm256_cvtepi8_epi32(v);
+    } else {
+      return _mm256_cvtepu8_epi32(v);
     }
+  };
+  constexpr int64_t kVecSize = 16;
+  for (; i + kVecSize <= numel; i += kVecSize) {
+    const __m128i in_vec =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m256i in_0_7 = widen(in_vec);
+    const __m256i in_8_15 = widen(_mm_srli_si128(in_vec, 8));
+    const __m256 out_0_7 = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_sub_epi32(in_0_7, zero_point_vec)),
+        scale_vec);
+    const __m256 out_8_15 = _mm256_mul_ps(
+        _mm256_cvtepi32_ps(_mm256_sub_epi32(in_8_15, zero_point_vec)),
+        scale_vec);
+    _mm256_storeu_ps(out + i, out_0_7);
+    _mm256_storeu_ps(out + i + 8, out_8_15);
+  }
+#endif
+  for (; i < numel; i++) {
+    out[i] = (in[i] - zero_point) * scale;
   }
 }
 
+template <typename CTYPE_IN>
 void dequantize_optimized(
-    const int8_t* in,
+    const CTYPE_IN* in,
     const double scale,
     const int64_t zero_point,
     float* out,
@@ -119,39 +167,12 @@ void dequantize_optimized(
       "zero_point must be %" PRId64 " >= quant_max %" PRId64,
       zero_point,
       quant_max);
-  size_t i = 0;
-#if defined(__aarch64__) || defined(__ARM_NEON)
-  int8x8_t zero_point_vec = vdup_n_s8(zero_point);
-  float32x4_t scales = vdupq_n_f32(static_cast<float>(scale));
-  constexpr int32_t kVecSize = 16;
-  const size_t num_vecs = numel / kVecSize;
-  const int8_t* in_copy = in;
-  float* out_copy = out;
-  for (; i < num_vecs; i++) {
-    int8x16_t in_vec = vld1q_s8(in_copy);
-    int16x8_t sub_vec_0_7 = vsubl_s8(vget_low_s8(in_vec), zero_point_vec);
-    int32x4_t sub_vec_0_3 = vmovl_s16(vget_low_s16(sub_vec_0_7));
-    int32x4_t sub_vec_4_7 = vmovl_s16(vget_high_s16(sub_vec_0_7));
-    float32x4_t out_vec_0_3 = vmulq_f32(vcvtq_f32_s32(sub_vec_0_3), scales);
-    float32x4_t out_vec_4_7 = vmulq_f32(vcvtq_f32_s32(sub_vec_4_7), scales);
-
-    int16x8_t sub_vec_8_15 = vsubl_s8(vget_high_s8(in_vec), zero_point_vec);
-    int32x4_t sub_vec_8_11 = vmovl_s16(vget_low_s16(sub_vec_8_15));
-    int32x4_t sub_vec_12_15 = vmovl_s16(vget_high_s16(sub_vec_8_15));
-    float32x4_t out_vec_8_11 = vmulq_f32(vcvtq_f32_s32(sub_vec_8_11), scales);
-    float32x4_t out_vec_12_15 = vmulq_f32(vcvtq_f32_s32(sub_vec_12_15), scales);
-    vst1q_f32(out_copy + 0, out_vec_0_3);
-    vst1q_f32(out_copy + 4, out_vec_4_7);
-    vst1q_f32(out_copy + 8, out_vec_8_11);
-    vst1q_f32(out_copy + 12, out_vec_12_15);
-    in_copy += kVecSize;
-    out_copy += kVecSize;
-  }
-  i = i * kVecSize;
-#endif
-  for (; i < numel; i++) {
-    out[i] = (in[i] - zero_point) * scale;
-  }
+  dequantize_8bit_to_float(
+      in,
+      static_cast<float>(scale),
+      static_cast<int32_t>(zero_point),
+      out,
+      numel);
 }
 
 float get_scale(const Tensor& scale, size_t channel_ix) {
@@ -170,7 +191,8 @@ float get_scale(const Tensor& scale, size_t channel_ix) {
 bool can_use_optimized_dequantize_per_channel(
     const Tensor& in,
     const ScalarType in_dtype,
-    std::optional<ScalarType>& out_dtype) {
+    std::optional<ScalarType>& out_dtype,
+    const Tensor& out) {
   bool is_contiguous = false;
 #ifdef USE_ATEN_LIB
   is_contiguous = in.is_contiguous();
@@ -178,13 +200,16 @@ bool can_use_optimized_dequantize_per_channel(
   is_contiguous = executorch::runtime::is_contiguous_dim_order(
       in.dim_order().data(), in.dim());
 #endif
-  if (!is_contiguous || (in_dtype != ScalarType::Char) ||
+  if (!is_contiguous ||
+      (in_dtype != ScalarType::Char && in_dtype != ScalarType::Byte) ||
+      out.scalar_type() != ScalarType::Float ||
       (out_dtype.has_value() && out_dtype.value() != ScalarType::Float)) {
     return false;
   }
   return true;
 }
 
+template <typename CTYPE_IN>
 void dequantize_per_channel_optimized(
     const Tensor& in,
     const Tensor& scales,
@@ -198,7 +223,7 @@ void dequantize_per_channel_optimized(
   check_dequantize_per_tensor_args(
       in, quant_min, quant_max, in_dtype, out_dtype, out);
   ET_CHECK_MSG(
-      in_dtype == ScalarType::Char,
+      in_dtype == ScalarType::Char || in_dtype == ScalarType::Byte,
       "in.scalar_type() %" PRId8 " is not supported:",
       static_cast<int8_t>(in.scalar_type()));
   if (out_dtype.has_value()) {
@@ -206,43 +231,83 @@ void dequantize_per_channel_optimized(
         out_dtype.value() == ScalarType::Float,
         "Only float output is supported");
   }
-  const int8_t* in_data = in.const_data_ptr<int8_t>();
+  if (in.numel() == 0) {
+    return;
+  }
+  ET_CHECK_MSG(in.dim() > 0, "Input tensor must have at least one dimension");
+  const CTYPE_IN* in_data = in.const_data_ptr<CTYPE_IN>();
   float* out_data = out.mutable_data_ptr<float>();
   const int64_t* zero_points_data = nullptr;
   if (opt_zero_points.has_value()) {
     zero_points_data = opt_zero_points.value().const_data_ptr<int64_t>();
   }
-  const StridesType axis_stride = in.strides()[axis];
-  const StridesType outer_stride = in.size(axis) * axis_stride;
-  apply_over_unpacked_dim(
-      [in_data,
-       out_data,
-       &scales,
-       zero_points_data,
-       axis_stride,
-       outer_stride,
-       quant_min,
-       quant_max](
-          SizesType numel, SizesType outer_idx, SizesType unpacked_dim_idx) {
-        const int8_t* in_data_local =
-            in_data + outer_idx * outer_stride + unpacked_dim_idx * axis_stride;
-        const double scale = get_scale(scales, unpacked_dim_idx);
-        const int64_t zero_point = zero_points_data != nullptr
-            ? zero_points_data[unpacked_dim_idx]
-            : 0;
-        float* out_data_local = out_data + outer_idx * outer_stride +
-            unpacked_dim_idx * axis_stride;
-        dequantize_optimized(
-            in_data_local,
-            scale,
-            zero_point,
-            out_data_local,
-            quant_min,
-            quant_max,
-            numel);
-      },
-      in,
-      axis);
+  // The input is contiguous, so it is laid out as [outer, axis_size, inner]
+  // and each channel of each outer index is one contiguous block of inner
+  // elements. Blocks are independent, so they are processed in parallel.
+  const int64_t axis_size = in.size(axis);
+  const int64_t inner_size = in.strides()[axis];
+  const int64_t num_blocks = in.numel() / inner_size;
+  const int64_t grain_size = std::max<int64_t>(
+      1, ::executorch::extension::internal::GRAIN_SIZE / inner_size);
+  const bool success = ::executorch::extension::parallel_for(
+      0, num_blocks, grain_size, [&](const auto begin, const auto end) {
+        for (int64_t block = begin; block < end; block++) {
+          const int64_t channel_idx = block % axis_size;
+          const double scale = get_scale(scales, channel_idx);
+          const int64_t zero_point = zero_points_data != nullptr
+              ? zero_points_data[channel_idx]
+              : 0;
+          dequantize_optimized(
+              in_data + block * inner_size,
+              scale,
+              zero_point,
+              out_data + block * inner_size,
+              quant_min,
+              quant_max,
+              inner_size);
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in dequantize_per_channel_out");
+}
+
+/**
+ * Dequantizes a contiguous tensor with a single scale and zero point, in
+ * parallel over chunks of elements.
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void dequantize_per_tensor_impl(
+    const Tensor& input,
+    double scale,
+    int64_t zero_point,
+    Tensor& out) {
+  /* Hoist these function calls out of our inner loop because they might not
+   * get inlined without LTO, particularly in ATen mode. */
+  auto* out_data_ptr = out.mutable_data_ptr<CTYPE_OUT>();
+  const auto* input_data_ptr = input.const_data_ptr<CTYPE_IN>();
+  const bool success = ::executorch::extension::parallel_for(
+      0,
+      input.numel(),
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](const auto begin, const auto end) {
+        if constexpr (
+            std::is_same_v<CTYPE_OUT, float> &&
+            (std::is_same_v<CTYPE_IN, int8_t> ||
+             std::is_same_v<CTYPE_IN, uint8_t>)) {
+          dequantize_8bit_to_float(
+              input_data_ptr + begin,
+              static_cast<float>(scale),
+              static_cast<int32_t>(zero_point),
+              out_data_ptr + begin,
+              end - begin);
+        } else {
+          for (auto i = begin; i < end; i++) {
+            out_data_ptr[i] = static_cast<CTYPE_OUT>(
+                (input_data_ptr[i] - static_cast<int32_t>(zero_point)) *
+                static_cast<float>(scale));
+          }
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in dequantize_per_tensor_out");
 }
 
 } // namespace
@@ -275,19 +340,11 @@ Tensor& dequantize_per_tensor_out(
 
   // calculate the dequantized output, cast scale to float to match fbgemm
   // behavior
-#define DEQUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)                        \
-  case ScalarType::out_dtype: {                                                \
-    /* Hoist these function calls out of our inner loop because they might not \
-     * get inlined without LTO, particularly in ATen mode. */                  \
-    auto* out_data_ptr = out.mutable_data_ptr<OUT_CTYPE>();                    \
-    const auto* input_data_ptr = input.const_data_ptr<IN_CTYPE>();             \
-    const auto input_numel = input.numel();                                    \
-    for (size_t i = 0; i < input_numel; i++) {                                 \
-      out_data_ptr[i] = static_cast<OUT_CTYPE>(                                \
-          (input_data_ptr[i] - static_cast<int32_t>(zero_point)) *             \
-          static_cast<float>(scale));                                          \
-    }                                                                          \
-  } break;
+#define DEQUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype) \
+  case ScalarType::out_dtype:                         \
+    dequantize_per_tensor_impl<IN_CTYPE, OUT_CTYPE>(  \
+        input, scale, zero_point, out);               \
+    break;
 #define CALCULATE_INT_TYPE(IN_CTYPE, in_dtype)                \
   case ScalarType::in_dtype:                                  \
     switch (out.scalar_type()) {                              \
@@ -398,17 +455,31 @@ Tensor& dequantize_per_channel_out(
   check_dequantize_per_tensor_args(
       input, quant_min, quant_max, dtype, out_dtype, out);
 
-  if (can_use_optimized_dequantize_per_channel(input, dtype, out_dtype)) {
-    dequantize_per_channel_optimized(
-        input,
-        scale,
-        opt_zero_points,
-        out,
-        axis,
-        quant_min,
-        quant_max,
-        dtype,
-        out_dtype);
+  if (can_use_optimized_dequantize_per_channel(
+          input, dtype, out_dtype, out)) {
+    if (dtype == ScalarType::Char) {
+      dequantize_per_channel_optimized<int8_t>(
+          input,
+          scale,
+          opt_zero_points,
+          out,
+          axis,
+          quant_min,
+          quant_max,
+          dtype,
+          out_dtype);
+    } else {
+      dequantize_per_channel_optimized<uint8_t>(
+          input,
+          scale,
+          opt_zero_points,
+          out,
+          axis,
+          quant_min,
+          quant_max,
+          dtype,
+          out_dtype);
+    }
     return out;
   }
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/quantized/cpu/linearxb.h>
+#include <executorch/runtime/kernel/kernel_includes.h>
+
+namespace torch {
+namespace executor {
+namespace native {
+
+using Tensor = executorch::aten::Tensor;
+
+/**
+ * Computes out = input @ dequantize(weight).T for a weight quantized to 2
+ * bits per channel or per group, packed 4 values per byte as for
+ * embedding_2bit. The weight is dequantized on the fly and never
+ * materialized in full precision.
+ *
+ * Corresponds as the out variant to torch.ops.quantized_decomposed.linear_2bit
+ *
+ * NOTE: quant_min and quant_max are not used in computation, but rather
+ * metadata that is passed around which can be useful for pattern matching. See
+ * https://github.com/pytorch/pytorch/pull/87093#discussion_r1000841181 for more
+ * info.
+ */
+Tensor& quantized_linear_2bit_out(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    const int64_t weight_quant_min,
+    const int64_t weight_quant_max,
+    Tensor& out) {
+  KernelRuntimeContext context{};
+  auto& res = quantized_linear_xbit_out(
+      context,
+      input,
+      weight,
+      weight_scales,
+      opt_weight_zero_points,
+      weight_quant_min,
+      weight_quant_max,
+      out,
+      2);
+  ET_CHECK(context.failure_state() == Error::Ok);
+  return res;
+}
+
+Tensor& quantized_linear_2bit_out(
+    KernelRuntimeContext& context,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    int64_t weight_quant_min,
+    int64_t weight_quant_max,
+    Tensor& out) {
+  return quantized_linear_xbit_out(
+      context,
+      input,
+      weight,
+      weight_scales,
+      opt_weight_zero_points,
+      weight_quant_min,
+      weight_quant_max,
+      out,
+      2);
+}
+
+/**
+ * Like quantized_linear_2bit_out, but quantizes input to int8 per row on the
+ * fly and accumulates in int32.
+ *
+ * Corresponds as the out variant to
+ * torch.ops.quantized_decomposed.linear_2bit.dynamic
+ */
+Tensor& quantized_linear_2bit_dynamic_out(
+    KernelRuntimeContext& context,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_scales,
+    const std::optional<Tensor>& opt_weight_zero_points,
+    int64_t weight_quant_min,
+    int64_t weight_quant_max,
+    Tensor& out) {
+  return quantized_linear_xbit_dynamic_out(
+      context,
+      input,
+      weight,
+      weight_scales,
+      opt_weight_zero_points,
+      weight_quant_min,
+      weight_quant_max,
+      out,
+      2);
+}
+
+} // namespace native
+} // namespace executor
+} // namespace torch
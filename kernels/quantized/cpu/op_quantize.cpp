@@ -7,9 +7,14 @@
  */
 
 #include <executorch/runtime/kernel/kernel_includes.h>
+#include <executorch/runtime/kernel/thread_parallel_interface.h>
 #include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 /**
  * For an input tensor, use the scale and zero_point arguments to quantize it.
@@ -105,6 +110,172 @@ T quantize_val(
   return static_cast<T>(qvalue);
 }
 
+namespace {
+
+#if defined(__AVX2__)
+/**
+ * Quantizes 8 floats to int32 lanes already clamped to [quant_min,
+ * quant_max]. Rounds to nearest even and adds the zero point in float, exactly
+ * like quantize_val().
+ */
+inline __m256i quantize_8_avx2(
+    const float* in,
+    __m256 inv_scale,
+    __m256 zero_point,
+    __m256 quant_min,
+    __m256 quant_max) {
+  __m256 q = _mm256_round_ps(
+      _mm256_mul_ps(_mm256_loadu_ps(in), inv_scale),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  q = _mm256_add_ps(q, zero_point);
+  q = _mm256_min_ps(_mm256_max_ps(q, quant_min), quant_max);
+  return _mm256_cvttps_epi32(q);
+}
+#endif
+
+/**
+ * Quantizes `numel` contiguous elements that share a scale and zero point.
+ * Float to 8-bit quantization is vectorized on AVX2; other dtypes and the
+ * tail go through quantize_val().
+ */
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void quantize_contiguous(
+    const CTYPE_IN* in,
+    CTYPE_OUT* out,
+    int64_t numel,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max) {
+  int64_t i = 0;
+#if defined(__AVX2__)
+  if constexpr (
+      std::is_same_v<CTYPE_IN, float> &&
+      (std::is_same_v<CTYPE_OUT, int8_t> ||
+       std::is_same_v<CTYPE_OUT, uint8_t>)) {
+    const __m256 inv_scale_vec =
+        _mm256_set1_ps(1.0f / static_cast<float>(scale));
+    const __m256 zero_point_vec =
+        _mm256_set1_ps(static_cast<float>(static_cast<int32_t>(zero_point)));
+    const __m256 quant_min_vec = _mm256_set1_ps(static_cast<float>(quant_min));
+    const __m256 quant_max_vec = _mm256_set1_ps(static_cast<float>(quant_max));
+    // packs_epi32/packs_epi16 interleave the 128-bit lanes; this restores
+    // element order.
+    const __m256i lane_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    constexpr int64_t kVecSize = 32;
+    for (; i + kVecSize <= numel; i += kVecSize) {
+      const __m256i q0 = quantize_8_avx2(
+          in + i, inv_scale_vec, zero_point_vec, quant_min_vec, quant_max_vec);
+      const __m256i q1 = quantize_8_avx2(
+          in + i + 8,
+          inv_scale_vec,
+          zero_point_vec,
+          quant_min_vec,
+          quant_max_vec);
+      const __m256i q2 = quantize_8_avx2(
+          in + i + 16,
+          inv_scale_vec,
+          zero_point_vec,
+          quant_min_vec,
+          quant_max_vec);
+      const __m256i q3 = quantize_8_avx2(
+          in + i + 24,
+          inv_scale_vec,
+          zero_point_vec,
+          quant_min_vec,
+          quant_max_vec);
+      // Values are already within the output range, so the saturating packs
+      // are exact.
+      const __m256i q01 = _mm256_packs_epi32(q0, q1);
+      const __m256i q23 = _mm256_packs_epi32(q2, q3);
+      __m256i packed;
+      if constexpr (std::is_same_v<CTYPE_OUT, int8_t>) {
+        packed = _mm256_packs_epi16(q01, q23);
+      } else {
+        packed = _mm256_packus_epi16(q01, q23);
+      }
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i),
+          _mm256_permutevar8x32_epi32(packed, lane_order));
+    }
+  }
+#endif
+  for (; i < numel; i++) {
+    out[i] = quantize_val<CTYPE_OUT, CTYPE_IN>(
+        scale, zero_point, in[i], quant_min, quant_max);
+  }
+}
+
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void quantize_per_tensor_impl(
+    const Tensor& input,
+    double scale,
+    int64_t zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    Tensor& out) {
+  /* Hoist these function calls out of our inner loop because they might not
+   * get inlined without LTO, particularly in ATen mode. */
+  auto* out_data_ptr = out.mutable_data_ptr<CTYPE_OUT>();
+  const auto* input_data_ptr = input.const_data_ptr<CTYPE_IN>();
+  const bool success = ::executorch::extension::parallel_for(
+      0,
+      input.numel(),
+      ::executorch::extension::internal::GRAIN_SIZE,
+      [&](const auto begin, const auto end) {
+        quantize_contiguous(
+            input_data_ptr + begin,
+            out_data_ptr + begin,
+            end - begin,
+            scale,
+            zero_point,
+            quant_min,
+            quant_max);
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in quantize_per_tensor_out");
+}
+
+template <typename CTYPE_IN, typename CTYPE_OUT>
+void quantize_per_channel_impl(
+    const Tensor& input,
+    const double* scale_data,
+    const int64_t* zero_point_data,
+    int64_t axis,
+    int64_t quant_min,
+    int64_t quant_max,
+    Tensor& out) {
+  auto* out_data_ptr = out.mutable_data_ptr<CTYPE_OUT>();
+  const auto* input_data_ptr = input.const_data_ptr<CTYPE_IN>();
+  const int64_t axis_size = input.size(axis);
+  // Elements are laid out as [outer, axis_size, axis_block_size], so every
+  // contiguous block of axis_block_size elements shares one channel's
+  // parameters.
+  int64_t axis_block_size = 1;
+  for (int64_t i = axis + 1; i < input.dim(); i++) {
+    axis_block_size *= input.size(i);
+  }
+  const int64_t num_blocks = input.numel() / axis_block_size;
+  const int64_t grain_size = std::max<int64_t>(
+      1, ::executorch::extension::internal::GRAIN_SIZE / axis_block_size);
+  const bool success = ::executorch::extension::parallel_for(
+      0, num_blocks, grain_size, [&](const auto begin, const auto end) {
+        for (int64_t block = begin; block < end; block++) {
+          const int64_t channel_idx = block % axis_size;
+          quantize_contiguous(
+              input_data_ptr + block * axis_block_size,
+              out_data_ptr + block * axis_block_size,
+              axis_block_size,
+              scale_data[channel_idx],
+              zero_point_data[channel_idx],
+              quant_min,
+              quant_max);
+        }
+      });
+  ET_CHECK_MSG(success, "parallel_for failed in quantize_per_channel_out");
+}
+
+} // namespace
+
 Tensor& quantize_per_tensor_out(
     const Tensor& input,
     double scale,
@@ -121,19 +292,11 @@ Tensor& quantize_per_tensor_out(
   check_quantize_per_tensor_args(input, quant_min, quant_max, dtype, out);
 
   // calculate the quantized input
-#define QUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)                          \
-  case ScalarType::out_dtype: {                                                \
-    /* Hoist these function calls out of our inner loop because they might not \
-     * get inlined without LTO, particularly in ATen mode. */                  \
-    auto* out_data_ptr = out.mutable_data_ptr<OUT_CTYPE>();                    \
-    const auto* input_data_ptr = input.const_data_ptr<IN_CTYPE>();             \
-    const auto input_numel = input.numel();                                    \
-    for (size_t i = 0; i < input_numel; i++) {                                 \
-      IN_CTYPE value = input_data_ptr[i];                                      \
-      out_data_ptr[i] = quantize_val<OUT_CTYPE, IN_CTYPE>(                     \
-          scale, zero_point, value, quant_min, quant_max);                     \
-    }                                                                          \
-  } break;
+#define QUANTIZE_IMPL(IN_CTYPE, OUT_CTYPE, out_dtype)         \
+  case ScalarType::out_dtype:                                 \
+    quantize_per_tensor_impl<IN_CTYPE, OUT_CTYPE>(            \
+        input, scale, zero_point, quant_min, quant_max, out); \
+    break;
 #define CALCULATE_FLOAT_TYPE(IN_CTYPE, in_dtype)         \
   case ScalarType::in_dtype:                             \
     switch (out.scalar_type()) {                         \
@@ -284,30 +447,21 @@ Tensor& quantize_per_channel_out(
   const double* scale_data = scale.const_data_ptr<double>();
   const int64_t* zero_point_data = zero_point.const_data_ptr<int64_t>();
 
-  // High-performance single loop with direct channel calculation
-#define QUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype)                          \
-  case ScalarType::out_dtype: {                                                \
-    auto* out_data_ptr = out.mutable_data_ptr<CTYPE_OUT>();                    \
-    const auto* input_data_ptr = input.const_data_ptr<CTYPE_IN>();             \
-    const int64_t input_numel = input.numel();                                 \
-    const int64_t axis_size = input.size(axis);                                \
-    /* Calculate the stride pattern for efficient channel index calculation */ \
-    int64_t axis_block_size = 1;                                               \
-    for (int64_t i = axis + 1; i < input.dim(); i++) {                         \
-      axis_block_size *= input.size(i);                                        \
-    }                                                                          \
-    /* Single loop over all elements */                                        \
-    for (int64_t i = 0; i < input_numel; i++) {                                \
-      /* Calculate which channel this element belongs to */                    \
-      int64_t channel_idx = (i / axis_block_size) % axis_size;                 \
-      /* Get quantization parameters for this channel */                       \
-      double _scale = scale_data[channel_idx];                                 \
-      int64_t _zero_point = zero_point_data[channel_idx];                      \
-      /* Apply quantization */                                                 \
-      out_data_ptr[i] = quantize_val<CTYPE_OUT, CTYPE_IN>(                     \
-          _scale, _zero_point, input_data_ptr[i], quant_min, quant_max);       \
-    }                                                                          \
-  } break;
+  if (input.numel() == 0) {
+    return out;
+  }
+
+#define QUANTIZE_IMPL(CTYPE_IN, CTYPE_OUT, out_dtype) \
+  case ScalarType::out_dtype:                         \
+    quantize_per_channel_impl<CTYPE_IN, CTYPE_OUT>(   \
+        input,                                        \
+        scale_data,                                   \
+        zero_point_data,                              \
+        axis,                                         \
+        quant_min,                                    \
+        quant_max,                                    \
+        out);                                         \
+    break;
 
 #define CALCULATE_FLOAT_TYPE(CTYPE_IN, in_dtype)         \
   case ScalarType::in_dtype:                             \
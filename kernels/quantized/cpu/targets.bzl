@@ -8,15 +8,17 @@ _QUANT_OPS = (
     op_target(
         name = "op_choose_qparams",
         deps = [
-            "//executorch/kernels/portable/cpu:vec_ops",
+            "//executorch/extension/threadpool:threadpool",
         ],
     ),
     op_target(
         name = "op_dequantize",
         deps = [
+            "//executorch/extension/threadpool:threadpool",
             "//executorch/kernels/portable/cpu/util:reduce_util",
         ],
         _aten_mode_deps = [
+            "//executorch/extension/threadpool:threadpool",
             "//executorch/kernels/portable/cpu/util:reduce_util_aten",
         ],
     ),
@@ -37,6 +39,20 @@ _QUANT_OPS = (
             "//executorch/kernels/quantized/cpu:embeddingxb_aten",
         ],
     ),
+    op_target(
+        name = "op_linear2b",
+        deps = ["//executorch/kernels/quantized/cpu:linearxb"],
+        _aten_mode_deps = [
+            "//executorch/kernels/quantized/cpu:linearxb_aten",
+        ],
+    ),
+    op_target(
+        name = "op_linear4b",
+        deps = ["//executorch/kernels/quantized/cpu:linearxb"],
+        _aten_mode_deps = [
+            "//executorch/kernels/quantized/cpu:linearxb_aten",
+        ],
+    ),
     op_target(
         name = "op_mixed_mm",
         deps = [
@@ -51,6 +67,9 @@ _QUANT_OPS = (
     ),
     op_target(
         name = "op_quantize",
+        deps = [
+            "//executorch/extension/threadpool:threadpool",
+        ],
     ),
 )
 
@@ -70,6 +89,14 @@ def define_common_targets():
         exported_deps = quant_op_targets,
     )
 
+    runtime.cxx_library(
+        name = "xbit_unpack",
+        exported_headers = ["xbit_unpack.h"],
+        visibility = [
+            "//executorch/kernels/quantized/...",
+        ],
+    )
+
     runtime.cxx_library(
         name = "embeddingxb",
         srcs = ["embeddingxb.cpp"],
@@ -77,7 +104,11 @@ def define_common_targets():
         visibility = [
             "//executorch/kernels/quantized/...",
         ],
-        deps = ["//executorch/runtime/kernel:kernel_includes"],
+        deps = [
+            ":xbit_unpack",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
     )
 
     runtime.cxx_library(
@@ -87,7 +118,39 @@ def define_common_targets():
         visibility = [
             "//executorch/kernels/quantized/...",
         ],
-        deps = ["//executorch/runtime/kernel:kernel_includes_aten"],
+        deps = [
+            ":xbit_unpack",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes_aten",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "linearxb",
+        srcs = ["linearxb.cpp"],
+        exported_headers = ["linearxb.h"],
+        visibility = [
+            "//executorch/kernels/quantized/...",
+        ],
+        deps = [
+            ":xbit_unpack",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes",
+        ],
+    )
+
+    runtime.cxx_library(
+        name = "linearxb_aten",
+        srcs = ["linearxb.cpp"],
+        exported_headers = ["linearxb.h"],
+        visibility = [
+            "//executorch/kernels/quantized/...",
+        ],
+        deps = [
+            ":xbit_unpack",
+            "//executorch/extension/threadpool:threadpool",
+            "//executorch/runtime/kernel:kernel_includes_aten",
+        ],
     )
 
     runtime.cxx_library(
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace torch {
+namespace executor {
+namespace native {
+namespace xbit {
+
+/**
+ * Helpers for the 2 and 4 bit weights of embedding_{2,4}bit and
+ * linear_{2,4}bit. Weights are packed along their last dimension, each value
+ * stored as q + offset, so that it is unsigned. For 4 bits, the
+ * even element is in the high nibble; for 2 bits, element i of a byte is in
+ * bits [2i, 2i + 2).
+ */
+inline int32_t weight_offset(int weight_nbit) {
+  return weight_nbit == 4 ? 8 : 2;
+}
+
+inline int64_t values_per_byte(int weight_nbit) {
+  return 8 / weight_nbit;
+}
+
+inline uint8_t
+packed_value(const uint8_t* w_data, int64_t index, int weight_nbit) {
+  if (weight_nbit == 4) {
+    const uint8_t byte = w_data[index >> 1];
+    return (index & 1) ? (byte & 0x0F) : (byte >> 4);
+  }
+  return (w_data[index >> 2] >> (2 * (index & 3))) & 3;
+}
+
+/**
+ * Unpacks elements [begin, begin + n) of a packed weight row into one byte
+ * each, still offset (i.e. in [0, 2^nbit)).
+ */
+inline void unpack_weights(
+    const uint8_t* w_data,
+    int64_t begin,
+    int64_t n,
+    int weight_nbit,
+    uint8_t* out) {
+  const int64_t per_byte = values_per_byte(weight_nbit);
+  int64_t i = 0;
+  for (; i < n && (begin + i) % per_byte != 0; ++i) {
+    out[i] = packed_value(w_data, begin + i, weight_nbit);
+  }
+  const uint8_t* src = w_data + (begin + i) / per_byte;
+  if (weight_nbit == 4) {
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    for (; i + 64 <= n; i += 64, src += 32) {
+      const __m256i packed =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+      const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(packed, 4), mask);
+      const __m256i lo = _mm256_and_si256(packed, mask);
+      // Interleaving hi and lo restores element order within each 128-bit
+      // lane; the permutes then put the lanes back in order.
+      const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+      const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i),
+          _mm256_permute2x128_si256(a, b, 0x20));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i + 32),
+          _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    const __m128i mask128 = _mm_set1_epi8(0x0F);
+    for (; i + 32 <= n; i += 32, src += 16) {
+      const __m128i packed =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask128);
+      const __m128i lo = _mm_and_si128(packed, mask128);
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+    // Byte-wise so that the compiler can vectorize it on other targets.
+    for (; i + 2 <= n; i += 2, ++src) {
+      out[i] = *src >> 4;
+      out[i + 1] = *src & 0x0F;
+    }
+  } else {
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi8(0x03);
+    for (; i + 128 <= n; i += 128, src += 32) {
+      const __m256i packed =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+      const __m256i w0 = _mm256_and_si256(packed, mask);
+      const __m256i w1 = _mm256_and_si256(_mm256_srli_epi16(packed, 2), mask);
+      const __m256i w2 = _mm256_and_si256(_mm256_srli_epi16(packed, 4), mask);
+      const __m256i w3 = _mm256_and_si256(_mm256_srli_epi16(packed, 6), mask);
+      const __m256i w01_lo = _mm256_unpacklo_epi8(w0, w1);
+      const __m256i w01_hi = _mm256_unpackhi_epi8(w0, w1);
+      const __m256i w23_lo = _mm256_unpacklo_epi8(w2, w3);
+      const __m256i w23_hi = _mm256_unpackhi_epi8(w2, w3);
+      // Per lane, q0..q3 hold the elements of bytes 0-3, 4-7, 8-11 and 12-15.
+      const __m256i q0 = _mm256_unpacklo_epi16(w01_lo, w23_lo);
+      const __m256i q1 = _mm256_unpackhi_epi16(w01_lo, w23_lo);
+      const __m256i q2 = _mm256_unpacklo_epi16(w01_hi, w23_hi);
+      const __m256i q3 = _mm256_unpackhi_epi16(w01_hi, w23_hi);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i),
+          _mm256_permute2x128_si256(q0, q1, 0x20));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i + 32),
+          _mm256_permute2x128_si256(q2, q3, 0x20));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i + 64),
+          _mm256_permute2x128_si256(q0, q1, 0x31));
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + i + 96),
+          _mm256_permute2x128_si256(q2, q3, 0x31));
+    }
+    const __m128i mask128 = _mm_set1_epi8(0x03);
+    for (; i + 64 <= n; i += 64, src += 16) {
+      const __m128i packed =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      const __m128i w0 = _mm_and_si128(packed, mask128);
+      const __m128i w1 = _mm_and_si128(_mm_srli_epi16(packed, 2), mask128);
+      const __m128i w2 = _mm_and_si128(_mm_srli_epi16(packed, 4), mask128);
+      const __m128i w3 = _mm_and_si128(_mm_srli_epi16(packed, 6), mask128);
+      const __m128i w01_lo = _mm_unpacklo_epi8(w0, w1);
+      const __m128i w01_hi = _mm_unpackhi_epi8(w0, w1);
+      const __m128i w23_lo = _mm_unpacklo_epi8(w2, w3);
+      const __m128i w23_hi = _mm_unpackhi_epi8(w2, w3);
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i),
+          _mm_unpacklo_epi16(w01_lo, w23_lo));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i + 16),
+          _mm_unpackhi_epi16(w01_lo, w23_lo));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i + 32),
+          _mm_unpacklo_epi16(w01_hi, w23_hi));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i + 48),
+          _mm_unpackhi_epi16(w01_hi, w23_hi));
+    }
+#endif
+    for (; i + 4 <= n; i += 4, ++src) {
+      out[i] = *src & 3;
+      out[i + 1] = (*src >> 2) & 3;
+      out[i + 2] = (*src >> 4) & 3;
+      out[i + 3] = *src >> 6;
+    }
+  }
+  for (; i < n; ++i) {
+    out[i] = packed_value(w_data, begin + i, weight_nbit);
+  }
+}
+
+/**
+ * Dequantizes n unpacked weights that share a scale and zero point:
+ * out[i] = (w[i] - offset - zero_point) * scale, computed in float.
+ */
+template <typename CTYPE_OUT>
+inline void dequantize_weights(
+    const uint8_t* w,
+    int64_t n,
+    int weight_nbit,
+    float zero_point,
+    float scale,
+    CTYPE_OUT* out) {
+  const float offset = static_cast<float>(weight_offset(weight_nbit));
+  int64_t i = 0;
+#if defined(__AVX2__)
+  const __m256 offset_v = _mm256_set1_ps(offset);
+  const __m256 zero_point_v = _mm256_set1_ps(zero_point);
+  const __m256 scale_v = _mm256_set1_ps(scale);
+  const auto dequantize_8 = [&](int64_t j) {
+    const __m256i w_i32 = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(w + j)));
+    const __m256 q = _mm256_sub_ps(_mm256_cvtepi32_ps(w_i32), offset_v);
+    return _mm256_mul_ps(_mm256_sub_ps(q, zero_point_v), scale_v);
+  };
+  if constexpr (std::is_same_v<CTYPE_OUT, float>) {
+    for (; i + 8 <= n; i += 8) {
+      _mm256_storeu_ps(out + i, dequantize_8(i));
+    }
+  }
+#if defined(__F16C__)
+  // Fuses the cast to Half, rounding to nearest even like the scalar path.
+  if constexpr (std::is_same_v<CTYPE_OUT, executorch::aten::Half>) {
+    for (; i + 8 <= n; i += 8) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + i),
+          _mm256_cvtps_ph(dequantize_8(i), _MM_FROUND_TO_NEAREST_INT));
+    }
+  }
+#endif
+#endif
+  for (; i < n; ++i) {
+    const float q = static_cast<float>(w[i]) - offset;
+    out[i] = static_cast<CTYPE_OUT>((q - zero_point) * scale);
+  }
+}
+
+} // namespace xbit
+} // namespace native
+} // namespace executor
+} // namespace torch
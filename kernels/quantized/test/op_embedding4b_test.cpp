@@ -154,3 +154,67 @@ TEST(OpQuantizedEmbedding4bTest, TestGroupWiseQuantizedEmbeddingDeath2) {
           out),
       "");
 }
+
+TEST(OpQuantizedEmbedding4bTest, TestWideRowsMatchReference) {
+  et_pal_init();
+  TensorFactory<ScalarType::Byte> tfb;
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Half> tfh;
+  TensorFactory<ScalarType::Long> tfl;
+
+  // Rows wide enough to take the vectorized paths, with groups that end in a
+  // partial vector.
+  const int32_t num_rows = 4;
+  const int32_t embedding_dim = 600;
+  const int32_t num_groups = 3;
+  const int32_t group_size = embedding_dim / num_groups;
+
+  std::vector<uint8_t> packed(num_rows * embedding_dim / 2);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    packed[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  std::vector<float> scales(num_rows * num_groups);
+  std::vector<float> zero_points(num_rows * num_groups);
+  for (size_t i = 0; i < scales.size(); ++i) {
+    scales[i] = 0.25f * static_cast<float>(i + 1);
+    zero_points[i] = static_cast<float>(static_cast<int32_t>(i % 5) - 2);
+  }
+  const std::vector<int64_t> index_data = {3, 0, 2, 3, 1};
+
+  std::vector<float> expected_data;
+  for (int64_t index : index_data) {
+    for (int32_t j = 0; j < embedding_dim; ++j) {
+      const uint8_t byte = packed[index * embedding_dim / 2 + j / 2];
+      const int32_t q = ((j % 2 == 0) ? (byte >> 4) : (byte & 0x0F)) - 8;
+      const int32_t g = index * num_groups + j / group_size;
+      expected_data.push_back(
+          (static_cast<float>(q) - zero_points[g]) * scales[g]);
+    }
+  }
+
+  Tensor qweight = tfb.make({num_rows, embedding_dim / 2}, packed);
+  Tensor weight_scales = tf.make({num_rows, num_groups}, scales);
+  Tensor weight_zero_points = tf.make({num_rows, num_groups}, zero_points);
+  Tensor indices = tfl.make({5}, index_data);
+  const std::vector<int32_t> out_sizes = {5, embedding_dim};
+
+  Tensor out = tf.zeros(out_sizes);
+  quantized_embedding_4bit_out(
+      qweight, weight_scales, weight_zero_points, -8, 7, indices, out);
+  EXPECT_TENSOR_EQ(out, tf.make(out_sizes, expected_data));
+
+  // The cast to Half is fused into the dequantization.
+  Tensor out_half = tfh.zeros(out_sizes);
+  torch::executor::native::quantized_embedding_4bit_dtype_out(
+      qweight,
+      weight_scales,
+      weight_zero_points,
+      -8,
+      7,
+      indices,
+      ScalarType::Half,
+      out_half);
+  std::vector<executorch::aten::Half> expected_half(
+      expected_data.begin(), expected_data.end());
+  EXPECT_TENSOR_EQ(out_half, tfh.make(out_sizes, expected_half));
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/kernels/quantized/NativeFunctions.h> // Declares the operator
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
+#include <executorch/runtime/core/memory_allocator.h>
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::ET_RUNTIME_NAMESPACE::KernelRuntimeContext;
+using executorch::runtime::Error;
+using executorch::runtime::MemoryAllocator;
+using std::optional;
+using torch::executor::native::quantized_linear_2bit_dynamic_out;
+using torch::executor::native::quantized_linear_2bit_out;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+// Packs values in [-2, 1] four per byte, the first element in the low bits.
+std::vector<uint8_t> pack_2bit(const std::vector<int32_t>& values) {
+  std::vector<uint8_t> packed(values.size() / 4);
+  for (size_t i = 0; i < packed.size(); ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      packed[i] |= (values[4 * i + j] + 2) << (2 * j);
+    }
+  }
+  return packed;
+}
+
+// in @ ((q - zp) * scale).T, computed naively.
+std::vector<float> reference_linear(
+    const std::vector<float>& in,
+    const std::vector<int32_t>& q,
+    const std::vector<float>& scales,
+    const std::vector<float>& zero_points,
+    int32_t m,
+    int32_t n,
+    int32_t k,
+    int32_t num_groups) {
+  const int32_t group_size = k / num_groups;
+  std::vector<float> out(m * n, 0.0f);
+  for (int32_t i = 0; i < m; ++i) {
+    for (int32_t j = 0; j < n; ++j) {
+      double sum = 0;
+      for (int32_t kk = 0; kk < k; ++kk) {
+        const int32_t g = j * num_groups + kk / group_size;
+        sum += in[i * k + kk] *
+            ((q[j * k + kk] - zero_points[g]) * static_cast<double>(scales[g]));
+      }
+      out[i * n + j] = static_cast<float>(sum);
+    }
+  }
+  return out;
+}
+
+struct RandomProblem {
+  std::vector<float> in;
+  std::vector<int32_t> q;
+  std::vector<float> scales;
+  std::vector<float> zero_points;
+};
+
+RandomProblem
+make_random_problem(int32_t m, int32_t n, int32_t k, int32_t num_groups) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> in_dist(-2.0f, 2.0f);
+  std::uniform_int_distribution<int32_t> q_dist(-2, 1);
+  std::uniform_real_distribution<float> scale_dist(0.01f, 0.1f);
+  std::uniform_int_distribution<int32_t> zp_dist(-2, 2);
+  RandomProblem p;
+  p.in.resize(m * k);
+  p.q.resize(n * k);
+  p.scales.resize(n * num_groups);
+  p.zero_points.resize(n * num_groups);
+  for (auto& v : p.in) {
+    v = in_dist(gen);
+  }
+  for (auto& v : p.q) {
+    v = q_dist(gen);
+  }
+  for (auto& v : p.scales) {
+    v = scale_dist(gen);
+  }
+  for (auto& v : p.zero_points) {
+    v = static_cast<float>(zp_dist(gen));
+  }
+  return p;
+}
+
+} // namespace
+
+class OpQuantizedLinear2bTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Since these tests cause ET_LOG to be called, the PAL must be initialized
+    // first.
+    et_pal_init();
+  }
+
+  TensorFactory<ScalarType::Byte> tfb_;
+  TensorFactory<ScalarType::Float> tf_;
+};
+
+TEST_F(OpQuantizedLinear2bTest, PerChannel) {
+  // -2,  1,  0, 1, -> 0, 3, 2, 3 -> (reverse) 11 10 11 00 -> 236
+  //  0, -1, -2, 0, -> 2, 1, 0, 2 -> (reverse) 10 00 01 10 -> 134
+  // -2, -1,  0, 1, -> 0, 1, 2, 3 -> (reverse) 11 10 01 00 -> 228
+  Tensor qweight = tfb_.make({3, 1}, {236, 134, 228});
+  Tensor weight_scales = tf_.make({3}, {0.5, 1.0, 1.5});
+  Tensor weight_zero_points = tf_.make({3}, {1, -2, 0});
+  /*
+  fp_weight = [-1.5,  0.0, -0.5, 0.0,
+                2.0,  1.0,  0.0, 2.0,
+               -3.0, -1.5,  0.0, 1.5]
+  */
+  Tensor input = tf_.make({2, 4}, {1.0, 2.0, 3.0, 4.0, -1.0, 0.0, 0.5, 2.0});
+
+  Tensor out = tf_.zeros({2, 3});
+  Tensor expected = tf_.make({2, 3}, {-3.0, 12.0, 0.0, 1.25, 2.0, 6.0});
+
+  quantized_linear_2bit_out(
+      input, qweight, weight_scales, weight_zero_points, -2, 1, out);
+  EXPECT_TENSOR_EQ(out, expected);
+
+  out = tf_.zeros({2, 3});
+  KernelRuntimeContext context{};
+  quantized_linear_2bit_out(
+      context, input, qweight, weight_scales, weight_zero_points, -2, 1, out);
+  EXPECT_EQ(context.failure_state(), Error::Ok);
+  EXPECT_TENSOR_EQ(out, expected);
+}
+
+TEST_F(OpQuantizedLinear2bTest, MatchesReference) {
+  // Shapes that exercise partial row, column and k tiles, and groups that
+  // don't start on a vector boundary.
+  const int32_t m = 11;
+  const int32_t n = 37;
+  const int32_t k = 1000;
+  const int32_t num_groups = 4;
+  RandomProblem p = make_random_problem(m, n, k, num_groups);
+
+  Tensor input = tf_.make({m, k}, p.in);
+  Tensor qweight = tfb_.make({n, k / 4}, pack_2bit(p.q));
+  Tensor weight_scales = tf_.make({n, num_groups}, p.scales);
+  Tensor weight_zero_points = tf_.make({n, num_groups}, p.zero_points);
+  Tensor expected = tf_.make(
+      {m, n},
+      reference_linear(
+          p.in, p.q, p.scales, p.zero_points, m, n, k, num_groups));
+
+  Tensor out = tf_.zeros({m, n});
+  quantized_linear_2bit_out(
+      input, qweight, weight_scales, weight_zero_points, -2, 1, out);
+  EXPECT_TENSOR_CLOSE_WITH_TOL(out, expected, 1e-4, 1e-4);
+
+  TensorFactory<ScalarType::Half> tfh;
+  std::vector<executorch::aten::Half> in_half(p.in.begin(), p.in.end());
+  Tensor out_half = tfh.zeros({m, n});
+  quantized_linear_2bit_out(
+      tfh.make({m, k}, in_half),
+      qweight,
+      weight_scales,
+      weight_zero_points,
+      -2,
+      1,
+      out_half);
+  const float* expected_data = expected.const_data_ptr<float>();
+  std::vector<executorch::aten::Half> expected_half(
+      expected_data, expected_data + m * n);
+  EXPECT_TENSOR_CLOSE_WITH_TOL(
+      out_half, tfh.make({m, n}, expected_half), 1e-2, 5e-2);
+}
+
+TEST_F(OpQuantizedLinear2bTest, Dynamic) {
+  const int32_t m = 5;
+  const int32_t n = 19;
+  const int32_t k = 256;
+  const int32_t num_groups = 2;
+  RandomProblem p = make_random_problem(m, n, k, num_groups);
+
+  Tensor input = tf_.make({m, k}, p.in);
+  Tensor qweight = tfb_.make({n, k / 4}, pack_2bit(p.q));
+  Tensor weight_scales = tf_.make({n, num_groups}, p.scales);
+  Tensor weight_zero_points = tf_.make({n, num_groups}, p.zero_points);
+  Tensor expected = tf_.make(
+      {m, n},
+      reference_linear(
+          p.in, p.q, p.scales, p.zero_points, m, n, k, num_groups));
+
+  // @lint-ignore CLANGTIDY facebook-hte-CArray
+  uint8_t temp_buffer[4096];
+  MemoryAllocator allocator(sizeof(temp_buffer), temp_buffer);
+  KernelRuntimeContext context(nullptr, &allocator);
+
+  Tensor out = tf_.zeros({m, n});
+  quantized_linear_2bit_dynamic_out(
+      context, input, qweight, weight_scales, weight_zero_points, -2, 1, out);
+  EXPECT_EQ(context.failure_state(), Error::Ok);
+  // The input is quantized to int8, which costs up to half a step of 2/127
+  // per element.
+  EXPECT_TENSOR_CLOSE_WITH_TOL(out, expected, 2e-2, 0.15);
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/**
+ * Micro-benchmark for the quantize, dequantize and choose_qparams kernels, on
+ * the shapes that dynamically quantized linear layers feed them.
+ *
+ * Usage: quantized_ops_benchmark [iterations]
+ *
+ * Prints the median time per call and the effective memory bandwidth for
+ * each kernel and shape.
+ */
+
+#include <executorch/kernels/quantized/NativeFunctions.h> // Declares the operator
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using torch::executor::native::choose_qparams_per_token_asymmetric_out;
+using torch::executor::native::choose_qparams_tensor_out;
+using torch::executor::native::dequantize_per_channel_out;
+using torch::executor::native::dequantize_per_tensor_out;
+using torch::executor::native::dequantize_per_token_out;
+using torch::executor::native::quantize_per_channel_out;
+using torch::executor::native::quantize_per_tensor_out;
+using torch::executor::native::quantize_per_token_out;
+using torch::executor::testing::TensorFactory;
+
+namespace {
+
+struct Shape {
+  int32_t rows;
+  int32_t cols;
+};
+
+// Activations of a single token, a short prompt and a long prompt, and a
+// weight-sized matrix.
+const Shape kShapes[] = {{1, 4096}, {32, 4096}, {512, 4096}, {4096, 4096}};
+
+template <typename Fn>
+double median_us(int iterations, const Fn& fn) {
+  // Warm up caches and the threadpool.
+  fn();
+  std::vector<double> times(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    times[i] = std::chrono::duration<double, std::micro>(end - start).count();
+  }
+  std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+  return times[iterations / 2];
+}
+
+void report(const char* name, const Shape& shape, double us, size_t bytes) {
+  printf(
+      "%-36s %5" PRId32 " x %-5" PRId32 " %10.2f us %8.2f GB/s\n",
+      name,
+      shape.rows,
+      shape.cols,
+      us,
+      static_cast<double>(bytes) / (us * 1e3));
+}
+
+void bench_shape(const Shape& shape, int iterations) {
+  TensorFactory<ScalarType::Float> tf;
+  TensorFactory<ScalarType::Char> tfc;
+  TensorFactory<ScalarType::Double> tfd;
+  TensorFactory<ScalarType::Long> tfl;
+
+  const std::vector<int32_t> sizes = {shape.rows, shape.cols};
+  const size_t numel = static_cast<size_t>(shape.rows) * shape.cols;
+  std::vector<float> data(numel);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+  for (auto& v : data) {
+    v = dist(gen);
+  }
+
+  Tensor input = tf.make(sizes, data);
+  Tensor quantized = tfc.zeros(sizes);
+  Tensor dequantized = tf.zeros(sizes);
+  Tensor scale = tfd.zeros({1});
+  Tensor zero_point = tfl.zeros({1});
+  Tensor token_scales = tfd.zeros({shape.rows, 1});
+  Tensor token_zero_points = tfl.zeros({shape.rows, 1});
+  Tensor channel_scales = tfd.full({shape.rows}, 0.03);
+  Tensor channel_zero_points = tfl.zeros({shape.rows});
+
+  const size_t float_bytes = numel * sizeof(float);
+  const size_t int8_bytes = numel * sizeof(int8_t);
+
+  double us = median_us(iterations, [&]() {
+    choose_qparams_tensor_out(
+        input, -128, 127, 1e-7, ScalarType::Char, scale, zero_point);
+  });
+  report("choose_qparams.Tensor_out", shape, us, float_bytes);
+
+  us = median_us(iterations, [&]() {
+    quantize_per_tensor_out(
+        input, 0.03, 0, -128, 127, ScalarType::Char, quantized);
+  });
+  report("quantize_per_tensor.out", shape, us, float_bytes + int8_bytes);
+
+  us = median_us(iterations, [&]() {
+    dequantize_per_tensor_out(
+        quantized, 0.03, 0, -128, 127, ScalarType::Char, {}, dequantized);
+  });
+  report("dequantize_per_tensor.out", shape, us, float_bytes + int8_bytes);
+
+  us = median_us(iterations, [&]() {
+    choose_qparams_per_token_asymmetric_out(
+        input, ScalarType::Float, token_scales, token_zero_points);
+  });
+  report("choose_qparams_per_token_asymmetric", shape, us, float_bytes);
+
+  us = median_us(iterations, [&]() {
+    quantize_per_token_out(
+        input,
+        token_scales,
+        token_zero_points,
+        -128,
+        127,
+        ScalarType::Char,
+        quantized);
+  });
+  report("quantize_per_token.out", shape, us, float_bytes + int8_bytes);
+
+  us = median_us(iterations, [&]() {
+    dequantize_per_token_out(
+        quantized,
+        token_scales,
+        token_zero_points,
+        -128,
+        127,
+        ScalarType::Char,
+        ScalarType::Float,
+        dequantized);
+  });
+  report("dequantize_per_token.out", shape, us, float_bytes + int8_bytes);
+
+  us = median_us(iterations, [&]() {
+    quantize_per_channel_out(
+        input,
+        channel_scales,
+        channel_zero_points,
+        0,
+        -128,
+        127,
+        ScalarType::Char,
+        quantized);
+  });
+  report("quantize_per_channel.out", shape, us, float_bytes + int8_bytes);
+
+  us = median_us(iterations, [&]() {
+    dequantize_per_channel_out(
+        quantized,
+        channel_scales,
+        channel_zero_points,
+        0,
+        -128,
+        127,
+        ScalarType::Char,
+        {},
+        dequantized);
+  });
+  report("dequantize_per_channel.out", shape, us, float_bytes + int8_bytes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  executorch::runtime::runtime_init();
+  const int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 50;
+  for (const auto& shape : kShapes) {
+    bench_shape(shape, iterations);
+  }
+  return 0;
+}
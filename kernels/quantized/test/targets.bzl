@@ -1,3 +1,4 @@
+load("@fbsource//xplat/executorch/build:runtime_wrapper.bzl", "runtime")
 load("@fbsource//xplat/executorch/kernels/test:util.bzl", "define_supported_features_lib", "op_test")
 
 def define_common_targets():
@@ -27,6 +28,8 @@ def define_common_targets():
     ])
     op_test("op_embedding2b_test", kernel_name = "quantized")
     op_test("op_embedding4b_test", kernel_name = "quantized")
+    op_test("op_linear2b_test", kernel_name = "quantized")
+    op_test("op_linear4b_test", kernel_name = "quantized")
     op_test("op_mixed_mm_test", kernel_name = "quantized", deps = [
         "//executorch/kernels/quantized/cpu:op_mixed_mm",
         "//executorch/kernels/quantized:generated_lib_headers",
@@ -39,3 +42,16 @@ def define_common_targets():
         "//executorch/kernels/portable:generated_lib_headers",
         "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
     ])
+
+    runtime.cxx_binary(
+        name = "quantized_ops_benchmark",
+        srcs = ["quantized_ops_benchmark.cpp"],
+        deps = [
+            "//executorch/kernels/quantized/cpu:op_choose_qparams",
+            "//executorch/kernels/quantized/cpu:op_dequantize",
+            "//executorch/kernels/quantized/cpu:op_quantize",
+            "//executorch/kernels/quantized:generated_lib_headers",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/platform:platform",
+        ],
+    )
@@ -16,6 +16,10 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
 
 using namespace ::testing;
 using executorch::aten::IntArrayRef;
@@ -174,3 +178,135 @@ TEST_F(OpTopkValuesTest, NonPartialSort) {
     EXPECT_TENSOR_EQ(indices, indices_expected);
   }
 }
+
+namespace {
+
+// topk computed by sorting every row: larger first (smaller first if
+// !largest), NaN above everything, ties broken by lower index.
+template <typename CTYPE>
+void reference_topk(
+    const std::vector<CTYPE>& in,
+    int64_t outer,
+    int64_t n,
+    int64_t inner,
+    int64_t k,
+    bool largest,
+    std::vector<CTYPE>& values,
+    std::vector<int64_t>& indices) {
+  values.resize(outer * k * inner);
+  indices.resize(outer * k * inner);
+  std::vector<int64_t> order(n);
+  for (int64_t o = 0; o < outer; ++o) {
+    for (int64_t i = 0; i < inner; ++i) {
+      const auto at = [&](int64_t j) {
+        return static_cast<double>(in[(o * n + j) * inner + i]);
+      };
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+        const double x = at(a);
+        const double y = at(b);
+        if (std::isnan(x) || std::isnan(y)) {
+          return largest ? !std::isnan(y) : !std::isnan(x);
+        }
+        return largest ? x > y : x < y;
+      });
+      for (int64_t j = 0; j < k; ++j) {
+        values[(o * k + j) * inner + i] = in[(o * n + order[j]) * inner + i];
+        indices[(o * k + j) * inner + i] = order[j];
+      }
+    }
+  }
+}
+
+} // namespace
+
+TEST_F(OpTopkValuesTest, LargeRowsMatchReference) {
+  TensorFactory<ScalarType::Float> tfFloat;
+  TensorFactory<ScalarType::Long> tfLong;
+
+  struct Case {
+    int64_t outer;
+    int64_t n;
+    int64_t inner;
+    int64_t k;
+  };
+  // Short rows, small k, large k, many rows and rows long enough to be
+  // split, along the last dim and along an inner one.
+  const Case cases[] = {
+      {64, 100, 1, 3},
+      {8, 3000, 1, 5},
+      {4, 5000, 1, 200},
+      {4, 5000, 1, 600},
+      {512, 300, 1, 20},
+      {2, 3000, 3, 40},
+      {1, 40000, 1, 10},
+      {1, 70000, 1, 300},
+      {1, 2000, 1, 2000},
+  };
+
+  std::mt19937 gen(7);
+  // Few distinct values, so ties are common.
+  std::uniform_int_distribution<int> dist(-200, 200);
+  for (const Case& c : cases) {
+    std::vector<float> data(c.outer * c.n * c.inner);
+    for (auto& v : data) {
+      v = static_cast<float>(dist(gen)) * 0.25f;
+    }
+    data[data.size() / 3] = NAN;
+    const std::vector<int32_t> in_sizes = {
+        static_cast<int32_t>(c.outer),
+        static_cast<int32_t>(c.n),
+        static_cast<int32_t>(c.inner)};
+    const std::vector<int32_t> out_sizes = {
+        static_cast<int32_t>(c.outer),
+        static_cast<int32_t>(c.k),
+        static_cast<int32_t>(c.inner)};
+    Tensor input = tfFloat.make(in_sizes, data);
+    for (const bool largest : {true, false}) {
+      std::vector<float> expected_values;
+      std::vector<int64_t> expected_indices;
+      reference_topk(
+          data,
+          c.outer,
+          c.n,
+          c.inner,
+          c.k,
+          largest,
+          expected_values,
+          expected_indices);
+      Tensor values = tfFloat.zeros(out_sizes);
+      Tensor indices = tfLong.zeros(out_sizes);
+      op_topk_values(input, c.k, 1, largest, true, values, indices);
+      EXPECT_TENSOR_EQ(values, tfFloat.make(out_sizes, expected_values));
+      EXPECT_TENSOR_EQ(indices, tfLong.make(out_sizes, expected_indices));
+    }
+  }
+}
+
+TEST_F(OpTopkValuesTest, HalfLargeRowMatchesReference) {
+  TensorFactory<ScalarType::Half> tfHalf;
+  TensorFactory<ScalarType::Long> tfLong;
+
+  const int64_t n = 50000;
+  const int64_t k = 100;
+  std::mt19937 gen(3);
+  std::uniform_int_distribution<int> dist(-3000, 3000);
+  std::vector<executorch::aten::Half> data(n);
+  for (auto& v : data) {
+    v = executorch::aten::Half(static_cast<float>(dist(gen)) * 0.5f);
+  }
+  data[17] = executorch::aten::Half(NAN);
+
+  Tensor input = tfHalf.make({static_cast<int32_t>(n)}, data);
+  for (const bool largest : {true, false}) {
+    std::vector<executorch::aten::Half> expected_values;
+    std::vector<int64_t> expected_indices;
+    reference_topk(
+        data, 1, n, 1, k, largest, expected_values, expected_indices);
+    Tensor values = tfHalf.zeros({k});
+    Tensor indices = tfLong.zeros({k});
+    op_topk_values(input, k, 0, largest, true, values, indices);
+    EXPECT_TENSOR_EQ(values, tfHalf.make({k}, expected_values));
+    EXPECT_TENSOR_EQ(indices, tfLong.make({k}, expected_indices));
+  }
+}
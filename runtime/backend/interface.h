@@ -51,6 +51,17 @@ class BackendInterface {
    */
   ET_NODISCARD virtual bool is_available() const = 0;
 
+  /**
+   * Returns true if init() may be called for several delegates of this backend
+   * at the same time, from different threads. The runtime then initializes
+   * them concurrently when a Method is loaded with a parallel_for. init() may
+   * allocate from the context's runtime allocator and read from its named data
+   * map from any thread; the runtime serializes access to the allocator.
+   */
+  ET_NODISCARD virtual bool is_init_thread_safe() const {
+    return false;
+  }
+
   /**
    * Responsible to further process (compile/transform/optimize) the compiled
    * unit that was produced, ahead-of-time, as well as perform any backend
@@ -142,6 +153,7 @@ class BackendInterface {
    *     `init()`.
    */
   virtual void destroy(ET_UNUSED DelegateHandle* handle) const {}
+
 };
 
 /**
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace executorch {
+namespace runtime {
+
+/**
+ * Interface for allocators that hand out and take back individual blocks at
+ * execution time, unlike MemoryAllocator which only allocates until it is
+ * reset.
+ *
+ * The runtime uses a DynamicAllocator to back the data of DYNAMIC_UNBOUND
+ * tensors, which have no memory-planned buffer: a tensor gets a block when it
+ * is resized past the capacity of its current block, and gives it back when
+ * its last use has passed.
+ */
+class DynamicAllocator {
+ public:
+  virtual ~DynamicAllocator() = default;
+
+  /**
+   * Allocates a block of at least `size` bytes.
+   *
+   * @param[in] size The number of bytes needed.
+   * @param[out] capacity The usable size of the returned block, which may be
+   *     larger than `size`. Must be passed back to free().
+   *
+   * @returns The block, aligned to at least alignof(std::max_align_t), or
+   *     nullptr if the allocation failed.
+   */
+  virtual void* allocate(size_t size, size_t* capacity) = 0;
+
+  /**
+   * Returns a block obtained from allocate().
+   *
+   * @param[in] ptr The block to return.
+   * @param[in] capacity The capacity reported by allocate() for this block.
+   */
+  virtual void free(void* ptr, size_t capacity) = 0;
+
+  /**
+   * Returns true if a tensor that now needs `size` bytes should move out of
+   * its block of `capacity` bytes into a smaller one, so that a tensor that
+   * was once large does not keep a large block for the rest of its life.
+   */
+  virtual bool should_shrink(size_t size, size_t capacity) const {
+    (void)size;
+    (void)capacity;
+    return false;
+  }
+};
+
+} // namespace runtime
+} // namespace executorch
@@ -193,7 +193,8 @@ ET_NODISCARD Error set_tensor_data(
 }
 
 void reset_data_ptr(const torch::executor::Tensor& tensor) {
-  // Lean mode doesn't deallocate the tensor data_ptr in the allocator
+  // Planned memory is never deallocated in lean mode. Data that came from the
+  // tensor's dynamic allocator is returned to it by set_data().
   tensor.unsafeGetTensorImpl()->set_data(nullptr);
 }
 
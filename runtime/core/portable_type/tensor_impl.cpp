@@ -91,7 +91,7 @@ Error TensorImpl::internal_resize_contiguous(ArrayRef<SizesType> new_sizes) {
   // number of dimensions, it must be that the provided out tensor has zero
   // rank, therefore it already has the right size and we should just return.
   if (dim_ == 0) {
-    return Error::Ok;
+    return data_allocator_ != nullptr ? reserve_data(1) : Error::Ok;
   }
 
   switch (shape_dynamism_) {
@@ -114,17 +114,27 @@ Error TensorImpl::internal_resize_contiguous(ArrayRef<SizesType> new_sizes) {
 
       break;
     case TensorShapeDynamism::DYNAMIC_BOUND:
-      // TODO(T175194371): Unbounded dynamic tensor resizing is not yet
-      // supported: treat them as upper-bounded.
     case TensorShapeDynamism::DYNAMIC_UNBOUND: {
+      // Kernels resize their outputs on every call, and with recurring input
+      // shapes most calls keep the current shape.
+      if (std::equal(sizes_, sizes_ + dim_, new_sizes.begin()) &&
+          (data_allocator_ == nullptr || data_ != nullptr)) {
+        return Error::Ok;
+      }
       const auto new_numel = compute_numel(new_sizes.data(), dim_);
 
-      ET_CHECK_OR_RETURN_ERROR(
-          static_cast<size_t>(new_numel) <= numel_bound_,
-          NotSupported,
-          "Attempted to resize a bounded tensor with a maximum capacity of %zu elements to %zu elements.",
-          numel_bound_,
-          new_numel);
+      // Unbounded tensors with a data allocator grow into a new block;
+      // without one, they are treated as upper-bounded.
+      if (data_allocator_ != nullptr) {
+        ET_CHECK_OK_OR_RETURN_ERROR(reserve_data(new_numel));
+      } else {
+        ET_CHECK_OR_RETURN_ERROR(
+            static_cast<size_t>(new_numel) <= numel_bound_,
+            NotSupported,
+            "Attempted to resize a bounded tensor with a maximum capacity of %zu elements to %zu elements.",
+            numel_bound_,
+            new_numel);
+      }
 
       if (strides_ && dim_order_) {
         auto error =
@@ -140,6 +150,38 @@ Error TensorImpl::internal_resize_contiguous(ArrayRef<SizesType> new_sizes) {
   return Error::Ok;
 }
 
+Error TensorImpl::reserve_data(size_t numel) {
+  const size_t nbytes = numel * elementSize(type_);
+  if (nbytes == 0) {
+    return Error::Ok;
+  }
+  const bool fits = data_ != nullptr && numel <= numel_bound_;
+  if (fits &&
+      (data_capacity_ == 0 ||
+       !data_allocator_->should_shrink(nbytes, data_capacity_))) {
+    return Error::Ok;
+  }
+  size_t capacity = 0;
+  void* data = data_allocator_->allocate(nbytes, &capacity);
+  ET_CHECK_OR_RETURN_ERROR(
+      data != nullptr,
+      MemoryAllocationFailed,
+      "Failed to allocate %zu bytes for an unbounded tensor",
+      nbytes);
+  set_data(data);
+  data_capacity_ = capacity;
+  numel_bound_ = capacity / elementSize(type_);
+  return Error::Ok;
+}
+
+void TensorImpl::release_data() {
+  data_allocator_->free(data_, data_capacity_);
+  data_ = nullptr;
+  data_capacity_ = 0;
+  // Data set from outside is only known to hold the current shape.
+  numel_bound_ = numel_;
+}
+
 } // namespace etensor
 } // namespace runtime
 } // namespace executorch
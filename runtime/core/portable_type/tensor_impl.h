@@ -9,6 +9,7 @@
 #pragma once
 
 #include <executorch/runtime/core/array_ref.h>
+#include <executorch/runtime/core/dynamic_allocator.h>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/portable_type/scalar_type.h>
 #include <executorch/runtime/core/tensor_shape_dynamism.h>
@@ -198,11 +199,37 @@ class TensorImpl {
     return data_;
   }
 
-  /// Sets the underlying data blob to the passed in pointer.
+  /**
+   * Sets the underlying data blob to the passed in pointer. If the current
+   * data came from the tensor's data allocator, it is returned to it.
+   */
   void set_data(void* ptr) {
+    if (data_capacity_ != 0) {
+      release_data();
+    }
     data_ = ptr;
   }
 
+  /**
+   * Lets a DYNAMIC_UNBOUND tensor grow past the capacity of its current data:
+   * when it is resized to more elements than its data can hold, or while it
+   * has no data, it takes a new block from `allocator`. The contents of the
+   * tensor are unspecified after it moves to a new block.
+   *
+   * The allocator must outlive the tensor's use of its blocks. Has no effect
+   * on tensors with other dynamism, which can never grow past their bound.
+   */
+  void set_data_allocator(DynamicAllocator* allocator) {
+    if (shape_dynamism_ == TensorShapeDynamism::DYNAMIC_UNBOUND) {
+      data_allocator_ = allocator;
+    }
+  }
+
+  /// Returns the allocator set by set_data_allocator(), if any.
+  DynamicAllocator* data_allocator() const {
+    return data_allocator_;
+  }
+
   /*
    * DEPRECATED: Use torch::executor::resize_tensor() or
    * torch::executor::resize_tensor_impl().
@@ -231,6 +258,15 @@ class TensorImpl {
    */
   ET_NODISCARD Error internal_resize_contiguous(ArrayRef<SizesType> new_sizes);
 
+  /**
+   * Makes sure that the data of a tensor with a data allocator can hold
+   * `numel` elements, moving it to a new block if needed.
+   */
+  ET_NODISCARD Error reserve_data(size_t numel);
+
+  /// Returns the current data to the data allocator.
+  void release_data();
+
  private:
   // Keep fields arranged to avoid unnecessary alignment holes.
 
@@ -246,6 +282,12 @@ class TensorImpl {
   /// Pointer to underlying data blob. NOTE: Can be null.
   void* data_;
 
+  /// Allocator that DYNAMIC_UNBOUND tensors grow from. NOTE: Can be null.
+  DynamicAllocator* data_allocator_ = nullptr;
+
+  /// Capacity in bytes of `data_` if it came from `data_allocator_`, else 0.
+  size_t data_capacity_ = 0;
+
   /// Tensor's number of dimensions.
   const ssize_t dim_;
 
@@ -10,6 +10,7 @@
 #include <executorch/runtime/core/portable_type/tensor_impl.h>
 
 #include <gtest/gtest.h>
+#include <cstdlib>
 #include <random>
 
 #include <executorch/runtime/core/exec_aten/util/tensor_util.h>
@@ -19,6 +20,7 @@
 using namespace ::testing;
 
 using executorch::runtime::ArrayRef;
+using executorch::runtime::DynamicAllocator;
 using executorch::runtime::Error;
 using executorch::runtime::TensorShapeDynamism;
 using executorch::runtime::etensor::ScalarType;
@@ -262,13 +264,116 @@ TEST_F(TensorImplTest, TestSetSizesContigUnbounded) {
   err = resize_tensor_impl(&t, {new_sizes_4, 1});
   EXPECT_NE(err, Error::Ok);
 
-  // TODO(T175194371): For now, we can't resize past the original capacity.
-  // Once we can, this test should check for that ability.
-
   SizesType new_sizes_3[2] = {4, 2};
-  // Can't execeed original capacity.
+  // Without a data allocator, can't execeed original capacity.
+  err = resize_tensor_impl(&t, {new_sizes_3, 2});
+  EXPECT_NE(err, Error::Ok);
+}
+
+namespace {
+// Allocates exactly the requested size, and tracks the blocks in use.
+class CountingAllocator final : public DynamicAllocator {
+ public:
+  void* allocate(size_t size, size_t* capacity) override {
+    if (fail_) {
+      return nullptr;
+    }
+    ++num_allocated_;
+    in_use_bytes_ += size;
+    *capacity = size;
+    return std::malloc(size);
+  }
+  void free(void* ptr, size_t capacity) override {
+    ++num_freed_;
+    in_use_bytes_ -= capacity;
+    std::free(ptr);
+  }
+  bool should_shrink(size_t size, size_t capacity) const override {
+    return size * 4 <= capacity;
+  }
+
+  bool fail_ = false;
+  size_t num_allocated_ = 0;
+  size_t num_freed_ = 0;
+  size_t in_use_bytes_ = 0;
+};
+} // namespace
+
+TEST_F(TensorImplTest, TestSetSizesContigUnboundedWithAllocator) {
+  SizesType sizes[2] = {3, 2};
+  DimOrderType dim_order[2] = {0, 1};
+  StridesType strides[2] = {2, 1};
+  TensorImpl t(
+      ScalarType::Float,
+      2,
+      sizes,
+      /*data=*/nullptr,
+      dim_order,
+      strides,
+      TensorShapeDynamism::DYNAMIC_UNBOUND);
+  CountingAllocator allocator;
+  t.set_data_allocator(&allocator);
+  EXPECT_EQ(t.data_allocator(), &allocator);
+
+  // A tensor without data gets a block even if its size doesn't change.
+  SizesType new_sizes_1[2] = {3, 2};
+  Error err = resize_tensor_impl(&t, {new_sizes_1, 2});
+  EXPECT_EQ(err, Error::Ok);
+  ASSERT_NE(t.mutable_data(), nullptr);
+  EXPECT_EQ(allocator.in_use_bytes_, 6 * sizeof(float));
+
+  // Growing past the capacity moves to a bigger block.
+  SizesType new_sizes_2[2] = {40, 2};
+  err = resize_tensor_impl(&t, {new_sizes_2, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(t.numel(), 80);
+  EXPECT_EQ(t.strides()[0], 2);
+  EXPECT_EQ(allocator.num_allocated_, 2);
+  EXPECT_EQ(allocator.num_freed_, 1);
+  EXPECT_EQ(allocator.in_use_bytes_, 80 * sizeof(float));
+  t.mutable_data<float>()[79] = 1.0f;
+
+  // Shrinking a little keeps the block, shrinking a lot moves to a smaller one.
+  SizesType new_sizes_3[2] = {30, 2};
   err = resize_tensor_impl(&t, {new_sizes_3, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(allocator.num_allocated_, 2);
+  SizesType new_sizes_4[2] = {5, 2};
+  err = resize_tensor_impl(&t, {new_sizes_4, 2});
+  EXPECT_EQ(err, Error::Ok);
+  EXPECT_EQ(allocator.num_allocated_, 3);
+  EXPECT_EQ(allocator.in_use_bytes_, 10 * sizeof(float));
+
+  // Resetting the data returns the block.
+  t.set_data(nullptr);
+  EXPECT_EQ(allocator.num_freed_, 3);
+  EXPECT_EQ(allocator.in_use_bytes_, 0);
+
+  // Allocation failures are reported.
+  allocator.fail_ = true;
+  err = resize_tensor_impl(&t, {new_sizes_4, 2});
+  EXPECT_EQ(err, Error::MemoryAllocationFailed);
+}
+
+TEST_F(TensorImplTest, TestDataAllocatorOnlyForUnbounded) {
+  SizesType sizes[1] = {4};
+  float data[4] = {};
+  TensorImpl t(
+      ScalarType::Float,
+      1,
+      sizes,
+      data,
+      nullptr,
+      nullptr,
+      TensorShapeDynamism::DYNAMIC_BOUND);
+  CountingAllocator allocator;
+  t.set_data_allocator(&allocator);
+  EXPECT_EQ(t.data_allocator(), nullptr);
+
+  SizesType new_sizes[1] = {8};
+  Error err = resize_tensor_impl(&t, {new_sizes, 1});
   EXPECT_NE(err, Error::Ok);
+  EXPECT_EQ(allocator.num_allocated_, 0);
 }
 
 TEST_F(TensorImplTest, TestDynamicTensorNoStridesDimOrder) {
@@ -39,6 +39,7 @@ def define_common_targets():
             "array_ref.h",  # TODO(T157717874): Migrate all users to span and then move this to portable_type
             "data_loader.h",
             "defines.h",
+            "dynamic_allocator.h",
             "error.h",
             "freeable_buffer.h",
             "function_ref.h",
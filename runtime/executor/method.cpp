@@ -9,10 +9,15 @@
 #include <executorch/runtime/executor/method.h>
 
 #include <c10/util/irange.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cinttypes> // @donotremove
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
 
 #include <executorch/runtime/backend/interface.h>
 #include <executorch/runtime/core/event_tracer_hooks.h>
@@ -21,9 +26,11 @@
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/memory_manager.h>
 #include <executorch/runtime/executor/merged_data_map.h>
+#include <executorch/runtime/executor/method_snapshot.h>
 #include <executorch/runtime/executor/platform_memory_allocator.h>
 #include <executorch/runtime/executor/program.h>
 #include <executorch/runtime/executor/tensor_parser.h>
+#include <executorch/runtime/kernel/elementwise_fusion.h>
 #include <executorch/runtime/kernel/kernel_runtime_context.h>
 #include <executorch/runtime/kernel/operator_registry.h>
 #include <executorch/runtime/platform/assert.h>
@@ -62,6 +69,28 @@ class BackendDelegate final {
       const Program* program,
       BackendInitContext& backend_init_context,
       BackendDelegate* out) {
+    ArrayRef<CompileSpec> compile_specs;
+    Error err = Prepare(
+        delegate, program, backend_init_context, out, &compile_specs);
+    if (err != Error::Ok) {
+      return err;
+    }
+    return InitBackend(backend_init_context, compile_specs, out);
+  }
+
+  /**
+   * The first half of Init(): looks up the backend and loads the delegate data
+   * and compile specs, without calling the backend. On success, `out` must
+   * then be passed to InitBackend() or Abandon().
+   *
+   * @param[out] compile_specs The compile specs to pass to InitBackend().
+   */
+  static Error Prepare(
+      const executorch_flatbuffer::BackendDelegate& delegate,
+      const Program* program,
+      BackendInitContext& backend_init_context,
+      BackendDelegate* out,
+      ArrayRef<CompileSpec>* compile_specs) {
     // Look up the backend.
     ET_CHECK_OR_RETURN_ERROR(
         delegate.id() != nullptr, InvalidProgram, "Missing backend id");
@@ -86,31 +115,42 @@ class BackendDelegate final {
     }
 
     // Parse compilation specs from program
-    CompileSpec* compile_specs;
+    CompileSpec* compile_specs_list;
     Error err = PopulateCompileSpecs(
-        delegate.compile_specs(), backend_init_context, &compile_specs);
+        delegate.compile_specs(), backend_init_context, &compile_specs_list);
     if (err != Error::Ok) {
       ET_LOG(Error, "Failed to get compile specs for backend %s", backend_id);
       return err;
     }
-    size_t num_compile_specs = delegate.compile_specs()->size();
+    *compile_specs = ArrayRef<CompileSpec>(
+        compile_specs_list, delegate.compile_specs()->size());
 
+    out->backend_id_ = backend_id;
     out->backend_ = backend;
     out->handle_ = nullptr;
     // Pass a pointer to this buffer to the backend. It's safe for the backend
     // to point its handle to this object, since it will outlive the backend.
     new (&out->segment_) FreeableBuffer(std::move(processed_data.get()));
+    return Error::Ok;
+  }
 
+  /**
+   * The second half of Init(): calls the backend's init() on a delegate that
+   * Prepare() succeeded on. Only calls the backend, so it may run on another
+   * thread if `backend_init_thread_safe()` is true.
+   */
+  static Error InitBackend(
+      BackendInitContext& backend_init_context,
+      ArrayRef<CompileSpec> compile_specs,
+      BackendDelegate* out) {
     // Initialize the delegate.
-    Result<DelegateHandle*> handle = backend->init(
-        backend_init_context,
-        &out->segment_,
-        ArrayRef<CompileSpec>(compile_specs, num_compile_specs));
+    Result<DelegateHandle*> handle = out->backend_->init(
+        backend_init_context, &out->segment_, compile_specs);
     if (!handle.ok()) {
       ET_LOG(
           Error,
           "Init failed for backend %s: 0x%" PRIx32,
-          backend_id,
+          out->backend_id_,
           static_cast<uint32_t>(handle.error()));
       out->segment_.Free();
       return handle.error();
@@ -119,6 +159,19 @@ class BackendDelegate final {
     return Error::Ok;
   }
 
+  /**
+   * Releases a delegate that Prepare() succeeded on but that will not be
+   * passed to InitBackend().
+   */
+  static void Abandon(BackendDelegate* out) {
+    out->segment_.Free();
+  }
+
+  /// Returns true if InitBackend() may run concurrently with other delegates.
+  bool backend_init_thread_safe() const {
+    return backend_->is_init_thread_safe();
+  }
+
   ~BackendDelegate() {
     if (backend_ != nullptr) {
       backend_->destroy(handle_);
@@ -208,6 +261,7 @@ class BackendDelegate final {
   }
 
   FreeableBuffer segment_;
+  const char* backend_id_;
   const BackendInterface* backend_;
   DelegateHandle* handle_;
 };
@@ -223,10 +277,36 @@ struct Chain {
   Span<InstructionArgs> argument_lists_;
   /// Each instruction will have one kernel (not for delegate).
   OpFunction* kernels_;
+  /// Null if no kernels in this chain were fused. Otherwise, one entry per
+  /// instruction: non-empty at the first instruction of a fused run, whose
+  /// remaining instructions are skipped.
+  Span<const FusedElementwiseStage>* fused_stages_;
 };
 
 namespace {
 
+/**
+ * Serializes calls to another allocator, for backends that initialize
+ * concurrently. Allocations are short, so a spin lock is enough.
+ */
+class SynchronizedMemoryAllocator final : public MemoryAllocator {
+ public:
+  explicit SynchronizedMemoryAllocator(MemoryAllocator* allocator)
+      : MemoryAllocator(0, nullptr), allocator_(allocator) {}
+
+  void* allocate(size_t size, size_t alignment = kDefaultAlignment) override {
+    while (lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    void* ptr = allocator_->allocate(size, alignment);
+    lock_.clear(std::memory_order_release);
+    return ptr;
+  }
+
+ private:
+  MemoryAllocator* allocator_;
+  std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+};
+
 Result<InstructionArgs> gen_instruction_arguments(
     MemoryAllocator* method_allocator,
     size_t num_values,
@@ -739,12 +819,544 @@ Error Method::resolve_operator(
   return Error::Ok;
 }
 
+bool Method::restore_operator(
+    int32_t op_index,
+    OpFunction* kernels,
+    size_t kernel_index,
+    uint32_t registry_index) {
+  const auto ops = serialization_plan_->operators();
+  Span<const Kernel> registered = get_registered_kernels();
+  if (ops == nullptr ||
+      static_cast<flatbuffers::uoffset_t>(op_index) >= ops->size() ||
+      registry_index >= registered.size()) {
+    return false;
+  }
+  constexpr size_t kTempBufferSizeForName = 100;
+  char operator_name[kTempBufferSizeForName];
+  if (populate_operator_name(
+          ops->Get(op_index), kTempBufferSizeForName, operator_name) !=
+      Error::Ok) {
+    return false;
+  }
+  const Kernel& kernel = registered[registry_index];
+  if (strcmp(kernel.name_, operator_name) != 0) {
+    return false;
+  }
+  kernels[kernel_index] = kernel.op_;
+  return true;
+}
+
+namespace {
+
+uint64_t hash_flatbuffer_string(
+    const flatbuffers::String* str,
+    uint64_t seed) {
+  // Include the size so that adjacent strings can't run together.
+  const uint32_t size = str == nullptr ? 0 : str->size();
+  const uint64_t hash = internal::snapshot_hash(&size, sizeof(size), seed);
+  return str == nullptr ? hash
+                        : internal::snapshot_hash(str->c_str(), size, hash);
+}
+
+template <typename T>
+uint64_t hash_flatbuffer_vector(
+    const flatbuffers::Vector<T>* vec,
+    uint64_t seed) {
+  const uint32_t size = vec == nullptr ? 0 : vec->size();
+  const uint64_t hash = internal::snapshot_hash(&size, sizeof(size), seed);
+  return vec == nullptr
+      ? hash
+      : internal::snapshot_hash(vec->data(), size * sizeof(T), hash);
+}
+
+} // namespace
+
+uint64_t Method::snapshot_program_hash() const {
+  // Hashing the whole program could take longer than the lookups that a
+  // snapshot saves, since it may hold constant data. Snapshots only hold the
+  // kernel selected for each instruction, which depends on the operator name
+  // and on the dtypes and dim orders of its arguments, so hash those instead.
+  // Constants and delegate data are deliberately left out: a program with new
+  // weights selects the same kernels, and its delegates are always
+  // initialized from scratch.
+  const uint64_t program_size = program_->program_data_.size();
+  uint64_t hash =
+      internal::snapshot_hash(&program_size, sizeof(program_size), 0);
+  hash = hash_flatbuffer_string(serialization_plan_->name(), hash);
+  const auto ops = serialization_plan_->operators();
+  for (size_t i = 0; ops != nullptr && i < ops->size(); ++i) {
+    hash = hash_flatbuffer_string(ops->Get(i)->name(), hash);
+    hash = hash_flatbuffer_string(ops->Get(i)->overload(), hash);
+  }
+  const auto values = serialization_plan_->values();
+  for (size_t i = 0; values != nullptr && i < values->size(); ++i) {
+    const auto value = values->Get(i);
+    const auto val_type = value->val_type();
+    hash = internal::snapshot_hash(&val_type, sizeof(val_type), hash);
+    const auto tensor = value->val_as_Tensor();
+    if (tensor != nullptr) {
+      const auto scalar_type = tensor->scalar_type();
+      hash = internal::snapshot_hash(&scalar_type, sizeof(scalar_type), hash);
+      hash = hash_flatbuffer_vector(tensor->dim_order(), hash);
+    }
+  }
+  const auto chains = serialization_plan_->chains();
+  for (size_t i = 0; chains != nullptr && i < chains->size(); ++i) {
+    const auto instructions = chains->Get(i)->instructions();
+    for (size_t j = 0; instructions != nullptr && j < instructions->size();
+         ++j) {
+      const auto kernel_call = instructions->Get(j)->instr_args_as_KernelCall();
+      if (kernel_call != nullptr) {
+        const int32_t op_index = kernel_call->op_index();
+        hash = internal::snapshot_hash(&op_index, sizeof(op_index), hash);
+        hash = hash_flatbuffer_vector(kernel_call->args(), hash);
+      }
+    }
+  }
+  return hash;
+}
+
+const uint8_t* Method::validate_snapshot(Span<const uint8_t> snapshot) const {
+  if (snapshot.empty()) {
+    return nullptr;
+  }
+  MethodSnapshotHeader header;
+  if (snapshot.size() < sizeof(header)) {
+    ET_LOG(Info, "Ignoring truncated method snapshot");
+    return nullptr;
+  }
+  memcpy(&header, snapshot.data(), sizeof(header));
+  size_t num_instructions = 0;
+  const auto chains = serialization_plan_->chains();
+  for (size_t i = 0; chains != nullptr && i < chains->size(); ++i) {
+    const auto instructions = chains->Get(i)->instructions();
+    num_instructions += instructions == nullptr ? 0 : instructions->size();
+  }
+  // A snapshot that doesn't match is expected after the program or the
+  // kernels linked into the binary change; the method still loads normally.
+  if (memcmp(header.magic, "ETMS", sizeof(header.magic)) != 0 ||
+      header.version != kMethodSnapshotVersion ||
+      header.num_instructions != num_instructions ||
+      snapshot.size() <
+          sizeof(header) + num_instructions * sizeof(uint32_t) ||
+      header.registry_hash != internal::kernel_registry_hash() ||
+      header.program_hash != snapshot_program_hash()) {
+    ET_LOG(
+        Info,
+        "Ignoring method snapshot that does not match method %s",
+        serialization_plan_->name()->c_str());
+    return nullptr;
+  }
+  return snapshot.data() + sizeof(header);
+}
+
+namespace {
+
+/// Use counts of the values in a method, indexed by value index.
+class ValueUseCounts {
+ public:
+  ValueUseCounts(uint32_t* uses, size_t n_value)
+      : uses_(uses), n_value_(n_value) {
+    memset(uses_, 0, n_value_ * sizeof(uint32_t));
+  }
+
+  void add(int64_t value_index) {
+    // Indices that are not validated at init time are simply ignored; such a
+    // program fails elsewhere.
+    if (value_index >= 0 && static_cast<size_t>(value_index) < n_value_) {
+      uses_[value_index]++;
+    }
+  }
+
+  uint32_t get(size_t value_index) const {
+    return uses_[value_index];
+  }
+
+  /// Adds every value referenced by `instruction`.
+  void add_instruction(const executorch_flatbuffer::Instruction* instruction) {
+    const void* instr_args = instruction->instr_args();
+    switch (instruction->instr_args_type()) {
+      case executorch_flatbuffer::InstructionArguments::KernelCall: {
+        for (const auto arg_idx :
+             *static_cast<const executorch_flatbuffer::KernelCall*>(instr_args)
+                  ->args()) {
+          add(arg_idx);
+        }
+      } break;
+      case executorch_flatbuffer::InstructionArguments::DelegateCall: {
+        for (const auto arg_idx :
+             *static_cast<const executorch_flatbuffer::DelegateCall*>(
+                  instr_args)
+                  ->args()) {
+          add(arg_idx);
+        }
+      } break;
+      case executorch_flatbuffer::InstructionArguments::JumpFalseCall: {
+        add(static_cast<const executorch_flatbuffer::JumpFalseCall*>(
+                instr_args)
+                ->cond_value_index());
+      } break;
+      case executorch_flatbuffer::InstructionArguments::MoveCall: {
+        const auto* move_call =
+            static_cast<const executorch_flatbuffer::MoveCall*>(instr_args);
+        add(move_call->move_from());
+        add(move_call->move_to());
+      } break;
+      case executorch_flatbuffer::InstructionArguments::FreeCall: {
+        add(static_cast<const executorch_flatbuffer::FreeCall*>(instr_args)
+                ->value_index());
+      } break;
+      default:
+        break;
+    }
+  }
+
+  /// Adds every element of a list value, since list elements are referenced
+  /// through the list.
+  template <typename ListT>
+  void add_list_items(const void* val) {
+    for (const auto value_index : *static_cast<const ListT*>(val)->items()) {
+      add(value_index);
+    }
+  }
+
+ private:
+  uint32_t* uses_;
+  size_t n_value_;
+};
+
+/// Returns the number of entries in `args` that point to `value`.
+size_t count_occurrences(InstructionArgs args, const EValue* value) {
+  size_t count = 0;
+  for (const EValue* arg : args) {
+    count += arg == value ? 1 : 0;
+  }
+  return count;
+}
+
+} // namespace
+
+Error Method::fuse_elementwise_kernels() {
+  if (!has_fusible_elementwise_ops() || temp_allocator_ == nullptr) {
+    return Error::Ok;
+  }
+  // A fused run shows up as a single OPERATOR_CALL event and never writes its
+  // intermediate outputs, so leave the program alone when it is being traced.
+  if (event_tracer_ != nullptr) {
+    return Error::Ok;
+  }
+
+  // Count every reference to every value so that we only fuse through
+  // intermediates that have exactly one producer and one consumer. Inputs and
+  // outputs of the method are never intermediates.
+  uint32_t* uses_data = temp_allocator_->allocateList<uint32_t>(n_value_);
+  if (uses_data == nullptr) {
+    // Fusion is an optimization; run the program as-is.
+    return Error::Ok;
+  }
+  ValueUseCounts uses(uses_data, n_value_);
+  for (size_t i = 0; i < inputs_size(); ++i) {
+    uses.add(get_input_index(i));
+  }
+  for (size_t i = 0; i < outputs_size(); ++i) {
+    uses.add(get_output_index(i));
+  }
+  const auto flatbuffer_values = serialization_plan_->values();
+  for (size_t i = 0; i < n_value_; ++i) {
+    const auto serialization_value = flatbuffer_values->Get(i);
+    switch (serialization_value->val_type()) {
+      case executorch_flatbuffer::KernelTypes::IntList:
+        uses.add_list_items<executorch_flatbuffer::IntList>(
+            serialization_value->val());
+        break;
+      case executorch_flatbuffer::KernelTypes::TensorList:
+        uses.add_list_items<executorch_flatbuffer::TensorList>(
+            serialization_value->val());
+        break;
+      case executorch_flatbuffer::KernelTypes::OptionalTensorList:
+        uses.add_list_items<executorch_flatbuffer::OptionalTensorList>(
+            serialization_value->val());
+        break;
+      default:
+        break;
+    }
+  }
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    for (const auto instruction :
+         *chains_[chain_idx].s_chain_->instructions()) {
+      uses.add_instruction(instruction);
+    }
+  }
+
+  auto method_allocator = memory_manager_->method_allocator();
+  const auto ops = serialization_plan_->operators();
+  size_t num_fused_kernels = 0;
+  for (size_t chain_idx = 0; chain_idx < n_chains_; ++chain_idx) {
+    Chain& chain = chains_[chain_idx];
+    const auto instructions = chain.s_chain_->instructions();
+    const size_t num_instructions = instructions->size();
+
+    // Returns the fusible op for the instruction, or nullptr if the
+    // instruction can't take part in a fused run.
+    const auto fusible_op_at =
+        [&](size_t instr_idx) -> const FusibleElementwiseOp* {
+      const auto instruction = instructions->Get(instr_idx);
+      if (instruction->instr_args_type() !=
+          executorch_flatbuffer::InstructionArguments::KernelCall) {
+        return nullptr;
+      }
+      constexpr size_t kTempBufferSizeForName = 100;
+      char operator_name[kTempBufferSizeForName];
+      const auto op_index =
+          instruction->instr_args_as_KernelCall()->op_index();
+      if (populate_operator_name(
+              ops->Get(op_index), kTempBufferSizeForName, operator_name) !=
+          Error::Ok) {
+        return nullptr;
+      }
+      const FusibleElementwiseOp* op =
+          get_fusible_elementwise_op(operator_name);
+      if (op == nullptr || chain.kernels_[instr_idx] != op->kernel_ ||
+          chain.argument_lists_[instr_idx].size() != op->num_args_ ||
+          (op->can_fuse_fn_ != nullptr &&
+           !op->can_fuse_fn_(chain.argument_lists_[instr_idx].data()))) {
+        return nullptr;
+      }
+      return op;
+    };
+
+    // Instructions that a JumpFalseCall can land on must start a run.
+    bool* is_jump_target =
+        temp_allocator_->allocateList<bool>(num_instructions);
+    if (is_jump_target == nullptr) {
+      // Fusion is an optimization; keep the runs found so far.
+      break;
+    }
+    for (size_t i = 0; i < num_instructions; ++i) {
+      is_jump_target[i] = false;
+    }
+    for (const auto instruction : *instructions) {
+      if (instruction->instr_args_type() ==
+          executorch_flatbuffer::InstructionArguments::JumpFalseCall) {
+        const size_t destination = static_cast<size_t>(
+            instruction->instr_args_as_JumpFalseCall()
+                ->destination_instruction());
+        if (destination < num_instructions) {
+          is_jump_target[destination] = true;
+        }
+      }
+    }
+
+    // Returns true if the output of `prev` is an intermediate that is only
+    // consumed as the chained input of `next`.
+    const auto feeds_only = [&](size_t prev_idx,
+                                const FusibleElementwiseOp* prev_op,
+                                size_t next_idx,
+                                const FusibleElementwiseOp* next_op) {
+      const InstructionArgs prev_args = chain.argument_lists_[prev_idx];
+      const InstructionArgs next_args = chain.argument_lists_[next_idx];
+      const EValue* intermediate = prev_args[prev_op->out_arg_];
+      if (next_args[next_op->in_arg_] != intermediate ||
+          prev_args[prev_op->in_arg_] == intermediate ||
+          !intermediate->isTensor() ||
+          intermediate->toTensor().scalar_type() !=
+              executorch::aten::ScalarType::Float) {
+        return false;
+      }
+      const size_t prev_count = count_occurrences(prev_args, intermediate);
+      const size_t next_count = count_occurrences(next_args, intermediate);
+      return next_count == 1 &&
+          uses.get(intermediate - values_) == prev_count + next_count;
+    };
+
+    size_t head_idx = 0;
+    while (head_idx < num_instructions) {
+      const FusibleElementwiseOp* head_op = fusible_op_at(head_idx);
+      if (head_op == nullptr) {
+        head_idx++;
+        continue;
+      }
+      size_t run_length = 1;
+      const FusibleElementwiseOp* tail_op = head_op;
+      while (head_idx + run_length < num_instructions) {
+        const size_t next_idx = head_idx + run_length;
+        const FusibleElementwiseOp* next_op = fusible_op_at(next_idx);
+        if (next_op == nullptr || is_jump_target[next_idx] ||
+            !feeds_only(next_idx - 1, tail_op, next_idx, next_op)) {
+          break;
+        }
+        tail_op = next_op;
+        run_length++;
+      }
+      if (run_length < 2) {
+        head_idx++;
+        continue;
+      }
+
+      if (chain.fused_stages_ == nullptr) {
+        chain.fused_stages_ =
+            method_allocator->allocateList<Span<const FusedElementwiseStage>>(
+                num_instructions);
+        if (chain.fused_stages_ == nullptr) {
+          return Error::MemoryAllocationFailed;
+        }
+        for (size_t i = 0; i < num_instructions; ++i) {
+          new (&chain.fused_stages_[i]) Span<const FusedElementwiseStage>();
+        }
+      }
+      FusedElementwiseStage* stages =
+          method_allocator->allocateList<FusedElementwiseStage>(run_length);
+      if (stages == nullptr) {
+        return Error::MemoryAllocationFailed;
+      }
+      for (size_t i = 0; i < run_length; ++i) {
+        stages[i] = FusedElementwiseStage{
+            fusible_op_at(head_idx + i),
+            chain.kernels_[head_idx + i],
+            chain.argument_lists_[head_idx + i].data(),
+        };
+      }
+      chain.fused_stages_[head_idx] =
+          Span<const FusedElementwiseStage>(stages, run_length);
+      ET_LOG(
+          Debug,
+          "Fused %" ET_PRIsize_t " elementwise kernels at chain %" ET_PRIsize_t
+          " instruction %" ET_PRIsize_t,
+          run_length,
+          chain_idx,
+          head_idx);
+      num_fused_kernels += run_length;
+      head_idx += run_length;
+    }
+  }
+  temp_allocator_->reset();
+  if (num_fused_kernels > 0) {
+    ET_LOG(
+        Info,
+        "Fused %" ET_PRIsize_t " elementwise kernels in method %s",
+        num_fused_kernels,
+        serialization_plan_->name()->c_str());
+  }
+  return Error::Ok;
+}
+
+Error Method::init_delegates_concurrently(
+    size_t n_delegate,
+    const NamedDataMap* named_data_map,
+    ParallelForFn parallel_for) {
+  const auto delegates = serialization_plan_->delegates();
+  auto method_allocator = memory_manager_->method_allocator();
+  const char* method_name = serialization_plan_->name()->c_str();
+
+  // Per-delegate bookkeeping only lives until the end of init, so it comes
+  // from the temp allocator if that has room for it. Otherwise, as with the
+  // zero-size temp allocators of the pybindings, it takes a few bytes per
+  // delegate from the method allocator for the lifetime of the method.
+  ArrayRef<CompileSpec>* compile_specs = nullptr;
+  Error* results = nullptr;
+  size_t* concurrent = nullptr;
+  SynchronizedMemoryAllocator* allocator = nullptr;
+  for (MemoryAllocator* bookkeeping : {temp_allocator_, method_allocator}) {
+    compile_specs =
+        bookkeeping->allocateList<ArrayRef<CompileSpec>>(n_delegate);
+    results = bookkeeping->allocateList<Error>(n_delegate);
+    concurrent = bookkeeping->allocateList<size_t>(n_delegate);
+    allocator = bookkeeping->allocateInstance<SynchronizedMemoryAllocator>();
+    if (compile_specs != nullptr && results != nullptr &&
+        concurrent != nullptr && allocator != nullptr) {
+      break;
+    }
+    allocator = nullptr;
+  }
+  if (allocator == nullptr) {
+    ET_LOG(
+        Info,
+        "Not enough memory to initialize the delegates of method %s "
+        "concurrently, initializing them one at a time",
+        method_name);
+    return Error::Ok;
+  }
+  // Backends that run concurrently share the method allocator through a lock.
+  new (allocator) SynchronizedMemoryAllocator(method_allocator);
+
+  // Load each delegate's data and compile specs in order, since neither the
+  // method allocator nor every DataLoader is thread-safe, and initialize the
+  // delegates of backends that can't run concurrently right away.
+  size_t n_prepared = 0;
+  size_t n_concurrent = 0;
+  Error err = Error::Ok;
+  for (; n_prepared < n_delegate && err == Error::Ok; ++n_prepared) {
+    const size_t i = n_prepared;
+    BackendInitContext context(
+        method_allocator,
+        /*event_tracer=*/nullptr,
+        /*method_name=*/method_name,
+        /*named_data_map=*/named_data_map);
+    err = BackendDelegate::Prepare(
+        *delegates->Get(i),
+        program_,
+        context,
+        &delegates_[i],
+        &compile_specs[i]);
+    if (err != Error::Ok) {
+      break;
+    }
+    // Not initialized until InitBackend() succeeds on it.
+    results[i] = Error::Internal;
+    if (delegates_[i].backend_init_thread_safe()) {
+      concurrent[n_concurrent++] = i;
+    } else {
+      err = results[i] = BackendDelegate::InitBackend(
+          context, compile_specs[i], &delegates_[i]);
+    }
+  }
+
+  if (err == Error::Ok && n_concurrent > 0) {
+    bool ok = parallel_for(0, n_concurrent, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; ++j) {
+        const size_t i = concurrent[j];
+        BackendInitContext context(
+            allocator,
+            /*event_tracer=*/nullptr,
+            /*method_name=*/method_name,
+            /*named_data_map=*/named_data_map);
+        results[i] = BackendDelegate::InitBackend(
+            context, compile_specs[i], &delegates_[i]);
+      }
+    });
+    if (!ok) {
+      ET_LOG(Error, "parallel_for failed to initialize delegates");
+      err = Error::Internal;
+    }
+    for (size_t j = 0; j < n_concurrent && err == Error::Ok; ++j) {
+      err = results[concurrent[j]];
+    }
+  }
+
+  if (err != Error::Ok) {
+    // Delegates that failed in InitBackend() have already released their
+    // data. Release the rest, destroying the initialized ones.
+    for (size_t i = 0; i < n_prepared; ++i) {
+      if (results[i] == Error::Ok) {
+        delegates_[i].~BackendDelegate();
+      } else {
+        BackendDelegate::Abandon(&delegates_[i]);
+      }
+    }
+    return err;
+  }
+  n_delegate_ = n_delegate;
+  return Error::Ok;
+}
+
 Result<Method> Method::load(
     executorch_flatbuffer::ExecutionPlan* s_plan,
     const Program* program,
     MemoryManager* memory_manager,
     EventTracer* event_tracer,
-    const NamedDataMap* external_data_map) {
+    const NamedDataMap* external_data_map,
+    Span<const uint8_t> snapshot,
+    ParallelForFn delegate_init_parallel_for) {
   MemoryAllocator* temp_allocator = memory_manager->temp_allocator();
   if (temp_allocator == nullptr) {
     PlatformMemoryAllocator* platform_allocator =
@@ -758,7 +1370,8 @@ Result<Method> Method::load(
   }
   Method method(program, memory_manager, event_tracer, temp_allocator);
   ET_LOG(Debug, "Loading method: %s.", s_plan->name()->c_str());
-  Error err = method.init(s_plan, external_data_map);
+  Error err = method.init(
+      s_plan, external_data_map, snapshot, delegate_init_parallel_for);
   if (err != Error::Ok) {
     return err;
   } else {
@@ -769,7 +1382,9 @@ Result<Method> Method::load(
 
 Error Method::init(
     executorch_flatbuffer::ExecutionPlan* s_plan,
-    const NamedDataMap* external_data_map) {
+    const NamedDataMap* external_data_map,
+    Span<const uint8_t> snapshot,
+    ParallelForFn delegate_init_parallel_for) {
   EXECUTORCH_SCOPE_PROF("Method::init");
   internal::EventTracerProfileMethodScope event_tracer_profile_scope =
       internal::EventTracerProfileMethodScope(event_tracer_, "Method::init");
@@ -792,6 +1407,10 @@ Error Method::init(
     }
   }
 
+  // Kernel indices saved by a previous load of this method, or null to
+  // resolve every operator through the kernel registry.
+  const uint8_t* snapshot_kernels = validate_snapshot(snapshot);
+
   {
     // Resolve delegates
     const auto delegates = serialization_plan_->delegates();
@@ -838,7 +1457,17 @@ Error Method::init(
     // makes it safe for errors to return without updating any state.
     n_delegate_ = 0;
 
-    for (size_t i = 0; i < n_delegate; ++i) {
+    // EventTracer is not thread-safe, so tracing keeps delegate init serial.
+    if (delegate_init_parallel_for != nullptr && event_tracer_ == nullptr &&
+        n_delegate > 0) {
+      Error err = init_delegates_concurrently(
+          n_delegate, named_data_map, delegate_init_parallel_for);
+      if (err != Error::Ok) {
+        return err;
+      }
+    }
+
+    for (size_t i = n_delegate_; i < n_delegate; ++i) {
       const auto& delegate = *delegates->Get(i);
       BackendInitContext backend_init_context(
           method_allocator,
@@ -923,6 +1552,22 @@ Error Method::init(
               return res.error();
             }
             chain_instruction_arg_lists[instr_idx] = res.get();
+            uint32_t registry_index = kMethodSnapshotNoKernel;
+            if (snapshot_kernels != nullptr) {
+              memcpy(
+                  &registry_index,
+                  snapshot_kernels + instr_idx * sizeof(uint32_t),
+                  sizeof(uint32_t));
+            }
+            if (registry_index != kMethodSnapshotNoKernel &&
+                restore_operator(
+                    instr_args_as_KernelCall->op_index(),
+                    chain_instruction_kernels,
+                    instr_idx,
+                    registry_index)) {
+              // Skip the registry lookup.
+              break;
+            }
             auto err = resolve_operator(
                 instr_args_as_KernelCall->op_index(),
                 chain_instruction_kernels,
@@ -977,10 +1622,14 @@ Error Method::init(
           } break;
         }
       }
+      if (snapshot_kernels != nullptr) {
+        snapshot_kernels += num_instructions * sizeof(uint32_t);
+      }
       chains_[i] = Chain{
           s_chain,
           Span<InstructionArgs>(chain_instruction_arg_lists, num_instructions),
           chain_instruction_kernels,
+          /*fused_stages_=*/nullptr,
       };
     }
     ET_CHECK_OR_RETURN_ERROR(
@@ -994,6 +1643,13 @@ Error Method::init(
     }
   }
 
+  {
+    Error err = fuse_elementwise_kernels();
+    if (err != Error::Ok) {
+      return err;
+    }
+  }
+
   step_state_ = StepState{0, 0};
 
   init_state_ = InitializationState::Initialized;
@@ -1319,7 +1975,14 @@ Error Method::execute_instruction() {
       // TODO(T147221312): Also expose tensor resizer via the context.
       KernelRuntimeContext context(event_tracer_, temp_allocator_);
       auto args = chain.argument_lists_[step_state_.instr_idx];
-      chain.kernels_[step_state_.instr_idx](context, args.data());
+      if (chain.fused_stages_ != nullptr &&
+          !chain.fused_stages_[step_state_.instr_idx].empty()) {
+        const auto stages = chain.fused_stages_[step_state_.instr_idx];
+        execute_fused_elementwise(context, stages);
+        next_instr_idx = step_state_.instr_idx + stages.size();
+      } else {
+        chain.kernels_[step_state_.instr_idx](context, args.data());
+      }
       // We reset the temp_allocator after the switch statement
       err = context.failure_state();
       if (err != Error::Ok) {
@@ -1577,6 +2240,110 @@ Error Method::execute() {
   return reset_execution(); // @lint-ignore CLANGTIDY facebook-hte-Deprecated
 }
 
+size_t Method::snapshot_size() const {
+  size_t num_instructions = 0;
+  for (size_t i = 0; i < n_chains_; ++i) {
+    num_instructions += chains_[i].argument_lists_.size();
+  }
+  return sizeof(MethodSnapshotHeader) + num_instructions * sizeof(uint32_t);
+}
+
+Result<size_t> Method::save_snapshot(void* buffer, size_t size) const {
+  ET_CHECK_OR_RETURN_ERROR(
+      initialized(),
+      InvalidState,
+      "Cannot save a snapshot of an uninitialized method");
+  const size_t nbytes = snapshot_size();
+  ET_CHECK_OR_RETURN_ERROR(
+      buffer != nullptr && size >= nbytes,
+      InvalidArgument,
+      "Snapshot buffer of %" ET_PRIsize_t
+      " bytes is smaller than %" ET_PRIsize_t,
+      size,
+      nbytes);
+  size_t num_instructions = 0;
+  for (size_t i = 0; i < n_chains_; ++i) {
+    num_instructions += chains_[i].argument_lists_.size();
+  }
+  ET_CHECK_OR_RETURN_ERROR(
+      num_instructions < kMethodSnapshotNoKernel,
+      NotSupported,
+      "Too many instructions for a snapshot: %" ET_PRIsize_t,
+      num_instructions);
+
+  // Registry indices sorted by kernel function, so that each instruction's
+  // kernel is found with a binary search instead of a registry scan.
+  Span<const Kernel> registered = get_registered_kernels();
+  uint32_t* by_function =
+      temp_allocator_->allocateList<uint32_t>(registered.size());
+  ET_CHECK_OR_RETURN_ERROR(
+      by_function != nullptr || registered.empty(),
+      MemoryAllocationFailed,
+      "Failed to allocate %" ET_PRIsize_t " kernel indices for a snapshot",
+      registered.size());
+  for (size_t k = 0; k < registered.size(); ++k) {
+    by_function[k] = static_cast<uint32_t>(k);
+  }
+  const auto function_less = [&](uint32_t a, uint32_t b) {
+    return std::less<OpFunction>()(registered[a].op_, registered[b].op_);
+  };
+  std::sort(by_function, by_function + registered.size(), function_less);
+
+  MethodSnapshotHeader header = {};
+  memcpy(header.magic, "ETMS", sizeof(header.magic));
+  header.version = kMethodSnapshotVersion;
+  header.program_hash = snapshot_program_hash();
+  header.registry_hash = internal::kernel_registry_hash();
+  header.num_instructions = static_cast<uint32_t>(num_instructions);
+  uint8_t* out = static_cast<uint8_t*>(buffer);
+  memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+
+  // Find the registry entry behind each resolved kernel. Several entries may
+  // share a function; any of them with the operator's name restores the same
+  // kernel.
+  const auto ops = serialization_plan_->operators();
+  constexpr size_t kTempBufferSizeForName = 100;
+  char operator_name[kTempBufferSizeForName];
+  for (size_t i = 0; i < n_chains_; ++i) {
+    const auto instructions = chains_[i].s_chain_->instructions();
+    for (size_t instr_idx = 0; instr_idx < instructions->size(); ++instr_idx) {
+      const auto instruction = instructions->Get(instr_idx);
+      uint32_t registry_index = kMethodSnapshotNoKernel;
+      if (instruction->instr_args_type() ==
+          executorch_flatbuffer::InstructionArguments::KernelCall) {
+        const auto op_index =
+            static_cast<const executorch_flatbuffer::KernelCall*>(
+                instruction->instr_args())
+                ->op_index();
+        // The op index was validated when the kernel was resolved.
+        Error err = populate_operator_name(
+            ops->Get(op_index), kTempBufferSizeForName, operator_name);
+        const OpFunction kernel = chains_[i].kernels_[instr_idx];
+        const uint32_t* it = std::lower_bound(
+            by_function,
+            by_function + registered.size(),
+            kernel,
+            [&](uint32_t k, OpFunction f) {
+              return std::less<OpFunction>()(registered[k].op_, f);
+            });
+        for (; err == Error::Ok && it != by_function + registered.size() &&
+             registered[*it].op_ == kernel;
+             ++it) {
+          if (strcmp(registered[*it].name_, operator_name) == 0) {
+            registry_index = *it;
+            break;
+          }
+        }
+      }
+      memcpy(out, &registry_index, sizeof(registry_index));
+      out += sizeof(registry_index);
+    }
+  }
+  temp_allocator_->reset();
+  return nbytes;
+}
+
 MethodMeta Method::method_meta() const {
   auto name = serialization_plan_->name()->c_str();
   auto method_meta = program_->method_meta(name);
@@ -17,6 +17,7 @@
 #include <executorch/runtime/core/evalue.h>
 #include <executorch/runtime/core/event_tracer.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/function_ref.h>
 #include <executorch/runtime/core/named_data_map.h>
 #include <executorch/runtime/core/span.h>
 #include <executorch/runtime/executor/memory_manager.h>
@@ -54,6 +55,18 @@ using OpFunction = void (*)(KernelRuntimeContext&, EValue**);
 using InstructionArgs = Span<EValue*>;
 using deserialization::NamedData;
 
+/**
+ * Calls `f` on chunks of the range [begin, end), possibly concurrently, and
+ * returns once every chunk has run. Returns false if the range is invalid.
+ * `executorch::extension::threadpool::parallel_for_on_new_threads` has this
+ * signature.
+ */
+using ParallelForFn = bool (*)(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    ::executorch::runtime::FunctionRef<void(int64_t, int64_t)> f);
+
 /**
  * An executable method of an executorch program. Maps to a python method like
  * `forward()` on the original nn.Module.
@@ -244,6 +257,29 @@ class Method final {
   /// DEPRECATED: Use `reset_execution()` instead.
   ET_DEPRECATED ET_NODISCARD Error experimental_reset_execution();
 
+  /**
+   * Returns the number of bytes that save_snapshot() writes.
+   */
+  size_t snapshot_size() const;
+
+  /**
+   * Writes a snapshot of the kernels that this Method's instructions resolved
+   * to. Passing the snapshot to a later `Program::load_method()` for the same
+   * program lets it skip the kernel registry lookups, which dominate the load
+   * time of methods with many operators. Delegates are not part of the
+   * snapshot and are always initialized by their backends. See
+   * method_snapshot.h for the format.
+   *
+   * Uses the temp allocator for one `uint32_t` per registered kernel.
+   *
+   * @param[in] buffer The buffer to write the snapshot to.
+   * @param[in] size The size of `buffer` in bytes. Must be at least
+   *     `snapshot_size()`.
+   *
+   * @returns The number of bytes written on success, non-Ok on failure.
+   */
+  ET_NODISCARD Result<size_t> save_snapshot(void* buffer, size_t size) const;
+
   /**
    * Returns the MethodMeta that corresponds to the calling Method.
    */
@@ -329,16 +365,25 @@ class Method final {
       const Program* program,
       MemoryManager* memory_manager,
       EventTracer* event_tracer,
-      const NamedDataMap* named_data_map);
+      const NamedDataMap* named_data_map,
+      Span<const uint8_t> snapshot,
+      ParallelForFn delegate_init_parallel_for);
 
   /**
    * Initialize the method from its serialized representation.
    *
+   * @param[in] snapshot An optional snapshot from save_snapshot(). Ignored if
+   *     it does not match this method.
+   * @param[in] delegate_init_parallel_for If non-null, used to initialize
+   *     delegates concurrently. See Program::load_method().
+   *
    * @returns Error::Ok on success, non-Ok on failure.
    */
   ET_NODISCARD Error init(
       executorch_flatbuffer::ExecutionPlan* s_plan,
-      const NamedDataMap* named_data_map);
+      const NamedDataMap* named_data_map,
+      Span<const uint8_t> snapshot,
+      ParallelForFn delegate_init_parallel_for);
 
   /// Returns true if the Method was successfully initialized.
   inline bool initialized() const {
@@ -402,6 +447,17 @@ class Method final {
    */
   ET_NODISCARD Error parse_values(const NamedDataMap* named_data_map);
 
+  /**
+   * Initializes the n_delegate entries of delegates_, calling the init() of
+   * backends that report is_init_thread_safe() concurrently through
+   * `parallel_for`. Sets n_delegate_ only if every delegate succeeds, and
+   * cleans up the ones that did otherwise.
+   */
+  ET_NODISCARD Error init_delegates_concurrently(
+      size_t n_delegate,
+      const NamedDataMap* named_data_map,
+      ParallelForFn parallel_for);
+
   ET_NODISCARD Error resolve_operator(
       int32_t op_index,
       OpFunction* kernels,
@@ -409,6 +465,36 @@ class Method final {
       InstructionArgs args,
       size_t n_args);
 
+  /**
+   * Sets `kernels[kernel_index]` to the registered kernel at `registry_index`
+   * that a snapshot recorded for the operator. Returns false, leaving the
+   * kernel unset, if that kernel is not the named operator.
+   */
+  bool restore_operator(
+      int32_t op_index,
+      OpFunction* kernels,
+      size_t kernel_index,
+      uint32_t registry_index);
+
+  /**
+   * Returns the kernel indices of `snapshot` if it was saved for this method,
+   * program and kernel registry, or nullptr.
+   */
+  const uint8_t* validate_snapshot(Span<const uint8_t> snapshot) const;
+
+  /// Hash of the parts of the program that kernel selection depends on.
+  uint64_t snapshot_program_hash() const;
+
+  /**
+   * Finds straight-line runs of registered fusible elementwise kernels in
+   * which each intermediate tensor feeds only the next kernel, and replaces
+   * each run with a single fused call. Only instructions whose resolved
+   * kernel is the one a fusible op mirrors take part. Does nothing if no
+   * fusible ops have been registered or an event tracer is attached. See
+   * runtime/kernel/elementwise_fusion.h.
+   */
+  ET_NODISCARD Error fuse_elementwise_kernels();
+
   void log_outputs();
 };
 
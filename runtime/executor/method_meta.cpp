@@ -7,6 +7,7 @@
  */
 
 #include <c10/util/safe_numerics.h>
+#include <cinttypes>
 #include <executorch/runtime/core/error.h>
 #include <executorch/runtime/core/exec_aten/exec_aten.h>
 #include <executorch/runtime/core/exec_aten/util/scalar_type_util.h>
@@ -376,5 +377,54 @@ size_t MethodMeta::num_instructions() const {
   }
   return num_instructions;
 }
+
+Result<const char*> MethodMeta::instruction_name(
+    size_t chain_index,
+    size_t instruction_index) const {
+  const auto chains = s_plan_->chains();
+  const size_t num_chains = chains ? chains->size() : 0;
+  ET_CHECK_OR_RETURN_ERROR(
+      chain_index < num_chains,
+      InvalidArgument,
+      "Chain index %zu out of range. num_chains: %zu",
+      chain_index,
+      num_chains);
+  const auto instructions = chains->Get(chain_index)->instructions();
+  const size_t count = instructions ? instructions->size() : 0;
+  ET_CHECK_OR_RETURN_ERROR(
+      instruction_index < count,
+      InvalidArgument,
+      "Instruction index %zu out of range. num_instructions: %zu",
+      instruction_index,
+      count);
+  const auto instruction = instructions->Get(instruction_index);
+  switch (instruction->instr_args_type()) {
+    case executorch_flatbuffer::InstructionArguments::KernelCall: {
+      const auto ops = s_plan_->operators();
+      const int32_t op_index =
+          instruction->instr_args_as_KernelCall()->op_index();
+      ET_CHECK_OR_RETURN_ERROR(
+          ops != nullptr && op_index >= 0 &&
+              static_cast<size_t>(op_index) < ops->size(),
+          InvalidProgram,
+          "Operator index %" PRId32 " out of range",
+          op_index);
+      return ops->Get(op_index)->name()->c_str();
+    }
+    case executorch_flatbuffer::InstructionArguments::DelegateCall: {
+      const int32_t delegate_index =
+          instruction->instr_args_as_DelegateCall()->delegate_index();
+      ET_CHECK_OR_RETURN_ERROR(
+          delegate_index >= 0 &&
+              static_cast<size_t>(delegate_index) < num_backends(),
+          InvalidProgram,
+          "Delegate index %" PRId32 " out of range",
+          delegate_index);
+      return s_plan_->delegates()->Get(delegate_index)->id()->c_str();
+    }
+    default:
+      return Error::NotFound;
+  }
+}
 } // namespace ET_RUNTIME_NAMESPACE
 } // namespace executorch
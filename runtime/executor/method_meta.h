@@ -265,6 +265,21 @@ class MethodMeta final {
    */
   ET_EXPERIMENTAL size_t num_instructions() const;
 
+  /**
+   * Get the name of what an instruction calls: the operator name (without
+   * the overload) of a kernel call, or the backend id of a delegate call.
+   * Matches the chain id and debug handle of the instruction's profiling
+   * events.
+   *
+   * @param[in] chain_index The index of the chain.
+   * @param[in] instruction_index The index of the instruction in the chain.
+   * @returns A Result wrapping the name on success, NotFound for instructions
+   * that call neither, or InvalidArgument if an index is invalid.
+   */
+  Result<const char*> instruction_name(
+      size_t chain_index,
+      size_t instruction_index) const;
+
   /**
    * DEPRECATED: Use num_memory_planned_buffers() instead.
    */
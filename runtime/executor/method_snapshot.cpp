@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/executor/method_snapshot.h>
+
+#include <cstring>
+
+#include <executorch/runtime/kernel/operator_registry.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+namespace internal {
+
+namespace {
+// FNV-1a constants, applied to 8-byte words and then to the trailing bytes.
+constexpr uint64_t kHashOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t kHashPrime = 0x100000001b3ULL;
+
+uint64_t hash_string(const char* str, uint64_t seed) {
+  // Include the terminator so that adjacent strings can't run together.
+  return snapshot_hash(str, str == nullptr ? 0 : strlen(str) + 1, seed);
+}
+} // namespace
+
+uint64_t snapshot_hash(const void* data, size_t size, uint64_t seed) {
+  uint64_t hash = seed ^ kHashOffsetBasis;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kHashPrime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kHashPrime;
+  }
+  return hash;
+}
+
+uint64_t kernel_registry_hash() {
+  Span<const Kernel> kernels = get_registered_kernels();
+  uint64_t hash = kernels.size();
+  for (const Kernel& kernel : kernels) {
+    hash = hash_string(kernel.name_, hash);
+    // Fallback kernels have no key data.
+    hash = hash_string(kernel.kernel_key_.data(), hash);
+  }
+  return hash;
+}
+
+} // namespace internal
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+
+/**
+ * Header of the snapshot written by `Method::save_snapshot()`. It is followed
+ * by one `uint32_t` per instruction of the method, in chain order: the index
+ * into `get_registered_kernels()` of the kernel that the instruction resolved
+ * to, or `kMethodSnapshotNoKernel` for instructions that do not call a kernel.
+ *
+ * The snapshot is only valid for the same method and kernel registry that
+ * wrote it, and for programs that select the same kernels. It holds no
+ * delegate or constant data. It uses the native byte order, and is meant to be
+ * cached next to the program on the device that created it.
+ */
+struct MethodSnapshotHeader {
+  /// Always "ETMS".
+  char magic[4];
+  /// kMethodSnapshotVersion.
+  uint32_t version;
+  /// Hash of the program size, the method name, and the operators, value
+  /// types and kernel calls of the method.
+  uint64_t program_hash;
+  /// Hash of the names and keys of every registered kernel, in order.
+  uint64_t registry_hash;
+  /// The number of kernel indices that follow the header.
+  uint32_t num_instructions;
+  uint32_t reserved;
+};
+
+constexpr uint32_t kMethodSnapshotVersion = 3;
+
+/// Kernel index of an instruction that does not call a kernel.
+constexpr uint32_t kMethodSnapshotNoKernel = UINT32_MAX;
+
+namespace internal {
+
+/**
+ * Hashes `size` bytes of `data`, continuing from `seed`. Not a cryptographic
+ * hash; only used to detect stale snapshots.
+ */
+uint64_t snapshot_hash(const void* data, size_t size, uint64_t seed);
+
+/// Returns the hash of the current kernel registry.
+uint64_t kernel_registry_hash();
+
+} // namespace internal
+
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
@@ -141,6 +141,22 @@ class Program final {
    * @param[in] event_tracer The event tracer to use for this method run.
    * @param[in] named_data_map An optional map of {name, blob} used to resolve
    *     data that is external to the PTE, if any.
+   * @param[in] snapshot An optional snapshot written by
+   *     `Method::save_snapshot()` for this method in an earlier process. If it
+   *     was saved for the same method and kernel registry, the method reuses
+   *     its resolved kernels instead of looking them up again. Otherwise it is
+   *     ignored. Delegates are initialized as usual either way.
+   * @param[in] delegate_init_parallel_for An optional parallel_for, such as
+   *     `executorch::extension::threadpool::parallel_for_on_new_threads`,
+   *     used to initialize the method's delegates concurrently. Avoid
+   *     `executorch::extension::parallel_for`, since delegates that are
+   *     initialized on its pool threads can't bind the threadpool for their
+   *     own execution. Only delegates whose backends report
+   *     `BackendInterface::is_init_thread_safe()` run concurrently, and the
+   *     program's DataLoader must support concurrent calls to load(). Ignored
+   *     if `event_tracer` is set, since EventTracer is not thread-safe. Needs
+   *     about 32 bytes per delegate of temp memory, which comes from the
+   *     method allocator instead if the temp allocator is too small.
    *
    * @returns The loaded method on success, or an error on failure.
    */
@@ -148,7 +164,9 @@ class Program final {
       const char* method_name,
       MemoryManager* memory_manager,
       EventTracer* event_tracer = nullptr,
-      const NamedDataMap* named_data_map = nullptr) const;
+      const NamedDataMap* named_data_map = nullptr,
+      Span<const uint8_t> snapshot = {},
+      ParallelForFn delegate_init_parallel_for = nullptr) const;
 
   /**
    * Gathers metadata for the named method.
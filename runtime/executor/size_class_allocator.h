@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/runtime/core/dynamic_allocator.h>
+#include <executorch/runtime/platform/log.h>
+#include <executorch/runtime/platform/platform.h>
+
+namespace executorch {
+namespace runtime {
+
+/**
+ * A DynamicAllocator that serves blocks from power-of-two size classes, and
+ * keeps freed blocks in per-class free lists so that later allocations of the
+ * same class reuse them. Memory is obtained with `pal_allocate()`.
+ *
+ * When a Method runs with a SizeClassAllocator, each of its DYNAMIC_UNBOUND
+ * activations takes a block sized for its actual shape and gives it back at
+ * its last use, so activation memory tracks the real input size rather than
+ * an export-time bound. After the first few executions the free lists hold a
+ * block for every live activation, and no more memory is requested from the
+ * platform.
+ *
+ * Not thread-safe: a SizeClassAllocator must only be used by one executing
+ * Method at a time. It must outlive the Methods that use it, and frees all of
+ * its blocks when destroyed.
+ */
+class SizeClassAllocator final : public DynamicAllocator {
+ public:
+  struct Options {
+    /// The size of the smallest size class. Rounded up to a power of two.
+    size_t min_block_size = 64;
+    /// The maximum number of bytes held from the platform, both in use and
+    /// cached. When an allocation would exceed it, cached blocks are released
+    /// first, and the allocation fails if that is not enough. 0 means no
+    /// limit.
+    size_t max_total_bytes = 0;
+    /// The maximum number of bytes kept in the free lists. Freed blocks past
+    /// this limit are returned to the platform.
+    size_t max_cached_bytes = SIZE_MAX;
+    /// A tensor whose block is at least this many times larger than it needs
+    /// moves to a smaller block when resized. 0 disables shrinking.
+    size_t shrink_ratio = 4;
+  };
+
+  SizeClassAllocator() : SizeClassAllocator(Options()) {}
+
+  explicit SizeClassAllocator(const Options& options) : options_(options) {
+    min_block_shift_ = 0;
+    while ((size_t{1} << min_block_shift_) < options_.min_block_size &&
+           min_block_shift_ + 1 < kNumClasses) {
+      ++min_block_shift_;
+    }
+  }
+
+  ~SizeClassAllocator() override {
+    while (blocks_ != nullptr) {
+      release(blocks_);
+    }
+  }
+
+  void* allocate(size_t size, size_t* capacity) override {
+    const size_t size_class = class_of(size);
+    if (size_class == kNumClasses) {
+      ET_LOG(Error, "Cannot allocate a block of %zu bytes", size);
+      return nullptr;
+    }
+    const size_t block_size = size_t{1} << size_class;
+    Block* block = free_lists_[size_class];
+    if (block != nullptr) {
+      free_lists_[size_class] = block->next_free;
+      cached_bytes_ -= block_size;
+    } else {
+      block = allocate_block(size_class);
+      if (block == nullptr) {
+        return nullptr;
+      }
+    }
+    in_use_bytes_ += block_size;
+    if (in_use_bytes_ > peak_in_use_bytes_) {
+      peak_in_use_bytes_ = in_use_bytes_;
+    }
+    *capacity = block_size;
+    return block + 1;
+  }
+
+  void free(void* ptr, size_t capacity) override {
+    if (ptr == nullptr) {
+      return;
+    }
+    Block* block = static_cast<Block*>(ptr) - 1;
+    in_use_bytes_ -= capacity;
+    if (capacity > options_.max_cached_bytes - cached_bytes_) {
+      release(block);
+      return;
+    }
+    block->next_free = free_lists_[block->size_class];
+    free_lists_[block->size_class] = block;
+    cached_bytes_ += capacity;
+  }
+
+  bool should_shrink(size_t size, size_t capacity) const override {
+    return options_.shrink_ratio != 0 &&
+        capacity > (size_t{1} << min_block_shift_) &&
+        size <= capacity / options_.shrink_ratio;
+  }
+
+  /**
+   * Returns every cached block to the platform, for example after a run of
+   * unusually large inputs.
+   */
+  void trim() {
+    for (size_t size_class = 0; size_class < kNumClasses; ++size_class) {
+      release_cached(size_class);
+    }
+  }
+
+  /// The number of bytes held from the platform, in use and cached.
+  size_t total_bytes() const {
+    return total_bytes_;
+  }
+
+  /// The number of bytes in blocks currently handed out.
+  size_t in_use_bytes() const {
+    return in_use_bytes_;
+  }
+
+  /// The number of bytes in cached free blocks.
+  size_t cached_bytes() const {
+    return cached_bytes_;
+  }
+
+  /// The largest value in_use_bytes() has had.
+  size_t peak_in_use_bytes() const {
+    return peak_in_use_bytes_;
+  }
+
+ private:
+  static constexpr size_t kNumClasses = sizeof(size_t) * 8 - 1;
+
+  // Header placed before every block, keeping the block aligned like the
+  // memory returned by the platform.
+  struct alignas(std::max_align_t) Block {
+    Block* prev;
+    Block* next;
+    Block* next_free;
+    size_t size_class;
+  };
+
+  // Returns the smallest size class that holds `size` bytes, or kNumClasses.
+  size_t class_of(size_t size) const {
+    size_t size_class = min_block_shift_;
+    while (size_class < kNumClasses && (size_t{1} << size_class) < size) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  Block* allocate_block(size_t size_class) {
+    const size_t block_size = size_t{1} << size_class;
+    if (options_.max_total_bytes != 0 &&
+        total_bytes_ + block_size > options_.max_total_bytes) {
+      trim();
+      if (total_bytes_ + block_size > options_.max_total_bytes) {
+        ET_LOG(
+            Error,
+            "Allocating %zu bytes would exceed the limit of %zu bytes",
+            block_size,
+            options_.max_total_bytes);
+        return nullptr;
+      }
+    }
+    Block* block =
+        static_cast<Block*>(pal_allocate(sizeof(Block) + block_size));
+    if (block == nullptr) {
+      ET_LOG(Error, "Failed to allocate %zu bytes", sizeof(Block) + block_size);
+      return nullptr;
+    }
+    block->prev = nullptr;
+    block->next = blocks_;
+    block->next_free = nullptr;
+    block->size_class = size_class;
+    if (blocks_ != nullptr) {
+      blocks_->prev = block;
+    }
+    blocks_ = block;
+    total_bytes_ += block_size;
+    return block;
+  }
+
+  void release_cached(size_t size_class) {
+    while (free_lists_[size_class] != nullptr) {
+      Block* block = free_lists_[size_class];
+      free_lists_[size_class] = block->next_free;
+      cached_bytes_ -= size_t{1} << size_class;
+      release(block);
+    }
+  }
+
+  void release(Block* block) {
+    if (block->prev != nullptr) {
+      block->prev->next = block->next;
+    } else {
+      blocks_ = block->next;
+    }
+    if (block->next != nullptr) {
+      block->next->prev = block->prev;
+    }
+    total_bytes_ -= size_t{1} << block->size_class;
+    pal_free(block);
+  }
+
+  const Options options_;
+  size_t min_block_shift_;
+  std::array<Block*, kNumClasses> free_lists_{};
+  // Every block held from the platform, so that they can be freed on
+  // destruction even if a tensor still uses them.
+  Block* blocks_ = nullptr;
+  size_t total_bytes_ = 0;
+  size_t in_use_bytes_ = 0;
+  size_t cached_bytes_ = 0;
+  size_t peak_in_use_bytes_ = 0;
+
+  // Disable copy and move.
+  SizeClassAllocator(const SizeClassAllocator&) = delete;
+  SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+  SizeClassAllocator(SizeClassAllocator&&) = delete;
+  SizeClassAllocator& operator=(SizeClassAllocator&&) = delete;
+};
+
+} // namespace runtime
+} // namespace executorch
@@ -32,9 +32,11 @@ def define_common_targets():
         name = "memory_manager",
         exported_headers = [
             "memory_manager.h",
+            "size_class_allocator.h",
         ],
         exported_deps = [
             "//executorch/runtime/core:memory_allocator",
+            "//executorch/runtime/platform:platform",
         ],
         visibility = [
             "//executorch/...",
@@ -96,6 +98,7 @@ def define_common_targets():
             srcs = [
                 "method.cpp",
                 "method_meta.cpp",
+                "method_snapshot.cpp",
                 "program.cpp",
                 "tensor_parser_exec_aten.cpp",
                 "tensor_parser{}.cpp".format(aten_suffix if aten_mode else "_portable"),
@@ -106,6 +109,7 @@ def define_common_targets():
             exported_headers = [
                 "method.h",
                 "method_meta.h",
+                "method_snapshot.h",
                 "program.h",
                 "tensor_parser.h",
             ],
@@ -126,6 +130,7 @@ def define_common_targets():
                 "//executorch/runtime/core/exec_aten:lib" + aten_suffix,
                 "//executorch/runtime/core/exec_aten/util:scalar_type_util" + aten_suffix,
                 "//executorch/runtime/core/exec_aten/util:tensor_util" + aten_suffix,
+                "//executorch/runtime/kernel:elementwise_fusion" + aten_suffix,
                 "//executorch/runtime/kernel:kernel_runtime_context" + aten_suffix,
                 "//executorch/runtime/kernel:operator_registry" + aten_suffix,
                 "//executorch/runtime/platform:platform",
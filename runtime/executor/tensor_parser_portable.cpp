@@ -50,12 +50,13 @@ Result<Tensor> parseTensor(
 
   TensorShapeDynamism dynamism =
       static_cast<TensorShapeDynamism>(s_tensor->shape_dynamism());
-  // TODO(T175194371): Remove this check once fully dynamic shapes are
-  // supported.
+  // Unbounded tensors are not memory-planned, so their data has to come from
+  // the dynamic allocator as they are resized.
   ET_CHECK_OR_RETURN_ERROR(
-      dynamism != TensorShapeDynamism::DYNAMIC_UNBOUND,
+      dynamism != TensorShapeDynamism::DYNAMIC_UNBOUND ||
+          memory_manager->dynamic_allocator() != nullptr,
       NotSupported,
-      "Fully dynamic tensor shapes not yet supported: T175194371");
+      "DYNAMIC_UNBOUND tensors need a dynamic_allocator in the MemoryManager");
 
   ET_CHECK_OR_RETURN_ERROR(
       s_tensor->sizes() != nullptr, InvalidProgram, "Missing sizes field");
@@ -171,6 +172,7 @@ Result<Tensor> parseTensor(
     return data_ptr.error();
   }
   tensor_impl->set_data(data_ptr.get());
+  tensor_impl->set_data_allocator(memory_manager->dynamic_allocator());
 
   return Tensor(tensor_impl);
 }
@@ -10,6 +10,7 @@
 #include <cstring>
 #include <functional>
 #include <optional>
+#include <thread>
 #include <vector>
 
 #include <executorch/extension/data_loader/buffer_data_loader.h>
@@ -38,10 +39,12 @@ using executorch::runtime::DelegateHandle;
 using executorch::runtime::Error;
 using executorch::runtime::EValue;
 using executorch::runtime::FreeableBuffer;
+using executorch::runtime::FunctionRef;
 using executorch::runtime::MemoryAllocator;
 using executorch::runtime::Method;
 using executorch::runtime::Program;
 using executorch::runtime::Result;
+using executorch::runtime::Span;
 using executorch::runtime::testing::ManagedMemoryManager;
 using torch::executor::util::FileDataLoader;
 
@@ -115,6 +118,14 @@ class StubBackend final : public BackendInterface {
     }
   }
 
+  void install_is_init_thread_safe(bool is_init_thread_safe) {
+    is_init_thread_safe_ = is_init_thread_safe;
+  }
+
+  bool is_init_thread_safe() const override {
+    return is_init_thread_safe_;
+  }
+
   /**
    * Resets to the original constructed state.
    */
@@ -123,6 +134,7 @@ class StubBackend final : public BackendInterface {
     init_fn_.reset();
     execute_fn_.reset();
     destroy_fn_.reset();
+    is_init_thread_safe_ = false;
   }
 
   /**
@@ -155,6 +167,7 @@ class StubBackend final : public BackendInterface {
   std::optional<InitFn> init_fn_;
   std::optional<ExecuteFn> execute_fn_;
   std::optional<DestroyFn> destroy_fn_;
+  bool is_init_thread_safe_ = false;
 };
 
 bool StubBackend::registered_ = false;
@@ -607,6 +620,216 @@ TEST_P(BackendIntegrationTest, GetMethodNameDuringExecuteSuccess) {
   ASSERT_EQ(err, Error::Ok);
 }
 
+namespace {
+// The number of calls to ParallelForOnThreads().
+int parallel_for_calls = 0;
+
+// A ParallelForFn that runs each index on its own thread.
+bool ParallelForOnThreads(
+    int64_t begin,
+    int64_t end,
+    ET_UNUSED int64_t grain_size,
+    FunctionRef<void(int64_t, int64_t)> f) {
+  parallel_for_calls++;
+  std::vector<std::thread> threads;
+  for (int64_t i = begin; i < end; ++i) {
+    threads.emplace_back([&f, i]() { f(i, i + 1); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return true;
+}
+} // namespace
+
+TEST_P(BackendIntegrationTest, ThreadSafeBackendsInitConcurrently) {
+  StubBackend::singleton().install_is_init_thread_safe(true);
+  std::thread::id init_thread;
+  StubBackend::singleton().install_init(
+      [&](FreeableBuffer* processed,
+          ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          BackendInitContext& backend_init_context) -> Result<DelegateHandle*> {
+        init_thread = std::this_thread::get_id();
+        // The runtime allocator is usable from the init thread.
+        EXPECT_NE(
+            backend_init_context.get_runtime_allocator()->allocate(16),
+            nullptr);
+        return processed;
+      });
+  DelegateHandle* destroy_handle = nullptr;
+  StubBackend::singleton().install_destroy(
+      [&](DelegateHandle* handle) -> void { destroy_handle = handle; });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  parallel_for_calls = 0;
+  {
+    ManagedMemoryManager mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method = program->load_method(
+        "forward",
+        &mmm.get(),
+        /*event_tracer=*/nullptr,
+        /*named_data_map=*/nullptr,
+        /*snapshot=*/{},
+        ParallelForOnThreads);
+    ASSERT_EQ(method.error(), Error::Ok);
+    EXPECT_EQ(parallel_for_calls, 1);
+    EXPECT_NE(init_thread, std::thread::id());
+    EXPECT_NE(init_thread, std::this_thread::get_id());
+
+    auto input_cleanup = executorch::extension::prepare_input_tensors(*method);
+    ASSERT_EQ(input_cleanup.error(), Error::Ok);
+    EXPECT_EQ(method->execute(), Error::Ok);
+  }
+  // The delegate is destroyed with the method.
+  EXPECT_NE(destroy_handle, nullptr);
+}
+
+TEST_P(BackendIntegrationTest, ConcurrentInitWithoutTempMemory) {
+  StubBackend::singleton().install_is_init_thread_safe(true);
+  std::thread::id init_thread;
+  StubBackend::singleton().install_init(
+      [&](FreeableBuffer* processed,
+          ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          ET_UNUSED BackendInitContext& backend_init_context)
+          -> Result<DelegateHandle*> {
+        init_thread = std::this_thread::get_id();
+        return processed;
+      });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  // Like the pybindings, which provide a zero-size temp allocator.
+  MemoryAllocator temp_allocator(0, nullptr);
+  parallel_for_calls = 0;
+  ManagedMemoryManager mmm(
+      kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes, &temp_allocator);
+  Result<Method> method = program->load_method(
+      "forward",
+      &mmm.get(),
+      /*event_tracer=*/nullptr,
+      /*named_data_map=*/nullptr,
+      /*snapshot=*/{},
+      ParallelForOnThreads);
+  ASSERT_EQ(method.error(), Error::Ok);
+  // The bookkeeping came from the method allocator instead.
+  EXPECT_EQ(parallel_for_calls, 1);
+  EXPECT_NE(init_thread, std::this_thread::get_id());
+}
+
+TEST_P(BackendIntegrationTest, UnsafeBackendsInitSerially) {
+  std::thread::id init_thread;
+  StubBackend::singleton().install_init(
+      [&](ET_UNUSED FreeableBuffer* processed,
+          ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          ET_UNUSED BackendInitContext& backend_init_context)
+          -> Result<DelegateHandle*> {
+        init_thread = std::this_thread::get_id();
+        return nullptr;
+      });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  parallel_for_calls = 0;
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = program->load_method(
+      "forward",
+      &mmm.get(),
+      /*event_tracer=*/nullptr,
+      /*named_data_map=*/nullptr,
+      /*snapshot=*/{},
+      ParallelForOnThreads);
+  ASSERT_EQ(method.error(), Error::Ok);
+  // Nothing was eligible to run concurrently.
+  EXPECT_EQ(parallel_for_calls, 0);
+  EXPECT_EQ(init_thread, std::this_thread::get_id());
+}
+
+TEST_P(BackendIntegrationTest, ConcurrentInitErrorFailsLoad) {
+  StubBackend::singleton().install_is_init_thread_safe(true);
+  StubBackend::singleton().install_init(
+      [&](ET_UNUSED FreeableBuffer* processed,
+          ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          ET_UNUSED BackendInitContext& backend_init_context)
+          -> Result<DelegateHandle*> { return Error::InvalidProgram; });
+  bool destroy_called = false;
+  StubBackend::singleton().install_destroy(
+      [&](ET_UNUSED DelegateHandle* handle) -> void { destroy_called = true; });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = program->load_method(
+      "forward",
+      &mmm.get(),
+      /*event_tracer=*/nullptr,
+      /*named_data_map=*/nullptr,
+      /*snapshot=*/{},
+      ParallelForOnThreads);
+  EXPECT_EQ(method.error(), Error::InvalidProgram);
+  // Delegates that failed to init are never destroyed.
+  EXPECT_FALSE(destroy_called);
+}
+
+TEST_P(BackendIntegrationTest, SnapshotStillInitializesDelegates) {
+  int init_calls = 0;
+  StubBackend::singleton().install_init(
+      [&](FreeableBuffer* processed,
+          ET_UNUSED ArrayRef<CompileSpec> compile_specs,
+          ET_UNUSED BackendInitContext& backend_init_context)
+          -> Result<DelegateHandle*> {
+        init_calls++;
+        return processed;
+      });
+
+  Result<FileDataLoader> loader = FileDataLoader::from(program_path());
+  ASSERT_EQ(loader.error(), Error::Ok);
+  Result<Program> program = Program::load(&loader.get());
+  ASSERT_EQ(program.error(), Error::Ok);
+
+  std::vector<uint8_t> snapshot;
+  {
+    ManagedMemoryManager mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method = program->load_method("forward", &mmm.get());
+    ASSERT_EQ(method.error(), Error::Ok);
+    snapshot.resize(method->snapshot_size());
+    Result<size_t> written =
+        method->save_snapshot(snapshot.data(), snapshot.size());
+    ASSERT_EQ(written.error(), Error::Ok);
+  }
+  const int num_delegates = init_calls;
+  ASSERT_GT(num_delegates, 0);
+
+  // Snapshots only cache kernels, so delegates, which may depend on data
+  // that the snapshot doesn't cover, are initialized again.
+  {
+    ManagedMemoryManager mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method = program->load_method(
+        "forward",
+        &mmm.get(),
+        /*event_tracer=*/nullptr,
+        /*named_data_map=*/nullptr,
+        Span<const uint8_t>(snapshot.data(), snapshot.size()));
+    ASSERT_EQ(method.error(), Error::Ok);
+  }
+  EXPECT_EQ(init_calls, 2 * num_delegates);
+}
+
 // TODO: Add more tests for the runtime-to-backend interface. E.g.:
 // - Errors during init() or execute() result in runtime init/execution failures
 // - Correct values are passed to init()/execute()
@@ -9,6 +9,7 @@
 #include <executorch/runtime/executor/memory_manager.h>
 
 #include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/size_class_allocator.h>
 
 #include <executorch/test/utils/DeathTest.h>
 #include <gtest/gtest.h>
@@ -17,6 +18,7 @@ using namespace ::testing;
 using executorch::runtime::HierarchicalAllocator;
 using executorch::runtime::MemoryAllocator;
 using executorch::runtime::MemoryManager;
+using executorch::runtime::SizeClassAllocator;
 
 TEST(MemoryManagerTest, MinimalCtor) {
   MemoryAllocator method_allocator(0, nullptr);
@@ -49,6 +51,22 @@ TEST(MemoryManagerTest, CtorWithPlannedMemoryAndTemp) {
   EXPECT_EQ(mm.method_allocator(), &method_allocator);
   EXPECT_EQ(mm.planned_memory(), &planned_memory);
   EXPECT_EQ(mm.temp_allocator(), &temp_allocator);
+  EXPECT_EQ(mm.dynamic_allocator(), nullptr);
+}
+
+TEST(MemoryManagerTest, CtorWithDynamicAllocator) {
+  MemoryAllocator method_allocator(0, nullptr);
+  HierarchicalAllocator planned_memory({});
+  MemoryAllocator temp_allocator(0, nullptr);
+  SizeClassAllocator dynamic_allocator;
+
+  MemoryManager mm(
+      &method_allocator, &planned_memory, &temp_allocator, &dynamic_allocator);
+
+  EXPECT_EQ(mm.method_allocator(), &method_allocator);
+  EXPECT_EQ(mm.planned_memory(), &planned_memory);
+  EXPECT_EQ(mm.temp_allocator(), &temp_allocator);
+  EXPECT_EQ(mm.dynamic_allocator(), &dynamic_allocator);
 }
 
 TEST(MemoryManagerTest, DEPRECATEDCtor) {
@@ -0,0 +1,534 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/data_loader/buffer_data_loader.h>
+#include <executorch/kernels/portable/cpu/fusible_elementwise_ops.h>
+#include <executorch/runtime/core/exec_aten/exec_aten.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/core/event_tracer.h>
+#include <executorch/runtime/core/hierarchical_allocator.h>
+#include <executorch/runtime/core/memory_allocator.h>
+#include <executorch/runtime/executor/memory_manager.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/kernel/elementwise_fusion.h>
+#include <executorch/runtime/kernel/operator_registry.h>
+#include <executorch/runtime/platform/runtime.h>
+#include <executorch/schema/program_generated.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::extension::BufferDataLoader;
+using executorch::runtime::AllocatorID;
+using executorch::runtime::ArrayRef;
+using executorch::runtime::ChainID;
+using executorch::runtime::DebugHandle;
+using executorch::runtime::DelegateDebugIntId;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::EventTracer;
+using executorch::runtime::EventTracerEntry;
+using executorch::runtime::EventTracerFilterBase;
+using executorch::runtime::FusibleElementwiseOp;
+using executorch::runtime::get_fusible_elementwise_op;
+using executorch::runtime::get_op_function_from_registry;
+using executorch::runtime::HierarchicalAllocator;
+using executorch::runtime::Kernel;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::LoggedEValueType;
+using executorch::runtime::MemoryAllocator;
+using executorch::runtime::MemoryManager;
+using executorch::runtime::Method;
+using executorch::runtime::Program;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+using executorch::runtime::testing::TensorFactory;
+using torch::executor::native::register_portable_fusible_elementwise_ops;
+
+namespace {
+
+// Number of elements in every tensor. Odd, and large enough to span several
+// fused tiles.
+constexpr int32_t kNumel = 1027;
+// Bytes reserved for each tensor in the planned buffer.
+constexpr size_t kTensorBytes = 4112;
+
+// Indices of the values in the test program.
+constexpr int32_t kX = 0;
+constexpr int32_t kY = 1;
+constexpr int32_t kZ = 2;
+constexpr int32_t kSigmoidOut = 3;
+constexpr int32_t kMulOut = 4;
+constexpr int32_t kAddOut = 5;
+constexpr int32_t kNumTensors = 6;
+constexpr int32_t kAlpha = 6;
+constexpr int32_t kCond = 7;
+
+// Value that the tests write to the intermediate tensors before executing,
+// to tell whether the method wrote them.
+constexpr float kSentinel = 42.0f;
+
+/**
+ * Serializes a program whose "forward" method computes
+ * add(mul(sigmoid(x), y), z) with the portable kernels, one instruction per
+ * operator. All tensors are memory planned.
+ *
+ * `outputs` lists the value indices that the method returns. If
+ * `jump_destination` is non-negative, a JumpFalseCall to that instruction is
+ * appended; its condition is always true, so it never jumps. The sigmoid
+ * instruction calls the `sigmoid_name` operator.
+ */
+std::vector<uint8_t> make_program(
+    const std::vector<int32_t>& outputs,
+    int32_t jump_destination,
+    const char* sigmoid_name) {
+  flatbuffers::FlatBufferBuilder builder;
+
+  const std::vector<int32_t> sizes = {kNumel};
+  const std::vector<uint8_t> dim_order = {0};
+  std::vector<flatbuffers::Offset<executorch_flatbuffer::EValue>> values;
+  for (int32_t i = 0; i < kNumTensors; ++i) {
+    const auto allocation_info =
+        executorch_flatbuffer::CreateAllocationDetails(
+            builder,
+            /*memory_id=*/1,
+            /*memory_offset_low=*/static_cast<uint32_t>(i * kTensorBytes));
+    const auto tensor = executorch_flatbuffer::CreateTensorDirect(
+        builder,
+        executorch_flatbuffer::ScalarType::FLOAT,
+        /*storage_offset=*/0,
+        &sizes,
+        &dim_order,
+        /*requires_grad=*/false,
+        /*data_buffer_idx=*/0,
+        allocation_info);
+    values.push_back(executorch_flatbuffer::CreateEValue(
+        builder, executorch_flatbuffer::KernelTypes::Tensor, tensor.Union()));
+  }
+  values.push_back(executorch_flatbuffer::CreateEValue(
+      builder,
+      executorch_flatbuffer::KernelTypes::Int,
+      executorch_flatbuffer::CreateInt(builder, /*int_val=*/1).Union()));
+  values.push_back(executorch_flatbuffer::CreateEValue(
+      builder,
+      executorch_flatbuffer::KernelTypes::Bool,
+      executorch_flatbuffer::CreateBool(builder, /*bool_val=*/true).Union()));
+
+  const std::vector<flatbuffers::Offset<executorch_flatbuffer::Operator>>
+      operators = {
+          executorch_flatbuffer::CreateOperatorDirect(
+              builder, sigmoid_name, "out"),
+          executorch_flatbuffer::CreateOperatorDirect(
+              builder, "aten::mul", "out"),
+          executorch_flatbuffer::CreateOperatorDirect(
+              builder, "aten::add", "out"),
+      };
+
+  const std::vector<std::vector<int32_t>> kernel_args = {
+      {kX, kSigmoidOut, kSigmoidOut},
+      {kSigmoidOut, kY, kMulOut, kMulOut},
+      {kMulOut, kZ, kAlpha, kAddOut, kAddOut},
+  };
+  std::vector<flatbuffers::Offset<executorch_flatbuffer::Instruction>>
+      instructions;
+  for (size_t op_index = 0; op_index < kernel_args.size(); ++op_index) {
+    const auto kernel_call = executorch_flatbuffer::CreateKernelCallDirect(
+        builder, static_cast<int32_t>(op_index), &kernel_args[op_index]);
+    instructions.push_back(executorch_flatbuffer::CreateInstruction(
+        builder,
+        executorch_flatbuffer::InstructionArguments::KernelCall,
+        kernel_call.Union()));
+  }
+  if (jump_destination >= 0) {
+    const auto jump = executorch_flatbuffer::CreateJumpFalseCall(
+        builder, kCond, jump_destination);
+    instructions.push_back(executorch_flatbuffer::CreateInstruction(
+        builder,
+        executorch_flatbuffer::InstructionArguments::JumpFalseCall,
+        jump.Union()));
+  }
+
+  const std::vector<int32_t> inputs = {kX, kY, kZ};
+  const std::vector<flatbuffers::Offset<executorch_flatbuffer::Chain>> chains =
+      {executorch_flatbuffer::CreateChainDirect(
+          builder, &inputs, &outputs, &instructions)};
+  const std::vector<
+      flatbuffers::Offset<executorch_flatbuffer::BackendDelegate>>
+      delegates;
+  // Entry 0 is reserved for constants.
+  const std::vector<int64_t> non_const_buffer_sizes = {
+      0, kNumTensors * kTensorBytes};
+  const std::vector<flatbuffers::Offset<executorch_flatbuffer::ExecutionPlan>>
+      plans = {executorch_flatbuffer::CreateExecutionPlanDirect(
+          builder,
+          "forward",
+          executorch_flatbuffer::CreateContainerMetadataDirect(
+              builder, "", ""),
+          &values,
+          &inputs,
+          &outputs,
+          &chains,
+          &operators,
+          &delegates,
+          &non_const_buffer_sizes)};
+
+  // A constant segment with only the placeholder offset has no constants.
+  const std::vector<uint64_t> constant_offsets = {0};
+  const auto program = executorch_flatbuffer::CreateProgramDirect(
+      builder,
+      /*version=*/0,
+      &plans,
+      /*constant_buffer=*/nullptr,
+      /*backend_delegate_data=*/nullptr,
+      /*segments=*/nullptr,
+      executorch_flatbuffer::CreateSubsegmentOffsetsDirect(
+          builder, /*segment_index=*/0, &constant_offsets));
+  executorch_flatbuffer::FinishProgramBuffer(builder, program);
+
+  return std::vector<uint8_t>(
+      builder.GetBufferPointer(),
+      builder.GetBufferPointer() + builder.GetSize());
+}
+
+/**
+ * A loaded "forward" method of a program from make_program(), along with the
+ * program and memory that it refers to.
+ */
+class LoadedMethod {
+ public:
+  LoadedMethod(
+      const std::vector<int32_t>& outputs,
+      int32_t jump_destination,
+      const char* sigmoid_name)
+      : program_data_(make_program(outputs, jump_destination, sigmoid_name)),
+        loader_(program_data_.data(), program_data_.size()),
+        planned_pool_(kNumTensors * kTensorBytes),
+        planned_span_(planned_pool_.data(), planned_pool_.size()),
+        planned_memory_({&planned_span_, 1}),
+        method_pool_(32 * 1024),
+        method_allocator_(method_pool_.size(), method_pool_.data()),
+        temp_pool_(32 * 1024),
+        temp_allocator_(temp_pool_.size(), temp_pool_.data()),
+        memory_manager_(
+            &method_allocator_,
+            &planned_memory_,
+            &temp_allocator_) {}
+
+  Error load(EventTracer* event_tracer) {
+    Result<Program> program = Program::load(&loader_);
+    if (!program.ok()) {
+      return program.error();
+    }
+    program_ = std::make_unique<Program>(std::move(program.get()));
+    Result<Method> method =
+        program_->load_method("forward", &memory_manager_, event_tracer);
+    if (!method.ok()) {
+      return method.error();
+    }
+    method_ = std::make_unique<Method>(std::move(method.get()));
+    return Error::Ok;
+  }
+
+  Method& method() {
+    return *method_;
+  }
+
+  // Returns the planned data of the tensor at `value_index`.
+  float* tensor_data(int32_t value_index) {
+    return reinterpret_cast<float*>(
+        planned_pool_.data() + value_index * kTensorBytes);
+  }
+
+ private:
+  std::vector<uint8_t> program_data_;
+  BufferDataLoader loader_;
+  std::vector<uint8_t> planned_pool_;
+  Span<uint8_t> planned_span_;
+  HierarchicalAllocator planned_memory_;
+  std::vector<uint8_t> method_pool_;
+  MemoryAllocator method_allocator_;
+  std::vector<uint8_t> temp_pool_;
+  MemoryAllocator temp_allocator_;
+  MemoryManager memory_manager_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<Method> method_;
+};
+
+/// An event tracer that records nothing, at the default debug level.
+class NullEventTracer : public EventTracer {
+ public:
+  void create_event_block(const char*) override {}
+  EventTracerEntry start_profiling(const char*, ChainID, DebugHandle)
+      override {
+    return EventTracerEntry();
+  }
+  void end_profiling(EventTracerEntry) override {}
+  void track_allocation(AllocatorID, size_t) override {}
+  AllocatorID track_allocator(const char*) override {
+    return 0;
+  }
+  EventTracerEntry start_profiling_delegate(const char*, DelegateDebugIntId)
+      override {
+    return EventTracerEntry();
+  }
+  void end_profiling_delegate(EventTracerEntry, const void*, size_t)
+      override {}
+  void log_profiling_delegate(
+      const char*,
+      DelegateDebugIntId,
+      et_timestamp_t,
+      et_timestamp_t,
+      const void*,
+      size_t) override {}
+  void set_delegation_intermediate_output_filter(
+      EventTracerFilterBase*) override {}
+  Result<bool> log_intermediate_output_delegate(
+      const char*,
+      DelegateDebugIntId,
+      const Tensor&) override {
+    return true;
+  }
+  Result<bool> log_intermediate_output_delegate(
+      const char*,
+      DelegateDebugIntId,
+      const ArrayRef<Tensor>) override {
+    return true;
+  }
+  Result<bool> log_intermediate_output_delegate(
+      const char*,
+      DelegateDebugIntId,
+      const int&) override {
+    return true;
+  }
+  Result<bool> log_intermediate_output_delegate(
+      const char*,
+      DelegateDebugIntId,
+      const bool&) override {
+    return true;
+  }
+  Result<bool> log_intermediate_output_delegate(
+      const char*,
+      DelegateDebugIntId,
+      const double&) override {
+    return true;
+  }
+  Result<bool> log_evalue(const EValue&, LoggedEValueType) override {
+    return true;
+  }
+};
+
+// Computes sigmoid with the portable kernel, but is a different kernel than
+// the one that the fusible "aten::sigmoid.out" op mirrors.
+void test_sigmoid_kernel(KernelRuntimeContext& context, EValue** args) {
+  get_op_function_from_registry("aten::sigmoid.out").get()(context, args);
+}
+
+class MethodFusionTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    executorch::runtime::runtime_init();
+    ASSERT_EQ(register_portable_fusible_elementwise_ops(), Error::Ok);
+
+    // Describe "test::sigmoid.out" as fusible with the portable sigmoid
+    // kernel, but register a different kernel under that name.
+    static const Kernel kernel("test::sigmoid.out", test_sigmoid_kernel);
+    ASSERT_EQ(executorch::runtime::register_kernel(kernel), Error::Ok);
+    const FusibleElementwiseOp* sigmoid =
+        get_fusible_elementwise_op("aten::sigmoid.out");
+    ASSERT_NE(sigmoid, nullptr);
+    FusibleElementwiseOp op = *sigmoid;
+    op.name_ = "test::sigmoid.out";
+    ASSERT_EQ(
+        executorch::runtime::register_fusible_elementwise_ops({&op, 1}),
+        Error::Ok);
+  }
+
+  void SetUp() override {
+
+    std::vector<float> x(kNumel);
+    std::vector<float> y(kNumel);
+    std::vector<float> z(kNumel);
+    for (int32_t i = 0; i < kNumel; ++i) {
+      x[i] = static_cast<float>(i % 31) / 4.0f - 4.0f;
+      y[i] = static_cast<float>(i % 7) - 3.0f;
+      z[i] = static_cast<float>(i % 5) / 2.0f;
+    }
+    x_ = tf_.make({kNumel}, x);
+    y_ = tf_.make({kNumel}, y);
+    z_ = tf_.make({kNumel}, z);
+  }
+
+  // Loads a method, sets its inputs and fills its intermediates with
+  // kSentinel.
+  std::unique_ptr<LoadedMethod> load_method(
+      const std::vector<int32_t>& outputs,
+      int32_t jump_destination = -1,
+      EventTracer* event_tracer = nullptr,
+      const char* sigmoid_name = "aten::sigmoid") {
+    auto loaded = std::make_unique<LoadedMethod>(
+        outputs, jump_destination, sigmoid_name);
+    EXPECT_EQ(loaded->load(event_tracer), Error::Ok);
+    EXPECT_EQ(loaded->method().set_input(x_, 0), Error::Ok);
+    EXPECT_EQ(loaded->method().set_input(y_, 1), Error::Ok);
+    EXPECT_EQ(loaded->method().set_input(z_, 2), Error::Ok);
+    for (int32_t value_index : {kSigmoidOut, kMulOut}) {
+      float* data = loaded->tensor_data(value_index);
+      for (int32_t i = 0; i < kNumel; ++i) {
+        data[i] = kSentinel;
+      }
+    }
+    return loaded;
+  }
+
+  // Returns true if the method wrote the tensor at `value_index`.
+  bool was_written(LoadedMethod& loaded, int32_t value_index) {
+    const float* data = loaded.tensor_data(value_index);
+    for (int32_t i = 0; i < kNumel; ++i) {
+      if (data[i] != kSentinel) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns the expected value of `value_index`, computed in double.
+  Tensor expected(int32_t value_index) {
+    std::vector<float> data(kNumel);
+    for (int32_t i = 0; i < kNumel; ++i) {
+      const double x = x_.const_data_ptr<float>()[i];
+      const double sigmoid = 1.0 / (1.0 + std::exp(-x));
+      const double mul = sigmoid * y_.const_data_ptr<float>()[i];
+      const double add = mul + z_.const_data_ptr<float>()[i];
+      if (value_index == kSigmoidOut) {
+        data[i] = static_cast<float>(sigmoid);
+      } else if (value_index == kMulOut) {
+        data[i] = static_cast<float>(mul);
+      } else {
+        data[i] = static_cast<float>(add);
+      }
+    }
+    return tf_.make({kNumel}, data);
+  }
+
+  // Returns the planned tensor at `value_index` as a Tensor.
+  Tensor planned_tensor(LoadedMethod& loaded, int32_t value_index) {
+    return tf_.make(
+        {kNumel},
+        std::vector<float>(
+            loaded.tensor_data(value_index),
+            loaded.tensor_data(value_index) + kNumel));
+  }
+
+  TensorFactory<ScalarType::Float> tf_;
+  Tensor x_ = tf_.zeros({1});
+  Tensor y_ = tf_.zeros({1});
+  Tensor z_ = tf_.zeros({1});
+};
+
+} // namespace
+
+TEST_F(MethodFusionTest, FusedChainMatchesUnfusedRun) {
+  auto fused = load_method({kAddOut});
+  // Returning the intermediates gives them a second user, so nothing fuses.
+  auto unfused = load_method({kSigmoidOut, kMulOut, kAddOut});
+
+  ASSERT_EQ(fused->method().execute(), Error::Ok);
+  ASSERT_EQ(unfused->method().execute(), Error::Ok);
+
+  const Tensor fused_out = fused->method().get_output(0).toTensor();
+  const Tensor unfused_out = unfused->method().get_output(2).toTensor();
+  EXPECT_TENSOR_CLOSE(fused_out, unfused_out);
+  EXPECT_TENSOR_CLOSE(fused_out, expected(kAddOut));
+
+  // The fused run never wrote the intermediates; the unfused run wrote both.
+  EXPECT_FALSE(was_written(*fused, kSigmoidOut));
+  EXPECT_FALSE(was_written(*fused, kMulOut));
+  EXPECT_TENSOR_CLOSE(
+      planned_tensor(*unfused, kSigmoidOut), expected(kSigmoidOut));
+  EXPECT_TENSOR_CLOSE(planned_tensor(*unfused, kMulOut), expected(kMulOut));
+}
+
+TEST_F(MethodFusionTest, IntermediateWithAnotherUserBreaksChain) {
+  // The sigmoid output is also a method output, so only mul and add fuse.
+  auto loaded = load_method({kSigmoidOut, kAddOut});
+
+  ASSERT_EQ(loaded->method().execute(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(0).toTensor(), expected(kSigmoidOut));
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(1).toTensor(), expected(kAddOut));
+  EXPECT_FALSE(was_written(*loaded, kMulOut));
+}
+
+TEST_F(MethodFusionTest, JumpTargetBreaksChain) {
+  // A jump can land on the mul, so it has to start a new run: the sigmoid
+  // runs on its own and only mul and add fuse.
+  auto loaded = load_method({kAddOut}, /*jump_destination=*/1);
+
+  ASSERT_EQ(loaded->method().execute(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(0).toTensor(), expected(kAddOut));
+  EXPECT_TENSOR_CLOSE(
+      planned_tensor(*loaded, kSigmoidOut), expected(kSigmoidOut));
+  EXPECT_FALSE(was_written(*loaded, kMulOut));
+}
+
+TEST_F(MethodFusionTest, JumpToChainHeadKeepsChain) {
+  auto loaded = load_method({kAddOut}, /*jump_destination=*/0);
+
+  ASSERT_EQ(loaded->method().execute(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(0).toTensor(), expected(kAddOut));
+  EXPECT_FALSE(was_written(*loaded, kSigmoidOut));
+  EXPECT_FALSE(was_written(*loaded, kMulOut));
+}
+
+TEST_F(MethodFusionTest, EventTracerDisablesFusion) {
+  // Every operator is traced as its own event, so nothing fuses even at the
+  // default debug level.
+  NullEventTracer event_tracer;
+  auto loaded =
+      load_method({kAddOut}, /*jump_destination=*/-1, &event_tracer);
+
+  ASSERT_EQ(loaded->method().execute(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(0).toTensor(), expected(kAddOut));
+  EXPECT_TENSOR_CLOSE(
+      planned_tensor(*loaded, kSigmoidOut), expected(kSigmoidOut));
+  EXPECT_TENSOR_CLOSE(planned_tensor(*loaded, kMulOut), expected(kMulOut));
+}
+
+TEST_F(MethodFusionTest, OtherKernelWithFusibleNameIsNotFused) {
+  // The sigmoid instruction resolves to a kernel that its fusible op doesn't
+  // mirror, so it runs on its own and only mul and add fuse.
+  auto loaded = load_method(
+      {kAddOut},
+      /*jump_destination=*/-1,
+      /*event_tracer=*/nullptr,
+      "test::sigmoid");
+
+  ASSERT_EQ(loaded->method().execute(), Error::Ok);
+
+  EXPECT_TENSOR_CLOSE(
+      loaded->method().get_output(0).toTensor(), expected(kAddOut));
+  EXPECT_TENSOR_CLOSE(
+      planned_tensor(*loaded, kSigmoidOut), expected(kSigmoidOut));
+  EXPECT_FALSE(was_written(*loaded, kMulOut));
+}
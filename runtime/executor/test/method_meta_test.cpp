@@ -192,6 +192,32 @@ TEST_F(MethodMetaTest, MethodMetaAttribute) {
   ASSERT_EQ(bad_access.error(), Error::InvalidArgument);
 }
 
+TEST_F(MethodMetaTest, InstructionName) {
+  Result<MethodMeta> method_meta = programs_["add"]->method_meta("forward");
+  ASSERT_EQ(method_meta.error(), Error::Ok);
+
+  // AddModule has a single chain, whose kernel calls are all adds.
+  size_t num_adds = 0;
+  for (size_t i = 0; i < method_meta->num_instructions(); ++i) {
+    Result<const char*> name = method_meta->instruction_name(0, i);
+    if (name.error() == Error::NotFound) {
+      continue;
+    }
+    ASSERT_EQ(name.error(), Error::Ok);
+    EXPECT_STREQ(name.get(), "aten::add");
+    num_adds++;
+  }
+  EXPECT_GT(num_adds, 0);
+
+  // Invalid index Errors
+  EXPECT_EQ(
+      method_meta->instruction_name(0, method_meta->num_instructions())
+          .error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      method_meta->instruction_name(1, 0).error(), Error::InvalidArgument);
+}
+
 TEST_F(MethodMetaTest, TensorInfoSizeOverflow) {
   // Create sizes that will cause overflow when multiplied
   std::vector<int32_t> overflow_sizes = {
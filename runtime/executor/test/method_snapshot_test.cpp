@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <executorch/extension/data_loader/file_data_loader.h>
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/result.h>
+#include <executorch/runtime/executor/method.h>
+#include <executorch/runtime/executor/method_snapshot.h>
+#include <executorch/runtime/executor/program.h>
+#include <executorch/runtime/executor/test/managed_memory_manager.h>
+#include <executorch/runtime/kernel/operator_registry.h>
+#include <executorch/runtime/platform/runtime.h>
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::aten::Scalar;
+using executorch::extension::FileDataLoader;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::get_registered_kernels;
+using executorch::runtime::Kernel;
+using executorch::runtime::KernelKey;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::kMethodSnapshotNoKernel;
+using executorch::runtime::kMethodSnapshotVersion;
+using executorch::runtime::Method;
+using executorch::runtime::MethodSnapshotHeader;
+using executorch::runtime::Program;
+using executorch::runtime::register_kernel;
+using executorch::runtime::Result;
+using executorch::runtime::Span;
+using executorch::runtime::testing::ManagedMemoryManager;
+
+constexpr size_t kDefaultNonConstMemBytes = 32 * 1024U;
+constexpr size_t kDefaultRuntimeMemBytes = 32 * 1024U;
+
+namespace {
+
+// Returns the registry index of the kernel with the given name and key.
+size_t find_kernel(const char* name, KernelKey key) {
+  Span<const Kernel> kernels = get_registered_kernels();
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    if (strcmp(kernels[i].name_, name) == 0 && kernels[i].kernel_key_ == key) {
+      return i;
+    }
+  }
+  return kernels.size();
+}
+
+// Key of the float, contiguous add.out call in ModuleAdd.
+const KernelKey kAddFloatKey("v1/6;0,1|6;0,1|6;0,1|6;0,1");
+
+} // namespace
+
+class MethodSnapshotTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    executorch::runtime::runtime_init();
+    // Two add.out kernels that the method can resolve to, and one kernel with
+    // a different name. The bodies differ so that the functions do too.
+    Error err = register_kernel(Kernel(
+        "aten::add.out", {}, [](KernelRuntimeContext&, EValue** stack) {
+          *(stack[0]) = Scalar(1);
+        }));
+    ASSERT_EQ(err, Error::Ok);
+    err = register_kernel(Kernel(
+        "aten::add.out",
+        kAddFloatKey,
+        [](KernelRuntimeContext&, EValue** stack) {
+          *(stack[0]) = Scalar(2);
+        }));
+    ASSERT_EQ(err, Error::Ok);
+    err = register_kernel(Kernel(
+        "aten::mul.out", {}, [](KernelRuntimeContext&, EValue** stack) {
+          *(stack[0]) = Scalar(3);
+        }));
+    ASSERT_EQ(err, Error::Ok);
+  }
+
+  void SetUp() override {
+    const char* path = std::getenv("ET_MODULE_ADD_PATH");
+    Result<FileDataLoader> loader = FileDataLoader::from(path);
+    ASSERT_EQ(loader.error(), Error::Ok);
+    loader_ = std::make_unique<FileDataLoader>(std::move(loader.get()));
+
+    Result<Program> program = Program::load(
+        loader_.get(), Program::Verification::InternalConsistency);
+    ASSERT_EQ(program.error(), Error::Ok);
+    program_ = std::make_unique<Program>(std::move(program.get()));
+  }
+
+  // Loads "forward" with the given snapshot and returns its own snapshot.
+  std::vector<uint8_t> load_and_save(Span<const uint8_t> snapshot = {}) {
+    ManagedMemoryManager mmm(
+        kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+    Result<Method> method = program_->load_method(
+        "forward",
+        &mmm.get(),
+        /*event_tracer=*/nullptr,
+        /*named_data_map=*/nullptr,
+        snapshot);
+    EXPECT_EQ(method.error(), Error::Ok);
+    if (!method.ok()) {
+      return {};
+    }
+    std::vector<uint8_t> saved(method->snapshot_size());
+    Result<size_t> written = method->save_snapshot(saved.data(), saved.size());
+    EXPECT_EQ(written.error(), Error::Ok);
+    EXPECT_EQ(written.get(), saved.size());
+    return saved;
+  }
+
+  static Span<const uint8_t> span(const std::vector<uint8_t>& v) {
+    return {v.data(), v.size()};
+  }
+
+  static MethodSnapshotHeader header(const std::vector<uint8_t>& snapshot) {
+    MethodSnapshotHeader header;
+    memcpy(&header, snapshot.data(), sizeof(header));
+    return header;
+  }
+
+  static uint32_t kernel_index(
+      const std::vector<uint8_t>& snapshot,
+      size_t instruction) {
+    uint32_t index;
+    memcpy(
+        &index,
+        snapshot.data() + sizeof(MethodSnapshotHeader) +
+            instruction * sizeof(uint32_t),
+        sizeof(index));
+    return index;
+  }
+
+  static void set_kernel_index(
+      std::vector<uint8_t>& snapshot,
+      size_t instruction,
+      uint32_t index) {
+    memcpy(
+        snapshot.data() + sizeof(MethodSnapshotHeader) +
+            instruction * sizeof(uint32_t),
+        &index,
+        sizeof(index));
+  }
+
+  // Points every instruction that resolved to the specialized add.out kernel
+  // at `index` instead, and returns how many did.
+  static size_t redirect_add(std::vector<uint8_t>& snapshot, uint32_t index) {
+    const size_t add_index = find_kernel("aten::add.out", kAddFloatKey);
+    size_t count = 0;
+    for (size_t i = 0; i < header(snapshot).num_instructions; ++i) {
+      if (kernel_index(snapshot, i) == add_index) {
+        set_kernel_index(snapshot, i, index);
+        count++;
+      }
+    }
+    return count;
+  }
+
+  std::unique_ptr<FileDataLoader> loader_;
+  std::unique_ptr<Program> program_;
+};
+
+TEST_F(MethodSnapshotTest, SavesResolvedKernels) {
+  std::vector<uint8_t> snapshot = load_and_save();
+  ASSERT_GT(snapshot.size(), sizeof(MethodSnapshotHeader));
+
+  MethodSnapshotHeader h = header(snapshot);
+  EXPECT_EQ(memcmp(h.magic, "ETMS", 4), 0);
+  EXPECT_EQ(h.version, kMethodSnapshotVersion);
+  EXPECT_EQ(
+      snapshot.size(),
+      sizeof(MethodSnapshotHeader) + h.num_instructions * sizeof(uint32_t));
+
+  // The float add resolves to its specialized kernel.
+  const size_t add_index = find_kernel("aten::add.out", kAddFloatKey);
+  bool found_add = false;
+  for (size_t i = 0; i < h.num_instructions; ++i) {
+    const uint32_t index = kernel_index(snapshot, i);
+    EXPECT_TRUE(index == kMethodSnapshotNoKernel || index == add_index);
+    found_add |= index == add_index;
+  }
+  EXPECT_TRUE(found_add);
+
+  // Loading with the snapshot resolves to the same kernels.
+  EXPECT_EQ(load_and_save(span(snapshot)), snapshot);
+}
+
+TEST_F(MethodSnapshotTest, RestoresKernelsFromSnapshot) {
+  std::vector<uint8_t> snapshot = load_and_save();
+  // Point the add at the fallback kernel, which a registry lookup would never
+  // pick. A method loaded from the snapshot uses it.
+  const size_t fallback = find_kernel("aten::add.out", {});
+  ASSERT_GT(redirect_add(snapshot, static_cast<uint32_t>(fallback)), 0);
+
+  EXPECT_EQ(load_and_save(span(snapshot)), snapshot);
+}
+
+TEST_F(MethodSnapshotTest, ResolvesKernelsWithWrongName) {
+  std::vector<uint8_t> original = load_and_save();
+  std::vector<uint8_t> snapshot = original;
+  const size_t mul = find_kernel("aten::mul.out", {});
+  ASSERT_GT(redirect_add(snapshot, static_cast<uint32_t>(mul)), 0);
+  EXPECT_EQ(load_and_save(span(snapshot)), original);
+
+  // Indices past the end of the registry are looked up as well.
+  snapshot = original;
+  ASSERT_GT(
+      redirect_add(
+          snapshot, static_cast<uint32_t>(get_registered_kernels().size())),
+      0);
+  EXPECT_EQ(load_and_save(span(snapshot)), original);
+}
+
+TEST_F(MethodSnapshotTest, IgnoresStaleSnapshots) {
+  const std::vector<uint8_t> original = load_and_save();
+  std::vector<uint8_t> redirected = original;
+  const size_t fallback = find_kernel("aten::add.out", {});
+  ASSERT_GT(redirect_add(redirected, static_cast<uint32_t>(fallback)), 0);
+
+  // Each of these snapshots is rejected as a whole, so the method resolves
+  // the add through the registry again.
+  std::vector<uint8_t> stale = redirected;
+  stale[offsetof(MethodSnapshotHeader, program_hash)] ^= 1;
+  EXPECT_EQ(load_and_save(span(stale)), original);
+
+  stale = redirected;
+  stale[offsetof(MethodSnapshotHeader, registry_hash)] ^= 1;
+  EXPECT_EQ(load_and_save(span(stale)), original);
+
+  stale = redirected;
+  stale[offsetof(MethodSnapshotHeader, version)] ^= 1;
+  EXPECT_EQ(load_and_save(span(stale)), original);
+
+  stale = redirected;
+  stale.pop_back();
+  EXPECT_EQ(load_and_save(span(stale)), original);
+}
+
+TEST_F(MethodSnapshotTest, SaveFailsWithSmallBuffer) {
+  ManagedMemoryManager mmm(kDefaultNonConstMemBytes, kDefaultRuntimeMemBytes);
+  Result<Method> method = program_->load_method("forward", &mmm.get());
+  ASSERT_EQ(method.error(), Error::Ok);
+
+  std::vector<uint8_t> buffer(method->snapshot_size() - 1);
+  EXPECT_EQ(
+      method->save_snapshot(buffer.data(), buffer.size()).error(),
+      Error::InvalidArgument);
+  EXPECT_EQ(
+      method->save_snapshot(nullptr, method->snapshot_size()).error(),
+      Error::InvalidArgument);
+}
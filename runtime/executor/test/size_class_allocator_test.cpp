@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/executor/size_class_allocator.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <executorch/runtime/platform/runtime.h>
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using executorch::runtime::SizeClassAllocator;
+
+class SizeClassAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    executorch::runtime::runtime_init();
+  }
+};
+
+TEST_F(SizeClassAllocatorTest, RoundsUpToSizeClasses) {
+  SizeClassAllocator allocator;
+  size_t capacity = 0;
+
+  void* small = allocator.allocate(1, &capacity);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(capacity, 64);
+  allocator.free(small, capacity);
+
+  void* large = allocator.allocate(1000, &capacity);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(capacity, 1024);
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(large) % alignof(std::max_align_t), 0);
+  // The whole capacity is usable.
+  std::memset(large, 0xab, capacity);
+  allocator.free(large, capacity);
+}
+
+TEST_F(SizeClassAllocatorTest, ReusesFreedBlocks) {
+  SizeClassAllocator allocator;
+  size_t capacity = 0;
+
+  void* first = allocator.allocate(100, &capacity);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(allocator.in_use_bytes(), 128);
+  allocator.free(first, capacity);
+  EXPECT_EQ(allocator.in_use_bytes(), 0);
+  EXPECT_EQ(allocator.cached_bytes(), 128);
+
+  // Any size in the same class gets the cached block back.
+  void* second = allocator.allocate(65, &capacity);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(allocator.cached_bytes(), 0);
+  EXPECT_EQ(allocator.total_bytes(), 128);
+
+  // A different class needs a new block.
+  void* third = allocator.allocate(200, &capacity);
+  EXPECT_NE(third, first);
+  EXPECT_EQ(allocator.total_bytes(), 128 + 256);
+  EXPECT_EQ(allocator.peak_in_use_bytes(), 128 + 256);
+}
+
+TEST_F(SizeClassAllocatorTest, TrimReleasesCachedBlocks) {
+  SizeClassAllocator allocator;
+  size_t a_capacity = 0;
+  size_t b_capacity = 0;
+  void* a = allocator.allocate(100, &a_capacity);
+  void* b = allocator.allocate(1000, &b_capacity);
+  allocator.free(a, a_capacity);
+
+  allocator.trim();
+  EXPECT_EQ(allocator.cached_bytes(), 0);
+  EXPECT_EQ(allocator.total_bytes(), 1024);
+  EXPECT_EQ(allocator.in_use_bytes(), 1024);
+  allocator.free(b, b_capacity);
+}
+
+TEST_F(SizeClassAllocatorTest, LimitsCachedBytes) {
+  SizeClassAllocator::Options options;
+  options.max_cached_bytes = 128;
+  SizeClassAllocator allocator(options);
+  size_t a_capacity = 0;
+  size_t b_capacity = 0;
+  void* a = allocator.allocate(128, &a_capacity);
+  void* b = allocator.allocate(128, &b_capacity);
+
+  allocator.free(a, a_capacity);
+  allocator.free(b, b_capacity);
+  // Only one of the blocks fits in the cache.
+  EXPECT_EQ(allocator.cached_bytes(), 128);
+  EXPECT_EQ(allocator.total_bytes(), 128);
+}
+
+TEST_F(SizeClassAllocatorTest, LimitsTotalBytes) {
+  SizeClassAllocator::Options options;
+  options.max_total_bytes = 1024;
+  SizeClassAllocator allocator(options);
+  size_t capacity = 0;
+
+  void* a = allocator.allocate(512, &capacity);
+  ASSERT_NE(a, nullptr);
+  allocator.free(a, capacity);
+
+  // The cached 512-byte block is released to make room for 1024 bytes.
+  void* b = allocator.allocate(1024, &capacity);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(allocator.total_bytes(), 1024);
+
+  // Nothing is cached, so there is no room for more.
+  EXPECT_EQ(allocator.allocate(1, &capacity), nullptr);
+  EXPECT_EQ(allocator.allocate(SIZE_MAX, &capacity), nullptr);
+}
+
+TEST_F(SizeClassAllocatorTest, ShrinksOversizedBlocks) {
+  SizeClassAllocator allocator;
+  EXPECT_FALSE(allocator.should_shrink(600, 1024));
+  EXPECT_TRUE(allocator.should_shrink(256, 1024));
+  // The smallest class never shrinks.
+  EXPECT_FALSE(allocator.should_shrink(1, 64));
+
+  SizeClassAllocator::Options options;
+  options.shrink_ratio = 0;
+  SizeClassAllocator no_shrink(options);
+  EXPECT_FALSE(no_shrink.should_shrink(1, 1024));
+}
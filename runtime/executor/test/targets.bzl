@@ -105,6 +105,21 @@ def define_common_targets(is_fbcode = False):
         ],
     )
 
+    runtime.cxx_test(
+        name = "method_fusion_test",
+        srcs = [
+            "method_fusion_test.cpp",
+        ],
+        deps = [
+            "//executorch/extension/data_loader:buffer_data_loader",
+            "//executorch/kernels/portable/cpu:fusible_elementwise_ops",
+            "//executorch/kernels/portable:generated_lib",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+            "//executorch/runtime/executor:program",
+            "//executorch/schema:program",
+        ],
+    )
+
     # TODO(dbort): Find a way to make these run for ANDROID/APPLE in xplat. The
     # android and ios test determinators don't like the reference to the model
     # file in fbcode. See https://fburl.com/9esapdmd
@@ -213,6 +228,20 @@ def define_common_targets(is_fbcode = False):
             env = modules_env,
         )
 
+        runtime.cxx_test(
+            name = "method_snapshot_test",
+            srcs = [
+                "method_snapshot_test.cpp",
+            ],
+            deps = [
+                ":managed_memory_manager",
+                "//executorch/runtime/executor:program",
+                "//executorch/runtime/kernel:operator_registry",
+                "//executorch/extension/data_loader:file_data_loader",
+            ],
+            env = modules_env,
+        )
+
         runtime.cxx_test(
             name = "kernel_integration_test",
             srcs = [
@@ -288,6 +317,17 @@ def define_common_targets(is_fbcode = False):
             ],
         )
 
+        runtime.cxx_test(
+            name = "size_class_allocator_test",
+            srcs = [
+                "size_class_allocator_test.cpp",
+            ],
+            deps = [
+                "//executorch/runtime/executor:memory_manager",
+                "//executorch/runtime/platform:platform",
+            ],
+        )
+
         runtime.cxx_test(
             name = "tensor_parser_test",
             srcs = [
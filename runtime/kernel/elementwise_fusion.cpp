@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/kernel/elementwise_fusion.h>
+
+#include <cinttypes>
+#include <cstring>
+
+#include <executorch/runtime/core/exec_aten/util/tensor_util.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/log.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+
+namespace {
+
+// Maximum number of operators that can be registered as fusible.
+constexpr size_t kMaxFusibleElementwiseOps = 64;
+
+// Number of float elements computed per tile. Small enough that a tile stays
+// in L1 across all stages of a chain.
+constexpr size_t kTileSize = 512;
+
+// Number of elements per parallel_for chunk. Matches the GRAIN_SIZE in
+// thread_parallel_interface.h that the portable elementwise kernels use.
+constexpr int64_t kGrainSize = 32768;
+
+// Only zero-initialized, so that ops can be registered from static
+// initializers in other translation units.
+// @lint-ignore CLANGTIDY facebook-hte-CArray
+FusibleElementwiseOp registered_fusible_ops[kMaxFusibleElementwiseOps];
+size_t num_registered_fusible_ops = 0;
+
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+
+// Like tensor_is_contiguous(), but quiet: a non-contiguous tensor is an
+// expected reason to fall back, not an error.
+bool is_contiguous_quiet(const Tensor& t) {
+  const auto strides = t.strides();
+  const auto sizes = t.sizes();
+  int64_t expected_stride = 1;
+  for (size_t i = strides.size(); i > 0; --i) {
+    if (sizes[i - 1] != 1 && strides[i - 1] != expected_stride) {
+      return false;
+    }
+    expected_stride *= sizes[i - 1];
+  }
+  return true;
+}
+
+bool sizes_equal(const Tensor& a, const Tensor& b) {
+  const auto a_sizes = a.sizes();
+  const auto b_sizes = b.sizes();
+  if (a_sizes.size() != b_sizes.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a_sizes.size(); ++i) {
+    if (a_sizes[i] != b_sizes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool can_execute_fused(
+    Span<const FusedElementwiseStage> stages,
+    const Tensor& in) {
+  if (in.scalar_type() != ScalarType::Float || !is_contiguous_quiet(in)) {
+    return false;
+  }
+  for (const auto& stage : stages) {
+    const FusibleElementwiseOp* op = stage.op;
+    const EValue* out_arg = stage.args[op->out_arg_];
+    if (!out_arg->isTensor() ||
+        out_arg->toTensor().scalar_type() != ScalarType::Float) {
+      return false;
+    }
+    for (size_t i = 0; i < op->num_args_; ++i) {
+      const EValue* arg = stage.args[i];
+      // The returned value aliases the out argument.
+      if (i == op->in_arg_ || arg == out_arg || !arg->isTensor()) {
+        continue;
+      }
+      const Tensor& t = arg->toTensor();
+      if (t.scalar_type() != ScalarType::Float || !sizes_equal(t, in) ||
+          !is_contiguous_quiet(t)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Elementwise stages read and write matching indices, so reading a tensor
+// that is exactly the output is safe, but a partial overlap would let an early
+// tile clobber data that a later tile still has to read. Memory planning can
+// produce such overlaps when an operand's lifetime ends inside the chain.
+bool partially_overlaps(const Tensor& t, const Tensor& out) {
+  const auto* t_begin = static_cast<const char*>(t.const_data_ptr());
+  const auto* out_begin = static_cast<const char*>(out.const_data_ptr());
+  if (t_begin == out_begin) {
+    return false;
+  }
+  return t_begin < out_begin + out.nbytes() &&
+      out_begin < t_begin + t.nbytes();
+}
+
+bool reads_overlap_output(
+    Span<const FusedElementwiseStage> stages,
+    const Tensor& in,
+    const Tensor& out) {
+  if (partially_overlaps(in, out)) {
+    return true;
+  }
+  for (const auto& stage : stages) {
+    const FusibleElementwiseOp* op = stage.op;
+    const EValue* out_arg = stage.args[op->out_arg_];
+    for (size_t i = 0; i < op->num_args_; ++i) {
+      const EValue* arg = stage.args[i];
+      if (i == op->in_arg_ || arg == out_arg || !arg->isTensor()) {
+        continue;
+      }
+      if (partially_overlaps(arg->toTensor(), out)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void execute_unfused(
+    KernelRuntimeContext& context,
+    Span<const FusedElementwiseStage> stages) {
+  for (const auto& stage : stages) {
+    stage.kernel(context, stage.args);
+    if (context.failure_state() != Error::Ok) {
+      return;
+    }
+  }
+}
+
+} // namespace
+
+Error register_fusible_elementwise_ops(Span<const FusibleElementwiseOp> ops) {
+  ET_CHECK_OR_RETURN_ERROR(
+      ops.size() + num_registered_fusible_ops <= kMaxFusibleElementwiseOps,
+      RegistrationExceedingMaxKernels,
+      "Registering %" ET_PRIsize_t
+      " fusible ops would exceed the limit of %" ET_PRIsize_t,
+      ops.size(),
+      kMaxFusibleElementwiseOps);
+  for (const auto& op : ops) {
+    ET_CHECK_OR_RETURN_ERROR(
+        op.name_ != nullptr && op.tile_fn_ != nullptr &&
+            op.kernel_ != nullptr && op.in_arg_ < op.num_args_ && op.out_arg_ < op.num_args_ &&
+            op.in_arg_ != op.out_arg_,
+        InvalidArgument,
+        "Malformed fusible op %s",
+        op.name_ != nullptr ? op.name_ : "(null)");
+    ET_CHECK_OR_RETURN_ERROR(
+        get_fusible_elementwise_op(op.name_) == nullptr,
+        RegistrationAlreadyRegistered,
+        "Re-registering fusible op %s",
+        op.name_);
+    registered_fusible_ops[num_registered_fusible_ops++] = op;
+  }
+  return Error::Ok;
+}
+
+const FusibleElementwiseOp* get_fusible_elementwise_op(const char* name) {
+  for (size_t i = 0; i < num_registered_fusible_ops; ++i) {
+    if (strcmp(registered_fusible_ops[i].name_, name) == 0) {
+      return &registered_fusible_ops[i];
+    }
+  }
+  return nullptr;
+}
+
+bool has_fusible_elementwise_ops() {
+  return num_registered_fusible_ops > 0;
+}
+
+void execute_fused_elementwise(
+    KernelRuntimeContext& context,
+    Span<const FusedElementwiseStage> stages) {
+  ET_DCHECK(stages.size() > 0);
+  const FusedElementwiseStage& first = stages[0];
+  const FusedElementwiseStage& last = stages[stages.size() - 1];
+  const Tensor& in = first.args[first.op->in_arg_]->toTensor();
+
+  if (!can_execute_fused(stages, in)) {
+    execute_unfused(context, stages);
+    return;
+  }
+
+  Tensor& out = last.args[last.op->out_arg_]->toTensor();
+  Error err = resize_tensor(out, in.sizes());
+  if (err != Error::Ok || !is_contiguous_quiet(out)) {
+    ET_LOG(Error, "Failed to resize output of fused elementwise chain");
+    context.fail(Error::InvalidArgument);
+    return;
+  }
+  if (reads_overlap_output(stages, in, out)) {
+    execute_unfused(context, stages);
+    return;
+  }
+
+  const float* in_data = in.const_data_ptr<float>();
+  float* out_data = out.mutable_data_ptr<float>();
+  const int64_t numel = in.numel();
+  const auto run_tiles = [&](int64_t chunk_begin, int64_t chunk_end) {
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    float tile[kTileSize];
+    for (size_t begin = static_cast<size_t>(chunk_begin);
+         begin < static_cast<size_t>(chunk_end);
+         begin += kTileSize) {
+      const size_t remaining = static_cast<size_t>(chunk_end) - begin;
+      const size_t n = remaining < kTileSize ? remaining : kTileSize;
+      // The first stage reads the chained input, the last one writes the
+      // final output, and everything in between stays in the tile.
+      const float* src = in_data + begin;
+      for (size_t i = 0; i < stages.size(); ++i) {
+        float* dst = i + 1 == stages.size() ? out_data + begin : tile;
+        stages[i].op->tile_fn_(stages[i].args, src, dst, begin, n);
+        src = dst;
+      }
+    }
+  };
+
+  // Split the work exactly like the unfused portable kernels would, so that
+  // fusing never costs parallelism.
+  const ElementwiseParallelForFn parallel_for = first.op->parallel_for_;
+  if (parallel_for == nullptr || numel <= kGrainSize) {
+    run_tiles(0, numel);
+  } else if (!parallel_for(0, numel, kGrainSize, run_tiles)) {
+    ET_LOG(Error, "parallel_for failed in fused elementwise chain");
+    context.fail(Error::Internal);
+  }
+}
+
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <executorch/runtime/core/error.h>
+#include <executorch/runtime/core/evalue.h>
+#include <executorch/runtime/core/function_ref.h>
+#include <executorch/runtime/core/span.h>
+#include <executorch/runtime/kernel/operator_registry.h>
+#include <executorch/runtime/platform/compiler.h>
+
+namespace executorch {
+namespace ET_RUNTIME_NAMESPACE {
+
+/**
+ * Applies one elementwise operator to a contiguous tile of `n` float elements.
+ *
+ * `in` holds the tile of the operator's chained input and `out` receives the
+ * result; the two may alias. `begin` is the flat index of the first element
+ * of the tile within the full tensor, so operators with additional tensor
+ * operands can read the matching slice of them from `args`. `args` is the
+ * operator's full argument stack, as passed to its OpFunction.
+ */
+using ElementwiseTileFn = void (*)(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n);
+
+/**
+ * Returns true if an instruction's arguments are ones the tile function
+ * computes exactly like the operator's kernel. Called once by Method::init;
+ * arguments that the kernel would reject must leave the instruction unfused.
+ */
+using ElementwiseCanFuseFn = bool (*)(EValue** args);
+
+/**
+ * Calls `f` on chunks of the range [begin, end), possibly concurrently, and
+ * returns once every chunk has run. Returns false if the range is invalid.
+ * `executorch::extension::parallel_for` has this signature when threadpool
+ * support is enabled.
+ */
+using ElementwiseParallelForFn = bool (*)(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    FunctionRef<void(int64_t, int64_t)> f);
+
+/**
+ * Describes an out-variant elementwise operator whose kernel may be fused
+ * with neighboring elementwise kernels by Method::init.
+ *
+ * Every tensor argument other than the chained input and the output must
+ * have the same shape as the chained input for the fused path to be taken at
+ * execution time; otherwise the original kernels are called one by one.
+ *
+ * Fields marked optional may be null.
+ * Don't add default member initializers: the registry must stay trivially
+ * constructible so that ops can be registered from static initializers.
+ */
+struct FusibleElementwiseOp {
+  /// Operator name, with overload, e.g. "aten::sigmoid.out". Not owned.
+  const char* name_;
+  /// Number of entries in the argument stack, including the returned value.
+  size_t num_args_;
+  /// Index of the tensor argument that the previous operator's output feeds.
+  size_t in_arg_;
+  /// Index of the out tensor argument.
+  size_t out_arg_;
+  /// Computes the operator over one tile of float elements.
+  ElementwiseTileFn tile_fn_;
+  /// Optional. If set, instructions for which it returns false are not fused.
+  ElementwiseCanFuseFn can_fuse_fn_;
+  /// Optional. The parallel_for that the operator's kernel splits its work
+  /// with; a fused chain that starts with this operator splits its tiles the
+  /// same way. If null, fused chains run on the calling thread.
+  ElementwiseParallelForFn parallel_for_;
+  /// The kernel that tile_fn_ mirrors. Instructions whose resolved kernel is a
+  /// different one, e.g. an optimized or custom kernel registered under the
+  /// same name, are not fused.
+  OpFunction kernel_;
+};
+
+/**
+ * One operator in a fused chain: the operator description, its resolved
+ * unfused kernel, and its argument stack.
+ */
+struct FusedElementwiseStage {
+  const FusibleElementwiseOp* op;
+  OpFunction kernel;
+  EValue** args;
+};
+
+/**
+ * Registers operators that may take part in elementwise fusion. Operator
+ * names must be unique across calls.
+ *
+ * Nothing is registered by default: if no operators are registered,
+ * Method::init never fuses instructions.
+ */
+ET_NODISCARD Error
+register_fusible_elementwise_ops(Span<const FusibleElementwiseOp> ops);
+
+/**
+ * Returns the fusible description of the named operator, or nullptr if it has
+ * not been registered.
+ */
+const FusibleElementwiseOp* get_fusible_elementwise_op(const char* name);
+
+/// Returns true if any fusible operator has been registered.
+bool has_fusible_elementwise_ops();
+
+/**
+ * Runs a chain of elementwise operators as a single kernel. The chained input
+ * is read once and the final output written once, one tile at a time, without
+ * touching the intermediate tensors. Large tensors are split across threads
+ * with the first stage's parallel_for_, using the same grain size as the
+ * portable kernels.
+ *
+ * Falls back to calling each stage's kernel in order if any tensor is not
+ * contiguous or the operands' shapes differ from the chained input's, in which
+ * case the intermediate tensors are written as usual.
+ *
+ * Errors are reported through `context.fail()`.
+ */
+void execute_fused_elementwise(
+    KernelRuntimeContext& context,
+    Span<const FusedElementwiseStage> stages);
+
+} // namespace ET_RUNTIME_NAMESPACE
+} // namespace executorch
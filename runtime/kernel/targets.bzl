@@ -68,6 +68,25 @@ def define_common_targets():
             preprocessor_flags = _operator_registry_preprocessor_flags(),
         )
 
+        runtime.cxx_library(
+            name = "elementwise_fusion" + aten_suffix,
+            srcs = ["elementwise_fusion.cpp"],
+            exported_headers = ["elementwise_fusion.h"],
+            visibility = [
+                "//executorch/...",
+                "@EXECUTORCH_CLIENTS",
+            ],
+            exported_deps = [
+                ":operator_registry" + aten_suffix,
+                "//executorch/runtime/core:core",
+                "//executorch/runtime/core:evalue" + aten_suffix,
+            ],
+            deps = [
+                ":kernel_runtime_context" + aten_suffix,
+                "//executorch/runtime/core/exec_aten/util:tensor_util" + aten_suffix,
+            ],
+        )
+
         runtime.cxx_library(
             name = "kernel_runtime_context" + aten_suffix,
             exported_headers = [
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <executorch/runtime/kernel/elementwise_fusion.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_factory.h>
+#include <executorch/runtime/core/exec_aten/testing_util/tensor_util.h>
+#include <executorch/runtime/kernel/kernel_runtime_context.h>
+#include <executorch/runtime/platform/runtime.h>
+
+using namespace ::testing;
+using executorch::aten::ScalarType;
+using executorch::aten::Tensor;
+using executorch::runtime::Error;
+using executorch::runtime::EValue;
+using executorch::runtime::execute_fused_elementwise;
+using executorch::runtime::FusedElementwiseStage;
+using executorch::runtime::FusibleElementwiseOp;
+using executorch::runtime::get_fusible_elementwise_op;
+using executorch::runtime::has_fusible_elementwise_ops;
+using executorch::runtime::KernelRuntimeContext;
+using executorch::runtime::register_fusible_elementwise_ops;
+using executorch::runtime::Span;
+using executorch::runtime::testing::TensorFactory;
+
+namespace {
+
+// Number of times the unfused kernels have been called.
+int unfused_calls = 0;
+
+// test::add_one.out(Tensor self, *, Tensor(a!) out)
+void add_one_tile(EValue**, const float* in, float* out, size_t, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = in[i] + 1.0f;
+  }
+}
+
+void add_one_kernel(KernelRuntimeContext&, EValue** args) {
+  unfused_calls++;
+  const Tensor& in = args[0]->toTensor();
+  Tensor& out = args[1]->toTensor();
+  for (ssize_t i = 0; i < in.numel(); ++i) {
+    out.mutable_data_ptr<float>()[i] = in.const_data_ptr<float>()[i] + 1.0f;
+  }
+}
+
+// Unfused kernel that only counts calls, for inputs the other kernels can't
+// read.
+void counting_kernel(KernelRuntimeContext&, EValue**) {
+  unfused_calls++;
+}
+
+// test::mul.out(Tensor self, Tensor other, *, Tensor(a!) out)
+void mul_tile(
+    EValue** args,
+    const float* in,
+    float* out,
+    size_t begin,
+    size_t n) {
+  const float* other = args[1]->toTensor().const_data_ptr<float>() + begin;
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = in[i] * other[i];
+  }
+}
+
+void mul_kernel(KernelRuntimeContext&, EValue** args) {
+  unfused_calls++;
+  const Tensor& a = args[0]->toTensor();
+  const Tensor& b = args[1]->toTensor();
+  Tensor& out = args[2]->toTensor();
+  // Only handles the broadcast case that the tests below use: b has one
+  // element.
+  const float* b_data = b.const_data_ptr<float>();
+  for (ssize_t i = 0; i < a.numel(); ++i) {
+    out.mutable_data_ptr<float>()[i] = a.const_data_ptr<float>()[i] *
+        b_data[b.numel() == 1 ? 0 : i];
+  }
+}
+
+// Number of chunks that fake_parallel_for has run.
+int parallel_chunks = 0;
+
+// Splits the range into grain-sized chunks like a threadpool would, but runs
+// them in reverse order on the calling thread.
+bool fake_parallel_for(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    executorch::runtime::FunctionRef<void(int64_t, int64_t)> f) {
+  const int64_t num_chunks = (end - begin + grain_size - 1) / grain_size;
+  for (int64_t i = num_chunks; i > 0; --i) {
+    const int64_t chunk_begin = begin + (i - 1) * grain_size;
+    f(chunk_begin, std::min(chunk_begin + grain_size, end));
+    parallel_chunks++;
+  }
+  return true;
+}
+
+class ElementwiseFusionTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    executorch::runtime::runtime_init();
+    // @lint-ignore CLANGTIDY facebook-hte-CArray
+    static const FusibleElementwiseOp ops[] = {
+        {"test::add_one.out",
+         3,
+         0,
+         1,
+         add_one_tile,
+         /*can_fuse_fn_=*/nullptr,
+         /*parallel_for_=*/nullptr,
+         add_one_kernel},
+        {"test::mul.out",
+         4,
+         0,
+         2,
+         mul_tile,
+         /*can_fuse_fn_=*/nullptr,
+         /*parallel_for_=*/nullptr,
+         mul_kernel},
+        {"test::parallel_add_one.out",
+         3,
+         0,
+         1,
+         add_one_tile,
+         /*can_fuse_fn_=*/nullptr,
+         fake_parallel_for,
+         add_one_kernel},
+    };
+    ASSERT_EQ(register_fusible_elementwise_ops({ops, 3}), Error::Ok);
+  }
+
+  void SetUp() override {
+    unfused_calls = 0;
+    parallel_chunks = 0;
+  }
+
+  TensorFactory<ScalarType::Float> tf_;
+};
+
+} // namespace
+
+TEST_F(ElementwiseFusionTest, LookupRegisteredOps) {
+  EXPECT_TRUE(has_fusible_elementwise_ops());
+  const FusibleElementwiseOp* op = get_fusible_elementwise_op("test::mul.out");
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(op->num_args_, 4);
+  EXPECT_EQ(op->out_arg_, 2);
+  EXPECT_EQ(get_fusible_elementwise_op("test::missing.out"), nullptr);
+}
+
+TEST_F(ElementwiseFusionTest, ReregistrationFails) {
+  const FusibleElementwiseOp op = {
+      "test::add_one.out",
+      3,
+      0,
+      1,
+      add_one_tile,
+      /*can_fuse_fn_=*/nullptr,
+      /*parallel_for_=*/nullptr,
+      add_one_kernel};
+  EXPECT_EQ(
+      register_fusible_elementwise_ops({&op, 1}),
+      Error::RegistrationAlreadyRegistered);
+}
+
+TEST_F(ElementwiseFusionTest, MalformedOpFails) {
+  const FusibleElementwiseOp op = {
+      "test::bad.out",
+      2,
+      0,
+      0,
+      add_one_tile,
+      /*can_fuse_fn_=*/nullptr,
+      /*parallel_for_=*/nullptr,
+      add_one_kernel};
+  EXPECT_EQ(register_fusible_elementwise_ops({&op, 1}), Error::InvalidArgument);
+  EXPECT_EQ(get_fusible_elementwise_op("test::bad.out"), nullptr);
+}
+
+TEST_F(ElementwiseFusionTest, OpWithoutKernelFails) {
+  const FusibleElementwiseOp op = {
+      "test::no_kernel.out", 3, 0, 1, add_one_tile};
+  EXPECT_EQ(register_fusible_elementwise_ops({&op, 1}), Error::InvalidArgument);
+  EXPECT_EQ(get_fusible_elementwise_op("test::no_kernel.out"), nullptr);
+}
+
+TEST_F(ElementwiseFusionTest, FusedChainSkipsIntermediates) {
+  // (x + 1) * y + 1, over enough elements to span several tiles.
+  const std::vector<int32_t> sizes = {3, 700};
+  std::vector<float> x_data(2100);
+  std::vector<float> y_data(2100);
+  std::vector<float> expected_data(2100);
+  for (size_t i = 0; i < x_data.size(); ++i) {
+    x_data[i] = static_cast<float>(i % 17) - 8.0f;
+    y_data[i] = 0.5f * static_cast<float>(i % 5);
+    expected_data[i] = (x_data[i] + 1.0f) * y_data[i] + 1.0f;
+  }
+  EValue values[] = {
+      EValue(tf_.make(sizes, x_data)),
+      EValue(tf_.zeros(sizes)), // intermediate 0
+      EValue(tf_.make(sizes, y_data)),
+      EValue(tf_.full(sizes, 42.0f)), // intermediate 1
+      EValue(tf_.ones(sizes)), // output
+  };
+  EValue* stage0_args[] = {&values[0], &values[1], &values[1]};
+  EValue* stage1_args[] = {&values[1], &values[2], &values[3], &values[3]};
+  EValue* stage2_args[] = {&values[3], &values[4], &values[4]};
+  const FusedElementwiseStage stages[] = {
+      {get_fusible_elementwise_op("test::add_one.out"),
+       add_one_kernel,
+       stage0_args},
+      {get_fusible_elementwise_op("test::mul.out"), mul_kernel, stage1_args},
+      {get_fusible_elementwise_op("test::add_one.out"),
+       add_one_kernel,
+       stage2_args},
+  };
+
+  KernelRuntimeContext context;
+  execute_fused_elementwise(context, {stages, 3});
+  ASSERT_EQ(context.failure_state(), Error::Ok);
+
+  EXPECT_EQ(unfused_calls, 0);
+  EXPECT_TENSOR_EQ(values[4].toTensor(), tf_.make(sizes, expected_data));
+  // Intermediates are never written.
+  EXPECT_TENSOR_EQ(values[1].toTensor(), tf_.zeros(sizes));
+  EXPECT_TENSOR_EQ(values[3].toTensor(), tf_.full(sizes, 42.0f));
+}
+
+TEST_F(ElementwiseFusionTest, ShapeMismatchFallsBackToUnfusedKernels) {
+  // y is broadcast, which the fused path does not handle.
+  EValue values[] = {
+      EValue(tf_.make({2, 2}, {1, 2, 3, 4})),
+      EValue(tf_.zeros({2, 2})),
+      EValue(tf_.make({1}, {2})),
+      EValue(tf_.zeros({2, 2})),
+  };
+  EValue* stage0_args[] = {&values[0], &values[1], &values[1]};
+  EValue* stage1_args[] = {&values[1], &values[2], &values[3], &values[3]};
+  const FusedElementwiseStage stages[] = {
+      {get_fusible_elementwise_op("test::add_one.out"),
+       add_one_kernel,
+       stage0_args},
+      {get_fusible_elementwise_op("test::mul.out"), mul_kernel, stage1_args},
+  };
+
+  KernelRuntimeContext context;
+  execute_fused_elementwise(context, {stages, 2});
+  ASSERT_EQ(context.failure_state(), Error::Ok);
+
+  EXPECT_EQ(unfused_calls, 2);
+  EXPECT_TENSOR_EQ(values[1].toTensor(), tf_.make({2, 2}, {2, 3, 4, 5}));
+  EXPECT_TENSOR_EQ(values[3].toTensor(), tf_.make({2, 2}, {4, 6, 8, 10}));
+}
+
+TEST_F(ElementwiseFusionTest, NonFloatFallsBackToUnfusedKernels) {
+  TensorFactory<ScalarType::Int> tf_int;
+  EValue values[] = {
+      EValue(tf_int.make({2}, {1, 2})),
+      EValue(tf_.zeros({2})),
+      EValue(tf_.zeros({2})),
+  };
+  EValue* stage0_args[] = {&values[0], &values[1], &values[1]};
+  EValue* stage1_args[] = {&values[1], &values[2], &values[2]};
+  const FusedElementwiseStage stages[] = {
+      {get_fusible_elementwise_op("test::add_one.out"),
+       counting_kernel,
+       stage0_args},
+      {get_fusible_elementwise_op("test::add_one.out"),
+       counting_kernel,
+       stage1_args},
+  };
+
+  KernelRuntimeContext context;
+  execute_fused_elementwise(context, {stages, 2});
+  EXPECT_EQ(context.failure_state(), Error::Ok);
+  EXPECT_EQ(unfused_calls, 2);
+}
+
+TEST_F(ElementwiseFusionTest, LargeChainsAreSplitWithParallelFor) {
+  // Two and a half grain sizes, so the last chunk ends mid-tile.
+  const int32_t numel = 32768 * 2 + 16385;
+  std::vector<float> x_data(numel);
+  std::vector<float> expected_data(numel);
+  for (int32_t i = 0; i < numel; ++i) {
+    x_data[i] = static_cast<float>(i % 13);
+    expected_data[i] = x_data[i] + 2.0f;
+  }
+  EValue values[] = {
+      EValue(tf_.make({numel}, x_data)),
+      EValue(tf_.zeros({numel})), // intermediate
+      EValue(tf_.zeros({numel})), // output
+  };
+  EValue* stage0_args[] = {&values[0], &values[1], &values[1]};
+  EValue* stage1_args[] = {&values[1], &values[2], &values[2]};
+  const FusedElementwiseStage stages[] = {
+      {get_fusible_elementwise_op("test::parallel_add_one.out"),
+       add_one_kernel,
+       stage0_args},
+      {get_fusible_elementwise_op("test::add_one.out"),
+       add_one_kernel,
+       stage1_args},
+  };
+
+  KernelRuntimeContext context;
+  execute_fused_elementwise(context, {stages, 2});
+  ASSERT_EQ(context.failure_state(), Error::Ok);
+
+  EXPECT_EQ(unfused_calls, 0);
+  EXPECT_EQ(parallel_chunks, 3);
+  EXPECT_TENSOR_EQ(values[2].toTensor(), tf_.make({numel}, expected_data));
+  EXPECT_TENSOR_EQ(values[1].toTensor(), tf_.zeros({numel}));
+}
+
+TEST_F(ElementwiseFusionTest, SmallChainsRunOnTheCallingThread) {
+  EValue values[] = {
+      EValue(tf_.make({3}, {1, 2, 3})),
+      EValue(tf_.zeros({3})),
+      EValue(tf_.zeros({3})),
+  };
+  EValue* stage0_args[] = {&values[0], &values[1], &values[1]};
+  EValue* stage1_args[] = {&values[1], &values[2], &values[2]};
+  const FusedElementwiseStage stages[] = {
+      {get_fusible_elementwise_op("test::parallel_add_one.out"),
+       add_one_kernel,
+       stage0_args},
+      {get_fusible_elementwise_op("test::add_one.out"),
+       add_one_kernel,
+       stage1_args},
+  };
+
+  KernelRuntimeContext context;
+  execute_fused_elementwise(context, {stages, 2});
+  ASSERT_EQ(context.failure_state(), Error::Ok);
+
+  EXPECT_EQ(parallel_chunks, 0);
+  EXPECT_TENSOR_EQ(values[2].toTensor(), tf_.make({3}, {3, 4, 5}));
+}
@@ -20,6 +20,18 @@ def define_common_targets():
         ],
     )
 
+    runtime.cxx_test(
+        name = "elementwise_fusion_test",
+        srcs = [
+            "elementwise_fusion_test.cpp",
+        ],
+        deps = [
+            "//executorch/runtime/kernel:elementwise_fusion",
+            "//executorch/runtime/kernel:kernel_runtime_context",
+            "//executorch/runtime/core/exec_aten/testing_util:tensor_util",
+        ],
+    )
+
     runtime.cxx_test(
         name = "operator_registry_max_kernel_num_test",
         srcs = [
@@ -1236,6 +1236,9 @@ ATEN_OPS = (
     ),
     op_target(
         name = "op_topk",
+        deps = [
+            "//executorch/kernels/portable/cpu/util:topk_util",
+        ],
     ),
     op_target(
         name = "op_transpose_copy",
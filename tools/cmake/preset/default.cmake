@@ -129,6 +129,10 @@ define_overridable_option(
 define_overridable_option(
   EXECUTORCH_BUILD_SIZE_TEST "Build the size test" BOOL OFF
 )
+define_overridable_option(
+  EXECUTORCH_BUILD_KERNEL_BENCHMARKS
+  "Build the kernel micro-benchmarks, which need Google Benchmark" BOOL OFF
+)
 define_overridable_option(
   EXECUTORCH_BUILD_XNNPACK "Build the XNNPACK backend" BOOL OFF
 )
@@ -247,6 +251,11 @@ check_required_options_on(
   IF_ON EXECUTORCH_BUILD_TESTS REQUIRES EXECUTORCH_BUILD_EXTENSION_FLAT_TENSOR
 )
 
+check_required_options_on(
+  IF_ON EXECUTORCH_BUILD_KERNEL_BENCHMARKS REQUIRES
+  EXECUTORCH_BUILD_EXTENSION_TENSOR
+)
+
 check_conflicting_options_on(
   IF_ON EXECUTORCH_BUILD_ARM_BAREMETAL CONFLICTS_WITH
   EXECUTORCH_BUILD_EXTENSION_DATA_LOADER EXECUTORCH_BUILD_PTHREADPOOL